@@ -56,6 +56,13 @@ constexpr std::size_t cache_large_max = CACHE_LARGE_MAX;
 constexpr std::size_t cache_large_max = cache_small_max * 8u;
 #endif
 
+/* cache line size to pad shared data to */
+#ifdef CACHE_LINE_SIZE
+constexpr std::size_t cache_line_size = CACHE_LINE_SIZE;
+#else
+constexpr std::size_t cache_line_size = 64u;
+#endif
+
 /* get_divided_value()
 */
 constexpr std::size_t get_quotient_value(std::size_t value, std::size_t divider) noexcept {
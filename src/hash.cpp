@@ -0,0 +1,295 @@
+/**
+    Copyright (c) 2020, wicked systems
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright notice, this list of
+    conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, this list
+    of conditions and the following disclaimer in the documentation and/or other materials
+    provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+    THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+    OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+    HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+    TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**/
+#include "hash.h"
+#include <cstring>
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+/* crc32c tables
+   slicing-by-8 lookup tables for the software implementation and the zero-shift operators
+   used to combine the three interleaved hardware streams; all of them are generated at
+   compile time
+*/
+namespace {
+
+constexpr std::size_t crc_long_size  = 8192u;
+constexpr std::size_t crc_short_size = 256u;
+
+struct crc_table_t
+{
+  std::uint32_t data[8][256];
+};
+
+struct crc_shift_t
+{
+  std::uint32_t data[4][256];
+};
+
+constexpr crc_table_t make_table() noexcept
+{
+      crc_table_t l_table{};
+      for(std::uint32_t l_index = 0; l_index < 256; l_index++) {
+          std::uint32_t l_value = l_index;
+          for(int l_bit = 0; l_bit < 8; l_bit++) {
+              l_value = l_value & 1 ? (l_value >> 1) ^ crc32c::poly : l_value >> 1;
+          }
+          l_table.data[0][l_index] = l_value;
+      }
+      for(std::uint32_t l_index = 0; l_index < 256; l_index++) {
+          std::uint32_t l_value = l_table.data[0][l_index];
+          for(int l_slice = 1; l_slice < 8; l_slice++) {
+              l_value = l_table.data[0][l_value & 255] ^ (l_value >> 8);
+              l_table.data[l_slice][l_index] = l_value;
+          }
+      }
+      return l_table;
+}
+
+constexpr std::uint32_t gf2_matrix_times(const std::uint32_t* matrix, std::uint32_t vector) noexcept
+{
+      std::uint32_t l_sum = 0;
+      while(vector) {
+          if(vector & 1) {
+              l_sum ^= *matrix;
+          }
+          vector >>= 1;
+          matrix++;
+      }
+      return l_sum;
+}
+
+constexpr void gf2_matrix_square(std::uint32_t* square, const std::uint32_t* matrix) noexcept
+{
+      for(int l_index = 0; l_index < 32; l_index++) {
+          square[l_index] = gf2_matrix_times(matrix, matrix[l_index]);
+      }
+}
+
+/* make_shift()
+   build the operator that appends <length> zero bytes to a crc, split into four byte-wise
+   lookup tables
+*/
+constexpr crc_shift_t make_shift(std::size_t length) noexcept
+{
+      crc_shift_t   l_shift{};
+      std::uint32_t l_even[32]{};
+      std::uint32_t l_odd[32]{};
+      std::uint32_t l_row = 1;
+      l_odd[0] = crc32c::poly;
+      for(int l_index = 1; l_index < 32; l_index++) {
+          l_odd[l_index] = l_row;
+          l_row <<= 1;
+      }
+      // operators for two and four zero bits
+      gf2_matrix_square(l_even, l_odd);
+      gf2_matrix_square(l_odd, l_even);
+      // square until the operator covers <length> zero bytes
+      std::uint32_t* l_op = l_odd;
+      do {
+          gf2_matrix_square(l_even, l_odd);
+          length >>= 1;
+          if(length == 0) {
+              l_op = l_even;
+              break;
+          }
+          gf2_matrix_square(l_odd, l_even);
+          length >>= 1;
+      }
+      while(length);
+      for(std::uint32_t l_index = 0; l_index < 256; l_index++) {
+          l_shift.data[0][l_index] = gf2_matrix_times(l_op, l_index);
+          l_shift.data[1][l_index] = gf2_matrix_times(l_op, l_index << 8);
+          l_shift.data[2][l_index] = gf2_matrix_times(l_op, l_index << 16);
+          l_shift.data[3][l_index] = gf2_matrix_times(l_op, l_index << 24);
+      }
+      return l_shift;
+}
+
+constexpr crc_table_t s_crc_table = make_table();
+
+inline std::uint32_t crc_load32(const std::uint8_t* bytes) noexcept
+{
+      std::uint32_t l_result;
+      std::memcpy(std::addressof(l_result), bytes, sizeof(l_result));
+      return l_result;
+}
+
+/* crc_add_sw()
+   slicing-by-8 software implementation
+*/
+std::uint32_t crc_add_sw(std::uint32_t crc, const std::uint8_t* bytes, std::size_t length) noexcept
+{
+      auto& l_table = s_crc_table.data;
+      while(length && (reinterpret_cast<std::uintptr_t>(bytes) & 7)) {
+          crc = l_table[0][(crc ^ *bytes++) & 255] ^ (crc >> 8);
+          length--;
+      }
+      while(length >= 8) {
+          std::uint32_t l_lo = crc ^ crc_load32(bytes);
+          std::uint32_t l_hi = crc_load32(bytes + 4);
+          crc = l_table[7][l_lo & 255] ^
+                l_table[6][(l_lo >> 8) & 255] ^
+                l_table[5][(l_lo >> 16) & 255] ^
+                l_table[4][l_lo >> 24] ^
+                l_table[3][l_hi & 255] ^
+                l_table[2][(l_hi >> 8) & 255] ^
+                l_table[1][(l_hi >> 16) & 255] ^
+                l_table[0][l_hi >> 24];
+          bytes  += 8;
+          length -= 8;
+      }
+      while(length) {
+          crc = l_table[0][(crc ^ *bytes++) & 255] ^ (crc >> 8);
+          length--;
+      }
+      return crc;
+}
+
+#if defined(__x86_64__)
+constexpr crc_shift_t s_crc_long_shift  = make_shift(crc_long_size);
+constexpr crc_shift_t s_crc_short_shift = make_shift(crc_short_size);
+
+inline std::uint32_t crc_shift(const crc_shift_t& shift, std::uint32_t crc) noexcept
+{
+      return shift.data[0][crc & 255] ^
+             shift.data[1][(crc >> 8) & 255] ^
+             shift.data[2][(crc >> 16) & 255] ^
+             shift.data[3][crc >> 24];
+}
+
+inline std::uint64_t crc_load64(const std::uint8_t* bytes) noexcept
+{
+      std::uint64_t l_result;
+      std::memcpy(std::addressof(l_result), bytes, sizeof(l_result));
+      return l_result;
+}
+
+/* crc_add_block()
+   run three independent crc32 instructions over three adjacent blocks of <size> bytes and
+   merge the results; this hides the 3 cycle latency of the instruction
+*/
+__attribute__((target("sse4.2")))
+inline std::uint64_t crc_add_block(std::uint64_t crc0, const std::uint8_t*& bytes, std::size_t size, const crc_shift_t& shift) noexcept
+{
+      std::uint64_t       l_crc1 = 0;
+      std::uint64_t       l_crc2 = 0;
+      const std::uint8_t* l_tail = bytes + size;
+      do {
+          crc0   = _mm_crc32_u64(crc0, crc_load64(bytes));
+          l_crc1 = _mm_crc32_u64(l_crc1, crc_load64(bytes + size));
+          l_crc2 = _mm_crc32_u64(l_crc2, crc_load64(bytes + size * 2));
+          bytes += 8;
+      }
+      while(bytes < l_tail);
+      crc0   = crc_shift(shift, crc0) ^ l_crc1;
+      crc0   = crc_shift(shift, crc0) ^ l_crc2;
+      bytes += size * 2;
+      return crc0;
+}
+
+/* crc_add_hw()
+   SSE4.2 implementation
+*/
+__attribute__((target("sse4.2")))
+std::uint32_t crc_add_hw(std::uint32_t crc, const std::uint8_t* bytes, std::size_t length) noexcept
+{
+      std::uint64_t l_crc = crc;
+      while(length && (reinterpret_cast<std::uintptr_t>(bytes) & 7)) {
+          l_crc = _mm_crc32_u8(l_crc, *bytes++);
+          length--;
+      }
+      while(length >= crc_long_size * 3) {
+          l_crc   = crc_add_block(l_crc, bytes, crc_long_size, s_crc_long_shift);
+          length -= crc_long_size * 3;
+      }
+      while(length >= crc_short_size * 3) {
+          l_crc   = crc_add_block(l_crc, bytes, crc_short_size, s_crc_short_shift);
+          length -= crc_short_size * 3;
+      }
+      while(length >= 8) {
+          l_crc   = _mm_crc32_u64(l_crc, crc_load64(bytes));
+          bytes  += 8;
+          length -= 8;
+      }
+      while(length) {
+          l_crc = _mm_crc32_u8(l_crc, *bytes++);
+          length--;
+      }
+      return l_crc;
+}
+#endif
+
+using crc_add_t = std::uint32_t (*)(std::uint32_t, const std::uint8_t*, std::size_t) noexcept;
+
+crc_add_t crc_add_find() noexcept
+{
+#if defined(__x86_64__)
+      __builtin_cpu_init();
+      if(__builtin_cpu_supports("sse4.2")) {
+          return crc_add_hw;
+      }
+#endif
+      return crc_add_sw;
+}
+
+/* crc_add_get()
+   implementation in use; resolved once, on first call - so that it is valid even during static
+   initialisation of other translation units - and safely so if that first call comes from
+   several threads at once
+*/
+crc_add_t crc_add_get() noexcept
+{
+      static const crc_add_t s_crc_add = crc_add_find();
+      return s_crc_add;
+}
+
+/*namespace*/ }
+
+/* crc32c
+*/
+void  crc32c::add(std::uint32_t& value, const char* bytes, std::size_t length) noexcept
+{
+      if(bytes) {
+          if(length) {
+              value = crc_add_get()(value, reinterpret_cast<const std::uint8_t*>(bytes), length);
+          }
+      }
+}
+
+void  crc32c::add_sw(std::uint32_t& value, const char* bytes, std::size_t length) noexcept
+{
+      if(bytes) {
+          if(length) {
+              value = crc_add_sw(value, reinterpret_cast<const std::uint8_t*>(bytes), length);
+          }
+      }
+}
+
+bool  crc32c::has_hw() noexcept
+{
+#if defined(__x86_64__)
+      return crc_add_get() == crc_add_hw;
+#else
+      return false;
+#endif
+}
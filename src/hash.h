@@ -75,12 +75,12 @@ struct hash<std::uint32_t>
   using traits    = hash_traits<std::uint32_t>;
   using data_type = typename traits::data_type;
 
-  static void set(std::uint32_t& value, std::uint32_t bias = hash_traits<std::uint32_t>::bias) noexcept
+  static constexpr void set(std::uint32_t& value, std::uint32_t bias = hash_traits<std::uint32_t>::bias) noexcept
   {
           value = bias;
   }
 
-  static void add(std::uint32_t& value, const char* bytes, std::size_t length) noexcept
+  static constexpr void add(std::uint32_t& value, const char* bytes, std::size_t length) noexcept
   {
           if(bytes) {
               while(length) {
@@ -91,7 +91,7 @@ struct hash<std::uint32_t>
           }
   }
 
-  static void add(std::uint32_t& value, const char* string) noexcept
+  static constexpr void add(std::uint32_t& value, const char* string) noexcept
   {
           if(string) {
               while(string[0]) {
@@ -132,12 +132,12 @@ struct hash<std::uint64_t>
   using traits    = hash_traits<std::uint64_t>;
   using data_type = typename traits::data_type;
 
-  static void set(std::uint64_t& value, std::uint64_t bias = hash_traits<std::uint64_t>::bias) noexcept
+  static constexpr void set(std::uint64_t& value, std::uint64_t bias = hash_traits<std::uint64_t>::bias) noexcept
   {
           value = bias;
   }
 
-  static void add(std::uint64_t& value, const char* bytes, std::size_t length) noexcept
+  static constexpr void add(std::uint64_t& value, const char* bytes, std::size_t length) noexcept
   {
           if(bytes) {
               while(length) {
@@ -147,7 +147,7 @@ struct hash<std::uint64_t>
               }
           }
   }
-  static void add(std::uint64_t& value, const char* string) noexcept
+  static constexpr void add(std::uint64_t& value, const char* string) noexcept
   {
           if(string) {
               while(string[0]) {
@@ -309,4 +309,50 @@ class hash_ptr
           return *this;
   }
 };
+
+/* crc32c
+   Castagnoli CRC (reflected polynomial 0x82f63b78), as used by iSCSI, ext4 and most storage
+   formats; the running value is kept un-finalized, so that add() can be called repeatedly on
+   consecutive chunks of a stream and get() applied once at the end.
+   The implementation is selected at runtime: the SSE4.2 crc32 instruction over three
+   interleaved streams where the cpu supports it, a slicing-by-8 table lookup otherwise.
+*/
+struct crc32c
+{
+  static constexpr std::uint32_t  poly = 0x82f63b78u;
+  static constexpr std::uint32_t  bias = 0xffffffffu;
+
+  static void set(std::uint32_t& value, std::uint32_t bias = crc32c::bias) noexcept
+  {
+          value = bias;
+  }
+
+  static void add(std::uint32_t& value, const char* bytes, std::size_t length) noexcept;
+
+  /* add_sw()
+     same as add(), always through the software implementation
+  */
+  static void add_sw(std::uint32_t& value, const char* bytes, std::size_t length) noexcept;
+
+  static std::uint32_t get(std::uint32_t value) noexcept
+  {
+          return value ^ bias;
+  }
+
+  /* make()
+     compute the finalized checksum of a single block of memory
+  */
+  static std::uint32_t make(const char* bytes, std::size_t length) noexcept
+  {
+          std::uint32_t l_value;
+          set(l_value);
+          add(l_value, bytes, length);
+          return get(l_value);
+  }
+
+  /* has_hw()
+     check whether the hardware (SSE4.2) implementation is in use
+  */
+  static bool has_hw() noexcept;
+};
 #endif
@@ -0,0 +1,296 @@
+#ifndef memory_bloom_filter_h
+#define memory_bloom_filter_h
+/**
+    Copyright (c) 2020, wicked systems
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright notice, this list of
+    conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, this list
+    of conditions and the following disclaimer in the documentation and/or other materials
+    provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+    THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+    OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+    HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+    TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**/
+#include <memory.h>
+#include <memory/fragment.h>
+#include <hash.h>
+#include <cstring>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace memory {
+
+/* bloom_filter
+   blocked bloom filter: every key maps to a single block of 256 bits and sets one bit in
+   each of the block's eight 32 bit words; blocks are cache line aligned, so that a lookup
+   touches exactly one cache line. The eight bit positions are derived from the key hash with
+   eight odd multipliers and tested in a single pass with AVX2 (or SSE2) where available.
+   Keys are passed in either as strings or as precomputed hash<std::uint64_t> values.
+*/
+class bloom_filter
+{
+  public:
+  static constexpr std::size_t block_words = 8u;
+  static constexpr std::size_t block_bytes = block_words * sizeof(std::uint32_t);
+  static constexpr std::size_t block_align = 64u;
+
+  private:
+  static constexpr std::uint32_t s_salt[block_words] = {
+      0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+      0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u
+  };
+
+  fragment*       m_resource;
+  std::uint32_t*  m_data;
+  std::size_t     m_block_count;
+  std::size_t     m_insert_count;
+
+  private:
+  static inline std::uint64_t get_mix(std::uint64_t hash) noexcept {
+          hash ^= hash >> 33;
+          hash *= 0xff51afd7ed558ccdull;
+          hash ^= hash >> 33;
+          return hash;
+  }
+
+#if defined(__AVX2__)
+  /* get_mask()
+     one bit for each of the eight words of the block
+  */
+  static inline __m256i get_mask(std::uint32_t key) noexcept {
+          __m256i l_bits = _mm256_srli_epi32(
+                  _mm256_mullo_epi32(
+                      _mm256_set1_epi32(key),
+                      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s_salt))
+                  ),
+                  27
+              );
+          return _mm256_sllv_epi32(_mm256_set1_epi32(1), l_bits);
+  }
+#elif defined(__SSE2__)
+  /* get_mask()
+     one bit for each of four words of the block; SSE2 has neither a 32 bit low multiply nor
+     a variable shift, so the multiply is split into two 32x32->64 products and 1 << n is
+     built as the float 2^n, converted back to an integer (2^31 converts to 0x80000000, which
+     happens to be the right answer)
+  */
+  static inline __m128i get_mask(std::uint32_t key, const std::uint32_t* salt) noexcept {
+          __m128i l_key  = _mm_set1_epi32(key);
+          __m128i l_salt = _mm_loadu_si128(reinterpret_cast<const __m128i*>(salt));
+          __m128i l_even = _mm_mul_epu32(l_key, l_salt);
+          __m128i l_odd  = _mm_mul_epu32(l_key, _mm_srli_epi64(l_salt, 32));
+          __m128i l_product = _mm_unpacklo_epi32(
+                  _mm_shuffle_epi32(l_even, _MM_SHUFFLE(0, 0, 2, 0)),
+                  _mm_shuffle_epi32(l_odd, _MM_SHUFFLE(0, 0, 2, 0))
+              );
+          __m128i l_bits = _mm_srli_epi32(l_product, 27);
+          __m128i l_exponent = _mm_slli_epi32(_mm_add_epi32(l_bits, _mm_set1_epi32(127)), 23);
+          return _mm_cvttps_epi32(_mm_castsi128_ps(l_exponent));
+  }
+#endif
+
+  inline  std::uint32_t* get_block(std::uint64_t hash) const noexcept {
+          std::uint64_t l_index = ((hash >> 32) * m_block_count) >> 32;
+          return m_data + l_index * block_words;
+  }
+
+  public:
+  inline  bloom_filter(fragment* resource, std::size_t count, std::size_t bits_per_key = 16u) noexcept:
+          m_resource(resource),
+          m_data(nullptr),
+          m_block_count(0),
+          m_insert_count(0) {
+          reserve(count, bits_per_key);
+  }
+
+  inline  bloom_filter(std::size_t count, std::size_t bits_per_key = 16u) noexcept:
+          bloom_filter(fragment::get_default(), count, bits_per_key) {
+  }
+
+          bloom_filter(const bloom_filter&) noexcept = delete;
+
+  inline  bloom_filter(bloom_filter&& copy) noexcept:
+          m_resource(copy.m_resource),
+          m_data(copy.m_data),
+          m_block_count(copy.m_block_count),
+          m_insert_count(copy.m_insert_count) {
+          copy.m_data = nullptr;
+          copy.m_block_count = 0;
+          copy.m_insert_count = 0;
+  }
+
+  inline  ~bloom_filter() {
+          reset();
+  }
+
+  /* reserve()
+     (re)allocate the filter for <count> keys at <bits_per_key>; the filter is cleared
+  */
+          bool  reserve(std::size_t count, std::size_t bits_per_key = 16u) noexcept {
+          std::size_t l_bits = count * bits_per_key;
+          std::size_t l_block_count = global::get_quotient_value(l_bits, block_bytes * 8u);
+          if(l_block_count == 0) {
+              l_block_count = 1;
+          }
+          if(l_block_count > std::numeric_limits<std::uint32_t>::max()) {
+              return false;
+          }
+          reset();
+          if(m_resource) {
+              std::size_t l_size = global::get_round_value(l_block_count * block_bytes, block_align);
+              m_data = reinterpret_cast<std::uint32_t*>(m_resource->allocate(l_size, block_align));
+              if(m_data) {
+                  m_block_count = l_block_count;
+                  clear();
+                  return true;
+              }
+          }
+          return false;
+  }
+
+  /* insert()
+  */
+  inline  void  insert(std::uint64_t hash) noexcept {
+          if(m_data) {
+              hash = get_mix(hash);
+              std::uint32_t* l_block = get_block(hash);
+              std::uint32_t  l_key = hash;
+#if defined(__AVX2__)
+              __m256i* l_data = reinterpret_cast<__m256i*>(l_block);
+              _mm256_store_si256(l_data, _mm256_or_si256(_mm256_load_si256(l_data), get_mask(l_key)));
+#elif defined(__SSE2__)
+              __m128i* l_data = reinterpret_cast<__m128i*>(l_block);
+              _mm_store_si128(l_data + 0, _mm_or_si128(_mm_load_si128(l_data + 0), get_mask(l_key, s_salt + 0)));
+              _mm_store_si128(l_data + 1, _mm_or_si128(_mm_load_si128(l_data + 1), get_mask(l_key, s_salt + 4)));
+#else
+              for(std::size_t l_word = 0; l_word < block_words; l_word++) {
+                  l_block[l_word] |= 1u << ((l_key * s_salt[l_word]) >> 27);
+              }
+#endif
+              m_insert_count++;
+          }
+  }
+
+  inline  void  insert(const char* key, std::size_t length) noexcept {
+          std::uint64_t l_hash;
+          hash<std::uint64_t>::set(l_hash);
+          hash<std::uint64_t>::add(l_hash, key, length);
+          insert(l_hash);
+  }
+
+  inline  void  insert(const char* key) noexcept {
+          std::uint64_t l_hash;
+          hash<std::uint64_t>::set(l_hash);
+          hash<std::uint64_t>::add(l_hash, key);
+          insert(l_hash);
+  }
+
+  /* contains()
+     false if the key was definitely never inserted, true if it probably was
+  */
+  inline  bool  contains(std::uint64_t hash) const noexcept {
+          if(m_data) {
+              hash = get_mix(hash);
+              const std::uint32_t* l_block = get_block(hash);
+              std::uint32_t        l_key = hash;
+#if defined(__AVX2__)
+              return _mm256_testc_si256(_mm256_load_si256(reinterpret_cast<const __m256i*>(l_block)), get_mask(l_key));
+#elif defined(__SSE2__)
+              const __m128i* l_data = reinterpret_cast<const __m128i*>(l_block);
+              __m128i l_miss = _mm_or_si128(
+                      _mm_andnot_si128(_mm_load_si128(l_data + 0), get_mask(l_key, s_salt + 0)),
+                      _mm_andnot_si128(_mm_load_si128(l_data + 1), get_mask(l_key, s_salt + 4))
+                  );
+              return _mm_movemask_epi8(_mm_cmpeq_epi32(l_miss, _mm_setzero_si128())) == 0xffff;
+#else
+              for(std::size_t l_word = 0; l_word < block_words; l_word++) {
+                  if((l_block[l_word] & (1u << ((l_key * s_salt[l_word]) >> 27))) == 0) {
+                      return false;
+                  }
+              }
+              return true;
+#endif
+          }
+          return false;
+  }
+
+  inline  bool  contains(const char* key, std::size_t length) const noexcept {
+          std::uint64_t l_hash;
+          hash<std::uint64_t>::set(l_hash);
+          hash<std::uint64_t>::add(l_hash, key, length);
+          return contains(l_hash);
+  }
+
+  inline  bool  contains(const char* key) const noexcept {
+          std::uint64_t l_hash;
+          hash<std::uint64_t>::set(l_hash);
+          hash<std::uint64_t>::add(l_hash, key);
+          return contains(l_hash);
+  }
+
+  inline  void  clear() noexcept {
+          if(m_data) {
+              std::memset(m_data, 0, m_block_count * block_bytes);
+          }
+          m_insert_count = 0;
+  }
+
+  inline  void  reset() noexcept {
+          if(m_data) {
+              m_resource->deallocate(m_data, global::get_round_value(m_block_count * block_bytes, block_align), block_align);
+              m_data = nullptr;
+          }
+          m_block_count = 0;
+          m_insert_count = 0;
+  }
+
+  /* get_count()
+     number of insert() calls since the last clear()
+  */
+  inline  std::size_t get_count() const noexcept {
+          return m_insert_count;
+  }
+
+  /* get_size()
+     size of the filter, in bytes
+  */
+  inline  std::size_t get_size() const noexcept {
+          return m_block_count * block_bytes;
+  }
+
+  inline  operator bool() const noexcept {
+          return m_data;
+  }
+
+          bloom_filter& operator=(const bloom_filter&) noexcept = delete;
+
+  inline  bloom_filter& operator=(bloom_filter&& rhs) noexcept {
+          if(std::addressof(rhs) != this) {
+              reset();
+              m_resource = rhs.m_resource;
+              m_data = rhs.m_data;
+              m_block_count = rhs.m_block_count;
+              m_insert_count = rhs.m_insert_count;
+              rhs.m_data = nullptr;
+              rhs.m_block_count = 0;
+              rhs.m_insert_count = 0;
+          }
+          return *this;
+  }
+};
+
+/*namespace memory*/ }
+#endif
@@ -0,0 +1,353 @@
+#ifndef memory_cuckoo_filter_h
+#define memory_cuckoo_filter_h
+/**
+    Copyright (c) 2020, wicked systems
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright notice, this list of
+    conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, this list
+    of conditions and the following disclaimer in the documentation and/or other materials
+    provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+    THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+    OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+    HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+    TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**/
+#include <memory.h>
+#include <memory/fragment.h>
+#include <hash.h>
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace memory {
+
+/* cuckoo_filter
+   approximate set membership with deletion: every key is reduced to a 16 bit fingerprint
+   stored in one of two candidate buckets of four slots each; the alternate bucket is derived
+   from the current bucket and the fingerprint alone, so that entries can be relocated without
+   the original key. A lookup loads both 8 byte buckets into one SSE2 register and compares all
+   eight slots at once.
+   Only keys that have actually been inserted may be remove()-d.
+*/
+class cuckoo_filter
+{
+  public:
+  static constexpr std::size_t bucket_slots = 4u;
+  static constexpr std::size_t bucket_bytes = bucket_slots * sizeof(std::uint16_t);
+  static constexpr std::size_t bucket_align = 64u;
+  static constexpr int         kick_max = 500;
+
+  private:
+  fragment*       m_resource;
+  std::uint16_t*  m_data;
+  std::size_t     m_bucket_mask;
+  std::size_t     m_insert_count;
+  std::uint32_t   m_kick_seed;
+
+  private:
+  static inline std::uint64_t get_mix(std::uint64_t hash) noexcept {
+          hash ^= hash >> 33;
+          hash *= 0xff51afd7ed558ccdull;
+          hash ^= hash >> 33;
+          return hash;
+  }
+
+  /* get_fingerprint()
+     16 bit fingerprint from the upper half of the hash; 0 marks an empty slot and is never
+     returned
+  */
+  static inline std::uint16_t get_fingerprint(std::uint64_t hash) noexcept {
+          std::uint16_t l_result = hash >> 48;
+          if(l_result == 0) {
+              l_result = 1;
+          }
+          return l_result;
+  }
+
+  inline  std::size_t get_alt_index(std::size_t index, std::uint16_t fingerprint) const noexcept {
+          return (index ^ (fingerprint * 0x5bd1e995u)) & m_bucket_mask;
+  }
+
+  inline  std::uint16_t* get_bucket(std::size_t index) const noexcept {
+          return m_data + index * bucket_slots;
+  }
+
+  inline  bool  put(std::size_t index, std::uint16_t fingerprint) noexcept {
+          std::uint16_t* l_bucket = get_bucket(index);
+          for(std::size_t l_slot = 0; l_slot < bucket_slots; l_slot++) {
+              if(l_bucket[l_slot] == 0) {
+                  l_bucket[l_slot] = fingerprint;
+                  return true;
+              }
+          }
+          return false;
+  }
+
+  inline  bool  drop(std::size_t index, std::uint16_t fingerprint) noexcept {
+          std::uint16_t* l_bucket = get_bucket(index);
+          for(std::size_t l_slot = 0; l_slot < bucket_slots; l_slot++) {
+              if(l_bucket[l_slot] == fingerprint) {
+                  l_bucket[l_slot] = 0;
+                  return true;
+              }
+          }
+          return false;
+  }
+
+  public:
+  inline  cuckoo_filter(fragment* resource, std::size_t count) noexcept:
+          m_resource(resource),
+          m_data(nullptr),
+          m_bucket_mask(0),
+          m_insert_count(0),
+          m_kick_seed(0x9e3779b9u) {
+          reserve(count);
+  }
+
+  inline  cuckoo_filter(std::size_t count) noexcept:
+          cuckoo_filter(fragment::get_default(), count) {
+  }
+
+          cuckoo_filter(const cuckoo_filter&) noexcept = delete;
+
+  inline  cuckoo_filter(cuckoo_filter&& copy) noexcept:
+          m_resource(copy.m_resource),
+          m_data(copy.m_data),
+          m_bucket_mask(copy.m_bucket_mask),
+          m_insert_count(copy.m_insert_count),
+          m_kick_seed(copy.m_kick_seed) {
+          copy.m_data = nullptr;
+          copy.m_bucket_mask = 0;
+          copy.m_insert_count = 0;
+  }
+
+  inline  ~cuckoo_filter() {
+          reset();
+  }
+
+  /* reserve()
+     (re)allocate the filter for <count> keys at a load factor of at most 95%; the filter is
+     cleared
+  */
+          bool  reserve(std::size_t count) noexcept {
+          std::size_t l_bucket_count = std::bit_ceil(
+              global::get_quotient_value(count + count / 19u, bucket_slots) | 1u
+          );
+          reset();
+          if(m_resource) {
+              std::size_t l_size = global::get_round_value(l_bucket_count * bucket_bytes, bucket_align);
+              m_data = reinterpret_cast<std::uint16_t*>(m_resource->allocate(l_size, bucket_align));
+              if(m_data) {
+                  m_bucket_mask = l_bucket_count - 1u;
+                  clear();
+                  return true;
+              }
+          }
+          return false;
+  }
+
+  /* insert()
+     add a key to the filter; fails if the filter is too full to make room for it, in which
+     case the filter is left unchanged
+  */
+  inline  bool  insert(std::uint64_t hash) noexcept {
+          if(m_data) {
+              hash = get_mix(hash);
+              std::uint16_t l_fingerprint = get_fingerprint(hash);
+              std::size_t   l_index_0 = hash & m_bucket_mask;
+              std::size_t   l_index_1 = get_alt_index(l_index_0, l_fingerprint);
+              if(put(l_index_0, l_fingerprint) ||
+                  put(l_index_1, l_fingerprint)) {
+                  m_insert_count++;
+                  return true;
+              }
+              // both buckets are full: evict random victims along the cuckoo path, remembering
+              // the path so that the filter can be rolled back if no free slot is found
+              std::size_t    l_index = (m_kick_seed & 1u) ? l_index_1 : l_index_0;
+              std::uint16_t  l_carry = l_fingerprint;
+              std::uint8_t   l_path[kick_max];
+              for(int l_kick = 0; l_kick < kick_max; l_kick++) {
+                  m_kick_seed ^= m_kick_seed << 13;
+                  m_kick_seed ^= m_kick_seed >> 17;
+                  m_kick_seed ^= m_kick_seed << 5;
+                  std::size_t    l_slot = m_kick_seed % bucket_slots;
+                  std::uint16_t* l_bucket = get_bucket(l_index);
+                  std::swap(l_carry, l_bucket[l_slot]);
+                  l_path[l_kick] = l_slot;
+                  l_index = get_alt_index(l_index, l_carry);
+                  if(put(l_index, l_carry)) {
+                      m_insert_count++;
+                      return true;
+                  }
+              }
+              // undo the relocations, in reverse order
+              for(int l_kick = kick_max - 1; l_kick >= 0; l_kick--) {
+                  l_index = get_alt_index(l_index, l_carry);
+                  std::swap(l_carry, get_bucket(l_index)[l_path[l_kick]]);
+              }
+          }
+          return false;
+  }
+
+  inline  bool  insert(const char* key, std::size_t length) noexcept {
+          std::uint64_t l_hash;
+          hash<std::uint64_t>::set(l_hash);
+          hash<std::uint64_t>::add(l_hash, key, length);
+          return insert(l_hash);
+  }
+
+  inline  bool  insert(const char* key) noexcept {
+          std::uint64_t l_hash;
+          hash<std::uint64_t>::set(l_hash);
+          hash<std::uint64_t>::add(l_hash, key);
+          return insert(l_hash);
+  }
+
+  /* contains()
+     false if the key is definitely not in the filter, true if it probably is
+  */
+  inline  bool  contains(std::uint64_t hash) const noexcept {
+          if(m_data) {
+              hash = get_mix(hash);
+              std::uint16_t l_fingerprint = get_fingerprint(hash);
+              std::size_t   l_index_0 = hash & m_bucket_mask;
+              std::size_t   l_index_1 = get_alt_index(l_index_0, l_fingerprint);
+#if defined(__SSE2__)
+              std::uint64_t l_bucket_0;
+              std::uint64_t l_bucket_1;
+              std::memcpy(std::addressof(l_bucket_0), get_bucket(l_index_0), bucket_bytes);
+              std::memcpy(std::addressof(l_bucket_1), get_bucket(l_index_1), bucket_bytes);
+              __m128i l_data = _mm_set_epi64x(l_bucket_1, l_bucket_0);
+              __m128i l_test = _mm_cmpeq_epi16(l_data, _mm_set1_epi16(l_fingerprint));
+              return _mm_movemask_epi8(l_test) != 0;
+#else
+              const std::uint16_t* l_bucket_0 = get_bucket(l_index_0);
+              const std::uint16_t* l_bucket_1 = get_bucket(l_index_1);
+              for(std::size_t l_slot = 0; l_slot < bucket_slots; l_slot++) {
+                  if((l_bucket_0[l_slot] == l_fingerprint) ||
+                      (l_bucket_1[l_slot] == l_fingerprint)) {
+                      return true;
+                  }
+              }
+#endif
+          }
+          return false;
+  }
+
+  inline  bool  contains(const char* key, std::size_t length) const noexcept {
+          std::uint64_t l_hash;
+          hash<std::uint64_t>::set(l_hash);
+          hash<std::uint64_t>::add(l_hash, key, length);
+          return contains(l_hash);
+  }
+
+  inline  bool  contains(const char* key) const noexcept {
+          std::uint64_t l_hash;
+          hash<std::uint64_t>::set(l_hash);
+          hash<std::uint64_t>::add(l_hash, key);
+          return contains(l_hash);
+  }
+
+  /* remove()
+     remove one copy of a previously inserted key
+  */
+  inline  bool  remove(std::uint64_t hash) noexcept {
+          if(m_data) {
+              hash = get_mix(hash);
+              std::uint16_t l_fingerprint = get_fingerprint(hash);
+              std::size_t   l_index_0 = hash & m_bucket_mask;
+              std::size_t   l_index_1 = get_alt_index(l_index_0, l_fingerprint);
+              if(drop(l_index_0, l_fingerprint) ||
+                  drop(l_index_1, l_fingerprint)) {
+                  m_insert_count--;
+                  return true;
+              }
+          }
+          return false;
+  }
+
+  inline  bool  remove(const char* key, std::size_t length) noexcept {
+          std::uint64_t l_hash;
+          hash<std::uint64_t>::set(l_hash);
+          hash<std::uint64_t>::add(l_hash, key, length);
+          return remove(l_hash);
+  }
+
+  inline  bool  remove(const char* key) noexcept {
+          std::uint64_t l_hash;
+          hash<std::uint64_t>::set(l_hash);
+          hash<std::uint64_t>::add(l_hash, key);
+          return remove(l_hash);
+  }
+
+  inline  void  clear() noexcept {
+          if(m_data) {
+              std::memset(m_data, 0, get_size());
+          }
+          m_insert_count = 0;
+  }
+
+  inline  void  reset() noexcept {
+          if(m_data) {
+              m_resource->deallocate(m_data, global::get_round_value(get_size(), bucket_align), bucket_align);
+              m_data = nullptr;
+          }
+          m_bucket_mask = 0;
+          m_insert_count = 0;
+  }
+
+  /* get_count()
+     number of keys currently held in the filter
+  */
+  inline  std::size_t get_count() const noexcept {
+          return m_insert_count;
+  }
+
+  /* get_capacity()
+     total number of fingerprint slots
+  */
+  inline  std::size_t get_capacity() const noexcept {
+          return m_data ? (m_bucket_mask + 1u) * bucket_slots : 0u;
+  }
+
+  /* get_size()
+     size of the filter, in bytes
+  */
+  inline  std::size_t get_size() const noexcept {
+          return get_capacity() * sizeof(std::uint16_t);
+  }
+
+  inline  operator bool() const noexcept {
+          return m_data;
+  }
+
+          cuckoo_filter& operator=(const cuckoo_filter&) noexcept = delete;
+
+  inline  cuckoo_filter& operator=(cuckoo_filter&& rhs) noexcept {
+          if(std::addressof(rhs) != this) {
+              reset();
+              m_resource = rhs.m_resource;
+              m_data = rhs.m_data;
+              m_bucket_mask = rhs.m_bucket_mask;
+              m_insert_count = rhs.m_insert_count;
+              m_kick_seed = rhs.m_kick_seed;
+              rhs.m_data = nullptr;
+              rhs.m_bucket_mask = 0;
+              rhs.m_insert_count = 0;
+          }
+          return *this;
+  }
+};
+
+/*namespace memory*/ }
+#endif
@@ -0,0 +1,316 @@
+#ifndef memory_mpmc_ring_h
+#define memory_mpmc_ring_h
+/**
+    Copyright (c) 2020, wicked systems
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright notice, this list of
+    conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, this list
+    of conditions and the following disclaimer in the documentation and/or other materials
+    provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+    THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+    OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+    HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+    TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**/
+#include <memory.h>
+#include <memory/fragment.h>
+#include <atomic>
+#include <bit>
+#include <new>
+#include <span>
+
+namespace memory {
+
+/* mpmc_ring
+   fixed capacity, lock-free ring buffer for any number of producer and consumer threads
+   Xt - data type
+
+   Every slot carries a sequence number: slot <i> is free for the producer claiming position
+   <p> when its sequence equals <p> and holds data for the consumer claiming position <p> when
+   it equals <p> + 1. Producers and consumers claim positions with a CAS on their own cache
+   line padded index and then publish the slot with a release store of the next sequence, so
+   a slow thread only ever holds up the slot it claimed.
+*/
+template<typename Xt>
+class mpmc_ring
+{
+  public:
+  using  node_type = Xt;
+
+  private:
+  struct slot_t
+  {
+    std::atomic<std::size_t>  seq;
+    alignas(Xt) unsigned char data[sizeof(Xt)];
+
+    inline  Xt*   get_ptr() noexcept {
+            return std::launder(reinterpret_cast<Xt*>(data));
+    }
+  };
+
+  fragment*       m_resource;
+  slot_t*         m_data;
+  std::size_t     m_mask;
+
+  alignas(global::cache_line_size)
+  std::atomic<std::size_t>  m_head;
+
+  alignas(global::cache_line_size)
+  std::atomic<std::size_t>  m_tail;
+
+  private:
+  static constexpr std::size_t get_align() noexcept {
+          return alignof(slot_t) > global::cache_line_size ? alignof(slot_t) : global::cache_line_size;
+  }
+
+  static constexpr std::size_t get_alloc_size(std::size_t capacity) noexcept {
+          return global::get_round_value(capacity * sizeof(slot_t), get_align());
+  }
+
+  /* get_range()
+     claim up to <count> consecutive positions on <index>, whose slots must be at sequence
+     <position> + <bias>; returns the number of positions claimed and stores the first one in
+     <position>
+  */
+  inline  std::size_t get_range(std::atomic<std::size_t>& index, std::size_t& position, std::size_t count, std::size_t bias) noexcept {
+          std::size_t l_position = index.load(std::memory_order_relaxed);
+          while(true) {
+              std::size_t l_count = 0;
+              while(l_count < count) {
+                  slot_t*        l_slot = m_data + ((l_position + l_count) & m_mask);
+                  std::size_t    l_seq  = l_slot->seq.load(std::memory_order_acquire);
+                  std::ptrdiff_t l_diff = l_seq - (l_position + l_count + bias);
+                  if(l_diff != 0) {
+                      if((l_count == 0) &&
+                          (l_diff > 0)) {
+                          // another thread claimed this position already, reload and retry
+                          l_count = std::numeric_limits<std::size_t>::max();
+                      }
+                      break;
+                  }
+                  l_count++;
+              }
+              if(l_count == std::numeric_limits<std::size_t>::max()) {
+                  l_position = index.load(std::memory_order_relaxed);
+                  continue;
+              }
+              if(l_count == 0) {
+                  return 0;
+              }
+              if(index.compare_exchange_weak(l_position, l_position + l_count, std::memory_order_relaxed)) {
+                  position = l_position;
+                  return l_count;
+              }
+          }
+  }
+
+  public:
+  inline  mpmc_ring(fragment* resource, std::size_t capacity) noexcept:
+          m_resource(resource),
+          m_data(nullptr),
+          m_mask(0),
+          m_head(0),
+          m_tail(0) {
+          reserve(capacity);
+  }
+
+  inline  mpmc_ring(std::size_t capacity) noexcept:
+          mpmc_ring(fragment::get_default(), capacity) {
+  }
+
+          mpmc_ring(const mpmc_ring&) noexcept = delete;
+          mpmc_ring(mpmc_ring&&) noexcept = delete;
+
+  inline  ~mpmc_ring() {
+          reset();
+  }
+
+  /* reserve()
+     (re)allocate storage for at least <capacity> elements, rounded up to a power of two;
+     must not be called while any producer or consumer is active
+  */
+          bool  reserve(std::size_t capacity) noexcept {
+          reset();
+          if(m_resource) {
+              if(capacity < 2u) {
+                  capacity = 2u;
+              }
+              std::size_t l_capacity = std::bit_ceil(capacity);
+              m_data = reinterpret_cast<slot_t*>(m_resource->allocate(get_alloc_size(l_capacity), get_align()));
+              if(m_data) {
+                  for(std::size_t l_index = 0; l_index < l_capacity; l_index++) {
+                      new(std::addressof(m_data[l_index].seq)) std::atomic<std::size_t>(l_index);
+                  }
+                  m_mask = l_capacity - 1u;
+                  return true;
+              }
+          }
+          return false;
+  }
+
+  /* push()
+     append an element, false if the ring is full
+  */
+  template<typename... Args>
+  inline  bool  push(Args&&... args) noexcept {
+          if(m_data == nullptr) {
+              return false;
+          }
+          std::size_t l_position;
+          if(get_range(m_tail, l_position, 1u, 0u)) {
+              slot_t* l_slot = m_data + (l_position & m_mask);
+              new(l_slot->data) Xt(std::forward<Args>(args)...);
+              l_slot->seq.store(l_position + 1u, std::memory_order_release);
+              return true;
+          }
+          return false;
+  }
+
+  /* push()
+     append as many elements of <list> as there are consecutive free slots, in order; returns
+     the number pushed
+  */
+  inline  std::size_t push(std::span<const Xt> list) noexcept {
+          if(m_data == nullptr) {
+              return 0;
+          }
+          std::size_t l_position;
+          std::size_t l_count = 0;
+          if(list.size()) {
+              l_count = get_range(m_tail, l_position, list.size(), 0u);
+              for(std::size_t l_index = 0; l_index < l_count; l_index++) {
+                  slot_t* l_slot = m_data + ((l_position + l_index) & m_mask);
+                  new(l_slot->data) Xt(list[l_index]);
+                  l_slot->seq.store(l_position + l_index + 1u, std::memory_order_release);
+              }
+          }
+          return l_count;
+  }
+
+  /* push()
+     as above, moving the elements out of <list> instead of copying them
+  */
+  inline  std::size_t push(std::span<Xt> list) noexcept {
+          if(m_data == nullptr) {
+              return 0;
+          }
+          std::size_t l_position;
+          std::size_t l_count = 0;
+          if(list.size()) {
+              l_count = get_range(m_tail, l_position, list.size(), 0u);
+              for(std::size_t l_index = 0; l_index < l_count; l_index++) {
+                  slot_t* l_slot = m_data + ((l_position + l_index) & m_mask);
+                  new(l_slot->data) Xt(std::move(list[l_index]));
+                  l_slot->seq.store(l_position + l_index + 1u, std::memory_order_release);
+              }
+          }
+          return l_count;
+  }
+
+  /* pop()
+     remove the oldest element into <value>, false if the ring is empty
+  */
+  inline  bool  pop(Xt& value) noexcept {
+          if(m_data == nullptr) {
+              return false;
+          }
+          std::size_t l_position;
+          if(get_range(m_head, l_position, 1u, 1u)) {
+              slot_t* l_slot = m_data + (l_position & m_mask);
+              Xt*     l_node = l_slot->get_ptr();
+              value = std::move(*l_node);
+              l_node->~Xt();
+              l_slot->seq.store(l_position + m_mask + 1u, std::memory_order_release);
+              return true;
+          }
+          return false;
+  }
+
+  /* pop()
+     remove up to <list>.size() of the oldest consecutive elements into <list>; returns the
+     number popped
+  */
+  inline  std::size_t pop(std::span<Xt> list) noexcept {
+          if(m_data == nullptr) {
+              return 0;
+          }
+          std::size_t l_position;
+          std::size_t l_count = 0;
+          if(list.size()) {
+              l_count = get_range(m_head, l_position, list.size(), 1u);
+              for(std::size_t l_index = 0; l_index < l_count; l_index++) {
+                  slot_t* l_slot = m_data + ((l_position + l_index) & m_mask);
+                  Xt*     l_node = l_slot->get_ptr();
+                  list[l_index] = std::move(*l_node);
+                  l_node->~Xt();
+                  l_slot->seq.store(l_position + l_index + m_mask + 1u, std::memory_order_release);
+              }
+          }
+          return l_count;
+  }
+
+  /* get_size()
+     approximate number of elements in the ring
+  */
+  inline  std::size_t get_size() const noexcept {
+          std::size_t l_head = m_head.load(std::memory_order_acquire);
+          std::size_t l_tail = m_tail.load(std::memory_order_acquire);
+          if(l_tail > l_head) {
+              return l_tail - l_head;
+          }
+          return 0;
+  }
+
+  inline  std::size_t get_capacity() const noexcept {
+          return m_data ? m_mask + 1u : 0u;
+  }
+
+  inline  bool  is_empty() const noexcept {
+          return get_size() == 0;
+  }
+
+  /* clear()
+     drop all elements; must not be called while any producer or consumer is active
+  */
+  inline  void  clear() noexcept {
+          std::size_t l_head = m_head.load(std::memory_order_relaxed);
+          std::size_t l_tail = m_tail.load(std::memory_order_relaxed);
+          while(l_head != l_tail) {
+              m_data[l_head & m_mask].get_ptr()->~Xt();
+              l_head++;
+          }
+          for(std::size_t l_index = 0; l_index <= m_mask; l_index++) {
+              m_data[l_index].seq.store(l_index, std::memory_order_relaxed);
+          }
+          m_head.store(0, std::memory_order_relaxed);
+          m_tail.store(0, std::memory_order_relaxed);
+  }
+
+  inline  void  reset() noexcept {
+          if(m_data) {
+              clear();
+              m_resource->deallocate(m_data, get_alloc_size(m_mask + 1u), get_align());
+              m_data = nullptr;
+          }
+          m_mask = 0;
+  }
+
+  inline  operator bool() const noexcept {
+          return m_data;
+  }
+
+          mpmc_ring& operator=(const mpmc_ring&) noexcept = delete;
+          mpmc_ring& operator=(mpmc_ring&&) noexcept = delete;
+};
+
+/*namespace memory*/ }
+#endif
@@ -0,0 +1,329 @@
+#ifndef memory_perfect_map_h
+#define memory_perfect_map_h
+/**
+    Copyright (c) 2020, wicked systems
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright notice, this list of
+    conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, this list
+    of conditions and the following disclaimer in the documentation and/or other materials
+    provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+    THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+    OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+    HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+    TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**/
+#include <memory.h>
+#include <hash.h>
+#include <bit>
+#include <cstring>
+
+namespace memory {
+
+/* perfect_hash
+   collision-free hash table over a fixed set of <Size> string keys, built at compile time;
+   find() maps a key to its index in the original key list at the cost of a single hash, a
+   pilot lookup, one probe and one compare - no allocation and no runtime build.
+   Keys are hashed with a seeded hash<std::uint64_t>: the high half of the hash selects a
+   bucket, the low half - displaced by the bucket's pilot value - selects the slot; the
+   pilots (and, if needed, the seed) are searched for during construction.
+*/
+template<std::size_t Size>
+class perfect_hash
+{
+  static_assert(Size > 0, "perfect_hash over an empty key set is useless.");
+  static_assert(Size < std::numeric_limits<std::int32_t>::max(), "perfect_hash key set too large.");
+
+  public:
+  static constexpr std::size_t  key_count   = Size;
+  static constexpr std::size_t  map_size    = std::bit_ceil(Size + Size / 4);
+  static constexpr std::size_t  map_bits    = std::countr_zero(map_size);
+  static constexpr std::size_t  bucket_size = (Size + 1) / 2;
+  static constexpr unsigned int seed_max    = 256u;
+  static constexpr unsigned int pilot_max   = std::numeric_limits<std::uint16_t>::max();
+
+  private:
+  const char*    m_key[map_size];
+  std::size_t    m_key_length[map_size];
+  std::int32_t   m_key_index[map_size];
+  std::uint16_t  m_pilot[bucket_size];
+  std::uint64_t  m_seed;
+  bool           m_valid;
+
+  private:
+  static constexpr std::size_t  get_length(const char* key) noexcept {
+          std::size_t l_length = 0;
+          while(key[l_length]) {
+              l_length++;
+          }
+          return l_length;
+  }
+
+  static constexpr bool  is_equal(const char* lhs, const char* rhs, std::size_t length) noexcept {
+          if(std::is_constant_evaluated()) {
+              for(std::size_t l_index = 0; l_index < length; l_index++) {
+                  if(lhs[l_index] != rhs[l_index]) {
+                      return false;
+                  }
+              }
+              return true;
+          }
+          return std::memcmp(lhs, rhs, length) == 0;
+  }
+
+  /* get_hash()
+     seeded hash<std::uint64_t>, followed by a finalizer so that the trailing characters
+     of the key reach the upper bits as well
+  */
+  static constexpr std::uint64_t get_hash(const char* key, std::size_t length, std::uint64_t seed) noexcept {
+          std::uint64_t l_hash = 0;
+          hash<std::uint64_t>::set(l_hash, hash_traits<std::uint64_t>::bias ^ seed);
+          hash<std::uint64_t>::add(l_hash, key, length);
+          l_hash ^= l_hash >> 33;
+          l_hash *= 0xff51afd7ed558ccdull;
+          l_hash ^= l_hash >> 33;
+          return l_hash;
+  }
+
+  static constexpr std::size_t  get_bucket(std::uint64_t hash) noexcept {
+          return (hash >> 32) % bucket_size;
+  }
+
+  /* get_slot()
+     displace the hash by the pilot value and take the top bits of a multiplicative hash of
+     the result, so that every bit of the key hash has a chance to separate the slots
+  */
+  static constexpr std::size_t  get_slot(std::uint64_t hash, std::uint16_t pilot) noexcept {
+          if constexpr (map_bits > 0) {
+              std::uint64_t l_mix = (pilot + 1ull) * 0xc6a4a7935bd1e995ull;
+              return ((hash ^ l_mix) * 0x9e3779b97f4a7c15ull) >> (64 - map_bits);
+          } else
+              return 0;
+  }
+
+  /* make_p()
+     try to place all the keys using the given seed, searching for the pilot of each bucket;
+     buckets are placed largest first, while the table is still mostly empty
+  */
+  constexpr bool  make_p(const char* const (&keys)[Size], const std::size_t (&lengths)[Size], std::uint64_t seed) noexcept {
+          std::uint64_t l_hash[Size]{};
+          std::size_t   l_bucket_of[Size]{};
+          std::size_t   l_bucket_count[bucket_size]{};
+          std::size_t   l_bucket_max = 0;
+          bool          l_used[map_size]{};
+          for(std::size_t l_index = 0; l_index < Size; l_index++) {
+              l_hash[l_index] = get_hash(keys[l_index], lengths[l_index], seed);
+              l_bucket_of[l_index] = get_bucket(l_hash[l_index]);
+              if(++l_bucket_count[l_bucket_of[l_index]] > l_bucket_max) {
+                  l_bucket_max = l_bucket_count[l_bucket_of[l_index]];
+              }
+          }
+          for(std::size_t l_slot = 0; l_slot < map_size; l_slot++) {
+              m_key[l_slot] = nullptr;
+              m_key_length[l_slot] = 0;
+              m_key_index[l_slot] = -1;
+          }
+          for(std::size_t l_count = l_bucket_max; l_count > 0; l_count--) {
+              for(std::size_t l_bucket = 0; l_bucket < bucket_size; l_bucket++) {
+                  if(l_bucket_count[l_bucket] != l_count) {
+                      continue;
+                  }
+                  unsigned int l_pilot = 0;
+                  while(l_pilot <= pilot_max) {
+                      std::size_t l_slot_list[Size]{};
+                      std::size_t l_slot_count = 0;
+                      bool        l_fit = true;
+                      for(std::size_t l_index = 0; l_fit && (l_index < Size); l_index++) {
+                          if(l_bucket_of[l_index] == l_bucket) {
+                              std::size_t l_slot = get_slot(l_hash[l_index], l_pilot);
+                              if(l_used[l_slot]) {
+                                  l_fit = false;
+                              }
+                              for(std::size_t l_prev = 0; l_fit && (l_prev < l_slot_count); l_prev++) {
+                                  if(l_slot_list[l_prev] == l_slot) {
+                                      l_fit = false;
+                                  }
+                              }
+                              l_slot_list[l_slot_count++] = l_slot;
+                          }
+                      }
+                      if(l_fit) {
+                          break;
+                      }
+                      l_pilot++;
+                  }
+                  if(l_pilot > pilot_max) {
+                      return false;
+                  }
+                  m_pilot[l_bucket] = l_pilot;
+                  for(std::size_t l_index = 0; l_index < Size; l_index++) {
+                      if(l_bucket_of[l_index] == l_bucket) {
+                          std::size_t l_slot = get_slot(l_hash[l_index], l_pilot);
+                          l_used[l_slot] = true;
+                          m_key[l_slot] = keys[l_index];
+                          m_key_length[l_slot] = lengths[l_index];
+                          m_key_index[l_slot] = l_index;
+                      }
+                  }
+              }
+          }
+          m_seed = seed;
+          return true;
+  }
+
+  public:
+  constexpr perfect_hash(const char* const (&keys)[Size]) noexcept:
+          m_key(),
+          m_key_length(),
+          m_key_index(),
+          m_pilot(),
+          m_seed(0),
+          m_valid(false) {
+          std::size_t l_lengths[Size]{};
+          for(std::size_t l_index = 0; l_index < Size; l_index++) {
+              if(keys[l_index] == nullptr) {
+                  return;
+              }
+              l_lengths[l_index] = get_length(keys[l_index]);
+          }
+          // duplicate keys can not be told apart by any seed
+          for(std::size_t l_index = 0; l_index < Size; l_index++) {
+              for(std::size_t l_other = l_index + 1; l_other < Size; l_other++) {
+                  if(l_lengths[l_index] == l_lengths[l_other]) {
+                      if(is_equal(keys[l_index], keys[l_other], l_lengths[l_index])) {
+                          return;
+                      }
+                  }
+              }
+          }
+          for(unsigned int l_seed = 0; l_seed < seed_max; l_seed++) {
+              if(make_p(keys, l_lengths, l_seed)) {
+                  m_valid = true;
+                  break;
+              }
+          }
+  }
+
+  constexpr perfect_hash(const perfect_hash&) noexcept = default;
+  constexpr perfect_hash(perfect_hash&&) noexcept = default;
+
+  /* find()
+     get the index of <key> in the original key list, or -1 if not a member
+  */
+  constexpr int  find(const char* key, std::size_t length) const noexcept {
+          if(key) {
+              std::uint64_t l_hash = get_hash(key, length, m_seed);
+              std::size_t   l_slot = get_slot(l_hash, m_pilot[get_bucket(l_hash)]);
+              if(m_key_length[l_slot] == length) {
+                  if(m_key[l_slot]) {
+                      if(is_equal(m_key[l_slot], key, length)) {
+                          return m_key_index[l_slot];
+                      }
+                  }
+              }
+          }
+          return -1;
+  }
+
+  constexpr int  find(const char* key) const noexcept {
+          if(key) {
+              return find(key, get_length(key));
+          }
+          return -1;
+  }
+
+  constexpr bool contains(const char* key) const noexcept {
+          return find(key) >= 0;
+  }
+
+  constexpr bool contains(const char* key, std::size_t length) const noexcept {
+          return find(key, length) >= 0;
+  }
+
+  /* is_valid()
+     false if the key set holds null or duplicate keys, or no collision-free layout was found;
+     meant to be checked with a static_assert()
+  */
+  constexpr bool is_valid() const noexcept {
+          return m_valid;
+  }
+
+  constexpr perfect_hash& operator=(const perfect_hash&) noexcept = default;
+  constexpr perfect_hash& operator=(perfect_hash&&) noexcept = default;
+};
+
+template<std::size_t Size>
+perfect_hash(const char* const (&)[Size]) -> perfect_hash<Size>;
+
+/* perfect_map
+   perfect_hash with a value attached to each key
+*/
+template<typename Xt, std::size_t Size>
+class perfect_map
+{
+  public:
+  using  hash_type  = perfect_hash<Size>;
+  using  value_type = typename std::remove_cv<Xt>::type;
+
+  private:
+  hash_type   m_hash;
+  value_type  m_value[Size];
+
+  public:
+  constexpr perfect_map(const char* const (&keys)[Size], const value_type (&values)[Size]) noexcept:
+          m_hash(keys),
+          m_value() {
+          for(std::size_t l_index = 0; l_index < Size; l_index++) {
+              m_value[l_index] = values[l_index];
+          }
+  }
+
+  constexpr perfect_map(const perfect_map&) noexcept = default;
+  constexpr perfect_map(perfect_map&&) noexcept = default;
+
+  /* find()
+     get a pointer to the value associated with <key>, or nullptr if not a member
+  */
+  constexpr const value_type* find(const char* key, std::size_t length) const noexcept {
+          if(int l_index = m_hash.find(key, length); l_index >= 0) {
+              return std::addressof(m_value[l_index]);
+          }
+          return nullptr;
+  }
+
+  constexpr const value_type* find(const char* key) const noexcept {
+          if(int l_index = m_hash.find(key); l_index >= 0) {
+              return std::addressof(m_value[l_index]);
+          }
+          return nullptr;
+  }
+
+  constexpr bool contains(const char* key) const noexcept {
+          return m_hash.contains(key);
+  }
+
+  constexpr bool contains(const char* key, std::size_t length) const noexcept {
+          return m_hash.contains(key, length);
+  }
+
+  constexpr bool is_valid() const noexcept {
+          return m_hash.is_valid();
+  }
+
+  constexpr perfect_map& operator=(const perfect_map&) noexcept = default;
+  constexpr perfect_map& operator=(perfect_map&&) noexcept = default;
+};
+
+template<typename Xt, std::size_t Size>
+perfect_map(const char* const (&)[Size], const Xt (&)[Size]) -> perfect_map<Xt, Size>;
+
+/*namespace memory*/ }
+#endif
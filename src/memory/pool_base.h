@@ -165,6 +165,8 @@ class pool_base
                           }
                           l_base = m_base;
                           m_base = l_copy_ptr;
+                          m_head = l_copy_ptr + (m_head - l_base);
+                          m_tail = l_copy_ptr + (m_tail - l_base);
                           m_last = l_copy_ptr + l_size_new;
                           m_size = l_size_exp;
                       } else
@@ -0,0 +1,423 @@
+#ifndef memory_small_list_h
+#define memory_small_list_h
+/**
+    Copyright (c) 2020, wicked systems
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright notice, this list of
+    conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, this list
+    of conditions and the following disclaimer in the documentation and/or other materials
+    provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+    THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+    OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+    HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+    TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**/
+#include <memory.h>
+#include <memory_resource>
+#include <new>
+
+namespace memory {
+
+/* small_list
+   contiguous list with inline storage for the first N elements; grows into memory from the
+   allocator only once it holds more than N elements
+   Xt - data type
+   N  - number of inline elements
+   At - allocator type
+
+   The interface follows flat_list (and hence std::vector) closely enough to be used as a
+   drop-in replacement for short lists. Moving a list which has spilled over to the allocator
+   transfers the buffer; moving a list which still uses its inline storage moves the elements.
+*/
+template<typename Xt, std::size_t N = 8, typename At = std::pmr::polymorphic_allocator<Xt>>
+class small_list
+{
+  static_assert(N > 0, "small_list requires at least one inline element");
+
+  using  traits_type = std::allocator_traits<At>;
+
+  public:
+  using  node_type = typename std::remove_cv<Xt>::type;
+  using  value_type = Xt;
+  using  allocator_type = At;
+  using  size_type = std::size_t;
+
+  using  iterator = Xt*;
+  using  const_iterator = const Xt*;
+
+  using  iter_type = iterator;
+
+  static constexpr size_t elements_min = N;
+  static constexpr size_t elements_max = 0;
+
+  private:
+  At            m_allocator;
+  Xt*           m_data;
+  std::size_t   m_size;
+  std::size_t   m_capacity;
+  alignas(Xt)   unsigned char m_inline[N * sizeof(Xt)];
+
+  private:
+  inline  Xt*   get_inline() noexcept {
+          return reinterpret_cast<Xt*>(m_inline);
+  }
+
+  inline  void  dispose() noexcept {
+          clear();
+          if(is_inline() == false) {
+              traits_type::deallocate(m_allocator, m_data, m_capacity);
+          }
+          m_data = get_inline();
+          m_capacity = N;
+  }
+
+  /* relocate()
+     move the elements over into a buffer of <capacity> elements
+  */
+          bool  relocate(std::size_t capacity) noexcept {
+          Xt* l_data;
+          if(capacity > N) {
+              l_data = traits_type::allocate(m_allocator, capacity);
+              if(l_data == nullptr) {
+                  return false;
+              }
+          } else
+          if(is_inline() == false) {
+              l_data = get_inline();
+              capacity = N;
+          } else
+              return true;
+          for(std::size_t l_index = 0; l_index < m_size; l_index++) {
+              new(l_data + l_index) Xt(std::move(m_data[l_index]));
+              m_data[l_index].~Xt();
+          }
+          if(is_inline() == false) {
+              traits_type::deallocate(m_allocator, m_data, m_capacity);
+          }
+          m_data = l_data;
+          m_capacity = capacity;
+          return true;
+  }
+
+  inline  bool  grow() noexcept {
+          if(m_size < m_capacity) {
+              return true;
+          }
+          return relocate(m_capacity * 2u);
+  }
+
+  inline  void  assign(const small_list& copy) noexcept {
+          if(std::addressof(copy) != this) {
+              clear();
+              if(reserve(copy.m_size)) {
+                  for(std::size_t l_index = 0; l_index < copy.m_size; l_index++) {
+                      new(m_data + l_index) Xt(copy.m_data[l_index]);
+                  }
+                  m_size = copy.m_size;
+              }
+          }
+  }
+
+  inline  void  assign(small_list&& copy) noexcept {
+          if(std::addressof(copy) != this) {
+              if((copy.is_inline() == false) &&
+                  (copy.m_allocator == m_allocator)) {
+                  dispose();
+                  m_data = copy.m_data;
+                  m_size = copy.m_size;
+                  m_capacity = copy.m_capacity;
+                  copy.m_data = copy.get_inline();
+                  copy.m_size = 0;
+                  copy.m_capacity = N;
+              } else {
+                  clear();
+                  if(reserve(copy.m_size)) {
+                      for(std::size_t l_index = 0; l_index < copy.m_size; l_index++) {
+                          new(m_data + l_index) Xt(std::move(copy.m_data[l_index]));
+                      }
+                      m_size = copy.m_size;
+                  }
+                  copy.clear();
+              }
+          }
+  }
+
+  public:
+  inline  small_list() noexcept:
+          m_allocator(),
+          m_data(get_inline()),
+          m_size(0),
+          m_capacity(N) {
+  }
+
+  inline  small_list(const At& allocator) noexcept:
+          m_allocator(allocator),
+          m_data(get_inline()),
+          m_size(0),
+          m_capacity(N) {
+  }
+
+  inline  small_list(std::pmr::memory_resource* r) noexcept:
+          small_list(At(r)) {
+  }
+
+  inline  small_list(std::pmr::memory_resource* r, size_t reserve) noexcept:
+          small_list(At(r)) {
+          this->reserve(reserve);
+  }
+
+  inline  small_list(std::initializer_list<Xt> list, const At& allocator = At()) noexcept:
+          small_list(allocator) {
+          if(reserve(list.size())) {
+              for(auto& i_node: list) {
+                  new(m_data + m_size) Xt(i_node);
+                  m_size++;
+              }
+          }
+  }
+
+  inline  small_list(const small_list& copy) noexcept:
+          small_list(traits_type::select_on_container_copy_construction(copy.m_allocator)) {
+          assign(copy);
+  }
+
+  inline  small_list(small_list&& copy) noexcept:
+          small_list(copy.m_allocator) {
+          assign(std::move(copy));
+  }
+
+  inline  ~small_list() {
+          dispose();
+  }
+
+  inline  iterator begin() noexcept {
+          return m_data;
+  }
+
+  inline  const_iterator begin() const noexcept {
+          return m_data;
+  }
+
+  inline  const_iterator cbegin() const noexcept {
+          return m_data;
+  }
+
+  inline  iterator end() noexcept {
+          return m_data + m_size;
+  }
+
+  inline  const_iterator end() const noexcept {
+          return m_data + m_size;
+  }
+
+  inline  const_iterator cend() const noexcept {
+          return m_data + m_size;
+  }
+
+  inline  Xt*   data() noexcept {
+          return m_data;
+  }
+
+  inline  const Xt* data() const noexcept {
+          return m_data;
+  }
+
+  inline  Xt&   front() noexcept {
+          return m_data[0];
+  }
+
+  inline  const Xt& front() const noexcept {
+          return m_data[0];
+  }
+
+  inline  Xt&   back() noexcept {
+          return m_data[m_size - 1];
+  }
+
+  inline  const Xt& back() const noexcept {
+          return m_data[m_size - 1];
+  }
+
+  inline  iterator find(const node_type node) noexcept {
+          for(auto it = begin(); it != end(); it++) {
+              if(*it == node) {
+                  return it;
+              }
+          }
+          return end();
+  }
+
+  inline  bool contains(const node_type node) const noexcept {
+          for(auto it = cbegin(); it != cend(); it++) {
+              if(*it == node) {
+                  return true;
+              }
+          }
+          return false;
+  }
+
+  /* reserve()
+     make room for at least <count> elements; never shrinks the list
+  */
+  inline  bool  reserve(std::size_t count) noexcept {
+          if(count > m_capacity) {
+              return relocate(count);
+          }
+          return true;
+  }
+
+  /* shrink_to_fit()
+     move the elements back into the inline storage, if they fit, or into a buffer of the
+     exact size otherwise
+  */
+  inline  bool  shrink_to_fit() noexcept {
+          if(m_size < m_capacity) {
+              return relocate(m_size);
+          }
+          return true;
+  }
+
+  template<typename... Args>
+  inline  Xt*   emplace_back(Args&&... args) noexcept {
+          if(m_size < m_capacity) {
+              Xt* l_node = new(m_data + m_size) Xt(std::forward<Args>(args)...);
+              m_size++;
+              return l_node;
+          } else {
+              // the arguments may refer to an element of this list: build the new element
+              // before relocating
+              Xt l_value(std::forward<Args>(args)...);
+              if(grow()) {
+                  Xt* l_node = new(m_data + m_size) Xt(std::move(l_value));
+                  m_size++;
+                  return l_node;
+              }
+          }
+          return nullptr;
+  }
+
+  inline  bool  push_back(const Xt& value) noexcept {
+          return emplace_back(value);
+  }
+
+  inline  bool  push_back(Xt&& value) noexcept {
+          return emplace_back(std::move(value));
+  }
+
+  /* insert()
+     insert <value> before <position>; returns an iterator to the new element, or end() if
+     the list could not grow
+  */
+  inline  iterator insert(const_iterator position, const Xt& value) noexcept {
+          return emplace(position, value);
+  }
+
+  inline  iterator insert(const_iterator position, Xt&& value) noexcept {
+          return emplace(position, std::move(value));
+  }
+
+  template<typename... Args>
+  inline  iterator emplace(const_iterator position, Args&&... args) noexcept {
+          std::size_t l_index = position - m_data;
+          Xt          l_value(std::forward<Args>(args)...);
+          if(grow()) {
+              if(l_index < m_size) {
+                  new(m_data + m_size) Xt(std::move(m_data[m_size - 1]));
+                  for(std::size_t l_move = m_size - 1; l_move > l_index; l_move--) {
+                      m_data[l_move] = std::move(m_data[l_move - 1]);
+                  }
+                  m_data[l_index].~Xt();
+              }
+              new(m_data + l_index) Xt(std::move(l_value));
+              m_size++;
+              return m_data + l_index;
+          }
+          return end();
+  }
+
+  inline  void  pop_back() noexcept {
+          if(m_size) {
+              m_size--;
+              m_data[m_size].~Xt();
+          }
+  }
+
+  inline  iterator erase(const_iterator position) noexcept {
+          return erase(position, position + 1);
+  }
+
+  inline  iterator erase(const_iterator first, const_iterator last) noexcept {
+          std::size_t l_index = first - m_data;
+          std::size_t l_count = last - first;
+          if(l_count) {
+              for(std::size_t l_move = l_index + l_count; l_move < m_size; l_move++) {
+                  m_data[l_move - l_count] = std::move(m_data[l_move]);
+              }
+              for(std::size_t l_drop = m_size - l_count; l_drop < m_size; l_drop++) {
+                  m_data[l_drop].~Xt();
+              }
+              m_size -= l_count;
+          }
+          return m_data + l_index;
+  }
+
+  inline  void  clear() noexcept {
+          for(std::size_t l_index = 0; l_index < m_size; l_index++) {
+              m_data[l_index].~Xt();
+          }
+          m_size = 0;
+  }
+
+  inline  std::size_t size() const noexcept {
+          return m_size;
+  }
+
+  inline  std::size_t capacity() const noexcept {
+          return m_capacity;
+  }
+
+  inline  bool  empty() const noexcept {
+          return m_size == 0;
+  }
+
+  /* is_inline()
+     true if the elements are held in the inline storage
+  */
+  inline  bool  is_inline() const noexcept {
+          return m_data == reinterpret_cast<const Xt*>(m_inline);
+  }
+
+  inline  At    get_allocator() const noexcept {
+          return m_allocator;
+  }
+
+  inline  Xt&   operator[](std::size_t index) noexcept {
+          return m_data[index];
+  }
+
+  inline  const Xt& operator[](std::size_t index) const noexcept {
+          return m_data[index];
+  }
+
+  inline  small_list& operator=(const small_list& rhs) noexcept {
+          assign(rhs);
+          return *this;
+  }
+
+  inline  small_list& operator=(small_list&& rhs) noexcept {
+          assign(std::move(rhs));
+          return *this;
+  }
+};
+
+/*namespace memory*/ }
+#endif
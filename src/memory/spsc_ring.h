@@ -0,0 +1,275 @@
+#ifndef memory_spsc_ring_h
+#define memory_spsc_ring_h
+/**
+    Copyright (c) 2020, wicked systems
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright notice, this list of
+    conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, this list
+    of conditions and the following disclaimer in the documentation and/or other materials
+    provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+    THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+    OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+    HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+    TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**/
+#include <memory.h>
+#include <memory/fragment.h>
+#include <atomic>
+#include <bit>
+#include <new>
+#include <span>
+
+namespace memory {
+
+/* spsc_ring
+   fixed capacity, wait-free ring buffer for exactly one producer and one consumer thread
+   Xt - data type
+
+   The head (consumer) and tail (producer) indices live on separate cache lines; each side also
+   keeps a private copy of the other side's index and only reloads it when the ring appears
+   full or empty, so that in steady state neither thread touches the other's cache line.
+   Indices grow without wrapping and are masked on access, hence the capacity is a power of two.
+*/
+template<typename Xt>
+class spsc_ring
+{
+  public:
+  using  node_type = Xt;
+
+  private:
+  fragment*       m_resource;
+  Xt*             m_data;
+  std::size_t     m_mask;
+
+  alignas(global::cache_line_size)
+  std::atomic<std::size_t>  m_head;
+  std::size_t               m_tail_cache;
+
+  alignas(global::cache_line_size)
+  std::atomic<std::size_t>  m_tail;
+  std::size_t               m_head_cache;
+
+  private:
+  static constexpr std::size_t get_align() noexcept {
+          return alignof(Xt) > global::cache_line_size ? alignof(Xt) : global::cache_line_size;
+  }
+
+  static constexpr std::size_t get_alloc_size(std::size_t capacity) noexcept {
+          return global::get_round_value(capacity * sizeof(Xt), get_align());
+  }
+
+  /* get_free_count()
+     producer side: number of free slots, reloading the consumer index only when needed
+  */
+  inline  std::size_t get_free_count(std::size_t tail, std::size_t count) noexcept {
+          std::size_t l_capacity = m_mask + 1u;
+          if(l_capacity - (tail - m_head_cache) < count) {
+              m_head_cache = m_head.load(std::memory_order_acquire);
+          }
+          return l_capacity - (tail - m_head_cache);
+  }
+
+  /* get_used_count()
+     consumer side: number of readable slots, reloading the producer index only when needed
+  */
+  inline  std::size_t get_used_count(std::size_t head, std::size_t count) noexcept {
+          if(m_tail_cache - head < count) {
+              m_tail_cache = m_tail.load(std::memory_order_acquire);
+          }
+          return m_tail_cache - head;
+  }
+
+  public:
+  inline  spsc_ring(fragment* resource, std::size_t capacity) noexcept:
+          m_resource(resource),
+          m_data(nullptr),
+          m_mask(0),
+          m_head(0),
+          m_tail_cache(0),
+          m_tail(0),
+          m_head_cache(0) {
+          reserve(capacity);
+  }
+
+  inline  spsc_ring(std::size_t capacity) noexcept:
+          spsc_ring(fragment::get_default(), capacity) {
+  }
+
+          spsc_ring(const spsc_ring&) noexcept = delete;
+          spsc_ring(spsc_ring&&) noexcept = delete;
+
+  inline  ~spsc_ring() {
+          reset();
+  }
+
+  /* reserve()
+     (re)allocate storage for at least <capacity> elements, rounded up to a power of two;
+     must not be called while either side is active
+  */
+          bool  reserve(std::size_t capacity) noexcept {
+          reset();
+          if(m_resource) {
+              if(capacity < 2u) {
+                  capacity = 2u;
+              }
+              std::size_t l_capacity = std::bit_ceil(capacity);
+              m_data = reinterpret_cast<Xt*>(m_resource->allocate(get_alloc_size(l_capacity), get_align()));
+              if(m_data) {
+                  m_mask = l_capacity - 1u;
+                  return true;
+              }
+          }
+          return false;
+  }
+
+  /* push()
+     producer: append an element, false if the ring is full
+  */
+  template<typename... Args>
+  inline  bool  push(Args&&... args) noexcept {
+          if(m_data == nullptr) {
+              return false;
+          }
+          std::size_t l_tail = m_tail.load(std::memory_order_relaxed);
+          if(get_free_count(l_tail, 1u)) {
+              new(m_data + (l_tail & m_mask)) Xt(std::forward<Args>(args)...);
+              m_tail.store(l_tail + 1u, std::memory_order_release);
+              return true;
+          }
+          return false;
+  }
+
+  /* push()
+     producer: append as many elements of <list> as fit, in order; returns the number pushed
+  */
+  inline  std::size_t push(std::span<const Xt> list) noexcept {
+          if(m_data == nullptr) {
+              return 0;
+          }
+          std::size_t l_tail  = m_tail.load(std::memory_order_relaxed);
+          std::size_t l_count = get_free_count(l_tail, list.size());
+          if(l_count > list.size()) {
+              l_count = list.size();
+          }
+          if(l_count) {
+              for(std::size_t l_index = 0; l_index < l_count; l_index++) {
+                  new(m_data + ((l_tail + l_index) & m_mask)) Xt(list[l_index]);
+              }
+              m_tail.store(l_tail + l_count, std::memory_order_release);
+          }
+          return l_count;
+  }
+
+  /* pop()
+     consumer: remove the oldest element into <value>, false if the ring is empty
+  */
+  inline  bool  pop(Xt& value) noexcept {
+          if(m_data == nullptr) {
+              return false;
+          }
+          std::size_t l_head = m_head.load(std::memory_order_relaxed);
+          if(get_used_count(l_head, 1u)) {
+              Xt* l_node = m_data + (l_head & m_mask);
+              value = std::move(*l_node);
+              l_node->~Xt();
+              m_head.store(l_head + 1u, std::memory_order_release);
+              return true;
+          }
+          return false;
+  }
+
+  /* pop()
+     consumer: remove up to <list>.size() of the oldest elements into <list>; returns the
+     number popped
+  */
+  inline  std::size_t pop(std::span<Xt> list) noexcept {
+          if(m_data == nullptr) {
+              return 0;
+          }
+          std::size_t l_head  = m_head.load(std::memory_order_relaxed);
+          std::size_t l_count = get_used_count(l_head, list.size());
+          if(l_count > list.size()) {
+              l_count = list.size();
+          }
+          if(l_count) {
+              for(std::size_t l_index = 0; l_index < l_count; l_index++) {
+                  Xt* l_node = m_data + ((l_head + l_index) & m_mask);
+                  list[l_index] = std::move(*l_node);
+                  l_node->~Xt();
+              }
+              m_head.store(l_head + l_count, std::memory_order_release);
+          }
+          return l_count;
+  }
+
+  /* get_head()
+     consumer: peek at the oldest element without removing it
+  */
+  inline  Xt*   get_head() noexcept {
+          std::size_t l_head = m_head.load(std::memory_order_relaxed);
+          if(get_used_count(l_head, 1u)) {
+              return m_data + (l_head & m_mask);
+          }
+          return nullptr;
+  }
+
+  /* get_size()
+     number of elements in the ring; exact only when called from the producer or the consumer
+     while the other side is idle
+  */
+  inline  std::size_t get_size() const noexcept {
+          return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+  }
+
+  inline  std::size_t get_capacity() const noexcept {
+          return m_data ? m_mask + 1u : 0u;
+  }
+
+  inline  bool  is_empty() const noexcept {
+          return get_size() == 0;
+  }
+
+  /* clear()
+     drop all elements; must not be called while either side is active
+  */
+  inline  void  clear() noexcept {
+          std::size_t l_head = m_head.load(std::memory_order_relaxed);
+          std::size_t l_tail = m_tail.load(std::memory_order_relaxed);
+          while(l_head != l_tail) {
+              m_data[l_head & m_mask].~Xt();
+              l_head++;
+          }
+          m_head.store(0, std::memory_order_relaxed);
+          m_tail.store(0, std::memory_order_relaxed);
+          m_head_cache = 0;
+          m_tail_cache = 0;
+  }
+
+  inline  void  reset() noexcept {
+          if(m_data) {
+              clear();
+              m_resource->deallocate(m_data, get_alloc_size(m_mask + 1u), get_align());
+              m_data = nullptr;
+          }
+          m_mask = 0;
+  }
+
+  inline  operator bool() const noexcept {
+          return m_data;
+  }
+
+          spsc_ring& operator=(const spsc_ring&) noexcept = delete;
+          spsc_ring& operator=(spsc_ring&&) noexcept = delete;
+};
+
+/*namespace memory*/ }
+#endif
@@ -26,6 +26,8 @@
 #include "parallel/posix-thread-base.h"
 #include "parallel/atomic-thread-base.h"
 #include <vector>
+#include <atomic>
+#include <time.h>
 
 namespace parallel {
 
@@ -34,10 +36,26 @@ constexpr long int nspms = nspus * 1000;    /*nanoseconds in a milisecond*/
 constexpr long int nsps  = nspms * 1000;    /*nanoseconds in a second*/
 constexpr long int msps  = 1000;            /*milliseconds in a second*/
 
+/* futex_wait()
+   block while <address> holds <value>, or until <timeout> (relative, forever if null) expires;
+   returns -1 with errno set (EAGAIN, ETIMEDOUT, EINTR) if not woken up
+*/
+long  futex_wait(std::atomic<std::uint32_t>*, std::uint32_t, const struct timespec* = nullptr) noexcept;
+
+/* futex_wake()
+   wake up to <count> threads blocked in futex_wait() on <address>
+*/
+long  futex_wake(std::atomic<std::uint32_t>*, int) noexcept;
+
+/* cpu_relax()
+   spin-wait hint
+*/
+void  cpu_relax() noexcept;
+
 template<typename Bt>
 class thread;
 
-template<typename Xt, typename Ct, typename Vt = std::pmr::vector<Xt>>
+template<typename Xt, typename Ct, typename Vt = std::pmr::vector<Xt>, typename Mt = none>
 class queue;
 
 /*namespace parallel*/ }
@@ -0,0 +1,392 @@
+#ifndef parallel_algorithm_h
+#define parallel_algorithm_h
+/**
+    Copyright (c) 2020, wicked systems
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright notice, this list of
+    conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, this list
+    of conditions and the following disclaimer in the documentation and/or other materials
+    provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+    THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+    OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+    HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+    TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**/
+#include <parallel.h>
+#include "executor.h"
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <sched.h>
+
+namespace parallel {
+
+class range_job;
+
+/* range_task
+   executor task processing the index range [m_head, m_tail) of a range_job
+*/
+struct range_task
+{
+  range_job*    m_job;
+  std::size_t   m_head;
+  std::size_t   m_tail;
+
+  inline  void  operator()() noexcept;
+};
+
+using range_executor = executor<range_task>;
+
+/* get_worker_set()
+   the shared executor all algorithms run on, started on first use with one worker per online
+   processor
+*/
+range_executor& get_worker_set() noexcept;
+
+/* range_job
+   shared state of a single algorithm invocation: the range is split lazily - whoever holds a
+   range larger than the grain size enqueues its upper half and keeps the lower one as long as
+   the executor has fewer tasks than workers, and otherwise works through its range one grain at
+   a time, so that idle workers steal large pieces first and the caller of start() keeps busy on
+   its own share instead of waiting. Split points fall on cache line boundaries of the
+   underlying storage, so that no two tasks write to the same line.
+*/
+class range_job
+{
+  protected:
+  range_executor*           m_executor;
+  std::size_t               m_grain;
+  std::size_t               m_align_base;
+  std::size_t               m_align_step;
+  std::atomic<std::size_t>  m_pending;
+
+  protected:
+  /* get_split()
+     split point for [head, tail): the middle, rounded down to a cache line boundary
+  */
+  inline  std::size_t get_split(std::size_t head, std::size_t tail) const noexcept {
+          std::size_t l_split = head + (tail - head) / 2u;
+          if(l_split > m_align_base) {
+              l_split -= (l_split - m_align_base) % m_align_step;
+          }
+          return l_split;
+  }
+
+  virtual void  run(std::size_t, std::size_t) noexcept = 0;
+
+  public:
+  inline  range_job(range_executor& executor) noexcept:
+          m_executor(std::addressof(executor)),
+          m_grain(1),
+          m_align_base(0),
+          m_align_step(1),
+          m_pending(0) {
+  }
+
+          range_job(const range_job&) noexcept = delete;
+          range_job(range_job&&) noexcept = delete;
+
+  virtual ~range_job() {
+  }
+
+  /* has_idle_worker()
+     true if the executor may have a worker without a task to run
+  */
+  inline  bool  has_idle_worker() const noexcept {
+          return m_executor->get_pending_count() < m_executor->get_worker_count();
+  }
+
+  /* execute()
+     process [head, tail) one grain at a time, handing off the upper half of what is left to the
+     executor whenever it is larger than the grain size and a worker may be idle
+  */
+  inline  void  execute(std::size_t head, std::size_t tail) noexcept {
+          std::size_t l_done = 0;
+          while(head < tail) {
+              if((tail - head > m_grain) &&
+                  has_idle_worker()) {
+                  std::size_t l_split = get_split(head, tail);
+                  if((l_split > head) &&
+                      (l_split < tail)) {
+                      if(m_executor->enqueue(range_task{this, l_split, tail})) {
+                          tail = l_split;
+                          continue;
+                      }
+                  }
+              }
+              std::size_t l_next = tail;
+              if(tail - head > m_grain) {
+                  l_next = head + m_grain;
+              }
+              run(head, l_next);
+              l_done += l_next - head;
+              head = l_next;
+          }
+          m_pending.fetch_sub(l_done, std::memory_order_acq_rel);
+  }
+
+  /* start()
+     process elements [0, count) of a range whose first element lives at <address>, with
+     elements of <size> bytes; the calling thread works on the range alongside the workers and
+     returns once all elements have been processed, so the executor must be running. Nested
+     calls from a worker of the executor run sequentially.
+  */
+          void  start(std::size_t count, std::size_t grain, const void* address, std::size_t size) noexcept {
+          if(count == 0) {
+              return;
+          }
+          std::size_t l_worker_count = m_executor->get_worker_count();
+          if(size && (size <= global::cache_line_size)) {
+              m_align_step = global::cache_line_size / size;
+              if(address) {
+                  std::size_t l_offset = reinterpret_cast<std::uintptr_t>(address) % global::cache_line_size;
+                  if(l_offset) {
+                      m_align_base = ((global::cache_line_size - l_offset) / size) % m_align_step;
+                  }
+              }
+          }
+          if(grain == 0) {
+              grain = count / (l_worker_count * 8u + 1u);
+          }
+          m_grain = global::get_round_value(grain > m_align_step ? grain : m_align_step, m_align_step);
+          if((l_worker_count < 2) ||
+              (count <= m_grain) ||
+              m_executor->has_local_worker()) {
+              run(0, count);
+              return;
+          }
+          m_pending.store(count, std::memory_order_relaxed);
+          execute(0, count);
+          for(int l_spin = 0; m_pending.load(std::memory_order_acquire); l_spin++) {
+              if(l_spin > 64) {
+                  sched_yield();
+              }
+          }
+  }
+
+          range_job& operator=(const range_job&) noexcept = delete;
+          range_job& operator=(range_job&&) noexcept = delete;
+};
+
+inline  void  range_task::operator()() noexcept
+{
+        m_job->execute(m_head, m_tail);
+}
+
+/* get_address()
+   address of the element an iterator refers to, if the storage is contiguous
+*/
+template<typename It>
+inline  const void* get_address(It iter) noexcept
+{
+        if constexpr (std::contiguous_iterator<It>) {
+            return std::to_address(iter);
+        } else
+            return nullptr;
+}
+
+/* for_each_job
+*/
+template<typename It, typename Fn>
+class for_each_job: public range_job
+{
+  It    m_head;
+  Fn&   m_fn;
+
+  protected:
+  virtual void  run(std::size_t head, std::size_t tail) noexcept override {
+          for(It l_iter = m_head + head; l_iter != m_head + tail; l_iter++) {
+              m_fn(*l_iter);
+          }
+  }
+
+  public:
+  inline  for_each_job(range_executor& executor, It head, Fn& fn) noexcept:
+          range_job(executor),
+          m_head(head),
+          m_fn(fn) {
+  }
+};
+
+/* for_each()
+   invoke <fn> on every element of [head, tail), in parallel
+*/
+template<typename It, typename Fn>
+inline  void  for_each(range_executor& executor, It head, It tail, Fn&& fn, std::size_t grain = 0) noexcept
+{
+        if(head != tail) {
+            for_each_job<It, Fn> l_job(executor, head, fn);
+            l_job.start(tail - head, grain, get_address(head), sizeof(*head));
+        }
+}
+
+template<typename It, typename Fn>
+inline  void  for_each(It head, It tail, Fn&& fn, std::size_t grain = 0) noexcept
+{
+        for_each(get_worker_set(), head, tail, std::forward<Fn>(fn), grain);
+}
+
+/* parallel_for_job
+*/
+template<typename Fn>
+class parallel_for_job: public range_job
+{
+  std::size_t m_head;
+  Fn&         m_fn;
+
+  protected:
+  virtual void  run(std::size_t head, std::size_t tail) noexcept override {
+          for(std::size_t l_index = m_head + head; l_index != m_head + tail; l_index++) {
+              m_fn(l_index);
+          }
+  }
+
+  public:
+  inline  parallel_for_job(range_executor& executor, std::size_t head, Fn& fn) noexcept:
+          range_job(executor),
+          m_head(head),
+          m_fn(fn) {
+  }
+};
+
+/* parallel_for()
+   invoke <fn> with every index in [head, tail), in parallel
+*/
+template<typename Fn>
+inline  void  parallel_for(range_executor& executor, std::size_t head, std::size_t tail, Fn&& fn, std::size_t grain = 0) noexcept
+{
+        if(tail > head) {
+            parallel_for_job<Fn> l_job(executor, head, fn);
+            l_job.start(tail - head, grain, nullptr, 0);
+        }
+}
+
+template<typename Fn>
+inline  void  parallel_for(std::size_t head, std::size_t tail, Fn&& fn, std::size_t grain = 0) noexcept
+{
+        parallel_for(get_worker_set(), head, tail, std::forward<Fn>(fn), grain);
+}
+
+/* transform_job
+*/
+template<typename It, typename Ot, typename Fn>
+class transform_job: public range_job
+{
+  It    m_head;
+  Ot    m_out;
+  Fn&   m_fn;
+
+  protected:
+  virtual void  run(std::size_t head, std::size_t tail) noexcept override {
+          Ot l_out = m_out + head;
+          for(It l_iter = m_head + head; l_iter != m_head + tail; l_iter++) {
+              *l_out = m_fn(*l_iter);
+              l_out++;
+          }
+  }
+
+  public:
+  inline  transform_job(range_executor& executor, It head, Ot out, Fn& fn) noexcept:
+          range_job(executor),
+          m_head(head),
+          m_out(out),
+          m_fn(fn) {
+  }
+};
+
+/* transform()
+   store <fn>(element) for every element of [head, tail) into the range starting at <out>, in
+   parallel; the output range is split on its cache line boundaries; returns the end of the
+   output range
+*/
+template<typename It, typename Ot, typename Fn>
+inline  Ot    transform(range_executor& executor, It head, It tail, Ot out, Fn&& fn, std::size_t grain = 0) noexcept
+{
+        if(head != tail) {
+            transform_job<It, Ot, Fn> l_job(executor, head, out, fn);
+            l_job.start(tail - head, grain, get_address(out), sizeof(*out));
+        }
+        return out + (tail - head);
+}
+
+template<typename It, typename Ot, typename Fn>
+inline  Ot    transform(It head, It tail, Ot out, Fn&& fn, std::size_t grain = 0) noexcept
+{
+        return transform(get_worker_set(), head, tail, out, std::forward<Fn>(fn), grain);
+}
+
+/* reduce_job
+*/
+template<typename It, typename Vt, typename Fn>
+class reduce_job: public range_job
+{
+  It                m_head;
+  Vt                m_value;
+  Fn&               m_fn;
+  std::atomic_flag  m_lock;
+
+  protected:
+  virtual void  run(std::size_t head, std::size_t tail) noexcept override {
+          It l_iter = m_head + head;
+          Vt l_value = *l_iter;
+          for(l_iter++; l_iter != m_head + tail; l_iter++) {
+              l_value = m_fn(std::move(l_value), *l_iter);
+          }
+          while(m_lock.test_and_set(std::memory_order_acquire)) {
+          }
+          m_value = m_fn(std::move(m_value), std::move(l_value));
+          m_lock.clear(std::memory_order_release);
+  }
+
+  public:
+  inline  reduce_job(range_executor& executor, It head, Vt value, Fn& fn) noexcept:
+          range_job(executor),
+          m_head(head),
+          m_value(std::move(value)),
+          m_fn(fn),
+          m_lock() {
+  }
+
+  inline  Vt&   get_value() noexcept {
+          return m_value;
+  }
+};
+
+/* reduce()
+   combine <value> and all elements of [head, tail) with <fn>, in parallel; <fn> must be
+   associative and commutative, since partial results are combined in any order
+*/
+template<typename It, typename Vt, typename Fn>
+inline  Vt    reduce(range_executor& executor, It head, It tail, Vt value, Fn&& fn, std::size_t grain = 0) noexcept
+{
+        if(head != tail) {
+            reduce_job<It, Vt, Fn> l_job(executor, head, std::move(value), fn);
+            l_job.start(tail - head, grain, get_address(head), sizeof(*head));
+            return std::move(l_job.get_value());
+        }
+        return value;
+}
+
+template<typename It, typename Vt, typename Fn>
+inline  Vt    reduce(It head, It tail, Vt value, Fn&& fn, std::size_t grain = 0) noexcept
+{
+        return reduce(get_worker_set(), head, tail, std::move(value), std::forward<Fn>(fn), grain);
+}
+
+template<typename It, typename Vt>
+inline  Vt    reduce(It head, It tail, Vt value, std::size_t grain = 0) noexcept
+{
+        return reduce(get_worker_set(), head, tail, std::move(value), std::plus<>(), grain);
+}
+
+/*namespace parallel*/ }
+#endif
@@ -21,20 +21,88 @@
     TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
     SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 **/
-#include "posix-thread-base.h"
-#include <thread>
+#include "thread-base.h"
+#include <pthread.h>
 #include <atomic>
 
-/* NOTE: atomic thread base not yet implemented, defaulting to posix_thread_base
+/* atomic_thread_base
+   thread base driven by a single atomic state word instead of a mutex and a condition variable:
+   the thread spins on the state word for a short while when it runs out of work, then parks on
+   it with a futex; waking it up costs a single atomic operation, plus a system call only if
+   the thread is actually parked
 */
-class atomic_thread_base: public posix_thread_base
+class atomic_thread_base: public parallel::thread_base
 {
+  pthread_t     m_handle;
+
+  using base_type = parallel::thread_base;
+
+  protected:
+  static  constexpr std::uint32_t state_running = 1u;
+  static  constexpr std::uint32_t state_awake = 2u;
+  static  constexpr std::uint32_t state_signal = 4u;
+  static  constexpr int           spin_max = 1024;
+
+  protected:
+  std::atomic<std::uint32_t> m_state;
+  void*         m_return;
+  int           m_affinity;
+
+  protected:
+  static  bool  thread_set_affinity(atomic_thread_base*, int) noexcept;
+  static  void  thread_wake(atomic_thread_base*) noexcept;
+  static  void  thread_wait(atomic_thread_base*) noexcept;
+  static  bool  thread_wait(atomic_thread_base*, int) noexcept;
+  static  void  thread_yield() noexcept;
+  static  void  thread_exit(atomic_thread_base*, void*) noexcept;
+
+  template<typename Ct>
+  static  void* thread_boot(void* p) noexcept {
+          void* l_result = nullptr;
+          Ct*   l_object = reinterpret_cast<Ct*>(p);
+          int   l_affinity = affinity_none;
+          if(l_object) {
+              if(l_object->m_state.load(std::memory_order_acquire) & state_running) {
+                  if constexpr (base_type::has_launch_callback<Ct>::value) {
+                      l_object->thread_launch_event();
+                  }
+                  while(l_object->m_state.load(std::memory_order_acquire) & state_running) {
+                      if(l_object->m_affinity != l_affinity) {
+                          if(thread_set_affinity(l_object, l_object->m_affinity)) {
+                              l_affinity = l_object->m_affinity;
+                          } else
+                          if constexpr (base_type::has_error_callback<Ct>::value) {
+                              if(l_object->thread_error_event(e_thread_affinity_noset, l_result) == false) {
+                                  break;
+                              }
+                          } else
+                              l_affinity = l_object->m_affinity;
+                      }
+                      l_result = l_object->thread_loop(l_object);
+                  }
+                  if constexpr (base_type::has_finish_callback<Ct>::value) {
+                      l_object->thread_finish_event();
+                  }
+              }
+              thread_exit(l_object, l_result);
+              return l_result;
+          }
+          return nullptr;
+  }
+
+  protected:
+          bool  thread_resume(void*, void*(*)(void*)) noexcept;
+          bool  thread_suspend() noexcept;
+
   public:
-          atomic_thread_base(int = affinity_none);
+          atomic_thread_base(int = affinity_none) noexcept;
           atomic_thread_base(const atomic_thread_base&) noexcept = delete;
           atomic_thread_base(atomic_thread_base&&) noexcept = delete;
           ~atomic_thread_base();
-          atomic_thread_base& operator=(const posix_thread_base&) noexcept = delete;
-          atomic_thread_base& operator=(posix_thread_base&&) noexcept = delete;
+          bool  is_running(bool = true) noexcept;
+          bool  is_idle() noexcept;
+          void* get_exit_code() noexcept;
+          atomic_thread_base& operator=(const atomic_thread_base&) noexcept = delete;
+          atomic_thread_base& operator=(atomic_thread_base&&) noexcept = delete;
 };
 #endif
@@ -0,0 +1,524 @@
+#ifndef parallel_executor_h
+#define parallel_executor_h
+/**
+    Copyright (c) 2020, wicked systems
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright notice, this list of
+    conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, this list
+    of conditions and the following disclaimer in the documentation and/or other materials
+    provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+    THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+    OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+    HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+    TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**/
+#include <global.h>
+#include <memory.h>
+#include <memory/fragment.h>
+#include <none.h>
+#include "queue-base.h"
+#include "work-deque.h"
+#include "topology.h"
+#include <unistd.h>
+
+namespace parallel {
+
+/* executor
+   work stealing thread pool
+   Xt - task type; tasks are either invoked as Xt() or passed to the delegate's queue_execute()
+   Ct - delegate type: the class deriving from the executor, which may provide the same optional
+        callbacks as a queue consumer - queue_execute(), thread_wake_event(), thread_sleep_event(),
+        thread_launch_event() and thread_finish_event() (all invoked on the worker threads);
+        void if none are needed
+
+   Every worker owns a Chase-Lev deque: tasks enqueued from within a task go to the deque of the
+   worker running it, and are popped in LIFO order by that worker. Tasks enqueued from any other
+   thread go to a shared injection list, from which workers take them in small batches. A worker
+   that has run out of both steals from the top of another worker's deque, and parks on its
+   condition variable only after a final check of all queues.
+*/
+template<typename Xt, typename Ct = void>
+class executor: public queue_base<none>
+{
+  using base_type = queue_base<none>;
+  using delegate_type = typename std::conditional<std::is_void<Ct>::value, executor, Ct>::type;
+
+  public:
+  using node_type = Xt;
+
+  static constexpr std::size_t cache_max = 256u;
+  static constexpr std::size_t inject_batch_max = 32u;
+  static constexpr std::size_t loop_batch_max = 1024u;
+  static constexpr int         spin_max = 16;
+
+  private:
+  struct task_t
+  {
+    task_t*   next;
+    Xt        value;
+
+    template<typename... Args>
+    inline  task_t(Args&&... args) noexcept:
+            next(nullptr),
+            value(std::forward<Args>(args)...) {
+    }
+  };
+
+  class worker_t: public posix_thread_base
+  {
+    executor*               m_owner;
+    work_deque<task_t*>     m_deque;
+    task_t*                 m_cache;
+    std::size_t             m_cache_size;
+    std::uint32_t           m_seed;
+    bool                    m_parked;
+
+    protected:
+    inline  void* thread_loop(worker_t*) noexcept {
+            return m_owner->worker_loop(this);
+    }
+
+    friend class posix_thread_base;
+    friend class executor;
+
+    public:
+    inline  void  thread_launch_event() noexcept {
+            s_worker = this;
+            if constexpr (has_launch_callback<delegate_type>::value) {
+                m_owner->get_delegate()->thread_launch_event();
+            }
+    }
+
+    inline  void  thread_finish_event() noexcept {
+            if constexpr (has_finish_callback<delegate_type>::value) {
+                m_owner->get_delegate()->thread_finish_event();
+            }
+            s_worker = nullptr;
+    }
+
+    inline  worker_t(executor* owner, std::size_t index) noexcept:
+            posix_thread_base(affinity_none),
+            m_owner(owner),
+            m_deque(owner->m_resource),
+            m_cache(nullptr),
+            m_cache_size(0),
+            m_seed(0x9e3779b9u * (index + 1)),
+            m_parked(false) {
+    }
+
+    inline  ~worker_t() {
+            thread_suspend();
+    }
+
+    inline  bool  resume() noexcept {
+            return thread_resume(this, thread_boot<worker_t>);
+    }
+
+    inline  bool  suspend() noexcept {
+            return thread_suspend();
+    }
+  };
+
+  fragment*     m_resource;
+  worker_t*     m_workers;
+  std::size_t   m_worker_count;
+
+  pthread_mutex_t  m_inject_mutex;
+  task_t*          m_inject_head;
+  task_t*          m_inject_tail;
+
+  alignas(global::cache_line_size)
+  std::atomic<std::size_t>  m_inject_size;
+
+  alignas(global::cache_line_size)
+  std::atomic<std::size_t>  m_idle_count;
+
+  alignas(global::cache_line_size)
+  std::atomic<std::size_t>  m_pending_count;
+
+  static inline thread_local worker_t* s_worker = nullptr;
+
+  private:
+  inline  delegate_type* get_delegate() noexcept {
+          return static_cast<delegate_type*>(this);
+  }
+
+  /* get_local_worker()
+     the worker of this executor the calling thread runs on, if any
+  */
+  inline  worker_t* get_local_worker() const noexcept {
+          if(s_worker) {
+              if(s_worker->m_owner == this) {
+                  return s_worker;
+              }
+          }
+          return nullptr;
+  }
+
+  template<typename... Args>
+  inline  task_t* make_task(worker_t* worker, Args&&... args) noexcept {
+          void* l_memory;
+          if(worker && worker->m_cache) {
+              l_memory = worker->m_cache;
+              worker->m_cache = worker->m_cache->next;
+              worker->m_cache_size--;
+          } else
+              l_memory = m_resource->allocate(sizeof(task_t), alignof(task_t));
+          if(l_memory) {
+              return new(l_memory) task_t(std::forward<Args>(args)...);
+          }
+          return nullptr;
+  }
+
+  inline  void  free_task(worker_t* worker, task_t* task) noexcept {
+          task->~task_t();
+          if(worker && (worker->m_cache_size < cache_max)) {
+              task->next = worker->m_cache;
+              worker->m_cache = task;
+              worker->m_cache_size++;
+          } else
+              m_resource->deallocate(task, sizeof(task_t), alignof(task_t));
+  }
+
+  inline  void  inject(task_t* task) noexcept {
+          pthread_mutex_lock(std::addressof(m_inject_mutex));
+          if(m_inject_tail) {
+              m_inject_tail->next = task;
+          } else
+              m_inject_head = task;
+          m_inject_tail = task;
+          m_inject_size.fetch_add(1, std::memory_order_relaxed);
+          pthread_mutex_unlock(std::addressof(m_inject_mutex));
+  }
+
+  /* notify()
+     wake a parked worker, if there is one; pairs with the idle count increment and the final
+     queue check in worker_loop()
+  */
+  inline  void  notify() noexcept {
+          std::atomic_thread_fence(std::memory_order_seq_cst);
+          if(m_idle_count.load(std::memory_order_relaxed)) {
+              for(std::size_t l_index = 0; l_index < m_worker_count; l_index++) {
+                  worker_t* l_worker = m_workers + l_index;
+                  posix_thread_base::thread_lock(l_worker);
+                  if(l_worker->m_parked) {
+                      l_worker->m_parked = false;
+                      m_idle_count.fetch_sub(1, std::memory_order_relaxed);
+                      posix_thread_base::thread_wake(l_worker);
+                      posix_thread_base::thread_unlock(l_worker);
+                      break;
+                  }
+                  posix_thread_base::thread_unlock(l_worker);
+              }
+          }
+  }
+
+  /* get_task()
+     take the next task for <worker>: own deque first, then a batch off the injection list, then
+     steal from the other workers, starting at a random one
+  */
+          task_t* get_task(worker_t* worker) noexcept {
+          task_t* l_task;
+          if(worker->m_deque.pop(l_task)) {
+              return l_task;
+          }
+          if(m_inject_size.load(std::memory_order_relaxed)) {
+              pthread_mutex_lock(std::addressof(m_inject_mutex));
+              l_task = m_inject_head;
+              if(l_task) {
+                  std::size_t l_count = 1;
+                  task_t*     l_next = l_task->next;
+                  while(l_next && (l_count < inject_batch_max)) {
+                      task_t* l_push = l_next;
+                      l_next = l_next->next;
+                      l_push->next = nullptr;
+                      if(worker->m_deque.push(l_push) == false) {
+                          l_push->next = l_next;
+                          l_next = l_push;
+                          break;
+                      }
+                      l_count++;
+                  }
+                  m_inject_head = l_next;
+                  if(l_next == nullptr) {
+                      m_inject_tail = nullptr;
+                  }
+                  m_inject_size.fetch_sub(l_count, std::memory_order_relaxed);
+                  l_task->next = nullptr;
+              }
+              pthread_mutex_unlock(std::addressof(m_inject_mutex));
+              if(l_task) {
+                  return l_task;
+              }
+          }
+          if(m_worker_count > 1) {
+              worker->m_seed ^= worker->m_seed << 13;
+              worker->m_seed ^= worker->m_seed >> 17;
+              worker->m_seed ^= worker->m_seed << 5;
+              std::size_t l_base = worker->m_seed % m_worker_count;
+              for(std::size_t l_offset = 0; l_offset < m_worker_count; l_offset++) {
+                  worker_t* l_victim = m_workers + ((l_base + l_offset) % m_worker_count);
+                  if(l_victim != worker) {
+                      if(l_victim->m_deque.steal(l_task)) {
+                          return l_task;
+                      }
+                  }
+              }
+          }
+          return nullptr;
+  }
+
+  /* has_task()
+     true if any of the queues holds a task
+  */
+          bool  has_task() const noexcept {
+          if(m_inject_size.load(std::memory_order_relaxed)) {
+              return true;
+          }
+          for(std::size_t l_index = 0; l_index < m_worker_count; l_index++) {
+              if(m_workers[l_index].m_deque.is_empty() == false) {
+                  return true;
+              }
+          }
+          return false;
+  }
+
+  inline  void  execute(worker_t* worker, task_t* task) noexcept {
+          if constexpr (base_type::has_execute_delegate<delegate_type, node_type&>::value) {
+              get_delegate()->queue_execute(task->value);
+          } else
+              task->value();
+          free_task(worker, task);
+          m_pending_count.fetch_sub(1, std::memory_order_release);
+  }
+
+  /* worker_loop()
+     invoked from the thread boot loop, with the worker's lock held
+  */
+          void* worker_loop(worker_t* worker) noexcept {
+          std::size_t l_count = 0;
+          int         l_spin = 0;
+          posix_thread_base::thread_unlock(worker);
+          while((l_count < loop_batch_max) &&
+              (l_spin < spin_max)) {
+              task_t* l_task = get_task(worker);
+              if(l_task) {
+                  execute(worker, l_task);
+                  l_count++;
+                  l_spin = 0;
+              } else {
+                  if(l_count) {
+                      break;
+                  }
+                  posix_thread_base::thread_yield();
+                  l_spin++;
+              }
+          }
+          posix_thread_base::thread_lock(worker);
+          if(l_count == 0) {
+              worker->m_parked = true;
+              m_idle_count.fetch_add(1, std::memory_order_relaxed);
+              std::atomic_thread_fence(std::memory_order_seq_cst);
+              if(has_task() == false) {
+                  if constexpr (base_type::has_sleep_callback<delegate_type>::value) {
+                      get_delegate()->thread_sleep_event();
+                  }
+                  while(worker->m_parked && worker->m_running) {
+                      posix_thread_base::thread_wait(worker);
+                  }
+                  if constexpr (base_type::has_wake_callback<delegate_type>::value) {
+                      get_delegate()->thread_wake_event();
+                  }
+              }
+              if(worker->m_parked) {
+                  worker->m_parked = false;
+                  m_idle_count.fetch_sub(1, std::memory_order_relaxed);
+              }
+          }
+          return nullptr;
+  }
+
+  inline  void  dispose(task_t* task) noexcept {
+          task->~task_t();
+          m_resource->deallocate(task, sizeof(task_t), alignof(task_t));
+          m_pending_count.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  public:
+  /* executor()
+     create an executor with <worker_count> workers (one per online processor if 0); the
+     workers are not started until resume()
+  */
+  inline  executor(std::size_t worker_count = 0, fragment* resource = fragment::get_default()) noexcept:
+          base_type(),
+          m_resource(resource),
+          m_workers(nullptr),
+          m_worker_count(0),
+          m_inject_head(nullptr),
+          m_inject_tail(nullptr),
+          m_inject_size(0),
+          m_idle_count(0),
+          m_pending_count(0) {
+          pthread_mutex_init(std::addressof(m_inject_mutex), nullptr);
+          if(worker_count == 0) {
+              long int l_cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+              worker_count = l_cpu_count > 0 ? l_cpu_count : 1;
+          }
+          if(m_resource) {
+              m_workers = reinterpret_cast<worker_t*>(m_resource->allocate(worker_count * sizeof(worker_t), alignof(worker_t)));
+              if(m_workers) {
+                  for(std::size_t l_index = 0; l_index < worker_count; l_index++) {
+                      new(m_workers + l_index) worker_t(this, l_index);
+                  }
+                  m_worker_count = worker_count;
+              }
+          }
+  }
+
+          executor(const executor&) noexcept = delete;
+          executor(executor&&) noexcept = delete;
+
+  virtual ~executor() {
+          suspend();
+          if(m_workers) {
+              task_t* l_task;
+              for(std::size_t l_index = 0; l_index < m_worker_count; l_index++) {
+                  worker_t* l_worker = m_workers + l_index;
+                  while(l_worker->m_deque.pop(l_task)) {
+                      dispose(l_task);
+                  }
+                  while(l_worker->m_cache) {
+                      l_task = l_worker->m_cache;
+                      l_worker->m_cache = l_task->next;
+                      m_resource->deallocate(l_task, sizeof(task_t), alignof(task_t));
+                  }
+                  l_worker->~worker_t();
+              }
+              m_resource->deallocate(m_workers, m_worker_count * sizeof(worker_t), alignof(worker_t));
+          }
+          while(m_inject_head) {
+              task_t* l_task = m_inject_head;
+              m_inject_head = l_task->next;
+              dispose(l_task);
+          }
+          pthread_mutex_destroy(std::addressof(m_inject_mutex));
+  }
+
+  /* enqueue()
+     construct a task from <args> and schedule it; tasks enqueued from a worker of this executor
+     go to that worker's own deque
+  */
+  template<typename... Args>
+          bool  enqueue(Args&&... args) noexcept {
+          if(base_type::is_enabled()) {
+              worker_t* l_worker = get_local_worker();
+              task_t*   l_task = make_task(l_worker, std::forward<Args>(args)...);
+              if(l_task) {
+                  m_pending_count.fetch_add(1, std::memory_order_relaxed);
+                  if((l_worker == nullptr) ||
+                      (l_worker->m_deque.push(l_task) == false)) {
+                      inject(l_task);
+                  }
+                  notify();
+                  return true;
+              }
+          }
+          return false;
+  }
+
+  /* set_placement()
+     pin the workers to the cpus <policy> picks on <cpu_topology>; takes effect before each
+     worker's next task. place_none leaves the current affinity as it is.
+  */
+          bool  set_placement(placement_policy policy, int producer = -1, const topology& cpu_topology = topology::get_default()) noexcept {
+          if(policy == place_none) {
+              return true;
+          }
+          if(m_worker_count == 0) {
+              return false;
+          }
+          int* l_cpus = static_cast<int*>(m_resource->allocate(m_worker_count * sizeof(int), alignof(int)));
+          if(l_cpus == nullptr) {
+              return false;
+          }
+          bool l_result = cpu_topology.get_placement(policy, m_worker_count, l_cpus, producer) == m_worker_count;
+          if(l_result) {
+              for(std::size_t l_index = 0; l_index < m_worker_count; l_index++) {
+                  if(m_workers[l_index].set_affinity(l_cpus[l_index]) == false) {
+                      l_result = false;
+                  }
+              }
+          }
+          m_resource->deallocate(l_cpus, m_worker_count * sizeof(int), alignof(int));
+          return l_result;
+  }
+
+  /* resume()
+     start (or restart) all workers
+  */
+          bool  resume() noexcept {
+          bool  l_result = m_worker_count > 0;
+          for(std::size_t l_index = 0; l_index < m_worker_count; l_index++) {
+              if(m_workers[l_index].resume() == false) {
+                  l_result = false;
+              }
+          }
+          return l_result;
+  }
+
+  /* suspend()
+     stop all workers after their current task; tasks still queued are kept until the next
+     resume() or until the executor is destroyed
+  */
+          bool  suspend() noexcept {
+          bool  l_result = true;
+          for(std::size_t l_index = 0; l_index < m_worker_count; l_index++) {
+              if(m_workers[l_index].suspend() == false) {
+                  l_result = false;
+              }
+          }
+          return l_result;
+  }
+
+  /* has_local_worker()
+     true if the calling thread is one of the workers of this executor
+  */
+  inline  bool  has_local_worker() const noexcept {
+          return get_local_worker();
+  }
+
+  /* get_worker_count()
+  */
+  inline  std::size_t get_worker_count() const noexcept {
+          return m_worker_count;
+  }
+
+  /* get_pending_count()
+     number of tasks enqueued that have not yet finished executing
+  */
+  inline  std::size_t get_pending_count() const noexcept {
+          return m_pending_count.load(std::memory_order_acquire);
+  }
+
+  /* is_idle()
+     true if all enqueued tasks have been executed
+  */
+  inline  bool  is_idle() const noexcept {
+          return get_pending_count() == 0;
+  }
+
+          executor& operator=(const executor&) noexcept = delete;
+          executor& operator=(executor&&) noexcept = delete;
+};
+
+/*namespace parallel*/ }
+#endif
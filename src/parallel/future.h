@@ -0,0 +1,678 @@
+#ifndef parallel_future_h
+#define parallel_future_h
+/**
+    Copyright (c) 2020, wicked systems
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright notice, this list of
+    conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, this list
+    of conditions and the following disclaimer in the documentation and/or other materials
+    provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+    THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+    OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+    HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+    TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**/
+#include <parallel.h>
+#include <memory.h>
+#include <memory/bank.h>
+#include <memory/fragment.h>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include <time.h>
+
+namespace parallel {
+
+template<typename Xt>
+class future;
+
+template<typename Xt>
+class promise;
+
+/* future_state_base
+   the part of the shared state of a promise/future pair independent of the value type: the
+   state word and blocking on it
+
+   All transitions happen on a single atomic word: the producer sets state_ready (plus
+   state_broken if the promise was dropped unsatisfied) after storing the value, the consumer
+   sets state_continuation after storing a continuation, and waiters set state_waiting before
+   blocking on the word with futex_wait(). Whichever of the producer and the continuation
+   installer comes second runs the continuation, so exactly one of them does; the producer
+   only issues futex_wake() if someone is actually waiting.
+*/
+class future_state_base
+{
+  public:
+  static constexpr std::uint32_t state_ready = 1;
+  static constexpr std::uint32_t state_broken = 2;
+  static constexpr std::uint32_t state_continuation = 4;
+  static constexpr std::uint32_t state_waiting = 8;
+
+  protected:
+  std::atomic<std::uint32_t> m_state;
+  std::atomic<std::uint32_t> m_ref_count;
+
+  public:
+  inline  future_state_base() noexcept:
+          m_state(0),
+          m_ref_count(2) {
+  }
+
+          future_state_base(const future_state_base&) noexcept = delete;
+          future_state_base(future_state_base&&) noexcept = delete;
+
+  /* wait()
+     block until the state is ready
+  */
+  inline  void  wait() noexcept {
+          std::uint32_t l_state = m_state.load(std::memory_order_acquire);
+          while((l_state & state_ready) == 0) {
+              if((l_state & state_waiting) == 0) {
+                  if(m_state.compare_exchange_weak(l_state, l_state | state_waiting, std::memory_order_acquire) == false) {
+                      continue;
+                  }
+                  l_state |= state_waiting;
+              }
+              futex_wait(std::addressof(m_state), l_state);
+              l_state = m_state.load(std::memory_order_acquire);
+          }
+  }
+
+  /* wait()
+     block until the state is ready or <timeout> milliseconds have passed; returns true if ready
+  */
+          bool  wait(int timeout) noexcept {
+          struct timespec l_head_time;
+          struct timespec l_tail_time;
+          std::uint32_t   l_state = m_state.load(std::memory_order_acquire);
+          clock_gettime(CLOCK_MONOTONIC, std::addressof(l_head_time));
+          while((l_state & state_ready) == 0) {
+              if((l_state & state_waiting) == 0) {
+                  if(m_state.compare_exchange_weak(l_state, l_state | state_waiting, std::memory_order_acquire) == false) {
+                      continue;
+                  }
+                  l_state |= state_waiting;
+              }
+              clock_gettime(CLOCK_MONOTONIC, std::addressof(l_tail_time));
+              long int l_time = (l_tail_time.tv_sec - l_head_time.tv_sec) * nsps + l_tail_time.tv_nsec - l_head_time.tv_nsec;
+              long int l_left = timeout * nspms - l_time;
+              if(l_left <= 0) {
+                  return false;
+              }
+              struct timespec l_timeout = {l_left / nsps, l_left % nsps};
+              futex_wait(std::addressof(m_state), l_state, std::addressof(l_timeout));
+              l_state = m_state.load(std::memory_order_acquire);
+          }
+          return true;
+  }
+
+  inline  bool  is_ready() const noexcept {
+          return m_state.load(std::memory_order_acquire) & state_ready;
+  }
+
+  inline  bool  is_broken() const noexcept {
+          return m_state.load(std::memory_order_acquire) & state_broken;
+  }
+
+          future_state_base& operator=(const future_state_base&) noexcept = delete;
+          future_state_base& operator=(future_state_base&&) noexcept = delete;
+};
+
+/* future_state
+   shared state of a promise/future pair holding a value of type <Xt> (none for void)
+   States are drawn from a memory::bank per value type, guarded by a spin lock. A continuation
+   small enough is stored within the state, larger ones are allocated from the default
+   fragment.
+*/
+template<typename Xt>
+class future_state: public future_state_base
+{
+  public:
+  using value_type = typename std::conditional<std::is_void<Xt>::value, none, Xt>::type;
+  using bank_type = memory::bank<future_state, 256>;
+
+  static constexpr std::size_t continuation_size = 48;
+
+  private:
+  class continuation_base
+  {
+    public:
+    std::size_t   m_size;
+
+    public:
+    inline  continuation_base(std::size_t size) noexcept:
+            m_size(size) {
+    }
+
+    virtual void  run(future_state*) noexcept = 0;
+    virtual ~continuation_base() {
+    }
+  };
+
+  template<typename Fn>
+  class continuation_t: public continuation_base
+  {
+    Fn    m_fn;
+
+    public:
+    template<typename Ft>
+    inline  continuation_t(std::size_t size, Ft&& fn) noexcept:
+            continuation_base(size),
+            m_fn(std::forward<Ft>(fn)) {
+    }
+
+    virtual void  run(future_state* state) noexcept override {
+            m_fn(state);
+    }
+  };
+
+  continuation_base*  m_continuation;
+  bool                m_continuation_ref;
+  alignas(std::max_align_t) unsigned char m_continuation_data[continuation_size];
+  alignas(value_type) unsigned char m_value[sizeof(value_type)];
+
+  private:
+  static inline std::atomic_flag& get_lock() noexcept {
+          static std::atomic_flag s_lock;
+          return s_lock;
+  }
+
+  static inline bank_type& get_bank() noexcept {
+          static heap      s_heap;
+          static bank_type s_bank(s_heap);
+          return s_bank;
+  }
+
+  static inline void lock() noexcept {
+          while(get_lock().test_and_set(std::memory_order_acquire)) {
+              cpu_relax();
+          }
+  }
+
+  static inline void unlock() noexcept {
+          get_lock().clear(std::memory_order_release);
+  }
+
+  /* run_continuation()
+     run and dispose of the continuation; it may own the consumer's reference to the state,
+     which is dropped last
+  */
+  inline  void  run_continuation() noexcept {
+          continuation_base* l_continuation = m_continuation;
+          l_continuation->run(this);
+          if(l_continuation->m_size) {
+              std::size_t l_size = l_continuation->m_size;
+              l_continuation->~continuation_base();
+              fragment::get_default()->deallocate(l_continuation, l_size, alignof(std::max_align_t));
+          } else
+              l_continuation->~continuation_base();
+          m_continuation = nullptr;
+          if(m_continuation_ref) {
+              release();
+          }
+  }
+
+  /* set_state()
+     mark the state ready, waking up waiters and running the continuation, if any
+  */
+  inline  void  set_state(std::uint32_t state) noexcept {
+          std::uint32_t l_prev = m_state.fetch_or(state | state_ready, std::memory_order_acq_rel);
+          if(l_prev & state_waiting) {
+              futex_wake(std::addressof(m_state), std::numeric_limits<int>::max());
+          }
+          if(l_prev & state_continuation) {
+              run_continuation();
+          }
+  }
+
+  public:
+  inline  future_state() noexcept:
+          future_state_base(),
+          m_continuation(nullptr),
+          m_continuation_ref(false) {
+  }
+
+  inline  ~future_state() {
+          if((m_state.load(std::memory_order_relaxed) & (state_ready | state_broken)) == state_ready) {
+              get_value()->~value_type();
+          }
+  }
+
+  /* make()
+     a new state, referenced by both a producer and a consumer
+  */
+  static  future_state* make() noexcept {
+          lock();
+          future_state* l_state = get_bank().emplace();
+          unlock();
+          return l_state;
+  }
+
+  inline  void  release() noexcept {
+          if(m_ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+              lock();
+              get_bank().remove(this);
+              unlock();
+          }
+  }
+
+  /* set_continuation()
+     install <fn>, to be invoked as fn(future_state*) once the state is ready: on the thread
+     making it ready, or right away on the calling thread if it already is. With <owner> set,
+     the caller's reference to the state is handed over and dropped after <fn> has run. Only one
+     continuation can be installed.
+  */
+  template<typename Fn>
+          bool  set_continuation(Fn&& fn, bool owner = false) noexcept {
+          using continuation_type = continuation_t<typename std::decay<Fn>::type>;
+          if(m_state.load(std::memory_order_relaxed) & state_continuation) {
+              return false;
+          }
+          if constexpr ((sizeof(continuation_type) <= continuation_size) &&
+              (alignof(continuation_type) <= alignof(std::max_align_t))) {
+              m_continuation = new(m_continuation_data) continuation_type(0, std::forward<Fn>(fn));
+          } else {
+              std::size_t l_size = global::get_round_value(sizeof(continuation_type), alignof(std::max_align_t));
+              void*       l_data = fragment::get_default()->allocate(l_size, alignof(std::max_align_t));
+              if(l_data == nullptr) {
+                  return false;
+              }
+              m_continuation = new(l_data) continuation_type(l_size, std::forward<Fn>(fn));
+          }
+          m_continuation_ref = owner;
+          std::uint32_t l_prev = m_state.fetch_or(state_continuation, std::memory_order_acq_rel);
+          if(l_prev & state_ready) {
+              run_continuation();
+          }
+          return true;
+  }
+
+  template<typename... Args>
+  inline  void  set_value(Args&&... args) noexcept {
+          new(m_value) value_type(std::forward<Args>(args)...);
+          set_state(state_ready);
+  }
+
+  inline  void  set_broken() noexcept {
+          set_state(state_broken);
+  }
+
+  inline  value_type* get_value() noexcept {
+          return std::launder(reinterpret_cast<value_type*>(m_value));
+  }
+};
+
+/* promise
+   producing end of a promise/future pair
+   A promise dropped without a value breaks its future: waiters are released, continuations
+   are skipped and get() yields nullptr.
+*/
+template<typename Xt>
+class promise
+{
+  using state_type = future_state<Xt>;
+
+  state_type*   m_state;
+  bool          m_future;
+
+  private:
+  inline  void  release() noexcept {
+          if(m_future == false) {
+              // nobody took the future: drop its reference as well
+              m_state->release();
+          }
+          m_state->release();
+          m_state = nullptr;
+  }
+
+  public:
+  inline  promise() noexcept:
+          m_state(state_type::make()),
+          m_future(false) {
+  }
+
+          promise(const promise&) noexcept = delete;
+
+  inline  promise(promise&& copy) noexcept:
+          m_state(copy.m_state),
+          m_future(copy.m_future) {
+          copy.m_state = nullptr;
+  }
+
+  inline  ~promise() {
+          reset();
+  }
+
+  /* get_future()
+     the consuming end; can only be taken once
+  */
+  inline  future<Xt> get_future() noexcept {
+          if(m_state &&
+              (m_future == false)) {
+              m_future = true;
+              return future<Xt>(m_state);
+          }
+          return future<Xt>();
+  }
+
+  /* set_value()
+     store the value and make the future ready; the promise is spent afterwards
+  */
+  template<typename... Args>
+  inline  bool  set_value(Args&&... args) noexcept {
+          if(m_state) {
+              m_state->set_value(std::forward<Args>(args)...);
+              release();
+              return true;
+          }
+          return false;
+  }
+
+  /* reset()
+     break the promise, if not yet satisfied
+  */
+  inline  void  reset() noexcept {
+          if(m_state) {
+              m_state->set_broken();
+              release();
+          }
+  }
+
+  inline  operator bool() const noexcept {
+          return m_state;
+  }
+
+          promise& operator=(const promise&) noexcept = delete;
+
+  inline  promise& operator=(promise&& rhs) noexcept {
+          if(this != std::addressof(rhs)) {
+              reset();
+              m_state = rhs.m_state;
+              m_future = rhs.m_future;
+              rhs.m_state = nullptr;
+          }
+          return *this;
+  }
+};
+
+/* future
+   consuming end of a promise/future pair
+*/
+template<typename Xt>
+class future
+{
+  using state_type = future_state<Xt>;
+
+  public:
+  using value_type = typename state_type::value_type;
+
+  private:
+  state_type*   m_state;
+
+  template<typename Ot>
+  friend class future;
+
+  template<typename Ot>
+  friend class promise;
+
+  template<typename Ot>
+  friend future<void> when_all(std::vector<future<Ot>>&) noexcept;
+
+  template<typename Ot>
+  friend future<std::size_t> when_any(std::vector<future<Ot>>&) noexcept;
+
+  private:
+  inline  explicit future(state_type* state) noexcept:
+          m_state(state) {
+  }
+
+  public:
+  inline  future() noexcept:
+          m_state(nullptr) {
+  }
+
+          future(const future&) noexcept = delete;
+
+  inline  future(future&& copy) noexcept:
+          m_state(copy.m_state) {
+          copy.m_state = nullptr;
+  }
+
+  inline  ~future() {
+          reset();
+  }
+
+  /* wait()
+     block until the value is available, or the promise broken
+  */
+  inline  void  wait() noexcept {
+          if(m_state) {
+              m_state->wait();
+          }
+  }
+
+  /* wait()
+     block for at most <timeout> milliseconds; returns true if the future is ready
+  */
+  inline  bool  wait(int timeout) noexcept {
+          if(m_state) {
+              return m_state->wait(timeout);
+          }
+          return true;
+  }
+
+  /* get()
+     wait for the value and return it, nullptr if the promise was broken
+  */
+  inline  value_type* get() noexcept {
+          if(m_state) {
+              m_state->wait();
+              if(m_state->is_broken() == false) {
+                  return m_state->get_value();
+              }
+          }
+          return nullptr;
+  }
+
+  /* then()
+     chain <fn>, invoked with a reference to the value (without arguments for future<void>) on
+     whichever thread completes this future, or right away if it already is complete; returns a
+     future for the result of <fn>. This future is consumed. If the promise is broken, <fn> is
+     not invoked and the returned future is broken as well.
+  */
+  template<typename Fn>
+  inline  auto  then(Fn&& fn) noexcept {
+          using result_type = typename std::conditional<
+              std::is_void<Xt>::value,
+              std::invoke_result<Fn>,
+              std::invoke_result<Fn, value_type&>
+          >::type::type;
+          using target_type = future_state<result_type>;
+          if(m_state == nullptr) {
+              return future<result_type>();
+          }
+          target_type* l_target = target_type::make();
+          if(l_target == nullptr) {
+              return future<result_type>();
+          }
+          auto l_continuation = [l_target, l_fn = std::forward<Fn>(fn)](state_type* state) mutable noexcept {
+              if(state->is_broken()) {
+                  l_target->set_broken();
+              } else
+              if constexpr (std::is_void<Xt>::value) {
+                  if constexpr (std::is_void<result_type>::value) {
+                      l_fn();
+                      l_target->set_value();
+                  } else
+                      l_target->set_value(l_fn());
+              } else {
+                  if constexpr (std::is_void<result_type>::value) {
+                      l_fn(*state->get_value());
+                      l_target->set_value();
+                  } else
+                      l_target->set_value(l_fn(*state->get_value()));
+              }
+              l_target->release();
+          };
+          if(m_state->set_continuation(std::move(l_continuation), true) == false) {
+              // the continuation never took over our reference: drop it here
+              l_target->set_broken();
+              l_target->release();
+              m_state->release();
+          }
+          m_state = nullptr;
+          return future<result_type>(l_target);
+  }
+
+  inline  bool  is_ready() const noexcept {
+          return (m_state == nullptr) || m_state->is_ready();
+  }
+
+  inline  bool  is_valid() const noexcept {
+          return m_state;
+  }
+
+  inline  void  reset() noexcept {
+          if(m_state) {
+              m_state->release();
+              m_state = nullptr;
+          }
+  }
+
+  inline  operator bool() const noexcept {
+          return m_state;
+  }
+
+          future& operator=(const future&) noexcept = delete;
+
+  inline  future& operator=(future&& rhs) noexcept {
+          if(this != std::addressof(rhs)) {
+              reset();
+              m_state = rhs.m_state;
+              rhs.m_state = nullptr;
+          }
+          return *this;
+  }
+};
+
+/* when_all()
+   a future ready once all of <futures> are (invalid ones count as ready); the futures keep
+   their values, but can no longer be chained with then(). The result is broken if a future
+   already has a continuation installed.
+*/
+template<typename Xt>
+inline  future<void> when_all(std::vector<future<Xt>>& futures) noexcept
+{
+        struct join_t
+        {
+          std::atomic<std::size_t> m_count;
+          bool                     m_broken;
+          future_state<void>*      m_target;
+
+          static  void  release(join_t* join) noexcept {
+                  if(join->m_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                      if(join->m_broken) {
+                          join->m_target->set_broken();
+                      } else
+                          join->m_target->set_value();
+                      join->m_target->release();
+                      join->~join_t();
+                      fragment::get_default()->deallocate(join, sizeof(join_t), alignof(join_t));
+                  }
+          }
+        };
+
+        future_state<void>* l_target = future_state<void>::make();
+        if(l_target == nullptr) {
+            return future<void>();
+        }
+        void* l_data = fragment::get_default()->allocate(sizeof(join_t), alignof(join_t));
+        if(l_data == nullptr) {
+            l_target->set_broken();
+            l_target->release();
+            return future<void>(l_target);
+        }
+        // one count per future, plus one held until all continuations are installed
+        join_t* l_join = new(l_data) join_t{{futures.size() + 1}, false, l_target};
+        for(auto& i_future: futures) {
+            if(i_future.m_state) {
+                if(i_future.m_state->set_continuation([l_join](future_state<Xt>*) noexcept { join_t::release(l_join); })) {
+                    continue;
+                }
+                l_join->m_broken = true;
+            }
+            join_t::release(l_join);
+        }
+        join_t::release(l_join);
+        return future<void>(l_target);
+}
+
+/* when_any()
+   a future for the index of the first of <futures> to become ready (broken counts as ready);
+   broken if none of them is valid. The futures keep their values, but can no longer be chained
+   with then().
+*/
+template<typename Xt>
+inline  future<std::size_t> when_any(std::vector<future<Xt>>& futures) noexcept
+{
+        struct join_t
+        {
+          std::atomic<std::size_t>   m_count;
+          std::atomic<bool>          m_done;
+          future_state<std::size_t>* m_target;
+
+          static  void  set_value(join_t* join, std::size_t index) noexcept {
+                  if(join->m_done.exchange(true, std::memory_order_acq_rel) == false) {
+                      join->m_target->set_value(index);
+                      join->m_target->release();
+                  }
+                  release(join);
+          }
+
+          static  void  release(join_t* join) noexcept {
+                  if(join->m_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                      if(join->m_done.exchange(true, std::memory_order_acq_rel) == false) {
+                          join->m_target->set_broken();
+                          join->m_target->release();
+                      }
+                      join->~join_t();
+                      fragment::get_default()->deallocate(join, sizeof(join_t), alignof(join_t));
+                  }
+          }
+        };
+
+        future_state<std::size_t>* l_target = future_state<std::size_t>::make();
+        if(l_target == nullptr) {
+            return future<std::size_t>();
+        }
+        void* l_data = fragment::get_default()->allocate(sizeof(join_t), alignof(join_t));
+        if(l_data == nullptr) {
+            l_target->set_broken();
+            l_target->release();
+            return future<std::size_t>(l_target);
+        }
+        join_t* l_join = new(l_data) join_t{{futures.size() + 1}, {false}, l_target};
+        for(std::size_t l_index = 0; l_index < futures.size(); l_index++) {
+            future_state<Xt>* l_state = futures[l_index].m_state;
+            if((l_state == nullptr) ||
+                (l_state->set_continuation([l_join, l_index](future_state<Xt>*) noexcept { join_t::set_value(l_join, l_index); }) == false)) {
+                join_t::release(l_join);
+            }
+        }
+        join_t::release(l_join);
+        return future<std::size_t>(l_target);
+}
+
+/*namespace parallel*/ }
+#endif
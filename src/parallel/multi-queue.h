@@ -0,0 +1,445 @@
+#ifndef parallel_multi_queue_h
+#define parallel_multi_queue_h
+/**
+    Copyright (c) 2020, wicked systems
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright notice, this list of
+    conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, this list
+    of conditions and the following disclaimer in the documentation and/or other materials
+    provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+    THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+    OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+    HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+    TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**/
+#include <parallel.h>
+#include <memory.h>
+#include <memory/fragment.h>
+#include <none.h>
+#include "queue-base.h"
+#include "topology.h"
+#include <vector>
+#include <atomic>
+#include <time.h>
+#include <unistd.h>
+
+namespace parallel {
+
+/* worker_stats
+   per worker counters of a multi consumer queue
+*/
+struct worker_stats
+{
+  std::uint64_t task_count;   // tasks executed
+  std::uint64_t batch_count;  // batches taken off the shared buffer
+  std::uint64_t wake_count;   // transitions from idle to busy
+  std::uint64_t sleep_count;  // transitions from busy to idle
+  std::uint64_t busy_time;    // time spent executing tasks, in nanoseconds
+};
+
+/* multi_queue
+   execution queue with several consumer threads
+   Xt - task type; tasks are either invoked as Xt() or passed to the delegate's queue_execute()
+   Ct - delegate type (see executor), void if none
+   Vt - buffer type
+
+   Producers append to one shared buffer under a mutex. An idle worker takes its share of the
+   pending tasks (an equal split between the workers, capped at the batch size) into its own
+   buffer in a single lock round-trip, then executes them without the lock held. Workers that
+   find the buffer empty wait on a shared condition variable. Every worker can be pinned to its
+   own CPU set and keeps its own statistics, readable from any thread.
+*/
+template<typename Xt, typename Ct = void, typename Vt = std::pmr::vector<Xt>>
+class multi_queue: public queue_base<none>
+{
+  using base_type = queue_base<none>;
+  using pool_type = Vt;
+  using delegate_type = typename std::conditional<std::is_void<Ct>::value, multi_queue, Ct>::type;
+
+  public:
+  using node_type = typename pool_type::value_type;
+
+  private:
+  class worker_t: public posix_thread_base
+  {
+    multi_queue*  m_owner;
+    pool_type     m_batch;
+    cpu_set_t     m_cpu_set;
+    bool          m_cpu_set_dirty;
+    bool          m_busy;
+
+    std::atomic<std::uint64_t>  m_task_count;
+    std::atomic<std::uint64_t>  m_batch_count;
+    std::atomic<std::uint64_t>  m_wake_count;
+    std::atomic<std::uint64_t>  m_sleep_count;
+    std::atomic<std::uint64_t>  m_busy_time;
+
+    protected:
+    inline  void* thread_loop(worker_t*) noexcept {
+            if(m_cpu_set_dirty) {
+                if(thread_set_affinity(this, m_cpu_set)) {
+                    m_cpu_set_dirty = false;
+                }
+            }
+            return m_owner->worker_loop(this);
+    }
+
+    friend class posix_thread_base;
+    friend class multi_queue;
+
+    public:
+    inline  void  thread_launch_event() noexcept {
+            if constexpr (has_launch_callback<delegate_type>::value) {
+                m_owner->get_delegate()->thread_launch_event();
+            }
+    }
+
+    inline  void  thread_finish_event() noexcept {
+            if constexpr (has_finish_callback<delegate_type>::value) {
+                m_owner->get_delegate()->thread_finish_event();
+            }
+    }
+
+    inline  worker_t(multi_queue* owner) noexcept:
+            posix_thread_base(affinity_none),
+            m_owner(owner),
+            m_batch(),
+            m_cpu_set_dirty(false),
+            m_busy(false),
+            m_task_count(0),
+            m_batch_count(0),
+            m_wake_count(0),
+            m_sleep_count(0),
+            m_busy_time(0) {
+            CPU_ZERO(std::addressof(m_cpu_set));
+    }
+
+    inline  ~worker_t() {
+            thread_suspend();
+    }
+
+    inline  bool  resume() noexcept {
+            return thread_resume(this, thread_boot<worker_t>);
+    }
+
+    inline  bool  suspend() noexcept {
+            return thread_suspend();
+    }
+  };
+
+  fragment*       m_resource;
+  worker_t*       m_workers;
+  std::size_t     m_worker_count;
+
+  pthread_mutex_t m_mutex;
+  pthread_cond_t  m_condition;
+  pool_type       m_pool;
+  std::size_t     m_read;
+  std::size_t     m_batch_max;
+  std::size_t     m_idle_count;
+  bool            m_stop;
+
+  private:
+  inline  delegate_type* get_delegate() noexcept {
+          return static_cast<delegate_type*>(this);
+  }
+
+  static inline std::uint64_t get_time() noexcept {
+          struct timespec l_time;
+          clock_gettime(CLOCK_MONOTONIC, std::addressof(l_time));
+          return l_time.tv_sec * nsps + l_time.tv_nsec;
+  }
+
+  /* worker_loop()
+     invoked from the thread boot loop, with the worker's own lock held
+  */
+          void* worker_loop(worker_t* worker) noexcept {
+          if(worker->m_running == 0) {
+              return nullptr;
+          }
+          posix_thread_base::thread_unlock(worker);
+          pthread_mutex_lock(std::addressof(m_mutex));
+          std::size_t l_size = m_pool.size() - m_read;
+          if(l_size == 0) {
+              if(worker->m_busy) {
+                  if constexpr (base_type::has_sleep_callback<delegate_type>::value) {
+                      get_delegate()->thread_sleep_event();
+                  }
+                  worker->m_sleep_count.fetch_add(1, std::memory_order_relaxed);
+                  worker->m_busy = false;
+              }
+              if(m_stop == false) {
+                  m_idle_count++;
+                  pthread_cond_wait(std::addressof(m_condition), std::addressof(m_mutex));
+                  m_idle_count--;
+              }
+              pthread_mutex_unlock(std::addressof(m_mutex));
+          } else {
+              std::size_t l_share = (l_size + m_worker_count - 1) / m_worker_count;
+              if((m_batch_max > 0) &&
+                  (l_share > m_batch_max)) {
+                  l_share = m_batch_max;
+              }
+              auto l_head = m_pool.begin() + m_read;
+              worker->m_batch.insert(worker->m_batch.end(), std::make_move_iterator(l_head), std::make_move_iterator(l_head + l_share));
+              m_read += l_share;
+              if(m_read == m_pool.size()) {
+                  m_pool.clear();
+                  m_read = 0;
+              } else {
+                  // drop the consumed prefix once it outweighs the pending tasks, so that the
+                  // buffer does not grow without bound while it never runs empty; the tasks moved
+                  // are never more than the ones taken since the last compaction
+                  if(m_read >= m_pool.size() - m_read) {
+                      m_pool.erase(m_pool.begin(), m_pool.begin() + m_read);
+                      m_read = 0;
+                  }
+                  if(m_idle_count) {
+                      // more left over for the others
+                      pthread_cond_signal(std::addressof(m_condition));
+                  }
+              }
+              pthread_mutex_unlock(std::addressof(m_mutex));
+              if(worker->m_busy == false) {
+                  if constexpr (base_type::has_wake_callback<delegate_type>::value) {
+                      get_delegate()->thread_wake_event();
+                  }
+                  worker->m_wake_count.fetch_add(1, std::memory_order_relaxed);
+                  worker->m_busy = true;
+              }
+              std::uint64_t l_time = get_time();
+              for(auto& i_node: worker->m_batch) {
+                  if constexpr (base_type::has_execute_delegate<delegate_type, node_type&>::value) {
+                      get_delegate()->queue_execute(i_node);
+                  } else
+                      i_node();
+              }
+              worker->m_busy_time.fetch_add(get_time() - l_time, std::memory_order_relaxed);
+              worker->m_task_count.fetch_add(worker->m_batch.size(), std::memory_order_relaxed);
+              worker->m_batch_count.fetch_add(1, std::memory_order_relaxed);
+              worker->m_batch.clear();
+          }
+          posix_thread_base::thread_lock(worker);
+          return nullptr;
+  }
+
+  public:
+  /* multi_queue()
+     create a queue with <worker_count> consumer threads (one per online processor if 0); the
+     workers are not started until resume()
+  */
+  inline  multi_queue(std::size_t worker_count = 0, fragment* resource = fragment::get_default()) noexcept:
+          base_type(),
+          m_resource(resource),
+          m_workers(nullptr),
+          m_worker_count(0),
+          m_pool(),
+          m_read(0),
+          m_batch_max(0),
+          m_idle_count(0),
+          m_stop(false) {
+          pthread_mutex_init(std::addressof(m_mutex), nullptr);
+          pthread_cond_init(std::addressof(m_condition), nullptr);
+          if(worker_count == 0) {
+              long int l_cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+              worker_count = l_cpu_count > 0 ? l_cpu_count : 1;
+          }
+          if(m_resource) {
+              m_workers = reinterpret_cast<worker_t*>(m_resource->allocate(worker_count * sizeof(worker_t), alignof(worker_t)));
+              if(m_workers) {
+                  for(std::size_t l_index = 0; l_index < worker_count; l_index++) {
+                      new(m_workers + l_index) worker_t(this);
+                  }
+                  m_worker_count = worker_count;
+              }
+          }
+  }
+
+          multi_queue(const multi_queue&) noexcept = delete;
+          multi_queue(multi_queue&&) noexcept = delete;
+
+  virtual ~multi_queue() {
+          suspend();
+          if(m_workers) {
+              for(std::size_t l_index = 0; l_index < m_worker_count; l_index++) {
+                  m_workers[l_index].~worker_t();
+              }
+              m_resource->deallocate(m_workers, m_worker_count * sizeof(worker_t), alignof(worker_t));
+          }
+          pthread_cond_destroy(std::addressof(m_condition));
+          pthread_mutex_destroy(std::addressof(m_mutex));
+  }
+
+  /* enqueue()
+  */
+  template<typename... Args>
+          bool  enqueue(Args&&... args) noexcept {
+          if(base_type::is_enabled()) {
+              if(m_worker_count) {
+                  pthread_mutex_lock(std::addressof(m_mutex));
+                  m_pool.emplace_back(std::forward<Args>(args)...);
+                  if(m_idle_count) {
+                      pthread_cond_signal(std::addressof(m_condition));
+                  }
+                  pthread_mutex_unlock(std::addressof(m_mutex));
+                  return true;
+              }
+          }
+          return false;
+  }
+
+  /* resume()
+     start (or restart) all workers
+  */
+          bool  resume() noexcept {
+          bool  l_result = m_worker_count > 0;
+          for(std::size_t l_index = 0; l_index < m_worker_count; l_index++) {
+              if(m_workers[l_index].resume() == false) {
+                  l_result = false;
+              }
+          }
+          return l_result;
+  }
+
+  /* suspend()
+     stop all workers after their current batch; pending tasks are kept until the next resume()
+  */
+          bool  suspend() noexcept {
+          bool  l_result = true;
+          pthread_mutex_lock(std::addressof(m_mutex));
+          m_stop = true;
+          pthread_cond_broadcast(std::addressof(m_condition));
+          pthread_mutex_unlock(std::addressof(m_mutex));
+          for(std::size_t l_index = 0; l_index < m_worker_count; l_index++) {
+              if(m_workers[l_index].suspend() == false) {
+                  l_result = false;
+              }
+          }
+          pthread_mutex_lock(std::addressof(m_mutex));
+          m_stop = false;
+          pthread_mutex_unlock(std::addressof(m_mutex));
+          return l_result;
+  }
+
+  /* set_affinity()
+     pin worker <index> to the CPUs in <cpu_set>; takes effect before the worker's next batch
+  */
+          bool  set_affinity(std::size_t index, const cpu_set_t& cpu_set) noexcept {
+          if(index < m_worker_count) {
+              worker_t* l_worker = m_workers + index;
+              posix_thread_base::thread_lock(l_worker);
+              l_worker->m_cpu_set = cpu_set;
+              l_worker->m_cpu_set_dirty = true;
+              posix_thread_base::thread_unlock(l_worker);
+              return true;
+          }
+          return false;
+  }
+
+  /* set_placement()
+     pin each worker to the cpu <policy> picks on <cpu_topology>; takes effect before the
+     worker's next batch. place_none leaves the current affinity as it is.
+  */
+          bool  set_placement(placement_policy policy, int producer = -1, const topology& cpu_topology = topology::get_default()) noexcept {
+          if(policy == place_none) {
+              return true;
+          }
+          if(m_worker_count == 0) {
+              return false;
+          }
+          int* l_cpus = static_cast<int*>(m_resource->allocate(m_worker_count * sizeof(int), alignof(int)));
+          if(l_cpus == nullptr) {
+              return false;
+          }
+          bool l_result = cpu_topology.get_placement(policy, m_worker_count, l_cpus, producer) == m_worker_count;
+          if(l_result) {
+              for(std::size_t l_index = 0; l_index < m_worker_count; l_index++) {
+                  cpu_set_t l_cpu_set;
+                  CPU_ZERO(std::addressof(l_cpu_set));
+                  CPU_SET(l_cpus[l_index], std::addressof(l_cpu_set));
+                  set_affinity(l_index, l_cpu_set);
+              }
+          }
+          m_resource->deallocate(l_cpus, m_worker_count * sizeof(int), alignof(int));
+          return l_result;
+  }
+
+  /* get_affinity()
+     the CPU set worker <index> runs on
+  */
+          bool  get_affinity(std::size_t index, cpu_set_t& cpu_set) noexcept {
+          if(index < m_worker_count) {
+              worker_t* l_worker = m_workers + index;
+              posix_thread_base::thread_lock(l_worker);
+              if(CPU_COUNT(std::addressof(l_worker->m_cpu_set))) {
+                  cpu_set = l_worker->m_cpu_set;
+              } else
+                  sched_getaffinity(0, sizeof(cpu_set_t), std::addressof(cpu_set));
+              posix_thread_base::thread_unlock(l_worker);
+              return true;
+          }
+          return false;
+  }
+
+  /* get_batch_size()
+     maximum number of tasks a worker takes over at once; 0 for an equal share of all pending
+     tasks
+  */
+  inline  std::size_t get_batch_size() noexcept {
+          pthread_mutex_lock(std::addressof(m_mutex));
+          std::size_t l_result = m_batch_max;
+          pthread_mutex_unlock(std::addressof(m_mutex));
+          return l_result;
+  }
+
+  inline  void  set_batch_size(std::size_t value) noexcept {
+          pthread_mutex_lock(std::addressof(m_mutex));
+          m_batch_max = value;
+          pthread_mutex_unlock(std::addressof(m_mutex));
+  }
+
+  /* get_pending_count()
+     number of tasks not yet taken by any worker
+  */
+  inline  std::size_t get_pending_count() noexcept {
+          pthread_mutex_lock(std::addressof(m_mutex));
+          std::size_t l_result = m_pool.size() - m_read;
+          pthread_mutex_unlock(std::addressof(m_mutex));
+          return l_result;
+  }
+
+  inline  std::size_t get_worker_count() const noexcept {
+          return m_worker_count;
+  }
+
+  /* get_stats()
+     snapshot of the counters of worker <index>
+  */
+          worker_stats get_stats(std::size_t index) const noexcept {
+          worker_stats l_result{};
+          if(index < m_worker_count) {
+              worker_t* l_worker = m_workers + index;
+              l_result.task_count = l_worker->m_task_count.load(std::memory_order_relaxed);
+              l_result.batch_count = l_worker->m_batch_count.load(std::memory_order_relaxed);
+              l_result.wake_count = l_worker->m_wake_count.load(std::memory_order_relaxed);
+              l_result.sleep_count = l_worker->m_sleep_count.load(std::memory_order_relaxed);
+              l_result.busy_time = l_worker->m_busy_time.load(std::memory_order_relaxed);
+          }
+          return l_result;
+  }
+
+          multi_queue& operator=(const multi_queue&) noexcept = delete;
+          multi_queue& operator=(multi_queue&&) noexcept = delete;
+};
+
+/*namespace parallel*/ }
+#endif
@@ -23,6 +23,23 @@
 #include "parallel/posix-thread-base.h"
 #include "parallel/atomic-thread-base.h"
 #include "parallel/thread.h"
+#include "parallel/algorithm.h"
+#include "parallel/queue-metrics.h"
+#include "parallel/reclaim.h"
+#include "parallel/topology.h"
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <sched.h>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <tuple>
+#include <dirent.h>
+#include <fcntl.h>
 
 namespace parallel {
 
@@ -36,6 +53,918 @@ namespace parallel {
 {
 }
 
+/* futex_wait()
+*/
+long  futex_wait(std::atomic<std::uint32_t>* address, std::uint32_t value, const struct timespec* timeout) noexcept
+{
+      return syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(address), FUTEX_WAIT_PRIVATE, value, timeout, nullptr, 0);
+}
+
+/* futex_wake()
+*/
+long  futex_wake(std::atomic<std::uint32_t>* address, int count) noexcept
+{
+      return syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(address), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+}
+
+/* cpu_relax()
+*/
+void  cpu_relax() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+      __builtin_ia32_pause();
+#elif defined(__aarch64__)
+      asm volatile("yield" ::: "memory");
+#endif
+}
+
+/* tsc_clock
+*/
+std::uint64_t tsc_clock::get_scale() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+      static std::uint64_t s_scale = []() noexcept {
+          struct timespec l_head_time;
+          struct timespec l_tail_time;
+          std::uint64_t   l_time;
+          clock_gettime(CLOCK_MONOTONIC, std::addressof(l_head_time));
+          std::uint64_t   l_head_tsc = __rdtsc();
+          do {
+              clock_gettime(CLOCK_MONOTONIC, std::addressof(l_tail_time));
+              l_time = (l_tail_time.tv_sec - l_head_time.tv_sec) * nsps + l_tail_time.tv_nsec - l_head_time.tv_nsec;
+          }
+          while(l_time < 2 * nspms);
+          std::uint64_t   l_tail_tsc = __rdtsc();
+          if(l_tail_tsc > l_head_tsc) {
+              return (l_time << 32) / (l_tail_tsc - l_head_tsc);
+          }
+          return std::uint64_t(1) << 32;
+      }();
+      return s_scale;
+#else
+      return std::uint64_t(1) << 32;
+#endif
+}
+
+/* get_worker_set()
+*/
+range_executor& get_worker_set() noexcept
+{
+      static range_executor s_executor;
+      static bool           s_running = s_executor.resume();
+      (void)s_running;
+      return s_executor;
+}
+
+/* retire_batch
+*/
+retire_batch* retire_batch::make() noexcept
+{
+      void* l_data = fragment::get_default()->allocate(sizeof(retire_batch), alignof(retire_batch));
+      if(l_data) {
+          retire_batch* l_batch = static_cast<retire_batch*>(l_data);
+          l_batch->m_next = nullptr;
+          l_batch->m_epoch = 0;
+          l_batch->m_count = 0;
+          return l_batch;
+      }
+      return nullptr;
+}
+
+void  retire_batch::release(retire_batch* batch) noexcept
+{
+      fragment::get_default()->deallocate(batch, sizeof(retire_batch), alignof(retire_batch));
+}
+
+void  retire_batch::dispose(entry_t& entry) noexcept
+{
+      if(entry.m_destroy) {
+          entry.m_destroy(entry.m_node);
+      }
+      if(entry.m_resource) {
+          entry.m_resource->deallocate(entry.m_node, entry.m_size, entry.m_align);
+      }
+}
+
+void  retire_batch::dispose() noexcept
+{
+      for(std::size_t l_index = 0; l_index < m_count; l_index++) {
+          dispose(m_entries[l_index]);
+      }
+      m_count = 0;
+}
+
+/* reclaim_domain_base
+*/
+static std::atomic_flag               s_domain_lock;
+static reclaim_domain_base*           s_domain_head;
+static std::atomic<std::uint64_t>     s_domain_serial;
+static std::atomic<std::uint64_t>     s_thread_serial;
+
+static void  lock_domains() noexcept
+{
+      while(s_domain_lock.test_and_set(std::memory_order_acquire)) {
+          sched_yield();
+      }
+}
+
+static void  unlock_domains() noexcept
+{
+      s_domain_lock.clear(std::memory_order_release);
+}
+
+      reclaim_domain_base::reclaim_domain_base() noexcept:
+      m_prev(nullptr),
+      m_next(nullptr),
+      m_linked(true),
+      m_serial(s_domain_serial.fetch_add(1, std::memory_order_relaxed) + 1),
+      m_orphan_head(nullptr)
+{
+      lock_domains();
+      m_next = s_domain_head;
+      if(m_next) {
+          m_next->m_prev = this;
+      }
+      s_domain_head = this;
+      unlock_domains();
+}
+
+      reclaim_domain_base::~reclaim_domain_base()
+{
+      unlink();
+}
+
+std::uint64_t reclaim_domain_base::make_thread_id() noexcept
+{
+      struct thread_guard
+      {
+        inline  ~thread_guard() {
+                reclaim_domain_base::detach_thread();
+        }
+      };
+      thread_local thread_guard s_guard;
+      (void)s_guard;
+      s_thread_id = s_thread_serial.fetch_add(1, std::memory_order_relaxed) + 1;
+      return s_thread_id;
+}
+
+void  reclaim_domain_base::set_orphan(retire_batch* head) noexcept
+{
+      retire_batch* l_tail = head;
+      while(l_tail->m_next) {
+          l_tail = l_tail->m_next;
+      }
+      l_tail->m_next = m_orphan_head.load(std::memory_order_relaxed);
+      while(m_orphan_head.compare_exchange_weak(l_tail->m_next, head, std::memory_order_release, std::memory_order_relaxed) == false) {
+      }
+}
+
+retire_batch* reclaim_domain_base::get_orphan() noexcept
+{
+      if(m_orphan_head.load(std::memory_order_relaxed)) {
+          return m_orphan_head.exchange(nullptr, std::memory_order_acquire);
+      }
+      return nullptr;
+}
+
+void  reclaim_domain_base::unlink() noexcept
+{
+      lock_domains();
+      if(m_linked) {
+          if(m_prev) {
+              m_prev->m_next = m_next;
+          } else
+              s_domain_head = m_next;
+          if(m_next) {
+              m_next->m_prev = m_prev;
+          }
+          m_linked = false;
+      }
+      unlock_domains();
+}
+
+void  reclaim_domain_base::attach_thread() noexcept
+{
+      epoch_domain::get_default().attach();
+}
+
+void  reclaim_domain_base::detach_thread() noexcept
+{
+      if(s_thread_id) {
+          lock_domains();
+          for(reclaim_domain_base* l_domain = s_domain_head; l_domain != nullptr; l_domain = l_domain->m_next) {
+              l_domain->detach(s_thread_id);
+          }
+          unlock_domains();
+          for(auto& i_cache: s_cache) {
+              i_cache = {0, nullptr};
+          }
+      }
+}
+
+/* epoch_domain
+*/
+void  epoch_record::dispose() noexcept
+{
+      if(m_batch) {
+          m_batch->dispose();
+          retire_batch::release(m_batch);
+          m_batch = nullptr;
+      }
+      while(m_pending_head) {
+          retire_batch* l_next = m_pending_head->m_next;
+          m_pending_head->dispose();
+          retire_batch::release(m_pending_head);
+          m_pending_head = l_next;
+      }
+      m_pending_tail = nullptr;
+}
+
+      epoch_domain::epoch_domain() noexcept:
+      reclaim_domain<epoch_record>(),
+      m_epoch(0)
+{
+}
+
+      epoch_domain::~epoch_domain()
+{
+      unlink();
+      dispose();
+}
+
+/* seal()
+   stamp the batch being filled with the current epoch and queue it
+*/
+void  epoch_domain::seal(epoch_record* record) noexcept
+{
+      retire_batch* l_batch = record->m_batch;
+      if(l_batch) {
+          if(l_batch->m_count) {
+              l_batch->m_epoch = m_epoch.load(std::memory_order_seq_cst);
+              l_batch->m_next = nullptr;
+              if(record->m_pending_tail) {
+                  record->m_pending_tail->m_next = l_batch;
+              } else
+                  record->m_pending_head = l_batch;
+              record->m_pending_tail = l_batch;
+              record->m_batch = nullptr;
+          }
+      }
+}
+
+/* collect()
+   dispose of the queued batches of <record>, and of orphaned batches, old enough
+*/
+void  epoch_domain::collect(epoch_record* record) noexcept
+{
+      try_advance();
+      std::uint64_t l_epoch = m_epoch.load(std::memory_order_acquire);
+      while(record->m_pending_head) {
+          retire_batch* l_batch = record->m_pending_head;
+          if(l_batch->m_epoch + 2 > l_epoch) {
+              break;
+          }
+          record->m_pending_head = l_batch->m_next;
+          l_batch->dispose();
+          retire_batch::release(l_batch);
+      }
+      if(record->m_pending_head == nullptr) {
+          record->m_pending_tail = nullptr;
+      }
+      retire_batch* l_orphan = get_orphan();
+      retire_batch* l_keep = nullptr;
+      while(l_orphan) {
+          retire_batch* l_next = l_orphan->m_next;
+          if(l_orphan->m_epoch + 2 <= l_epoch) {
+              l_orphan->dispose();
+              retire_batch::release(l_orphan);
+          } else {
+              l_orphan->m_next = l_keep;
+              l_keep = l_orphan;
+          }
+          l_orphan = l_next;
+      }
+      if(l_keep) {
+          set_orphan(l_keep);
+      }
+}
+
+void  epoch_domain::retire(const retire_batch::entry_t& entry) noexcept
+{
+      epoch_record* l_record = get_record();
+      if(l_record) {
+          if(l_record->m_batch == nullptr) {
+              l_record->m_batch = retire_batch::make();
+          }
+          if(l_record->m_batch) {
+              retire_batch* l_batch = l_record->m_batch;
+              l_batch->m_entries[l_batch->m_count++] = entry;
+              if(l_batch->m_count == retire_batch::entry_max) {
+                  seal(l_record);
+                  collect(l_record);
+              }
+              return;
+          }
+      }
+      // no memory to keep track of the node: wait for the epoch to move on twice, unless that
+      // would deadlock on our own critical section, in which case the node is leaked
+      if((l_record == nullptr) ||
+          (l_record->m_nest == 0)) {
+          std::uint64_t l_epoch = m_epoch.load(std::memory_order_seq_cst);
+          while(m_epoch.load(std::memory_order_seq_cst) < l_epoch + 2) {
+              if(try_advance() == false) {
+                  sched_yield();
+              }
+          }
+          retire_batch::entry_t l_entry = entry;
+          retire_batch::dispose(l_entry);
+      }
+}
+
+void  epoch_domain::release_record(epoch_record* record) noexcept
+{
+      record->m_nest = 0;
+      record->m_epoch.store(0, std::memory_order_release);
+      seal(record);
+      collect(record);
+      if(record->m_pending_head) {
+          set_orphan(record->m_pending_head);
+          record->m_pending_head = nullptr;
+          record->m_pending_tail = nullptr;
+      }
+}
+
+bool  epoch_domain::try_advance() noexcept
+{
+      std::uint64_t l_epoch = m_epoch.load(std::memory_order_seq_cst);
+      epoch_record* l_record = m_record_head.load(std::memory_order_acquire);
+      while(l_record) {
+          std::uint64_t l_state = l_record->m_epoch.load(std::memory_order_seq_cst);
+          if((l_state & 1u) &&
+              ((l_state >> 1) != l_epoch)) {
+              return false;
+          }
+          l_record = l_record->m_next;
+      }
+      return m_epoch.compare_exchange_strong(l_epoch, l_epoch + 1, std::memory_order_seq_cst);
+}
+
+void  epoch_domain::collect() noexcept
+{
+      epoch_record* l_record = get_record();
+      if(l_record) {
+          seal(l_record);
+          collect(l_record);
+      }
+}
+
+bool  epoch_domain::synchronize() noexcept
+{
+      epoch_record* l_record = get_record();
+      if(l_record) {
+          if(l_record->m_nest) {
+              return false;
+          }
+          seal(l_record);
+      }
+      std::uint64_t l_epoch = m_epoch.load(std::memory_order_seq_cst);
+      while(m_epoch.load(std::memory_order_seq_cst) < l_epoch + 2) {
+          if(try_advance() == false) {
+              sched_yield();
+          }
+      }
+      if(l_record) {
+          collect(l_record);
+      }
+      return true;
+}
+
+std::size_t epoch_domain::get_pending_count() noexcept
+{
+      std::size_t   l_count = 0;
+      epoch_record* l_record = get_record();
+      if(l_record) {
+          if(l_record->m_batch) {
+              l_count += l_record->m_batch->m_count;
+          }
+          for(retire_batch* l_batch = l_record->m_pending_head; l_batch != nullptr; l_batch = l_batch->m_next) {
+              l_count += l_batch->m_count;
+          }
+      }
+      return l_count;
+}
+
+epoch_domain& epoch_domain::get_default() noexcept
+{
+      // never destroyed: threads may still detach from it during exit
+      alignas(epoch_domain) static unsigned char s_data[sizeof(epoch_domain)];
+      static epoch_domain* s_domain = new(s_data) epoch_domain();
+      return *s_domain;
+}
+
+/* hazard_domain
+*/
+void  hazard_record::dispose() noexcept
+{
+      if(m_batch) {
+          m_batch->dispose();
+          retire_batch::release(m_batch);
+          m_batch = nullptr;
+      }
+      while(m_pending_head) {
+          retire_batch* l_next = m_pending_head->m_next;
+          m_pending_head->dispose();
+          retire_batch::release(m_pending_head);
+          m_pending_head = l_next;
+      }
+      m_pending_count = 0;
+}
+
+      hazard_domain::hazard_domain() noexcept:
+      reclaim_domain<hazard_record>()
+{
+}
+
+      hazard_domain::~hazard_domain()
+{
+      unlink();
+      dispose();
+}
+
+/* scan()
+   dispose of the queued nodes of <record>, and of orphaned nodes, that no thread protects;
+   the survivors are packed back into as few batches as possible
+*/
+void  hazard_domain::scan(hazard_record* record) noexcept
+{
+      retire_batch* l_orphan = get_orphan();
+      while(l_orphan) {
+          retire_batch* l_next = l_orphan->m_next;
+          l_orphan->m_next = record->m_pending_head;
+          record->m_pending_head = l_orphan;
+          l_orphan = l_next;
+      }
+      if(record->m_pending_head == nullptr) {
+          return;
+      }
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      hazard_record* l_head = m_record_head.load(std::memory_order_acquire);
+      std::size_t    l_hazard_max = 0;
+      for(hazard_record* l_record = l_head; l_record != nullptr; l_record = l_record->m_next) {
+          l_hazard_max += hazard_max;
+      }
+      void** l_hazards = static_cast<void**>(fragment::get_default()->allocate(l_hazard_max * sizeof(void*), alignof(void*)));
+      if(l_hazards == nullptr) {
+          return;
+      }
+      std::size_t l_hazard_count = 0;
+      for(hazard_record* l_record = l_head; l_record != nullptr; l_record = l_record->m_next) {
+          for(auto& i_hazard: l_record->m_hazards) {
+              void* l_node = i_hazard.load(std::memory_order_acquire);
+              if(l_node) {
+                  l_hazards[l_hazard_count++] = l_node;
+              }
+          }
+      }
+      std::sort(l_hazards, l_hazards + l_hazard_count);
+      retire_batch* l_write_prev = nullptr;
+      retire_batch* l_write = record->m_pending_head;
+      std::size_t   l_write_index = 0;
+      for(retire_batch* l_read = record->m_pending_head; l_read != nullptr; l_read = l_read->m_next) {
+          for(std::size_t l_read_index = 0; l_read_index < l_read->m_count; l_read_index++) {
+              retire_batch::entry_t& l_entry = l_read->m_entries[l_read_index];
+              if(std::binary_search(l_hazards, l_hazards + l_hazard_count, l_entry.m_node)) {
+                  if(l_write_index == retire_batch::entry_max) {
+                      l_write->m_count = retire_batch::entry_max;
+                      l_write_prev = l_write;
+                      l_write = l_write->m_next;
+                      l_write_index = 0;
+                  }
+                  l_write->m_entries[l_write_index++] = l_entry;
+              } else
+                  retire_batch::dispose(l_entry);
+          }
+      }
+      fragment::get_default()->deallocate(l_hazards, l_hazard_max * sizeof(void*), alignof(void*));
+      retire_batch* l_free = l_write->m_next;
+      if(l_write_index) {
+          l_write->m_count = l_write_index;
+          l_write->m_next = nullptr;
+      } else {
+          l_write->m_next = l_free;
+          l_free = l_write;
+          if(l_write_prev) {
+              l_write_prev->m_next = nullptr;
+          } else
+              record->m_pending_head = nullptr;
+      }
+      while(l_free) {
+          retire_batch* l_next = l_free->m_next;
+          retire_batch::release(l_free);
+          l_free = l_next;
+      }
+      record->m_pending_count = 0;
+      for(retire_batch* l_batch = record->m_pending_head; l_batch != nullptr; l_batch = l_batch->m_next) {
+          record->m_pending_count++;
+      }
+}
+
+void  hazard_domain::retire(const retire_batch::entry_t& entry) noexcept
+{
+      hazard_record* l_record = get_record();
+      if(l_record) {
+          if(l_record->m_batch == nullptr) {
+              l_record->m_batch = retire_batch::make();
+          }
+          if(l_record->m_batch) {
+              retire_batch* l_batch = l_record->m_batch;
+              l_batch->m_entries[l_batch->m_count++] = entry;
+              if(l_batch->m_count == retire_batch::entry_max) {
+                  l_batch->m_next = l_record->m_pending_head;
+                  l_record->m_pending_head = l_batch;
+                  l_record->m_pending_count++;
+                  l_record->m_batch = nullptr;
+                  // scan once there are at least twice as many retired nodes as hazard slots, so
+                  // that each scan disposes of at least half of them
+                  std::size_t l_scan_count = get_thread_count() * hazard_max * 2 / retire_batch::entry_max + 1;
+                  if(l_record->m_pending_count >= l_scan_count) {
+                      scan(l_record);
+                  }
+              }
+              return;
+          }
+      }
+      // no memory to keep track of the node: wait until nobody protects it
+      while(true) {
+          bool l_protected = false;
+          std::atomic_thread_fence(std::memory_order_seq_cst);
+          for(hazard_record* l_iter = m_record_head.load(std::memory_order_acquire); l_iter != nullptr; l_iter = l_iter->m_next) {
+              for(auto& i_hazard: l_iter->m_hazards) {
+                  if(i_hazard.load(std::memory_order_acquire) == entry.m_node) {
+                      l_protected = true;
+                  }
+              }
+          }
+          if(l_protected == false) {
+              break;
+          }
+          sched_yield();
+      }
+      retire_batch::entry_t l_entry = entry;
+      retire_batch::dispose(l_entry);
+}
+
+void  hazard_domain::release_record(hazard_record* record) noexcept
+{
+      for(auto& i_hazard: record->m_hazards) {
+          i_hazard.store(nullptr, std::memory_order_release);
+      }
+      if(record->m_batch) {
+          record->m_batch->m_next = record->m_pending_head;
+          record->m_pending_head = record->m_batch;
+          record->m_batch = nullptr;
+      }
+      scan(record);
+      if(record->m_pending_head) {
+          set_orphan(record->m_pending_head);
+          record->m_pending_head = nullptr;
+          record->m_pending_count = 0;
+      }
+}
+
+void  hazard_domain::collect() noexcept
+{
+      hazard_record* l_record = get_record();
+      if(l_record) {
+          if(l_record->m_batch) {
+              l_record->m_batch->m_next = l_record->m_pending_head;
+              l_record->m_pending_head = l_record->m_batch;
+              l_record->m_batch = nullptr;
+          }
+          scan(l_record);
+      }
+}
+
+std::size_t hazard_domain::get_pending_count() noexcept
+{
+      std::size_t    l_count = 0;
+      hazard_record* l_record = get_record();
+      if(l_record) {
+          if(l_record->m_batch) {
+              l_count += l_record->m_batch->m_count;
+          }
+          for(retire_batch* l_batch = l_record->m_pending_head; l_batch != nullptr; l_batch = l_batch->m_next) {
+              l_count += l_batch->m_count;
+          }
+      }
+      return l_count;
+}
+
+hazard_domain& hazard_domain::get_default() noexcept
+{
+      alignas(hazard_domain) static unsigned char s_data[sizeof(hazard_domain)];
+      static hazard_domain* s_domain = new(s_data) hazard_domain();
+      return *s_domain;
+}
+
+/* topology
+*/
+static bool  read_text(const char* path, char* text, std::size_t size) noexcept
+{
+      int l_handle = open(path, O_RDONLY);
+      if(l_handle >= 0) {
+          ssize_t l_size = read(l_handle, text, size - 1);
+          close(l_handle);
+          if(l_size > 0) {
+              text[l_size] = 0;
+              return true;
+          }
+      }
+      return false;
+}
+
+static bool  read_int(const char* path, int& value) noexcept
+{
+      char l_text[32];
+      if(read_text(path, l_text, sizeof(l_text))) {
+          value = std::atoi(l_text);
+          return true;
+      }
+      return false;
+}
+
+/* read_cpu_list()
+   parse a cpu list in the sysfs format ("0-3,8,10-11")
+*/
+static bool  read_cpu_list(const char* path, cpu_set_t& set) noexcept
+{
+      char  l_text[4096];
+      CPU_ZERO(std::addressof(set));
+      if(read_text(path, l_text, sizeof(l_text))) {
+          char* l_iter = l_text;
+          while(*l_iter) {
+              if((*l_iter >= '0') && (*l_iter <= '9')) {
+                  long int l_head = std::strtol(l_iter, std::addressof(l_iter), 10);
+                  long int l_tail = l_head;
+                  if(*l_iter == '-') {
+                      l_tail = std::strtol(l_iter + 1, std::addressof(l_iter), 10);
+                  }
+                  for(long int l_cpu = l_head; (l_cpu <= l_tail) && (l_cpu < CPU_SETSIZE); l_cpu++) {
+                      CPU_SET(l_cpu, std::addressof(set));
+                  }
+              } else
+                  l_iter++;
+          }
+          return CPU_COUNT(std::addressof(set)) > 0;
+      }
+      return false;
+}
+
+static int   get_first_cpu(const cpu_set_t& set) noexcept
+{
+      for(int l_cpu = 0; l_cpu < CPU_SETSIZE; l_cpu++) {
+          if(CPU_ISSET(l_cpu, std::addressof(set))) {
+              return l_cpu;
+          }
+      }
+      return -1;
+}
+
+/* get_dense_index()
+   map <key> to an index in order of first appearance
+*/
+static int   get_dense_index(int* map, int key, int& count, bool& created) noexcept
+{
+      created = false;
+      if((key < 0) || (key >= CPU_SETSIZE)) {
+          key = 0;
+      }
+      if(map[key] < 0) {
+          map[key] = count++;
+          created = true;
+      }
+      return map[key];
+}
+
+      topology::topology(fragment* resource) noexcept:
+      m_resource(resource),
+      m_cpus(nullptr),
+      m_cpu_count(0),
+      m_core_count(0),
+      m_llc_count(0),
+      m_package_count(0),
+      m_node_count(0)
+{
+}
+
+      topology::~topology()
+{
+      reset();
+}
+
+void  topology::reset() noexcept
+{
+      if(m_cpus) {
+          m_resource->deallocate(m_cpus, m_cpu_count * sizeof(cpu_info), alignof(cpu_info));
+          m_cpus = nullptr;
+      }
+      m_cpu_count = 0;
+      m_core_count = 0;
+      m_llc_count = 0;
+      m_package_count = 0;
+      m_node_count = 0;
+}
+
+bool  topology::load(const char* path) noexcept
+{
+      char      l_name[PATH_MAX];
+      cpu_set_t l_online;
+      reset();
+      if(m_resource == nullptr) {
+          return false;
+      }
+      std::snprintf(l_name, sizeof(l_name), "%s/online", path);
+      if(read_cpu_list(l_name, l_online) == false) {
+          long int l_cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+          CPU_ZERO(std::addressof(l_online));
+          for(long int l_cpu = 0; (l_cpu < l_cpu_count) && (l_cpu < CPU_SETSIZE); l_cpu++) {
+              CPU_SET(l_cpu, std::addressof(l_online));
+          }
+      }
+      int l_cpu_count = CPU_COUNT(std::addressof(l_online));
+      if(l_cpu_count == 0) {
+          return false;
+      }
+      m_cpus = static_cast<cpu_info*>(m_resource->allocate(l_cpu_count * sizeof(cpu_info), alignof(cpu_info)));
+      if(m_cpus == nullptr) {
+          return false;
+      }
+      // keys (the first cpu of a core or cache domain, package and node numbers) to dense
+      // indices, and the running ranks of cores within cache domains and of cache domains within
+      // nodes
+      int  l_core_map[CPU_SETSIZE];
+      int  l_llc_map[CPU_SETSIZE];
+      int  l_package_map[CPU_SETSIZE];
+      int  l_node_map[CPU_SETSIZE];
+      int  l_core_rank[CPU_SETSIZE];
+      int  l_llc_rank[CPU_SETSIZE];
+      int  l_llc_core_count[CPU_SETSIZE];
+      int  l_node_llc_count[CPU_SETSIZE];
+      bool l_created;
+      std::fill_n(l_core_map, CPU_SETSIZE, -1);
+      std::fill_n(l_llc_map, CPU_SETSIZE, -1);
+      std::fill_n(l_package_map, CPU_SETSIZE, -1);
+      std::fill_n(l_node_map, CPU_SETSIZE, -1);
+      std::fill_n(l_llc_core_count, CPU_SETSIZE, 0);
+      std::fill_n(l_node_llc_count, CPU_SETSIZE, 0);
+      for(int l_cpu = 0; l_cpu < CPU_SETSIZE; l_cpu++) {
+          if(CPU_ISSET(l_cpu, std::addressof(l_online)) == false) {
+              continue;
+          }
+          cpu_info& l_info = m_cpus[m_cpu_count++];
+          cpu_set_t l_set;
+          l_info.cpu = l_cpu;
+          // SMT siblings
+          std::snprintf(l_name, sizeof(l_name), "%s/cpu%d/topology/thread_siblings_list", path, l_cpu);
+          if(read_cpu_list(l_name, l_set) == false) {
+              CPU_ZERO(std::addressof(l_set));
+              CPU_SET(l_cpu, std::addressof(l_set));
+          }
+          l_info.thread = 0;
+          for(int l_sibling = 0; l_sibling < l_cpu; l_sibling++) {
+              if(CPU_ISSET(l_sibling, std::addressof(l_set))) {
+                  l_info.thread++;
+              }
+          }
+          int l_core_key = get_first_cpu(l_set);
+          // package
+          int l_package_key = 0;
+          std::snprintf(l_name, sizeof(l_name), "%s/cpu%d/topology/physical_package_id", path, l_cpu);
+          read_int(l_name, l_package_key);
+          l_info.package = get_dense_index(l_package_map, l_package_key, m_package_count, l_created);
+          // NUMA node, from the node<n> link in the cpu directory
+          int l_node_key = 0;
+          std::snprintf(l_name, sizeof(l_name), "%s/cpu%d", path, l_cpu);
+          if(DIR* l_dir = opendir(l_name); l_dir != nullptr) {
+              while(struct dirent* l_entry = readdir(l_dir)) {
+                  if((std::strncmp(l_entry->d_name, "node", 4) == 0) &&
+                      (l_entry->d_name[4] >= '0') &&
+                      (l_entry->d_name[4] <= '9')) {
+                      l_node_key = std::atoi(l_entry->d_name + 4);
+                      break;
+                  }
+              }
+              closedir(l_dir);
+          }
+          l_info.node = l_node_key;
+          get_dense_index(l_node_map, l_node_key, m_node_count, l_created);
+          // last level cache: the highest level data or unified cache
+          int l_llc_key = 0;
+          int l_llc_level = 0;
+          for(int l_index = 0; l_index < 16; l_index++) {
+              char l_type[32];
+              int  l_level;
+              std::snprintf(l_name, sizeof(l_name), "%s/cpu%d/cache/index%d/level", path, l_cpu, l_index);
+              if(read_int(l_name, l_level) == false) {
+                  break;
+              }
+              std::snprintf(l_name, sizeof(l_name), "%s/cpu%d/cache/index%d/type", path, l_cpu, l_index);
+              if(read_text(l_name, l_type, sizeof(l_type)) &&
+                  (std::strncmp(l_type, "Instruction", 11) == 0)) {
+                  continue;
+              }
+              if(l_level > l_llc_level) {
+                  std::snprintf(l_name, sizeof(l_name), "%s/cpu%d/cache/index%d/shared_cpu_list", path, l_cpu, l_index);
+                  if(read_cpu_list(l_name, l_set)) {
+                      l_llc_key = get_first_cpu(l_set);
+                      l_llc_level = l_level;
+                  }
+              }
+          }
+          l_info.llc = get_dense_index(l_llc_map, l_llc_key, m_llc_count, l_created);
+          if(l_created) {
+              l_llc_rank[l_info.llc] = l_node_llc_count[l_node_map[l_node_key < CPU_SETSIZE ? l_node_key : 0]]++;
+          }
+          l_info.llc_rank = l_llc_rank[l_info.llc];
+          l_info.core = get_dense_index(l_core_map, l_core_key, m_core_count, l_created);
+          if(l_created) {
+              l_core_rank[l_info.core] = l_llc_core_count[l_info.llc]++;
+          }
+          l_info.core_rank = l_core_rank[l_info.core];
+      }
+      return true;
+}
+
+const cpu_info* topology::get_cpu_info(int cpu) const noexcept
+{
+      const cpu_info* l_iter = std::lower_bound(
+          m_cpus,
+          m_cpus + m_cpu_count,
+          cpu,
+          [](const cpu_info& info, int cpu) noexcept { return info.cpu < cpu; }
+      );
+      if((l_iter != m_cpus + m_cpu_count) &&
+          (l_iter->cpu == cpu)) {
+          return l_iter;
+      }
+      return nullptr;
+}
+
+std::size_t topology::get_placement(placement_policy policy, std::size_t count, int* cpus, int producer) const noexcept
+{
+      if((policy == place_none) ||
+          (count == 0) ||
+          (m_cpu_count == 0)) {
+          return 0;
+      }
+      int* l_order = static_cast<int*>(m_resource->allocate(m_cpu_count * sizeof(int), alignof(int)));
+      if(l_order == nullptr) {
+          return 0;
+      }
+      int l_llc = -1;
+      if(policy == place_same_llc) {
+          if(producer < 0) {
+              producer = sched_getcpu();
+          }
+          const cpu_info* l_producer = get_cpu_info(producer);
+          l_llc = l_producer ? l_producer->llc : m_cpus[0].llc;
+      }
+      int l_order_count = 0;
+      for(int l_index = 0; l_index < m_cpu_count; l_index++) {
+          if((l_llc < 0) ||
+              (m_cpus[l_index].llc == l_llc)) {
+              l_order[l_order_count++] = l_index;
+          }
+      }
+      auto l_key = [this, policy](int index) noexcept {
+          const cpu_info& l_info = m_cpus[index];
+          switch(policy) {
+              case place_compact:
+                  return std::make_tuple(l_info.node, l_info.llc, l_info.core, l_info.thread, l_info.cpu);
+              case place_scatter:
+                  return std::make_tuple(l_info.thread, l_info.core_rank, l_info.llc_rank, l_info.node, l_info.cpu);
+              case place_physical_core:
+                  return std::make_tuple(l_info.thread, l_info.node, l_info.llc, l_info.core, l_info.cpu);
+              default:
+                  return std::make_tuple(l_info.thread, l_info.core, 0, 0, l_info.cpu);
+          }
+      };
+      std::sort(l_order, l_order + l_order_count, [&l_key](int lhs, int rhs) noexcept { return l_key(lhs) < l_key(rhs); });
+      for(std::size_t l_index = 0; l_index < count; l_index++) {
+          cpus[l_index] = m_cpus[l_order[l_index % l_order_count]].cpu;
+      }
+      m_resource->deallocate(l_order, m_cpu_count * sizeof(int), alignof(int));
+      return count;
+}
+
+const topology& topology::get_default() noexcept
+{
+      static topology s_topology;
+      static bool     s_loaded = s_topology.load();
+      (void)s_loaded;
+      return s_topology;
+}
+
 /*namespace parallel*/ }
 
 /* posix_thread_base
@@ -85,22 +1014,28 @@ bool  posix_thread_base::thread_set_affinity(posix_thread_base* base, int affini
       CPU_ZERO(std::addressof(l_bits));
       if(affinity > affinity_none) {
           if(affinity < affinity_max) {
-              int cpu;
-              int count = CPU_COUNT(std::addressof(l_bits));
-              for(cpu = 0; cpu != count; cpu++) {
-                  CPU_SET(cpu, std::addressof(l_bits));
-              }
+              CPU_SET(affinity, std::addressof(l_bits));
           } else
               return false;
       } else
-          CPU_SET(affinity, std::addressof(l_bits));
-      if(pthread_setaffinity_np(base->m_handle, sizeof(cpu_set_t), std::addressof(l_bits))) {
+      if(sched_getaffinity(0, sizeof(cpu_set_t), std::addressof(l_bits))) {
+          return false;
+      }
+      if(thread_set_affinity(base, l_bits) == false) {
           return false;
       }
       base->m_affinity = affinity;
       return true;
 }
 
+bool  posix_thread_base::thread_set_affinity(posix_thread_base* base, const cpu_set_t& bits) noexcept
+{
+      if(base->m_handle) {
+          return pthread_setaffinity_np(base->m_handle, sizeof(cpu_set_t), std::addressof(bits)) == 0;
+      }
+      return false;
+}
+
 void  posix_thread_base::thread_wake(posix_thread_base* base) noexcept
 {
       pthread_cond_signal(std::addressof(base->m_condition));
@@ -140,6 +1075,16 @@ void  posix_thread_base::thread_exit(posix_thread_base*, void* result) noexcept
 {
 }
 
+void  posix_thread_base::thread_attach() noexcept
+{
+      parallel::reclaim_domain_base::attach_thread();
+}
+
+void  posix_thread_base::thread_detach() noexcept
+{
+      parallel::reclaim_domain_base::detach_thread();
+}
+
 bool  posix_thread_base::thread_resume(void* interface, void*(*function)(void*)) noexcept
 {
       int  l_error;
@@ -183,6 +1128,27 @@ bool  posix_thread_base::thread_suspend() noexcept
       return l_result;
 }
 
+bool  posix_thread_base::set_affinity(int affinity) noexcept
+{
+      if((affinity < affinity_none) ||
+          (affinity >= affinity_max)) {
+          return false;
+      }
+      pthread_mutex_lock(std::addressof(m_mutex));
+      m_affinity = affinity;
+      pthread_mutex_unlock(std::addressof(m_mutex));
+      return true;
+}
+
+int   posix_thread_base::get_affinity() noexcept
+{
+      int l_result;
+      pthread_mutex_lock(std::addressof(m_mutex));
+      l_result = m_affinity;
+      pthread_mutex_unlock(std::addressof(m_mutex));
+      return l_result;
+}
+
 bool  posix_thread_base::is_running(bool value) noexcept
 {
       bool l_result;
@@ -212,12 +1178,164 @@ void* posix_thread_base::get_exit_code() noexcept
 /* atomic_thread_base
  * lock-free thread base
 */
-      atomic_thread_base::atomic_thread_base(int affinity):
-      posix_thread_base(affinity)
+
+      atomic_thread_base::atomic_thread_base(int affinity) noexcept:
+      m_handle(0),
+      m_state(0),
+      m_return(nullptr),
+      m_affinity(affinity_none)
 {
+      if(affinity > affinity_none) {
+          if(affinity < affinity_max) {
+              m_affinity = affinity;
+          }
+      }
 }
 
       atomic_thread_base::~atomic_thread_base()
+{
+      thread_suspend();
+}
+
+bool  atomic_thread_base::thread_set_affinity(atomic_thread_base* base, int affinity) noexcept
+{
+      cpu_set_t l_bits;
+      CPU_ZERO(std::addressof(l_bits));
+      if(affinity > affinity_none) {
+          if(affinity < affinity_max) {
+              CPU_SET(affinity, std::addressof(l_bits));
+          } else
+              return false;
+      } else
+      if(sched_getaffinity(0, sizeof(cpu_set_t), std::addressof(l_bits))) {
+          return false;
+      }
+      if(pthread_setaffinity_np(base->m_handle, sizeof(cpu_set_t), std::addressof(l_bits))) {
+          return false;
+      }
+      base->m_affinity = affinity;
+      return true;
+}
+
+/* thread_wake()
+   signal the thread; only the first of several signals arriving while the thread is busy costs
+   an atomic read-modify-write, and the futex is only woken if the thread is parked on it
+*/
+void  atomic_thread_base::thread_wake(atomic_thread_base* base) noexcept
+{
+      std::uint32_t l_state = base->m_state.load(std::memory_order_relaxed);
+      if((l_state & state_signal) == 0) {
+          l_state = base->m_state.fetch_or(state_signal, std::memory_order_seq_cst);
+          if((l_state & state_awake) == 0) {
+              parallel::futex_wake(std::addressof(base->m_state), 1);
+          }
+      }
+}
+
+/* thread_wait()
+   wait for a signal: spin first, then clear the awake bit and park on the state word until a
+   signal arrives or the thread is suspended
+*/
+void  atomic_thread_base::thread_wait(atomic_thread_base* base) noexcept
+{
+      thread_wait(base, 0);
+}
+
+bool  atomic_thread_base::thread_wait(atomic_thread_base* base, int delay_ms) noexcept
+{
+      bool          l_result = false;
+      std::uint32_t l_state;
+      for(int l_spin = 0; l_spin < spin_max; l_spin++) {
+          l_state = base->m_state.load(std::memory_order_acquire);
+          if(l_state & state_signal) {
+              base->m_state.fetch_and(~state_signal, std::memory_order_acquire);
+              return true;
+          }
+          parallel::cpu_relax();
+      }
+      struct timespec  l_delay;
+      struct timespec* l_timeout = nullptr;
+      if(delay_ms > 0) {
+          l_delay.tv_sec = delay_ms / parallel::msps;
+          l_delay.tv_nsec = (delay_ms % parallel::msps) * parallel::nspms;
+          l_timeout = std::addressof(l_delay);
+      }
+      l_state = base->m_state.fetch_and(~state_awake, std::memory_order_seq_cst) & ~state_awake;
+      while(true) {
+          if(l_state & state_signal) {
+              l_result = true;
+              break;
+          }
+          if((l_state & state_running) == 0) {
+              break;
+          }
+          if(parallel::futex_wait(std::addressof(base->m_state), l_state, l_timeout) < 0) {
+              if(errno == ETIMEDOUT) {
+                  break;
+              }
+          }
+          l_state = base->m_state.load(std::memory_order_acquire);
+      }
+      base->m_state.fetch_or(state_awake, std::memory_order_relaxed);
+      base->m_state.fetch_and(~state_signal, std::memory_order_acquire);
+      return l_result;
+}
+
+void  atomic_thread_base::thread_yield() noexcept
+{
+      sched_yield();
+}
+
+void  atomic_thread_base::thread_exit(atomic_thread_base*, void*) noexcept
 {
 }
 
+bool  atomic_thread_base::thread_resume(void* interface, void*(*function)(void*)) noexcept
+{
+      if(m_handle == 0) {
+          // a signal may already be pending, from work submitted before the thread started
+          std::uint32_t l_state = m_state.load(std::memory_order_relaxed);
+          while((l_state & state_running) == 0) {
+              if(m_state.compare_exchange_weak(l_state, l_state | state_running | state_awake, std::memory_order_acq_rel)) {
+                  if(pthread_create(std::addressof(m_handle), nullptr, function, interface) == 0) {
+                      return true;
+                  }
+                  m_handle = 0;
+                  m_state.fetch_and(~(state_running | state_awake), std::memory_order_release);
+                  break;
+              }
+          }
+      }
+      return false;
+}
+
+bool  atomic_thread_base::thread_suspend() noexcept
+{
+      bool  l_result = true;
+      if(m_handle) {
+          m_state.fetch_and(~state_running, std::memory_order_seq_cst);
+          parallel::futex_wake(std::addressof(m_state), 1);
+          l_result = pthread_join(m_handle, std::addressof(m_return)) == 0;
+          m_handle = 0;
+          m_state.fetch_and(~state_awake, std::memory_order_release);
+      }
+      return l_result;
+}
+
+bool  atomic_thread_base::is_running(bool value) noexcept
+{
+      if(m_state.load(std::memory_order_relaxed) & state_awake) {
+          return value;
+      } else
+          return !value;
+}
+
+bool  atomic_thread_base::is_idle() noexcept
+{
+      return is_running(false);
+}
+
+void* atomic_thread_base::get_exit_code() noexcept
+{
+      return m_return;
+}
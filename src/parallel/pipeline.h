@@ -0,0 +1,561 @@
+#ifndef parallel_pipeline_h
+#define parallel_pipeline_h
+/**
+    Copyright (c) 2020, wicked systems
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright notice, this list of
+    conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, this list
+    of conditions and the following disclaimer in the documentation and/or other materials
+    provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+    THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+    OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+    HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+    TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**/
+#include <parallel.h>
+#include <parallel/ring-queue.h>
+#include <parallel/topology.h>
+#include <memory.h>
+#include <memory/fragment.h>
+#include <atomic>
+#include <functional>
+#include <type_traits>
+#include <sched.h>
+#include <time.h>
+
+namespace parallel {
+
+/* overflow_mode
+   what a stage does with items arriving while its input queue is full
+*/
+enum overflow_mode
+{
+  overflow_block,   // the producer waits for room
+  overflow_drop     // the item is dropped and counted
+};
+
+/* stage_stats
+   counters of a pipeline stage
+*/
+struct stage_stats
+{
+  std::uint64_t item_count;   // items processed
+  std::uint64_t batch_count;  // batches taken off the input queue
+  std::uint64_t drop_count;   // items refused at the input, full (overflow_drop) or closed
+  std::uint64_t idle_count;   // waits for input
+  std::uint64_t stall_count;  // waits for room in the next stage
+  std::uint64_t stall_time;   // nanoseconds spent waiting for room in the next stage
+  std::uint64_t run_time;     // nanoseconds since the stage was resumed
+
+  inline  double get_throughput() const noexcept {
+          return run_time ? static_cast<double>(item_count) * nsps / run_time : 0.0;
+  }
+};
+
+/* stage_base
+   type independent interface of a pipeline stage
+*/
+class stage_base
+{
+  const char*   m_name;
+
+  public:
+  inline  stage_base(const char* name) noexcept:
+          m_name(name) {
+  }
+
+          stage_base(const stage_base&) noexcept = delete;
+          stage_base(stage_base&&) noexcept = delete;
+
+  virtual ~stage_base() {
+  }
+
+  virtual bool  resume() noexcept = 0;
+  virtual bool  suspend() noexcept = 0;
+
+  /* is_drained()
+     true if the stage has nothing queued or in flight
+  */
+  virtual bool  is_drained() const noexcept = 0;
+
+  virtual stage_stats get_stats() const noexcept = 0;
+
+  inline  const char* get_name() const noexcept {
+          return m_name;
+  }
+
+          stage_base& operator=(const stage_base&) noexcept = delete;
+          stage_base& operator=(stage_base&&) noexcept = delete;
+};
+
+/* stage_input
+   receiving end of a stage: a bounded ring of <Xt> and the policy applied when it's full
+*/
+template<typename Xt>
+class stage_input: public stage_base
+{
+  protected:
+  ring_queue<Xt>  m_queue;
+  overflow_mode   m_overflow_mode;
+  std::atomic<std::uint64_t> m_drop_count;
+
+  public:
+  inline  stage_input(const char* name, std::size_t capacity, overflow_mode mode, fragment* resource) noexcept:
+          stage_base(name),
+          m_queue(capacity, resource),
+          m_overflow_mode(mode),
+          m_drop_count(0) {
+  }
+
+  /* push()
+     hand <value> over to the stage; fails if the item was dropped
+  */
+  inline  bool  push(Xt&& value) noexcept {
+          if(m_overflow_mode == overflow_block) {
+              if(m_queue.push(std::move(value))) {
+                  return true;
+              }
+          } else
+          if(m_queue.push(std::addressof(value), 1)) {
+              return true;
+          }
+          m_drop_count.fetch_add(1, std::memory_order_relaxed);
+          return false;
+  }
+
+  /* push()
+     hand a batch of <count> items over to the stage, counting the time spent waiting for room
+     into <stall_count> and <stall_time>; returns the number of items accepted
+  */
+          std::size_t push(Xt* items, std::size_t count, std::uint64_t& stall_count, std::uint64_t& stall_time) noexcept {
+          std::size_t l_count = m_queue.push(items, count);
+          if(l_count < count) {
+              if(m_overflow_mode == overflow_block) {
+                  struct timespec l_head_time;
+                  struct timespec l_tail_time;
+                  clock_gettime(CLOCK_MONOTONIC, std::addressof(l_head_time));
+                  while((l_count < count) &&
+                      (m_queue.is_closed() == false)) {
+                      m_queue.wait_for_space([]() noexcept { return false; });
+                      l_count += m_queue.push(items + l_count, count - l_count);
+                  }
+                  clock_gettime(CLOCK_MONOTONIC, std::addressof(l_tail_time));
+                  stall_count++;
+                  stall_time += (l_tail_time.tv_sec - l_head_time.tv_sec) * nsps + l_tail_time.tv_nsec - l_head_time.tv_nsec;
+              }
+              if(l_count < count) {
+                  m_drop_count.fetch_add(count - l_count, std::memory_order_relaxed);
+              }
+          }
+          return l_count;
+  }
+
+  inline  std::size_t push(Xt* items, std::size_t count) noexcept {
+          std::uint64_t l_stall_count = 0;
+          std::uint64_t l_stall_time = 0;
+          return push(items, count, l_stall_count, l_stall_time);
+  }
+
+  /* close()
+     refuse further input; whatever is queued is still processed
+  */
+  inline  void  close() noexcept {
+          m_queue.close();
+  }
+
+  inline  void  open() noexcept {
+          m_queue.open();
+  }
+
+  inline  std::size_t get_queue_size() const noexcept {
+          return m_queue.get_size();
+  }
+
+  inline  std::size_t get_queue_capacity() const noexcept {
+          return m_queue.get_capacity();
+  }
+};
+
+/* stage
+   pipeline stage turning items of <Xt> into items of <Yt> on a number of worker threads
+   Workers take up to a batch of items off the input queue at once, run them through the stage
+   function - bool(Xt&, Yt&), returning false to filter an item out, or void(Xt&) for a final
+   stage (Yt = void) - and hand the results over to the next stage as a single batch. Item types
+   must be default constructible, as each worker keeps a batch of them around.
+*/
+template<typename Xt, typename Yt>
+struct stage_function
+{
+  using type = std::function<bool(Xt&, Yt&)>;
+};
+
+template<typename Xt>
+struct stage_function<Xt, void>
+{
+  using type = std::function<void(Xt&)>;
+};
+
+template<typename Xt, typename Yt = void, typename Fn = typename stage_function<Xt, Yt>::type>
+class stage: public stage_input<Xt>
+{
+  using base_type = stage_input<Xt>;
+
+  public:
+  using output_type = typename std::conditional<std::is_void<Yt>::value, none, Yt>::type;
+
+  static constexpr std::size_t batch_size_default = 16;
+
+  private:
+  class worker_t: public posix_thread_base
+  {
+    stage*        m_owner;
+    Xt*           m_input;
+    output_type*  m_output;
+
+    protected:
+    inline  void* thread_loop(worker_t*) noexcept {
+            return m_owner->worker_loop(this);
+    }
+
+    friend class posix_thread_base;
+    friend class stage;
+
+    public:
+    inline  worker_t(stage* owner) noexcept:
+            posix_thread_base(affinity_none),
+            m_owner(owner),
+            m_input(nullptr),
+            m_output(nullptr) {
+    }
+
+    inline  ~worker_t() {
+            thread_suspend();
+    }
+
+    inline  bool  resume() noexcept {
+            return thread_resume(this, thread_boot<worker_t>);
+    }
+
+    inline  bool  suspend() noexcept {
+            return thread_suspend();
+    }
+  };
+
+  Fn            m_fn;
+  fragment*     m_resource;
+  worker_t*     m_workers;
+  std::size_t   m_worker_count;
+  std::size_t   m_batch_size;
+  stage_input<output_type>* m_next;
+  struct timespec m_start_time;
+
+  alignas(global::cache_line_size)
+  std::atomic<bool>           m_stop;
+  std::atomic<std::size_t>    m_busy_count;
+  alignas(global::cache_line_size)
+  std::atomic<std::uint64_t>  m_item_count;
+  std::atomic<std::uint64_t>  m_batch_count;
+  std::atomic<std::uint64_t>  m_idle_count;
+  std::atomic<std::uint64_t>  m_stall_count;
+  std::atomic<std::uint64_t>  m_stall_time;
+
+  private:
+  template<typename Ot>
+  inline  Ot*   make_array() noexcept {
+          Ot* l_array = static_cast<Ot*>(m_resource->allocate(m_batch_size * sizeof(Ot), alignof(Ot)));
+          if(l_array) {
+              for(std::size_t l_index = 0; l_index < m_batch_size; l_index++) {
+                  new(l_array + l_index) Ot();
+              }
+          }
+          return l_array;
+  }
+
+  template<typename Ot>
+  inline  void  free_array(Ot* array) noexcept {
+          if(array) {
+              for(std::size_t l_index = 0; l_index < m_batch_size; l_index++) {
+                  array[l_index].~Ot();
+              }
+              m_resource->deallocate(array, m_batch_size * sizeof(Ot), alignof(Ot));
+          }
+  }
+
+  /* worker_loop()
+     invoked from the thread boot loop, with the worker's lock held
+  */
+          void* worker_loop(worker_t* worker) noexcept {
+          posix_thread_base::thread_unlock(worker);
+          m_busy_count.fetch_add(1, std::memory_order_seq_cst);
+          std::size_t l_count = base_type::m_queue.pop(worker->m_input, m_batch_size);
+          if(l_count) {
+              if constexpr (std::is_void<Yt>::value) {
+                  for(std::size_t l_index = 0; l_index < l_count; l_index++) {
+                      m_fn(worker->m_input[l_index]);
+                  }
+              } else {
+                  std::size_t l_output_count = 0;
+                  for(std::size_t l_index = 0; l_index < l_count; l_index++) {
+                      if(m_fn(worker->m_input[l_index], worker->m_output[l_output_count])) {
+                          l_output_count++;
+                      }
+                  }
+                  if(l_output_count && m_next) {
+                      std::uint64_t l_stall_count = 0;
+                      std::uint64_t l_stall_time = 0;
+                      m_next->push(worker->m_output, l_output_count, l_stall_count, l_stall_time);
+                      if(l_stall_count) {
+                          m_stall_count.fetch_add(l_stall_count, std::memory_order_relaxed);
+                          m_stall_time.fetch_add(l_stall_time, std::memory_order_relaxed);
+                      }
+                  }
+              }
+              m_item_count.fetch_add(l_count, std::memory_order_relaxed);
+              m_batch_count.fetch_add(1, std::memory_order_relaxed);
+              m_busy_count.fetch_sub(1, std::memory_order_seq_cst);
+          } else {
+              m_busy_count.fetch_sub(1, std::memory_order_seq_cst);
+              m_idle_count.fetch_add(1, std::memory_order_relaxed);
+              base_type::m_queue.wait_for_data([this]() noexcept { return m_stop.load(std::memory_order_seq_cst); });
+          }
+          posix_thread_base::thread_lock(worker);
+          return nullptr;
+  }
+
+  public:
+  /* stage()
+     a stage running <fn> on <thread_count> workers, queueing up to <capacity> items
+  */
+  inline  stage(
+              const char* name,
+              Fn fn,
+              std::size_t thread_count = 1,
+              std::size_t capacity = 1024,
+              overflow_mode mode = overflow_block,
+              std::size_t batch_size = batch_size_default,
+              fragment* resource = fragment::get_default()
+          ) noexcept:
+          base_type(name, capacity, mode, resource),
+          m_fn(std::move(fn)),
+          m_resource(resource),
+          m_workers(nullptr),
+          m_worker_count(0),
+          m_batch_size(batch_size ? batch_size : 1),
+          m_next(nullptr),
+          m_start_time{0, 0},
+          m_stop(false),
+          m_busy_count(0),
+          m_item_count(0),
+          m_batch_count(0),
+          m_idle_count(0),
+          m_stall_count(0),
+          m_stall_time(0) {
+          if(m_resource && thread_count) {
+              m_workers = static_cast<worker_t*>(m_resource->allocate(thread_count * sizeof(worker_t), alignof(worker_t)));
+              if(m_workers) {
+                  for(std::size_t l_index = 0; l_index < thread_count; l_index++) {
+                      worker_t* l_worker = new(m_workers + l_index) worker_t(this);
+                      l_worker->m_input = make_array<Xt>();
+                      if constexpr (std::is_void<Yt>::value == false) {
+                          l_worker->m_output = make_array<output_type>();
+                      }
+                  }
+                  m_worker_count = thread_count;
+              }
+          }
+  }
+
+  virtual ~stage() {
+          suspend();
+          if(m_workers) {
+              for(std::size_t l_index = 0; l_index < m_worker_count; l_index++) {
+                  worker_t* l_worker = m_workers + l_index;
+                  free_array(l_worker->m_input);
+                  free_array(l_worker->m_output);
+                  l_worker->~worker_t();
+              }
+              m_resource->deallocate(m_workers, m_worker_count * sizeof(worker_t), alignof(worker_t));
+          }
+  }
+
+  /* connect()
+     send the output to <next>; to be done while suspended
+  */
+  inline  void  connect(stage_input<output_type>& next) noexcept {
+          m_next = std::addressof(next);
+  }
+
+  /* set_placement()
+     pin the workers to the cpus <policy> picks on <cpu_topology>; takes effect before each
+     worker's next batch. place_none leaves the current affinity as it is.
+  */
+          bool  set_placement(placement_policy policy, int producer = -1, const topology& cpu_topology = topology::get_default()) noexcept {
+          if(policy == place_none) {
+              return true;
+          }
+          if(m_worker_count == 0) {
+              return false;
+          }
+          int* l_cpus = static_cast<int*>(m_resource->allocate(m_worker_count * sizeof(int), alignof(int)));
+          if(l_cpus == nullptr) {
+              return false;
+          }
+          bool l_result = cpu_topology.get_placement(policy, m_worker_count, l_cpus, producer) == m_worker_count;
+          if(l_result) {
+              for(std::size_t l_index = 0; l_index < m_worker_count; l_index++) {
+                  if(m_workers[l_index].set_affinity(l_cpus[l_index]) == false) {
+                      l_result = false;
+                  }
+              }
+          }
+          m_resource->deallocate(l_cpus, m_worker_count * sizeof(int), alignof(int));
+          return l_result;
+  }
+
+  virtual bool  resume() noexcept override {
+          bool l_result = m_worker_count;
+          clock_gettime(CLOCK_MONOTONIC, std::addressof(m_start_time));
+          m_stop.store(false, std::memory_order_seq_cst);
+          for(std::size_t l_index = 0; l_index < m_worker_count; l_index++) {
+              worker_t* l_worker = m_workers + l_index;
+              if((l_worker->m_input == nullptr) ||
+                  ((std::is_void<Yt>::value == false) && (l_worker->m_output == nullptr)) ||
+                  (l_worker->resume() == false)) {
+                  l_result = false;
+              }
+          }
+          return l_result;
+  }
+
+  virtual bool  suspend() noexcept override {
+          bool l_result = true;
+          m_stop.store(true, std::memory_order_seq_cst);
+          base_type::m_queue.interrupt();
+          for(std::size_t l_index = 0; l_index < m_worker_count; l_index++) {
+              if(m_workers[l_index].suspend() == false) {
+                  l_result = false;
+              }
+          }
+          return l_result;
+  }
+
+  virtual bool  is_drained() const noexcept override {
+          // the queue first: workers count themselves busy before taking items off it
+          return base_type::m_queue.is_empty() &&
+              (m_busy_count.load(std::memory_order_seq_cst) == 0);
+  }
+
+  virtual stage_stats get_stats() const noexcept override {
+          stage_stats     l_stats;
+          struct timespec l_time;
+          clock_gettime(CLOCK_MONOTONIC, std::addressof(l_time));
+          l_stats.item_count = m_item_count.load(std::memory_order_relaxed);
+          l_stats.batch_count = m_batch_count.load(std::memory_order_relaxed);
+          l_stats.drop_count = base_type::m_drop_count.load(std::memory_order_relaxed);
+          l_stats.idle_count = m_idle_count.load(std::memory_order_relaxed);
+          l_stats.stall_count = m_stall_count.load(std::memory_order_relaxed);
+          l_stats.stall_time = m_stall_time.load(std::memory_order_relaxed);
+          l_stats.run_time = (m_start_time.tv_sec || m_start_time.tv_nsec) ?
+              (l_time.tv_sec - m_start_time.tv_sec) * nsps + l_time.tv_nsec - m_start_time.tv_nsec : 0;
+          return l_stats;
+  }
+
+  inline  std::size_t get_thread_count() const noexcept {
+          return m_worker_count;
+  }
+
+  inline  std::size_t get_batch_size() const noexcept {
+          return m_batch_size;
+  }
+};
+
+/* pipeline
+   a chain of stages, started from the last one and stopped from the first one
+*/
+class pipeline
+{
+  public:
+  static constexpr std::size_t stage_max = 16;
+
+  private:
+  stage_base*   m_stages[stage_max];
+  std::size_t   m_stage_count;
+
+  public:
+  inline  pipeline() noexcept:
+          m_stages(),
+          m_stage_count(0) {
+  }
+
+          pipeline(const pipeline&) noexcept = delete;
+          pipeline(pipeline&&) noexcept = delete;
+
+  inline  ~pipeline() {
+          suspend();
+  }
+
+  /* add()
+     append <stage> - to be connected to its neighbours by the caller - to the pipeline
+  */
+  inline  bool  add(stage_base& stage) noexcept {
+          if(m_stage_count < stage_max) {
+              m_stages[m_stage_count++] = std::addressof(stage);
+              return true;
+          }
+          return false;
+  }
+
+  inline  bool  resume() noexcept {
+          bool l_result = true;
+          for(std::size_t l_index = m_stage_count; l_index > 0; l_index--) {
+              if(m_stages[l_index - 1]->resume() == false) {
+                  l_result = false;
+              }
+          }
+          return l_result;
+  }
+
+  /* drain()
+     wait for all items pushed so far to make it through the pipeline
+  */
+  inline  void  drain() noexcept {
+          for(std::size_t l_index = 0; l_index < m_stage_count; l_index++) {
+              while(m_stages[l_index]->is_drained() == false) {
+                  sched_yield();
+              }
+          }
+  }
+
+  inline  bool  suspend() noexcept {
+          bool l_result = true;
+          for(std::size_t l_index = 0; l_index < m_stage_count; l_index++) {
+              if(m_stages[l_index]->suspend() == false) {
+                  l_result = false;
+              }
+          }
+          return l_result;
+  }
+
+  inline  stage_base* get_stage(std::size_t index) const noexcept {
+          return index < m_stage_count ? m_stages[index] : nullptr;
+  }
+
+  inline  std::size_t get_stage_count() const noexcept {
+          return m_stage_count;
+  }
+
+          pipeline& operator=(const pipeline&) noexcept = delete;
+          pipeline& operator=(pipeline&&) noexcept = delete;
+};
+
+/*namespace parallel*/ }
+#endif
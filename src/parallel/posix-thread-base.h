@@ -42,12 +42,15 @@ class posix_thread_base: public parallel::thread_base
   static  void  thread_lock(posix_thread_base*) noexcept;
   static  void  thread_unlock(posix_thread_base*) noexcept;
   static  bool  thread_set_affinity(posix_thread_base*, int) noexcept;
+  static  bool  thread_set_affinity(posix_thread_base*, const cpu_set_t&) noexcept;
   static  void  thread_wake(posix_thread_base*) noexcept;
   static  void  thread_wait(posix_thread_base*) noexcept;
   static  bool  thread_wait(posix_thread_base*, int) noexcept;
   static  void  thread_yield() noexcept;
   static  void* thread_join(posix_thread_base*) noexcept;
   static  void  thread_exit(posix_thread_base*, void*) noexcept;
+  static  void  thread_attach() noexcept;
+  static  void  thread_detach() noexcept;
 
   template<typename Ct>
   static  void* thread_boot(void* p) noexcept {
@@ -57,6 +60,7 @@ class posix_thread_base: public parallel::thread_base
           if(l_object) {
               thread_lock(l_object);
               if(l_object->m_running) {
+                  thread_attach();
                   if constexpr (base_type::has_launch_callback<Ct>::value) {
                       l_object->thread_launch_event();
                   }
@@ -73,9 +77,10 @@ class posix_thread_base: public parallel::thread_base
                       }
                       l_result = l_object->thread_loop(l_object);
                   }
-                  if constexpr (base_type::has_finish_callback<decltype(l_object)>::value) {
+                  if constexpr (base_type::has_finish_callback<Ct>::value) {
                       l_object->thread_finish_event();
                   }
+                  thread_detach();
                   l_object->m_running = 0;
                   l_object->m_awake = 1;
               }
@@ -95,6 +100,8 @@ class posix_thread_base: public parallel::thread_base
           posix_thread_base(const posix_thread_base&) noexcept = delete;
           posix_thread_base(posix_thread_base&&) noexcept = delete;
           ~posix_thread_base();
+          bool  set_affinity(int) noexcept;
+          int   get_affinity() noexcept;
           bool  is_running(bool = true) noexcept;
           bool  is_idle() noexcept;
           void* get_exit_code() noexcept;
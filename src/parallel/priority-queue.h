@@ -0,0 +1,394 @@
+#ifndef parallel_priority_queue_h
+#define parallel_priority_queue_h
+/**
+    Copyright (c) 2020, wicked systems
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright notice, this list of
+    conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, this list
+    of conditions and the following disclaimer in the documentation and/or other materials
+    provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+    THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+    OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+    HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+    TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**/
+#include <parallel.h>
+#include <memory.h>
+#include <memory/fragment.h>
+#include "queue-base.h"
+#include <atomic>
+#include <vector>
+#include <time.h>
+
+namespace parallel {
+
+/* lane_stats
+   per priority counters of a priority queue
+*/
+struct lane_stats
+{
+  std::uint64_t task_count;     // tasks taken off the lane
+  std::uint64_t promote_count;  // tasks served ahead of higher priorities for having waited too long
+  std::uint64_t wait_time;      // total time spent queued, in nanoseconds
+  std::uint64_t wait_max;       // longest time spent queued, in nanoseconds
+};
+
+/* priority_queue
+   execution queue with a posix consumer thread and a fixed number of priority lanes
+   Xt - task type; tasks are either invoked as Xt() or passed to the delegate's queue_execute()
+   LaneCount - number of priority lanes, lane 0 being the most urgent
+   Ct - delegate type (see executor), void if none
+
+   Every lane is a FIFO list of nodes taken from a pooled node array (blocks allocated from the
+   fragment and recycled through a free list). The consumer serves the most urgent non-empty
+   lane, one node at a time, up to the batch size per lock round-trip, then executes the batch
+   without holding the lock. Starvation protection: whenever the head of a less urgent lane has
+   been waiting for longer than the starvation limit, the longest waiting of those heads is
+   served first. Time spent waiting is accounted per lane.
+*/
+template<typename Xt, std::size_t LaneCount = 4, typename Ct = void>
+class priority_queue: public queue_base<posix_thread_base>
+{
+  using base_type = queue_base<posix_thread_base>;
+  using delegate_type = typename std::conditional<std::is_void<Ct>::value, priority_queue, Ct>::type;
+
+  static_assert(LaneCount > 0, "a priority queue needs at least one lane");
+
+  static constexpr std::size_t block_size = 256;
+
+  public:
+  using node_type = Xt;
+
+  private:
+  struct node_t
+  {
+    node_t*       next;
+    std::uint64_t time;
+    alignas(Xt) unsigned char value[sizeof(Xt)];
+
+    inline  Xt&   get_value() noexcept {
+            return *std::launder(reinterpret_cast<Xt*>(value));
+    }
+  };
+
+  struct block_t
+  {
+    block_t*      next;
+    node_t        nodes[block_size];
+  };
+
+  struct lane_t
+  {
+    node_t*       head;
+    node_t*       tail;
+    std::size_t   size;
+
+    std::atomic<std::uint64_t> task_count;
+    std::atomic<std::uint64_t> promote_count;
+    std::atomic<std::uint64_t> wait_time;
+    std::atomic<std::uint64_t> wait_max;
+  };
+
+  fragment*           m_resource;
+  block_t*            m_blocks;
+  node_t*             m_free;
+  lane_t              m_lanes[LaneCount];
+  std::size_t         m_pending_count;
+  std::pmr::vector<Xt> m_batch;
+  std::size_t         m_batch_max;
+  std::uint64_t       m_starve_time;
+  bool                m_busy;
+
+  private:
+  inline  delegate_type* get_delegate() noexcept {
+          return static_cast<delegate_type*>(this);
+  }
+
+  static inline std::uint64_t get_time() noexcept {
+          struct timespec l_time;
+          clock_gettime(CLOCK_MONOTONIC, std::addressof(l_time));
+          return l_time.tv_sec * nsps + l_time.tv_nsec;
+  }
+
+  /* get_node()
+     take a node off the free list, allocating a new block if needed
+  */
+  inline  node_t* get_node() noexcept {
+          if(m_free == nullptr) {
+              block_t* l_block = reinterpret_cast<block_t*>(m_resource->allocate(sizeof(block_t), alignof(block_t)));
+              if(l_block == nullptr) {
+                  return nullptr;
+              }
+              l_block->next = m_blocks;
+              m_blocks = l_block;
+              for(std::size_t l_index = 0; l_index < block_size; l_index++) {
+                  l_block->nodes[l_index].next = m_free;
+                  m_free = l_block->nodes + l_index;
+              }
+          }
+          node_t* l_node = m_free;
+          m_free = l_node->next;
+          return l_node;
+  }
+
+  inline  void  free_node(node_t* node) noexcept {
+          node->get_value().~Xt();
+          node->next = m_free;
+          m_free = node;
+  }
+
+  /* get_lane()
+     the lane to serve next: the one holding the longest waiting head past the starvation
+     limit, if any, the most urgent non-empty lane otherwise
+  */
+  inline  std::size_t get_lane(std::uint64_t time) noexcept {
+          std::size_t l_lane = LaneCount;
+          for(std::size_t l_index = 0; l_index < LaneCount; l_index++) {
+              if(m_lanes[l_index].head) {
+                  l_lane = l_index;
+                  break;
+              }
+          }
+          if(m_starve_time) {
+              std::uint64_t l_wait_max = m_starve_time;
+              std::size_t   l_starve_lane = LaneCount;
+              for(std::size_t l_index = l_lane + 1; l_index < LaneCount; l_index++) {
+                  node_t* l_head = m_lanes[l_index].head;
+                  if(l_head &&
+                      (time > l_head->time) &&
+                      (time - l_head->time > l_wait_max)) {
+                      l_wait_max = time - l_head->time;
+                      l_starve_lane = l_index;
+                  }
+              }
+              if(l_starve_lane < LaneCount) {
+                  m_lanes[l_starve_lane].promote_count.fetch_add(1, std::memory_order_relaxed);
+                  return l_starve_lane;
+              }
+          }
+          return l_lane;
+  }
+
+  protected:
+  template<typename Dt>
+  inline  void* thread_loop(Dt*) noexcept {
+          if(m_pending_count == 0) {
+              if(m_busy) {
+                  if constexpr (base_type::has_sleep_callback<delegate_type>::value) {
+                      get_delegate()->thread_sleep_event();
+                  }
+                  m_busy = false;
+              }
+              thread_wait(this);
+          } else {
+              std::uint64_t l_time = get_time();
+              std::size_t   l_count = m_pending_count;
+              if((m_batch_max > 0) &&
+                  (l_count > m_batch_max)) {
+                  l_count = m_batch_max;
+              }
+              for(std::size_t l_index = 0; l_index < l_count; l_index++) {
+                  lane_t& l_lane = m_lanes[get_lane(l_time)];
+                  node_t* l_node = l_lane.head;
+                  l_lane.head = l_node->next;
+                  if(l_lane.head == nullptr) {
+                      l_lane.tail = nullptr;
+                  }
+                  l_lane.size--;
+                  std::uint64_t l_wait = l_time > l_node->time ? l_time - l_node->time : 0;
+                  l_lane.task_count.fetch_add(1, std::memory_order_relaxed);
+                  l_lane.wait_time.fetch_add(l_wait, std::memory_order_relaxed);
+                  if(l_wait > l_lane.wait_max.load(std::memory_order_relaxed)) {
+                      l_lane.wait_max.store(l_wait, std::memory_order_relaxed);
+                  }
+                  m_batch.push_back(std::move(l_node->get_value()));
+                  free_node(l_node);
+              }
+              m_pending_count -= l_count;
+              if(m_busy == false) {
+                  if constexpr (base_type::has_wake_callback<delegate_type>::value) {
+                      get_delegate()->thread_wake_event();
+                  }
+                  m_busy = true;
+              }
+              thread_unlock(this);
+              for(auto& i_node: m_batch) {
+                  if constexpr (base_type::has_execute_delegate<delegate_type, node_type&>::value) {
+                      get_delegate()->queue_execute(i_node);
+                  } else
+                      i_node();
+              }
+              m_batch.clear();
+              thread_lock(this);
+          }
+          return nullptr;
+  }
+
+  friend class posix_thread_base;
+
+  public:
+  /* priority_queue()
+     the consumer is not started until resume()
+  */
+  inline  priority_queue(fragment* resource = fragment::get_default()) noexcept:
+          base_type(),
+          m_resource(resource),
+          m_blocks(nullptr),
+          m_free(nullptr),
+          m_lanes(),
+          m_pending_count(0),
+          m_batch(),
+          m_batch_max(16),
+          m_starve_time(10 * nspms),
+          m_busy(false) {
+  }
+
+          priority_queue(const priority_queue&) noexcept = delete;
+          priority_queue(priority_queue&&) noexcept = delete;
+
+  virtual ~priority_queue() {
+          base_type::thread_suspend();
+          for(lane_t& i_lane: m_lanes) {
+              while(node_t* l_node = i_lane.head) {
+                  i_lane.head = l_node->next;
+                  free_node(l_node);
+              }
+          }
+          while(m_blocks) {
+              block_t* l_block = m_blocks;
+              m_blocks = l_block->next;
+              m_resource->deallocate(l_block, sizeof(block_t), alignof(block_t));
+          }
+  }
+
+  /* enqueue()
+     construct a task from <args> at the back of lane <priority> (clamped to the least urgent
+     lane)
+  */
+  template<typename... Args>
+          bool  enqueue(std::size_t priority, Args&&... args) noexcept {
+          if(base_type::is_enabled()) {
+              if(priority >= LaneCount) {
+                  priority = LaneCount - 1;
+              }
+              std::uint64_t l_time = get_time();
+              base_type::thread_lock(this);
+              node_t* l_node = get_node();
+              if(l_node) {
+                  new(l_node->value) Xt(std::forward<Args>(args)...);
+                  l_node->next = nullptr;
+                  l_node->time = l_time;
+                  lane_t& l_lane = m_lanes[priority];
+                  if(l_lane.tail) {
+                      l_lane.tail->next = l_node;
+                  } else
+                      l_lane.head = l_node;
+                  l_lane.tail = l_node;
+                  l_lane.size++;
+                  if(++m_pending_count == 1) {
+                      base_type::thread_wake(this);
+                  }
+                  base_type::thread_unlock(this);
+                  return true;
+              }
+              base_type::thread_unlock(this);
+          }
+          return false;
+  }
+
+  /* get_batch_size()
+     maximum number of tasks the consumer takes over at once; 0 for all pending tasks. Small
+     batches let urgent tasks overtake sooner.
+  */
+  inline  std::size_t get_batch_size() noexcept {
+          base_type::thread_lock(this);
+          std::size_t l_result = m_batch_max;
+          base_type::thread_unlock(this);
+          return l_result;
+  }
+
+  inline  void  set_batch_size(std::size_t value) noexcept {
+          base_type::thread_lock(this);
+          m_batch_max = value;
+          base_type::thread_unlock(this);
+  }
+
+  /* get_starvation_limit()
+     waiting time, in nanoseconds, after which a task is served ahead of more urgent lanes; 0
+     for strict priorities
+  */
+  inline  std::uint64_t get_starvation_limit() noexcept {
+          base_type::thread_lock(this);
+          std::uint64_t l_result = m_starve_time;
+          base_type::thread_unlock(this);
+          return l_result;
+  }
+
+  inline  void  set_starvation_limit(std::uint64_t value) noexcept {
+          base_type::thread_lock(this);
+          m_starve_time = value;
+          base_type::thread_unlock(this);
+  }
+
+  /* get_pending_count()
+     number of tasks waiting in lane <priority>
+  */
+  inline  std::size_t get_pending_count(std::size_t priority) noexcept {
+          std::size_t l_result = 0;
+          if(priority < LaneCount) {
+              base_type::thread_lock(this);
+              l_result = m_lanes[priority].size;
+              base_type::thread_unlock(this);
+          }
+          return l_result;
+  }
+
+  inline  std::size_t get_pending_count() noexcept {
+          base_type::thread_lock(this);
+          std::size_t l_result = m_pending_count;
+          base_type::thread_unlock(this);
+          return l_result;
+  }
+
+  static constexpr std::size_t get_lane_count() noexcept {
+          return LaneCount;
+  }
+
+  /* get_stats()
+     snapshot of the counters of lane <priority>
+  */
+          lane_stats get_stats(std::size_t priority) const noexcept {
+          lane_stats l_result{};
+          if(priority < LaneCount) {
+              const lane_t& l_lane = m_lanes[priority];
+              l_result.task_count = l_lane.task_count.load(std::memory_order_relaxed);
+              l_result.promote_count = l_lane.promote_count.load(std::memory_order_relaxed);
+              l_result.wait_time = l_lane.wait_time.load(std::memory_order_relaxed);
+              l_result.wait_max = l_lane.wait_max.load(std::memory_order_relaxed);
+          }
+          return l_result;
+  }
+
+  inline  bool  resume() noexcept {
+          return thread_resume(get_delegate(), thread_boot<delegate_type>);
+  }
+
+  inline  bool  suspend() noexcept {
+          return thread_suspend();
+  }
+
+          priority_queue& operator=(const priority_queue&) noexcept = delete;
+          priority_queue& operator=(priority_queue&&) noexcept = delete;
+};
+
+/*namespace parallel*/ }
+#endif
@@ -0,0 +1,340 @@
+#ifndef parallel_queue_metrics_h
+#define parallel_queue_metrics_h
+/**
+    Copyright (c) 2020, wicked systems
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright notice, this list of
+    conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, this list
+    of conditions and the following disclaimer in the documentation and/or other materials
+    provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+    THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+    OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+    HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+    TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**/
+#include <parallel.h>
+#include <atomic>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace parallel {
+
+/* coarse_clock
+   CLOCK_MONOTONIC_COARSE timestamps: a few nanoseconds to read, but only as precise as the
+   kernel tick (typically 1 to 4ms)
+*/
+struct coarse_clock
+{
+  static inline std::uint64_t get_time() noexcept {
+          struct timespec l_time;
+          clock_gettime(CLOCK_MONOTONIC_COARSE, std::addressof(l_time));
+          return l_time.tv_sec * nsps + l_time.tv_nsec;
+  }
+
+  /* get_scale()
+     nanoseconds per time unit, as 32.32 fixed point
+  */
+  static inline std::uint64_t get_scale() noexcept {
+          return std::uint64_t(1) << 32;
+  }
+};
+
+/* tsc_clock
+   time stamp counter timestamps, converted to nanoseconds with a scale calibrated against
+   CLOCK_MONOTONIC on first use; falls back to CLOCK_MONOTONIC where there is no TSC
+*/
+struct tsc_clock
+{
+  static inline std::uint64_t get_time() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+          return __rdtsc();
+#else
+          struct timespec l_time;
+          clock_gettime(CLOCK_MONOTONIC, std::addressof(l_time));
+          return l_time.tv_sec * nsps + l_time.tv_nsec;
+#endif
+  }
+
+  static  std::uint64_t get_scale() noexcept;
+};
+
+/* latency_histogram
+   log-linear (HDR style) histogram of nanosecond values: values below 32 get a bucket each,
+   every power of two above that is split into 32 linear buckets, for a relative error under
+   3.2%; values past 2^40ns (about 18 minutes) are clamped. Recording is a relaxed atomic
+   increment, so any thread can read the histogram while it is being updated.
+*/
+class latency_histogram
+{
+  public:
+  static constexpr unsigned int sub_bits = 5;
+  static constexpr unsigned int sub_count = 1u << sub_bits;
+  static constexpr unsigned int range_bits = 40;
+  static constexpr unsigned int bucket_count = sub_count + (range_bits - sub_bits) * sub_count;
+
+  private:
+  std::atomic<std::uint64_t> m_buckets[bucket_count];
+  std::atomic<std::uint64_t> m_count;
+  std::atomic<std::uint64_t> m_sum;
+  std::atomic<std::uint64_t> m_max;
+
+  private:
+  static inline unsigned int get_index(std::uint64_t value) noexcept {
+          if(value < sub_count) {
+              return value;
+          }
+          if(value >= (std::uint64_t(1) << range_bits)) {
+              return bucket_count - 1;
+          }
+          unsigned int l_msb = 63 - __builtin_clzll(value);
+          unsigned int l_group = l_msb - sub_bits;
+          return sub_count + l_group * sub_count + ((value >> l_group) & (sub_count - 1));
+  }
+
+  /* get_limit()
+     highest value counted in bucket <index>
+  */
+  static inline std::uint64_t get_limit(unsigned int index) noexcept {
+          if(index < sub_count) {
+              return index;
+          }
+          unsigned int l_group = (index - sub_count) / sub_count;
+          unsigned int l_sub = (index - sub_count) % sub_count;
+          return ((std::uint64_t(sub_count + l_sub + 1)) << l_group) - 1;
+  }
+
+  public:
+  inline  latency_histogram() noexcept:
+          m_buckets(),
+          m_count(0),
+          m_sum(0),
+          m_max(0) {
+  }
+
+          latency_histogram(const latency_histogram&) noexcept = delete;
+          latency_histogram(latency_histogram&&) noexcept = delete;
+
+  inline  void  record(std::uint64_t value) noexcept {
+          m_buckets[get_index(value)].fetch_add(1, std::memory_order_relaxed);
+          m_count.fetch_add(1, std::memory_order_relaxed);
+          m_sum.fetch_add(value, std::memory_order_relaxed);
+          if(value > m_max.load(std::memory_order_relaxed)) {
+              m_max.store(value, std::memory_order_relaxed);
+          }
+  }
+
+  /* get_percentile()
+     upper bound of the value below which <percentile> percent of the recorded values fall
+  */
+          std::uint64_t get_percentile(double percentile) const noexcept {
+          std::uint64_t l_total = 0;
+          for(unsigned int l_index = 0; l_index < bucket_count; l_index++) {
+              l_total += m_buckets[l_index].load(std::memory_order_relaxed);
+          }
+          if(l_total) {
+              std::uint64_t l_rank = static_cast<std::uint64_t>(percentile * l_total / 100.0 + 0.5);
+              std::uint64_t l_count = 0;
+              if(l_rank == 0) {
+                  l_rank = 1;
+              }
+              for(unsigned int l_index = 0; l_index < bucket_count; l_index++) {
+                  l_count += m_buckets[l_index].load(std::memory_order_relaxed);
+                  if(l_count >= l_rank) {
+                      return get_limit(l_index);
+                  }
+              }
+          }
+          return 0;
+  }
+
+  inline  std::uint64_t get_count() const noexcept {
+          return m_count.load(std::memory_order_relaxed);
+  }
+
+  inline  std::uint64_t get_mean() const noexcept {
+          std::uint64_t l_count = get_count();
+          if(l_count) {
+              return m_sum.load(std::memory_order_relaxed) / l_count;
+          }
+          return 0;
+  }
+
+  inline  std::uint64_t get_max() const noexcept {
+          return m_max.load(std::memory_order_relaxed);
+  }
+
+  inline  void  reset() noexcept {
+          for(auto& i_bucket: m_buckets) {
+              i_bucket.store(0, std::memory_order_relaxed);
+          }
+          m_count.store(0, std::memory_order_relaxed);
+          m_sum.store(0, std::memory_order_relaxed);
+          m_max.store(0, std::memory_order_relaxed);
+  }
+
+          latency_histogram& operator=(const latency_histogram&) noexcept = delete;
+          latency_histogram& operator=(latency_histogram&&) noexcept = delete;
+};
+
+/* queue_metrics
+   instrumentation policy for parallel::queue (its Mt parameter; none to compile it out)
+   Ct - clock type: coarse_clock or tsc_clock
+
+   Keeps the time tasks spend queued (wait) and executing (service), the queue depth and its
+   high-water mark and the consumer's wake and sleep counts. Producers only touch the depth
+   counters, the rest is written by the consumer; everything is readable from any thread
+   without locking.
+*/
+template<typename Ct = coarse_clock>
+class queue_metrics
+{
+  public:
+  using clock_type = Ct;
+
+  private:
+  std::uint64_t m_scale;
+
+  alignas(global::cache_line_size)
+  std::atomic<std::uint64_t> m_depth;
+  std::atomic<std::uint64_t> m_depth_max;
+  std::atomic<std::uint64_t> m_enqueue_count;
+
+  alignas(global::cache_line_size)
+  std::atomic<std::uint64_t> m_dequeue_count;
+  std::atomic<std::uint64_t> m_wake_count;
+  std::atomic<std::uint64_t> m_sleep_count;
+  latency_histogram          m_wait;
+  latency_histogram          m_service;
+
+  private:
+  inline  std::uint64_t get_ns(std::uint64_t head, std::uint64_t tail) const noexcept {
+          if(tail > head) {
+              return (static_cast<unsigned __int128>(tail - head) * m_scale) >> 32;
+          }
+          return 0;
+  }
+
+  public:
+  inline  queue_metrics() noexcept:
+          m_scale(clock_type::get_scale()),
+          m_depth(0),
+          m_depth_max(0),
+          m_enqueue_count(0),
+          m_dequeue_count(0),
+          m_wake_count(0),
+          m_sleep_count(0),
+          m_wait(),
+          m_service() {
+  }
+
+          queue_metrics(const queue_metrics&) noexcept = delete;
+          queue_metrics(queue_metrics&&) noexcept = delete;
+
+  static inline std::uint64_t get_time() noexcept {
+          return clock_type::get_time();
+  }
+
+  /* enqueue_event()
+     a task has been accepted by the queue
+  */
+  inline  void  enqueue_event() noexcept {
+          std::uint64_t l_depth = m_depth.fetch_add(1, std::memory_order_relaxed) + 1;
+          std::uint64_t l_depth_max = m_depth_max.load(std::memory_order_relaxed);
+          while(l_depth > l_depth_max) {
+              if(m_depth_max.compare_exchange_weak(l_depth_max, l_depth, std::memory_order_relaxed)) {
+                  break;
+              }
+          }
+          m_enqueue_count.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /* discard_event()
+     a task has been taken back before the consumer got to it
+  */
+  inline  void  discard_event() noexcept {
+          m_depth.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  /* dequeue_event()
+     the consumer has taken over a task enqueued at <enqueue_time>, at <time>
+  */
+  inline  void  dequeue_event(std::uint64_t enqueue_time, std::uint64_t time) noexcept {
+          m_depth.fetch_sub(1, std::memory_order_relaxed);
+          m_dequeue_count.fetch_add(1, std::memory_order_relaxed);
+          m_wait.record(get_ns(enqueue_time, time));
+  }
+
+  /* execute_event()
+     a task has executed from <head_time> to <tail_time>
+  */
+  inline  void  execute_event(std::uint64_t head_time, std::uint64_t tail_time) noexcept {
+          m_service.record(get_ns(head_time, tail_time));
+  }
+
+  inline  void  wake_event() noexcept {
+          m_wake_count.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  inline  void  sleep_event() noexcept {
+          m_sleep_count.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  inline  std::uint64_t get_depth() const noexcept {
+          return m_depth.load(std::memory_order_relaxed);
+  }
+
+  inline  std::uint64_t get_depth_max() const noexcept {
+          return m_depth_max.load(std::memory_order_relaxed);
+  }
+
+  inline  void  reset_depth_max() noexcept {
+          m_depth_max.store(m_depth.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+
+  inline  std::uint64_t get_enqueue_count() const noexcept {
+          return m_enqueue_count.load(std::memory_order_relaxed);
+  }
+
+  inline  std::uint64_t get_dequeue_count() const noexcept {
+          return m_dequeue_count.load(std::memory_order_relaxed);
+  }
+
+  inline  std::uint64_t get_wake_count() const noexcept {
+          return m_wake_count.load(std::memory_order_relaxed);
+  }
+
+  inline  std::uint64_t get_sleep_count() const noexcept {
+          return m_sleep_count.load(std::memory_order_relaxed);
+  }
+
+  /* get_wait_histogram()
+     nanoseconds between enqueue and the consumer taking the task over
+  */
+  inline  const latency_histogram& get_wait_histogram() const noexcept {
+          return m_wait;
+  }
+
+  /* get_service_histogram()
+     nanoseconds spent executing a task
+  */
+  inline  const latency_histogram& get_service_histogram() const noexcept {
+          return m_service;
+  }
+
+          queue_metrics& operator=(const queue_metrics&) noexcept = delete;
+          queue_metrics& operator=(queue_metrics&&) noexcept = delete;
+};
+
+/*namespace parallel*/ }
+#endif
@@ -24,14 +24,17 @@
 #include <traits.h>
 #include <none.h>
 #include <vector>
+#include <memory.h>
+#include <memory/fragment.h>
 #include "queue-base.h"
+#include "queue-metrics.h"
 
 namespace parallel {
 
 /* queue
  * flat execution queue with no consumer
 */
-template<typename Xt, typename Ct, typename Vt>
+template<typename Xt, typename Ct, typename Vt, typename Mt>
 class queue: public queue_base<none>, protected Vt
 {
   using base_type = queue_base<none>;
@@ -173,47 +176,104 @@ class queue: public queue_base<none>, protected Vt
 
 /* queue
  * posix consumer queue
+ * producers append to the shared buffer under the lock; the consumer swaps it for its own,
+ * private buffer in a single lock round-trip and then executes the batch without holding the
+ * lock, so that producers are free to grow the shared buffer meanwhile; with a batch_max set,
+ * the swapped buffer is executed batch_max nodes per round-trip, the remainder being carried
+ * over to the next round instead of being moved back and forth
+ * Mt - instrumentation policy (see queue_metrics), none to compile it out; enqueue timestamps
+ * then travel in a buffer parallel to the task buffer
 */
-template<typename Xt, typename Vt>
-class queue<Xt, posix_thread_base, Vt>: public queue_base<posix_thread_base>, protected Vt
+template<typename Xt, typename Vt, typename Mt>
+class queue<Xt, posix_thread_base, Vt, Mt>: public queue_base<posix_thread_base>, protected Vt
 {
   using base_type = queue_base<posix_thread_base>;
   using pool_type = Vt;
   using node_type = typename pool_type::value_type;
   using iter_type = typename pool_type::iterator;
 
+  static constexpr bool has_metrics = std::is_same<Mt, none>::value == false;
+
+  using time_pool_type = typename std::conditional<has_metrics, std::pmr::vector<std::uint64_t>, none>::type;
+
   private:
-  off_t m_live;
-  off_t m_last;
+  pool_type     m_batch;
+  std::size_t   m_batch_read;
+  std::size_t   m_batch_max;
+  bool          m_busy;
+
+  [[no_unique_address]] Mt             m_metrics;
+  [[no_unique_address]] time_pool_type m_time_pool;
+  [[no_unique_address]] time_pool_type m_time_batch;
 
   protected:
   template<typename Ct>
   inline  void* thread_loop(Ct* consumer) noexcept {
-          if(m_live < 0) {
-              if(m_last >= 0) {
-                  pool_type::clear();
+          if(pool_type::empty() &&
+              (m_batch_read == m_batch.size())) {
+              if(m_busy) {
                   if constexpr (base_type::has_sleep_callback<Ct>::value) { 
                       consumer->thread_sleep_event();
                   }
+                  if constexpr (has_metrics) {
+                      m_metrics.sleep_event();
+                  }
+                  m_busy = false;
               }
               thread_wait(this);
-          } else
-          if(m_live >= 0) {
-              if(m_live < (ssize_t)pool_type::size()) {
-                  if(m_last < 0) {
-                      if constexpr (base_type::has_wake_callback<Ct>::value) {
-                          consumer->thread_wake_event();
-                      }
+          } else {
+              if(m_batch_read == m_batch.size()) {
+                  pool_type::swap(m_batch);
+                  if constexpr (has_metrics) {
+                      m_time_pool.swap(m_time_batch);
+                  }
+              }
+              std::size_t l_head = m_batch_read;
+              std::size_t l_tail = m_batch.size();
+              if((m_batch_max != 0) &&
+                  (l_tail - l_head > m_batch_max)) {
+                  l_tail = l_head + m_batch_max;
+              }
+              if(m_busy == false) {
+                  if constexpr (base_type::has_wake_callback<Ct>::value) {
+                      consumer->thread_wake_event();
+                  }
+                  if constexpr (has_metrics) {
+                      m_metrics.wake_event();
                   }
-                  thread_unlock(this);
+                  m_busy = true;
+              }
+              thread_unlock(this);
+              if constexpr (has_metrics) {
+                  std::uint64_t l_time = m_metrics.get_time();
+                  for(std::size_t i_index = l_head; i_index < l_tail; i_index++) {
+                      m_metrics.dequeue_event(m_time_batch[i_index], l_time);
+                  }
+              }
+              for(std::size_t i_index = l_head; i_index < l_tail; i_index++) {
+                  node_type& i_node = m_batch[i_index];
+                  if constexpr (has_metrics) {
+                      std::uint64_t l_head_time = m_metrics.get_time();
+                      if constexpr (base_type::has_execute_delegate<Ct, node_type>::value) {
+                          consumer->queue_execute(i_node);
+                      } else
+                          i_node();
+                      m_metrics.execute_event(l_head_time, m_metrics.get_time());
+                  } else
                   if constexpr (base_type::has_execute_delegate<Ct, node_type>::value) {
-                      consumer->queue_execute(pool_type::at(m_live));
+                      consumer->queue_execute(i_node);
                   } else
-                      pool_type::at(m_live)();
-                  thread_lock(this);
-                  m_last = m_live++;
-              } else
-                  m_live =-1;
+                      i_node();
+              }
+              if(l_tail == m_batch.size()) {
+                  m_batch.clear();
+                  if constexpr (has_metrics) {
+                      m_time_batch.clear();
+                  }
+                  l_tail = 0;
+              }
+              m_batch_read = l_tail;
+              thread_lock(this);
           }
           return nullptr;
   }
@@ -235,14 +295,20 @@ class queue<Xt, posix_thread_base, Vt>: public queue_base<posix_thread_base>, pr
   inline  queue(Args... args) noexcept:
           base_type(std::forward<Args>(args)...),
           pool_type(),
-          m_live(-1),
-          m_last(-1) {
+          m_batch(),
+          m_batch_read(0),
+          m_batch_max(0),
+          m_busy(false),
+          m_metrics(),
+          m_time_pool(),
+          m_time_batch() {
   }
 
           queue(const queue&) noexcept = delete;
           queue(queue&&) noexcept = delete;
 
   virtual ~queue() {
+          base_type::thread_suspend();
   }
 
   /* enqueue()
@@ -250,12 +316,19 @@ class queue<Xt, posix_thread_base, Vt>: public queue_base<posix_thread_base>, pr
   template<typename... Args>
           bool enqueue(Args... args) noexcept {
           if(base_type::is_enabled()) {
+              std::uint64_t l_time = 0;
+              if constexpr (has_metrics) {
+                  l_time = m_metrics.get_time();
+              }
               base_type::thread_lock(this);
               if(pool_type::size() < (size_t)std::numeric_limits<int>::max()) {
                   node_type& l_node = pool_type::emplace_back(std::forward<Args>(args)...);
                   if(queue_accept(l_node)) {
-                      if(m_live < 0) {
-                          m_live = 0;
+                      if constexpr (has_metrics) {
+                          m_time_pool.push_back(l_time);
+                          m_metrics.enqueue_event();
+                      }
+                      if(pool_type::size() == 1) {
                           base_type::thread_wake(this);
                       }
                       base_type::thread_unlock(this);
@@ -269,24 +342,269 @@ class queue<Xt, posix_thread_base, Vt>: public queue_base<posix_thread_base>, pr
   }
 
   /* dequeue()
+     drop the most recently enqueued node, if the consumer has not taken it yet
   */
           bool dequeue() noexcept {
           bool l_result = false;
           base_type::thread_lock(this);
-          node_type& l_node = pool_type::back();
-          l_result = queue_discard(l_node);
-          if(l_result) {
-              if(m_live > -1) {
-                  if(m_live == pool_type::size() - 1) {
-                      m_live =-1;
+          if(pool_type::size()) {
+              node_type& l_node = pool_type::back();
+              l_result = queue_discard(l_node);
+              if(l_result) {
+                  pool_type::pop_back();
+                  if constexpr (has_metrics) {
+                      m_time_pool.pop_back();
+                      m_metrics.discard_event();
                   }
               }
-              pool_type::pop_back();
           }
+          base_type::thread_unlock(this);
+          return l_result;
+  }
+
+  /* get_batch_size()
+     maximum number of nodes the consumer takes over at once; 0 for all pending nodes
+  */
+  inline  std::size_t get_batch_size() noexcept {
           base_type::thread_lock(this);
+          std::size_t l_result = m_batch_max;
+          base_type::thread_unlock(this);
           return l_result;
   }
 
+  inline  void set_batch_size(std::size_t value) noexcept {
+          base_type::thread_lock(this);
+          m_batch_max = value;
+          base_type::thread_unlock(this);
+  }
+
+  /* get_metrics()
+     instrumentation counters, readable from any thread
+  */
+  inline  const Mt& get_metrics() const noexcept {
+          return m_metrics;
+  }
+
+  inline  bool resume() noexcept {
+          return thread_resume(this, thread_boot<queue>);
+  }
+
+  inline  bool suspend() noexcept {
+          return thread_suspend();
+  }
+
+  inline  queue& operator=(const queue& copy) noexcept = delete;
+  inline  queue& operator=(queue&&) noexcept = delete;
+};
+
+/* queue
+ * atomic consumer queue
+ * lock-free multiple producer, single consumer queue: an intrusive linked list (Vyukov) where
+ * producers append with a single atomic exchange and the consumer unlinks without atomic
+ * read-modify-write operations; nodes are allocated from a fragment. Producers never block on
+ * the consumer: a push costs the exchange, and the wake-up at most one more atomic operation.
+ * Mt - instrumentation policy, as for the posix consumer queue; the enqueue timestamp is kept
+ * in the node
+*/
+template<typename Xt, typename Vt, typename Mt>
+class queue<Xt, atomic_thread_base, Vt, Mt>: public queue_base<atomic_thread_base>
+{
+  using base_type = queue_base<atomic_thread_base>;
+  using node_type = typename Vt::value_type;
+
+  static constexpr bool has_metrics = std::is_same<Mt, none>::value == false;
+
+  using time_type = typename std::conditional<has_metrics, std::uint64_t, none>::type;
+
+  struct link_base
+  {
+    std::atomic<link_base*> next;
+  };
+
+  struct link_t: public link_base
+  {
+    node_type value;
+    [[no_unique_address]] time_type time;
+
+    template<typename... Args>
+    inline  link_t(Args&&... args) noexcept:
+            link_base{nullptr},
+            value(std::forward<Args>(args)...),
+            time() {
+    }
+  };
+
+  private:
+  fragment*     m_resource;
+
+  alignas(global::cache_line_size)
+  std::atomic<link_base*> m_head;
+
+  alignas(global::cache_line_size)
+  link_base*    m_tail;
+  link_base     m_stub;
+  bool          m_busy;
+
+  [[no_unique_address]] Mt m_metrics;
+
+  private:
+  inline  void  push(link_base* link) noexcept {
+          link->next.store(nullptr, std::memory_order_relaxed);
+          link_base* l_prev = m_head.exchange(link, std::memory_order_acq_rel);
+          l_prev->next.store(link, std::memory_order_release);
+  }
+
+  /* pop()
+     consumer: unlink the oldest node; may return nullptr while a producer is half way through a
+     push() - the producer's wake-up may already have been folded into an earlier signal, so the
+     caller must check is_linking() before parking
+  */
+  inline  link_t* pop() noexcept {
+          link_base* l_tail = m_tail;
+          link_base* l_next = l_tail->next.load(std::memory_order_acquire);
+          if(l_tail == std::addressof(m_stub)) {
+              if(l_next == nullptr) {
+                  return nullptr;
+              }
+              m_tail = l_next;
+              l_tail = l_next;
+              l_next = l_next->next.load(std::memory_order_acquire);
+          }
+          if(l_next) {
+              m_tail = l_next;
+              return static_cast<link_t*>(l_tail);
+          }
+          if(l_tail != m_head.load(std::memory_order_acquire)) {
+              return nullptr;
+          }
+          push(std::addressof(m_stub));
+          l_next = l_tail->next.load(std::memory_order_acquire);
+          if(l_next) {
+              m_tail = l_next;
+              return static_cast<link_t*>(l_tail);
+          }
+          return nullptr;
+  }
+
+  /* is_linking()
+     consumer: true if a push() has claimed the head but not yet linked its node
+  */
+  inline  bool  is_linking() const noexcept {
+          return (m_tail != std::addressof(m_stub)) ||
+              (m_head.load(std::memory_order_acquire) != m_tail);
+  }
+
+  inline  void  dispose(link_t* link) noexcept {
+          link->~link_t();
+          m_resource->deallocate(link, sizeof(link_t), alignof(link_t));
+  }
+
+  protected:
+  template<typename Ct>
+  inline  void* thread_loop(Ct* consumer) noexcept {
+          link_t* l_link = pop();
+          if(l_link) {
+              if(m_busy == false) {
+                  if constexpr (base_type::has_wake_callback<Ct>::value) {
+                      consumer->thread_wake_event();
+                  }
+                  if constexpr (has_metrics) {
+                      m_metrics.wake_event();
+                  }
+                  m_busy = true;
+              }
+              if constexpr (has_metrics) {
+                  std::uint64_t l_head_time = m_metrics.get_time();
+                  m_metrics.dequeue_event(l_link->time, l_head_time);
+                  if constexpr (base_type::has_execute_delegate<Ct, node_type&>::value) {
+                      consumer->queue_execute(l_link->value);
+                  } else
+                      l_link->value();
+                  m_metrics.execute_event(l_head_time, m_metrics.get_time());
+              } else
+              if constexpr (base_type::has_execute_delegate<Ct, node_type&>::value) {
+                  consumer->queue_execute(l_link->value);
+              } else
+                  l_link->value();
+              dispose(l_link);
+          } else
+          if(is_linking()) {
+              base_type::thread_yield();
+          } else {
+              if(m_busy) {
+                  if constexpr (base_type::has_sleep_callback<Ct>::value) {
+                      consumer->thread_sleep_event();
+                  }
+                  if constexpr (has_metrics) {
+                      m_metrics.sleep_event();
+                  }
+                  m_busy = false;
+              }
+              thread_wait(this);
+          }
+          return nullptr;
+  }
+
+  virtual bool queue_accept(node_type&) noexcept {
+          return true;
+  }
+
+  friend class has_launch_callback<queue>;
+  friend class has_finish_callback<queue>;
+  friend class atomic_thread_base;
+
+  public:
+  template<typename... Args>
+  inline  queue(Args... args) noexcept:
+          base_type(std::forward<Args>(args)...),
+          m_resource(fragment::get_default()),
+          m_head(std::addressof(m_stub)),
+          m_tail(std::addressof(m_stub)),
+          m_stub{nullptr},
+          m_busy(false),
+          m_metrics() {
+  }
+
+          queue(const queue&) noexcept = delete;
+          queue(queue&&) noexcept = delete;
+
+  virtual ~queue() {
+          base_type::thread_suspend();
+          while(link_t* l_link = pop()) {
+              dispose(l_link);
+          }
+  }
+
+  /* enqueue()
+  */
+  template<typename... Args>
+          bool enqueue(Args... args) noexcept {
+          if(base_type::is_enabled()) {
+              void* l_memory = m_resource->allocate(sizeof(link_t), alignof(link_t));
+              if(l_memory) {
+                  link_t* l_link = new(l_memory) link_t(std::forward<Args>(args)...);
+                  if(queue_accept(l_link->value)) {
+                      if constexpr (has_metrics) {
+                          l_link->time = m_metrics.get_time();
+                          m_metrics.enqueue_event();
+                      }
+                      push(l_link);
+                      base_type::thread_wake(this);
+                      return true;
+                  }
+                  dispose(l_link);
+              }
+          }
+          return false;
+  }
+
+  /* get_metrics()
+     instrumentation counters, readable from any thread
+  */
+  inline  const Mt& get_metrics() const noexcept {
+          return m_metrics;
+  }
+
   inline  bool resume() noexcept {
           return thread_resume(this, thread_boot<queue>);
   }
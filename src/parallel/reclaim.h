@@ -0,0 +1,530 @@
+#ifndef parallel_reclaim_h
+#define parallel_reclaim_h
+/**
+    Copyright (c) 2020, wicked systems
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright notice, this list of
+    conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, this list
+    of conditions and the following disclaimer in the documentation and/or other materials
+    provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+    THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+    OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+    HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+    TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**/
+#include <parallel.h>
+#include <memory.h>
+#include <memory/fragment.h>
+#include <atomic>
+#include <cstdint>
+
+namespace parallel {
+
+/* retire_batch
+   block of nodes retired by a single thread and disposed of together: destroyed and handed
+   back to the fragment they came from
+*/
+struct retire_batch
+{
+  static constexpr std::size_t entry_max = 64;
+
+  struct entry_t
+  {
+    void*         m_node;
+    void        (*m_destroy)(void*) noexcept;
+    fragment*     m_resource;
+    std::uint32_t m_size;
+    std::uint32_t m_align;
+  };
+
+  retire_batch* m_next;
+  std::uint64_t m_epoch;
+  std::size_t   m_count;
+  entry_t       m_entries[entry_max];
+
+  public:
+  static  retire_batch* make() noexcept;
+  static  void  release(retire_batch*) noexcept;
+
+  static  void  dispose(entry_t&) noexcept;
+          void  dispose() noexcept;
+};
+
+/* reclaim_domain_base
+   registry of live reclamation domains and per-thread identity
+   Threads get a record in each domain they use; the record is released - its retired nodes
+   flushed or handed over to the domain - when the thread detaches: on finish for threads
+   started through posix_thread_base, at thread exit for any other thread.
+*/
+class reclaim_domain_base
+{
+  reclaim_domain_base*  m_prev;
+  reclaim_domain_base*  m_next;
+  bool                  m_linked;
+
+  protected:
+  struct cache_t
+  {
+    std::uint64_t m_serial;
+    void*         m_record;
+  };
+
+  static constexpr std::size_t cache_size = 4;
+
+  static inline thread_local std::uint64_t s_thread_id;
+  static inline thread_local cache_t       s_cache[cache_size];
+  static inline thread_local unsigned int  s_cache_next;
+
+  std::uint64_t               m_serial;
+  std::atomic<retire_batch*>  m_orphan_head;
+
+  protected:
+  static  std::uint64_t make_thread_id() noexcept;
+
+  static inline std::uint64_t get_thread_id() noexcept {
+          if(s_thread_id == 0) {
+              return make_thread_id();
+          }
+          return s_thread_id;
+  }
+
+  inline  void* get_cached_record() const noexcept {
+          for(auto& i_cache: s_cache) {
+              if(i_cache.m_serial == m_serial) {
+                  return i_cache.m_record;
+              }
+          }
+          return nullptr;
+  }
+
+  inline  void  set_cached_record(void* record) noexcept {
+          s_cache[s_cache_next++ % cache_size] = {m_serial, record};
+  }
+
+          void  set_orphan(retire_batch*) noexcept;
+          retire_batch* get_orphan() noexcept;
+          void  unlink() noexcept;
+
+  virtual void  detach(std::uint64_t) noexcept = 0;
+
+  public:
+          reclaim_domain_base() noexcept;
+          reclaim_domain_base(const reclaim_domain_base&) noexcept = delete;
+          reclaim_domain_base(reclaim_domain_base&&) noexcept = delete;
+  virtual ~reclaim_domain_base();
+
+  /* attach_thread()
+     register the calling thread with the default epoch domain
+  */
+  static  void  attach_thread() noexcept;
+
+  /* detach_thread()
+     release the records of the calling thread in all domains
+  */
+  static  void  detach_thread() noexcept;
+
+          reclaim_domain_base& operator=(const reclaim_domain_base&) noexcept = delete;
+          reclaim_domain_base& operator=(reclaim_domain_base&&) noexcept = delete;
+};
+
+/* reclaim_domain
+   per-thread record management: records are claimed on first use by a thread, go back to the
+   domain once it detaches and are reused by threads coming later; they are only freed along
+   with the domain
+*/
+template<typename Rt>
+class reclaim_domain: public reclaim_domain_base
+{
+  protected:
+  std::atomic<Rt*>          m_record_head;
+  std::atomic<std::size_t>  m_record_count;
+
+  protected:
+  virtual void  release_record(Rt*) noexcept = 0;
+
+  Rt*   make_record() noexcept {
+          std::uint64_t l_thread_id = get_thread_id();
+          Rt*           l_record = m_record_head.load(std::memory_order_acquire);
+          // a record still owned by this thread, but evicted from the cache
+          while(l_record) {
+              if(l_record->m_owner.load(std::memory_order_relaxed) == l_thread_id) {
+                  return l_record;
+              }
+              l_record = l_record->m_next;
+          }
+          l_record = m_record_head.load(std::memory_order_acquire);
+          while(l_record) {
+              std::uint64_t l_owner = 0;
+              if(l_record->m_owner.compare_exchange_strong(l_owner, l_thread_id, std::memory_order_acquire)) {
+                  return l_record;
+              }
+              l_record = l_record->m_next;
+          }
+          void* l_data = fragment::get_default()->allocate(sizeof(Rt), alignof(Rt));
+          if(l_data == nullptr) {
+              return nullptr;
+          }
+          l_record = new(l_data) Rt();
+          l_record->m_owner.store(l_thread_id, std::memory_order_relaxed);
+          l_record->m_next = m_record_head.load(std::memory_order_relaxed);
+          while(m_record_head.compare_exchange_weak(l_record->m_next, l_record, std::memory_order_release, std::memory_order_relaxed) == false) {
+          }
+          m_record_count.fetch_add(1, std::memory_order_relaxed);
+          return l_record;
+  }
+
+  inline  Rt*   get_record() noexcept {
+          Rt* l_record = static_cast<Rt*>(get_cached_record());
+          if(l_record == nullptr) {
+              l_record = make_record();
+              if(l_record) {
+                  set_cached_record(l_record);
+              }
+          }
+          return l_record;
+  }
+
+  virtual void  detach(std::uint64_t thread_id) noexcept override {
+          Rt* l_record = m_record_head.load(std::memory_order_acquire);
+          while(l_record) {
+              if(l_record->m_owner.load(std::memory_order_relaxed) == thread_id) {
+                  release_record(l_record);
+                  l_record->m_owner.store(0, std::memory_order_release);
+              }
+              l_record = l_record->m_next;
+          }
+  }
+
+  /* dispose()
+     free all records, along with whatever they still hold; the domain must be idle
+  */
+  inline  void  dispose() noexcept {
+          Rt* l_record = m_record_head.exchange(nullptr, std::memory_order_acquire);
+          while(l_record) {
+              Rt* l_next = l_record->m_next;
+              l_record->dispose();
+              l_record->~Rt();
+              fragment::get_default()->deallocate(l_record, sizeof(Rt), alignof(Rt));
+              l_record = l_next;
+          }
+          retire_batch* l_orphan = get_orphan();
+          while(l_orphan) {
+              retire_batch* l_next = l_orphan->m_next;
+              l_orphan->dispose();
+              retire_batch::release(l_orphan);
+              l_orphan = l_next;
+          }
+          m_record_count.store(0, std::memory_order_relaxed);
+  }
+
+  public:
+  inline  reclaim_domain() noexcept:
+          reclaim_domain_base(),
+          m_record_head(nullptr),
+          m_record_count(0) {
+  }
+
+  inline  ~reclaim_domain() {
+  }
+
+  /* attach()
+     claim a record for the calling thread ahead of its first use
+  */
+  inline  bool  attach() noexcept {
+          return get_record();
+  }
+
+  /* get_thread_count()
+     number of records, i.e. the highest number of threads using the domain at once
+  */
+  inline  std::size_t get_thread_count() const noexcept {
+          return m_record_count.load(std::memory_order_relaxed);
+  }
+};
+
+/* epoch_record
+   per-thread state in an epoch_domain
+*/
+struct epoch_record
+{
+  alignas(global::cache_line_size)
+  std::atomic<std::uint64_t>  m_epoch;
+  std::atomic<std::uint64_t>  m_owner;
+  epoch_record*   m_next;
+  unsigned int    m_nest;
+  retire_batch*   m_batch;
+  retire_batch*   m_pending_head;
+  retire_batch*   m_pending_tail;
+
+  public:
+  inline  epoch_record() noexcept:
+          m_epoch(0),
+          m_owner(0),
+          m_next(nullptr),
+          m_nest(0),
+          m_batch(nullptr),
+          m_pending_head(nullptr),
+          m_pending_tail(nullptr) {
+  }
+
+          void  dispose() noexcept;
+};
+
+/* epoch_domain
+   epoch-based reclamation
+   Readers bracket their accesses to shared nodes with enter() and leave(), which publish the
+   global epoch observed on entry in the thread's record. A node unlinked from a shared
+   structure is passed to retire(); retired nodes collect in a per-thread batch, stamped with
+   the global epoch once it fills up, and the batch is disposed of once the global epoch has
+   moved two steps past the stamp, at which point no thread can still be inside the critical
+   section it was reachable from. The global epoch only advances once all threads inside a
+   critical section have observed its current value.
+   The read side costs a single fenced store into a thread-private cache line; retirement is
+   amortised over the batch.
+*/
+class epoch_domain: public reclaim_domain<epoch_record>
+{
+  alignas(global::cache_line_size)
+  std::atomic<std::uint64_t>  m_epoch;
+
+  private:
+          void  seal(epoch_record*) noexcept;
+          void  collect(epoch_record*) noexcept;
+          void  retire(const retire_batch::entry_t&) noexcept;
+
+  protected:
+  virtual void  release_record(epoch_record*) noexcept override;
+
+  public:
+          epoch_domain() noexcept;
+          epoch_domain(const epoch_domain&) noexcept = delete;
+          epoch_domain(epoch_domain&&) noexcept = delete;
+          ~epoch_domain();
+
+  /* enter()
+     enter a critical section; sections nest
+  */
+  inline  bool  enter() noexcept {
+          epoch_record* l_record = get_record();
+          if(l_record) {
+              if(l_record->m_nest++ == 0) {
+                  l_record->m_epoch.store((m_epoch.load(std::memory_order_relaxed) << 1) | 1u, std::memory_order_relaxed);
+                  std::atomic_thread_fence(std::memory_order_seq_cst);
+              }
+              return true;
+          }
+          return false;
+  }
+
+  /* leave()
+     leave a critical section
+  */
+  inline  void  leave() noexcept {
+          epoch_record* l_record = get_record();
+          if(l_record) {
+              if(--l_record->m_nest == 0) {
+                  l_record->m_epoch.store(0, std::memory_order_release);
+              }
+          }
+  }
+
+  /* retire()
+     dispose of <node> once no thread can hold a reference to it anymore: destroy it and return
+     it to <resource>
+  */
+  template<typename Xt>
+  inline  void  retire(Xt* node, fragment* resource = fragment::get_default()) noexcept {
+          retire({node, [](void* p) noexcept { static_cast<Xt*>(p)->~Xt(); }, resource, sizeof(Xt), alignof(Xt)});
+  }
+
+  /* retire()
+     return raw memory to <resource> once no thread can hold a reference to it anymore
+  */
+  inline  void  retire(void* node, std::size_t size, std::size_t align, fragment* resource) noexcept {
+          retire({node, nullptr, resource, static_cast<std::uint32_t>(size), static_cast<std::uint32_t>(align)});
+  }
+
+  /* try_advance()
+     move the global epoch on, if all threads inside a critical section have observed it
+  */
+          bool  try_advance() noexcept;
+
+  /* collect()
+     try to advance the epoch and dispose of what the calling thread retired, as far as safe
+  */
+          void  collect() noexcept;
+
+  /* synchronize()
+     wait for the epoch to move on twice and dispose of everything the calling thread retired;
+     fails if called from within a critical section
+  */
+          bool  synchronize() noexcept;
+
+  inline  std::uint64_t get_epoch() const noexcept {
+          return m_epoch.load(std::memory_order_relaxed);
+  }
+
+  /* get_pending_count()
+     number of nodes retired by the calling thread and not yet disposed of
+  */
+          std::size_t get_pending_count() noexcept;
+
+  static  epoch_domain& get_default() noexcept;
+
+          epoch_domain& operator=(const epoch_domain&) noexcept = delete;
+          epoch_domain& operator=(epoch_domain&&) noexcept = delete;
+};
+
+/* epoch_guard
+   scoped epoch_domain critical section
+*/
+class epoch_guard
+{
+  epoch_domain& m_domain;
+
+  public:
+  inline  epoch_guard(epoch_domain& domain = epoch_domain::get_default()) noexcept:
+          m_domain(domain) {
+          m_domain.enter();
+  }
+
+          epoch_guard(const epoch_guard&) noexcept = delete;
+          epoch_guard(epoch_guard&&) noexcept = delete;
+
+  inline  ~epoch_guard() {
+          m_domain.leave();
+  }
+
+          epoch_guard& operator=(const epoch_guard&) noexcept = delete;
+          epoch_guard& operator=(epoch_guard&&) noexcept = delete;
+};
+
+/* hazard_record
+   per-thread state in a hazard_domain
+*/
+struct hazard_record
+{
+  static constexpr std::size_t hazard_max = 4;
+
+  alignas(global::cache_line_size)
+  std::atomic<void*>          m_hazards[hazard_max];
+  std::atomic<std::uint64_t>  m_owner;
+  hazard_record*  m_next;
+  retire_batch*   m_batch;
+  retire_batch*   m_pending_head;
+  std::size_t     m_pending_count;
+
+  public:
+  inline  hazard_record() noexcept:
+          m_hazards(),
+          m_owner(0),
+          m_next(nullptr),
+          m_batch(nullptr),
+          m_pending_head(nullptr),
+          m_pending_count(0) {
+          for(auto& i_hazard: m_hazards) {
+              i_hazard.store(nullptr, std::memory_order_relaxed);
+          }
+  }
+
+          void  dispose() noexcept;
+};
+
+/* hazard_domain
+   hazard pointer reclamation
+   Each thread publishes the nodes it is about to dereference in one of its hazard_max slots;
+   retired nodes are batched per thread and, once enough of them pile up, checked against the
+   set of published pointers: those not found are disposed of, the rest stay for the next scan.
+   Unlike epochs, a stalled thread can only hold back the few nodes it protects, at the cost
+   of a fence per protected load.
+*/
+class hazard_domain: public reclaim_domain<hazard_record>
+{
+  private:
+          void  scan(hazard_record*) noexcept;
+          void  retire(const retire_batch::entry_t&) noexcept;
+
+  protected:
+  virtual void  release_record(hazard_record*) noexcept override;
+
+  public:
+  static constexpr std::size_t hazard_max = hazard_record::hazard_max;
+
+  public:
+          hazard_domain() noexcept;
+          hazard_domain(const hazard_domain&) noexcept = delete;
+          hazard_domain(hazard_domain&&) noexcept = delete;
+          ~hazard_domain();
+
+  /* protect()
+     load <source> and publish it in hazard slot <index>, repeating until the published value
+     is still current; the node is then safe to use until the slot is cleared or reused
+  */
+  template<typename Xt>
+  inline  Xt*   protect(std::size_t index, const std::atomic<Xt*>& source) noexcept {
+          hazard_record* l_record = get_record();
+          Xt*            l_value = source.load(std::memory_order_relaxed);
+          if(l_record) {
+              while(true) {
+                  l_record->m_hazards[index].store(l_value, std::memory_order_relaxed);
+                  std::atomic_thread_fence(std::memory_order_seq_cst);
+                  Xt* l_check = source.load(std::memory_order_acquire);
+                  if(l_check == l_value) {
+                      break;
+                  }
+                  l_value = l_check;
+              }
+              return l_value;
+          }
+          return nullptr;
+  }
+
+  inline  void  clear(std::size_t index) noexcept {
+          hazard_record* l_record = get_record();
+          if(l_record) {
+              l_record->m_hazards[index].store(nullptr, std::memory_order_release);
+          }
+  }
+
+  inline  void  clear() noexcept {
+          hazard_record* l_record = get_record();
+          if(l_record) {
+              for(auto& i_hazard: l_record->m_hazards) {
+                  i_hazard.store(nullptr, std::memory_order_release);
+              }
+          }
+  }
+
+  template<typename Xt>
+  inline  void  retire(Xt* node, fragment* resource = fragment::get_default()) noexcept {
+          retire({node, [](void* p) noexcept { static_cast<Xt*>(p)->~Xt(); }, resource, sizeof(Xt), alignof(Xt)});
+  }
+
+  inline  void  retire(void* node, std::size_t size, std::size_t align, fragment* resource) noexcept {
+          retire({node, nullptr, resource, static_cast<std::uint32_t>(size), static_cast<std::uint32_t>(align)});
+  }
+
+  /* collect()
+     dispose of what the calling thread retired and no thread protects
+  */
+          void  collect() noexcept;
+
+          std::size_t get_pending_count() noexcept;
+
+  static  hazard_domain& get_default() noexcept;
+
+          hazard_domain& operator=(const hazard_domain&) noexcept = delete;
+          hazard_domain& operator=(hazard_domain&&) noexcept = delete;
+};
+
+/*namespace parallel*/ }
+#endif
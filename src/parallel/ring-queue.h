@@ -0,0 +1,263 @@
+#ifndef parallel_ring_queue_h
+#define parallel_ring_queue_h
+/**
+    Copyright (c) 2020, wicked systems
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright notice, this list of
+    conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, this list
+    of conditions and the following disclaimer in the documentation and/or other materials
+    provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+    THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+    OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+    HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+    TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**/
+#include <parallel.h>
+#include <memory.h>
+#include <memory/fragment.h>
+#include <memory/mpmc_ring.h>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <span>
+#include <utility>
+
+namespace parallel {
+
+/* ring_queue
+   bounded multi-producer, multi-consumer queue of <Xt>: the lock-free memory::mpmc_ring holds
+   the items, and blocking is layered on top with a pair of futex event counts, one per
+   direction. Threads register before sleeping and the other side only bumps the count and
+   wakes them up when somebody is registered, keeping the non-blocking paths free of system
+   calls. Items left over are destroyed with the ring.
+*/
+template<typename Xt>
+class ring_queue
+{
+  memory::mpmc_ring<Xt>       m_ring;
+
+  alignas(global::cache_line_size)
+  std::atomic<std::uint32_t>  m_data_event;
+  std::atomic<std::uint32_t>  m_data_wait_count;
+  alignas(global::cache_line_size)
+  std::atomic<std::uint32_t>  m_space_event;
+  std::atomic<std::uint32_t>  m_space_wait_count;
+  std::atomic<bool>           m_closed;
+
+  private:
+  static inline void notify(std::atomic<std::uint32_t>& event, std::atomic<std::uint32_t>& wait_count, int count) noexcept {
+          std::atomic_thread_fence(std::memory_order_seq_cst);
+          if(wait_count.load(std::memory_order_relaxed)) {
+              event.fetch_add(1, std::memory_order_seq_cst);
+              futex_wake(std::addressof(event), count);
+          }
+  }
+
+  template<typename Pt, typename Ft>
+  static inline void wait(std::atomic<std::uint32_t>& event, std::atomic<std::uint32_t>& wait_count, Pt&& ready, Ft&& stop) noexcept {
+          std::uint32_t l_event = event.load(std::memory_order_seq_cst);
+          wait_count.fetch_add(1, std::memory_order_seq_cst);
+          std::atomic_thread_fence(std::memory_order_seq_cst);
+          if((ready() == false) &&
+              (stop() == false)) {
+              futex_wait(std::addressof(event), l_event);
+          }
+          wait_count.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  public:
+  /* ring_queue()
+     a queue holding up to <capacity> items, rounded up to a power of two
+  */
+  inline  ring_queue(std::size_t capacity, fragment* resource = fragment::get_default()) noexcept:
+          m_ring(resource, capacity),
+          m_data_event(0),
+          m_data_wait_count(0),
+          m_space_event(0),
+          m_space_wait_count(0),
+          m_closed(false) {
+  }
+
+          ring_queue(const ring_queue&) noexcept = delete;
+          ring_queue(ring_queue&&) noexcept = delete;
+
+  /* try_push()
+     construct an item at the back from <args>; fails if the queue is full or closed
+  */
+  template<typename... Args>
+  inline  bool  try_push(Args&&... args) noexcept {
+          if(m_closed.load(std::memory_order_relaxed) == false) {
+              return m_ring.push(std::forward<Args>(args)...);
+          }
+          return false;
+  }
+
+  /* try_pop()
+     move the item at the front into <value>; fails if the queue is empty
+  */
+  inline  bool  try_pop(Xt& value) noexcept {
+          return m_ring.pop(value);
+  }
+
+  /* push()
+     move as many of the <count> items at <items> in as there is room for, waking up consumers
+     once for the lot; returns the number of items pushed
+  */
+  inline  std::size_t push(Xt* items, std::size_t count) noexcept {
+          std::size_t l_count = 0;
+          if(m_closed.load(std::memory_order_relaxed) == false) {
+              while(l_count < count) {
+                  std::size_t l_push_count = m_ring.push(std::span<Xt>(items + l_count, count - l_count));
+                  if(l_push_count == 0) {
+                      break;
+                  }
+                  l_count += l_push_count;
+              }
+          }
+          if(l_count) {
+              notify(m_data_event, m_data_wait_count, static_cast<int>(l_count));
+          }
+          return l_count;
+  }
+
+  /* push()
+     move <value> in, waiting for room if needed; fails if the queue is closed
+  */
+  inline  bool  push(Xt&& value) noexcept {
+          while(true) {
+              if(try_push(std::move(value))) {
+                  notify(m_data_event, m_data_wait_count, 1);
+                  return true;
+              }
+              if(is_closed()) {
+                  return false;
+              }
+              wait_for_space([]() noexcept { return false; });
+          }
+  }
+
+  /* pop()
+     move up to <count> items out into <items>, waking up blocked producers once for the lot;
+     returns the number of items popped
+  */
+  inline  std::size_t pop(Xt* items, std::size_t count) noexcept {
+          std::size_t l_count = 0;
+          while(l_count < count) {
+              std::size_t l_pop_count = m_ring.pop(std::span<Xt>(items + l_count, count - l_count));
+              if(l_pop_count == 0) {
+                  break;
+              }
+              l_count += l_pop_count;
+          }
+          if(l_count) {
+              notify(m_space_event, m_space_wait_count, static_cast<int>(l_count));
+          }
+          return l_count;
+  }
+
+  /* pop()
+     move the front item into <value>, waiting for one if needed; fails once the queue is closed
+     and empty
+  */
+  inline  bool  pop(Xt& value) noexcept {
+          while(true) {
+              if(try_pop(value)) {
+                  notify(m_space_event, m_space_wait_count, 1);
+                  return true;
+              }
+              if(is_closed()) {
+                  return false;
+              }
+              wait_for_data([]() noexcept { return false; });
+          }
+  }
+
+  /* wait_for_data()
+     block until the queue may have items, it is closed, interrupt() is called or <stop>
+     returns true
+  */
+  template<typename Ft>
+  inline  void  wait_for_data(Ft&& stop) noexcept {
+          wait(
+              m_data_event,
+              m_data_wait_count,
+              [this]() noexcept { return (is_empty() == false) || is_closed(); },
+              std::forward<Ft>(stop)
+          );
+  }
+
+  /* wait_for_space()
+     block until the queue may have room, it is closed, interrupt() is called or <stop>
+     returns true
+  */
+  template<typename Ft>
+  inline  void  wait_for_space(Ft&& stop) noexcept {
+          wait(
+              m_space_event,
+              m_space_wait_count,
+              [this]() noexcept { return (is_full() == false) || is_closed(); },
+              std::forward<Ft>(stop)
+          );
+  }
+
+  /* interrupt()
+     wake up all blocked threads, so that they reevaluate their stop condition
+  */
+  inline  void  interrupt() noexcept {
+          m_data_event.fetch_add(1, std::memory_order_seq_cst);
+          futex_wake(std::addressof(m_data_event), std::numeric_limits<int>::max());
+          m_space_event.fetch_add(1, std::memory_order_seq_cst);
+          futex_wake(std::addressof(m_space_event), std::numeric_limits<int>::max());
+  }
+
+  /* close()
+     refuse further items; consumers drain what is left
+  */
+  inline  void  close() noexcept {
+          m_closed.store(true, std::memory_order_seq_cst);
+          interrupt();
+  }
+
+  inline  void  open() noexcept {
+          m_closed.store(false, std::memory_order_seq_cst);
+  }
+
+  inline  bool  is_closed() const noexcept {
+          return m_closed.load(std::memory_order_seq_cst);
+  }
+
+  inline  bool  is_empty() const noexcept {
+          return m_ring.is_empty();
+  }
+
+  inline  bool  is_full() const noexcept {
+          return m_ring.get_size() >= m_ring.get_capacity();
+  }
+
+  inline  std::size_t get_size() const noexcept {
+          return m_ring.get_size();
+  }
+
+  inline  std::size_t get_capacity() const noexcept {
+          return m_ring.get_capacity();
+  }
+
+  inline  operator bool() const noexcept {
+          return m_ring;
+  }
+
+          ring_queue& operator=(const ring_queue&) noexcept = delete;
+          ring_queue& operator=(ring_queue&&) noexcept = delete;
+};
+
+/*namespace parallel*/ }
+#endif
@@ -0,0 +1,305 @@
+#ifndef parallel_sync_h
+#define parallel_sync_h
+/**
+    Copyright (c) 2020, wicked systems
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright notice, this list of
+    conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, this list
+    of conditions and the following disclaimer in the documentation and/or other materials
+    provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+    THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+    OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+    HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+    TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**/
+#include <parallel.h>
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <unistd.h>
+
+namespace parallel {
+
+/* cache_aligned
+   a value padded out to its own cache line(s), so that values updated by different threads -
+   per-thread counters, say - don't share lines
+*/
+template<typename Xt>
+class alignas(global::cache_line_size) cache_aligned
+{
+  Xt    m_value;
+
+  public:
+  template<typename... Args>
+  inline  cache_aligned(Args&&... args) noexcept:
+          m_value(std::forward<Args>(args)...) {
+  }
+
+  inline  Xt&   get() noexcept {
+          return m_value;
+  }
+
+  inline  const Xt& get() const noexcept {
+          return m_value;
+  }
+
+  inline  Xt&   operator*() noexcept {
+          return m_value;
+  }
+
+  inline  const Xt& operator*() const noexcept {
+          return m_value;
+  }
+
+  inline  Xt*   operator->() noexcept {
+          return std::addressof(m_value);
+  }
+
+  inline  const Xt* operator->() const noexcept {
+          return std::addressof(m_value);
+  }
+};
+
+/* latch
+   single use countdown: wait() blocks until count_down() has taken the count to zero
+   The high bit of the word flags sleeping waiters, so that the last count_down() only enters
+   the kernel when someone is actually blocked.
+*/
+class latch
+{
+  static constexpr std::uint32_t waiting_bit = 0x80000000u;
+  static constexpr std::uint32_t count_mask = waiting_bit - 1u;
+
+  std::atomic<std::uint32_t>  m_state;
+
+  public:
+  inline  latch(std::uint32_t count) noexcept:
+          m_state(count & count_mask) {
+  }
+
+          latch(const latch&) noexcept = delete;
+          latch(latch&&) noexcept = delete;
+
+  inline  void  count_down(std::uint32_t count = 1) noexcept {
+          std::uint32_t l_prev = m_state.fetch_sub(count, std::memory_order_acq_rel);
+          if((l_prev & count_mask) == count) {
+              if(l_prev & waiting_bit) {
+                  futex_wake(std::addressof(m_state), std::numeric_limits<int>::max());
+              }
+          }
+  }
+
+  inline  bool  try_wait() const noexcept {
+          return (m_state.load(std::memory_order_acquire) & count_mask) == 0;
+  }
+
+  inline  void  wait() noexcept {
+          std::uint32_t l_state = m_state.load(std::memory_order_acquire);
+          while(l_state & count_mask) {
+              if((l_state & waiting_bit) == 0) {
+                  if(m_state.compare_exchange_weak(l_state, l_state | waiting_bit, std::memory_order_acquire) == false) {
+                      continue;
+                  }
+                  l_state |= waiting_bit;
+              }
+              futex_wait(std::addressof(m_state), l_state);
+              l_state = m_state.load(std::memory_order_acquire);
+          }
+  }
+
+  inline  void  arrive_and_wait(std::uint32_t count = 1) noexcept {
+          count_down(count);
+          wait();
+  }
+
+          latch& operator=(const latch&) noexcept = delete;
+          latch& operator=(latch&&) noexcept = delete;
+};
+
+/* barrier
+   reusable rendezvous point for a fixed number of threads
+   Threads block on a phase word, bumped by the last thread to arrive; waiters spin for a short
+   while before parking (unless there is only one cpu to spin on), and the last arrival only
+   wakes them up if any of them parked.
+*/
+class barrier
+{
+  static constexpr int  spin_max = 64;
+
+  std::uint32_t m_count;
+  int           m_spin_max;
+  alignas(global::cache_line_size)
+  std::atomic<std::uint32_t>  m_arrive_count;
+  std::atomic<std::uint32_t>  m_sleep_count;
+  alignas(global::cache_line_size)
+  std::atomic<std::uint32_t>  m_phase;
+
+  public:
+  inline  barrier(std::uint32_t count) noexcept:
+          m_count(count),
+          m_spin_max(sysconf(_SC_NPROCESSORS_ONLN) > 1 ? spin_max : 0),
+          m_arrive_count(0),
+          m_sleep_count(0),
+          m_phase(0) {
+  }
+
+          barrier(const barrier&) noexcept = delete;
+          barrier(barrier&&) noexcept = delete;
+
+  /* arrive_and_wait()
+     block until all threads arrived; returns true on exactly one of them per phase
+  */
+  inline  bool  arrive_and_wait() noexcept {
+          std::uint32_t l_phase = m_phase.load(std::memory_order_acquire);
+          if(m_arrive_count.fetch_add(1, std::memory_order_acq_rel) + 1 == m_count) {
+              m_arrive_count.store(0, std::memory_order_relaxed);
+              m_phase.fetch_add(1, std::memory_order_seq_cst);
+              if(m_sleep_count.load(std::memory_order_seq_cst)) {
+                  futex_wake(std::addressof(m_phase), std::numeric_limits<int>::max());
+              }
+              return true;
+          }
+          for(int l_spin = 0; l_spin < m_spin_max; l_spin++) {
+              if(m_phase.load(std::memory_order_acquire) != l_phase) {
+                  return false;
+              }
+              cpu_relax();
+          }
+          m_sleep_count.fetch_add(1, std::memory_order_seq_cst);
+          while(m_phase.load(std::memory_order_seq_cst) == l_phase) {
+              futex_wait(std::addressof(m_phase), l_phase);
+          }
+          m_sleep_count.fetch_sub(1, std::memory_order_relaxed);
+          return false;
+  }
+
+  inline  std::uint32_t get_count() const noexcept {
+          return m_count;
+  }
+
+  inline  std::uint32_t get_phase() const noexcept {
+          return m_phase.load(std::memory_order_acquire);
+  }
+
+          barrier& operator=(const barrier&) noexcept = delete;
+          barrier& operator=(barrier&&) noexcept = delete;
+};
+
+/* seqlock
+   read-mostly snapshot of a trivially copyable <Xt>
+   Writers take the sequence odd for the duration of the update, readers retry until they
+   copied the value out between two equal, even reads of the sequence; readers never write to
+   shared memory. The value is kept as an array of atomic words so that the racy copies are
+   well defined.
+*/
+template<typename Xt>
+class seqlock
+{
+  static_assert(std::is_trivially_copyable<Xt>::value, "seqlock value must be trivially copyable");
+
+  static constexpr std::size_t word_count = (sizeof(Xt) + sizeof(std::uintptr_t) - 1) / sizeof(std::uintptr_t);
+
+  alignas(global::cache_line_size)
+  std::atomic<std::uint32_t>  m_sequence;
+  std::atomic<std::uintptr_t> m_data[word_count];
+
+  private:
+  inline  void  copy_in(const Xt& value) noexcept {
+          std::uintptr_t l_data[word_count] = {};
+          std::memcpy(l_data, std::addressof(value), sizeof(Xt));
+          for(std::size_t l_index = 0; l_index < word_count; l_index++) {
+              m_data[l_index].store(l_data[l_index], std::memory_order_relaxed);
+          }
+  }
+
+  public:
+  inline  seqlock(const Xt& value = Xt()) noexcept:
+          m_sequence(0) {
+          copy_in(value);
+  }
+
+          seqlock(const seqlock&) noexcept = delete;
+          seqlock(seqlock&&) noexcept = delete;
+
+  /* load()
+     a consistent copy of the value
+  */
+  inline  Xt    load() const noexcept {
+          Xt             l_value;
+          std::uintptr_t l_data[word_count];
+          std::uint32_t  l_sequence;
+          while(true) {
+              l_sequence = m_sequence.load(std::memory_order_acquire);
+              if(l_sequence & 1u) {
+                  cpu_relax();
+                  continue;
+              }
+              for(std::size_t l_index = 0; l_index < word_count; l_index++) {
+                  l_data[l_index] = m_data[l_index].load(std::memory_order_relaxed);
+              }
+              std::atomic_thread_fence(std::memory_order_acquire);
+              if(m_sequence.load(std::memory_order_relaxed) == l_sequence) {
+                  break;
+              }
+          }
+          std::memcpy(std::addressof(l_value), l_data, sizeof(Xt));
+          return l_value;
+  }
+
+  /* store()
+     replace the value; concurrent writers are serialised
+  */
+  inline  void  store(const Xt& value) noexcept {
+          update([&value](Xt& current) noexcept { current = value; });
+  }
+
+  /* update()
+     modify the value in place through fn(Xt&), under the write side of the lock
+  */
+  template<typename Fn>
+  inline  void  update(Fn&& fn) noexcept {
+          std::uint32_t l_sequence = m_sequence.load(std::memory_order_relaxed);
+          while(true) {
+              if((l_sequence & 1u) == 0) {
+                  if(m_sequence.compare_exchange_weak(l_sequence, l_sequence + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                      break;
+                  }
+              } else {
+                  cpu_relax();
+                  l_sequence = m_sequence.load(std::memory_order_relaxed);
+              }
+          }
+          std::atomic_thread_fence(std::memory_order_release);
+          Xt             l_value;
+          std::uintptr_t l_data[word_count];
+          for(std::size_t l_index = 0; l_index < word_count; l_index++) {
+              l_data[l_index] = m_data[l_index].load(std::memory_order_relaxed);
+          }
+          std::memcpy(std::addressof(l_value), l_data, sizeof(Xt));
+          fn(l_value);
+          copy_in(l_value);
+          m_sequence.store(l_sequence + 2, std::memory_order_release);
+  }
+
+  inline  std::uint32_t get_sequence() const noexcept {
+          return m_sequence.load(std::memory_order_acquire);
+  }
+
+          seqlock& operator=(const seqlock&) noexcept = delete;
+          seqlock& operator=(seqlock&&) noexcept = delete;
+};
+
+/*namespace parallel*/ }
+#endif
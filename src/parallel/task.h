@@ -0,0 +1,415 @@
+#ifndef parallel_task_h
+#define parallel_task_h
+/**
+    Copyright (c) 2020, wicked systems
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright notice, this list of
+    conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, this list
+    of conditions and the following disclaimer in the documentation and/or other materials
+    provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+    THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+    OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+    HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+    TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**/
+#include <parallel.h>
+#include <memory.h>
+#include <memory/fragment.h>
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <sched.h>
+
+namespace parallel {
+
+template<typename Xt>
+class task;
+
+/* task_promise_base
+   part of the task promise independent of the result type: frame allocation, continuation and
+   completion state
+*/
+class task_promise_base
+{
+  static constexpr std::size_t frame_align = alignof(std::max_align_t);
+
+  public:
+  static constexpr unsigned int state_running = 0;
+  static constexpr unsigned int state_notify = 1;
+  static constexpr unsigned int state_ready = 2;
+
+  protected:
+  std::coroutine_handle<>   m_continuation;
+  std::atomic<unsigned int> m_state;
+
+  protected:
+  /* final_awaiter
+     on completion, transfer control to the awaiting coroutine, if any; otherwise wake up a
+     thread blocked in task::wait(). The frame may be destroyed as soon as m_state reads
+     state_ready, so that is the last access to it.
+  */
+  struct final_awaiter
+  {
+    inline  bool  await_ready() const noexcept {
+            return false;
+    }
+
+    template<typename Pt>
+    inline  std::coroutine_handle<> await_suspend(std::coroutine_handle<Pt> handle) noexcept {
+            task_promise_base&      l_promise = handle.promise();
+            std::coroutine_handle<> l_continuation = l_promise.m_continuation;
+            if(l_continuation) {
+                l_promise.m_state.store(state_ready, std::memory_order_release);
+                return l_continuation;
+            }
+            l_promise.m_state.store(state_notify, std::memory_order_release);
+            l_promise.m_state.notify_all();
+            l_promise.m_state.store(state_ready, std::memory_order_release);
+            return std::noop_coroutine();
+    }
+
+    inline  void  await_resume() const noexcept {
+    }
+  };
+
+  /* get_frame()
+     allocate a coroutine frame of <size> bytes from <resource>; the resource is stored past the
+     end of the frame, for operator delete
+  */
+  static  void* get_frame(std::size_t size, fragment* resource) noexcept {
+          if(resource) {
+              std::size_t l_size = global::get_round_value(size, frame_align);
+              void* l_frame = resource->allocate(l_size + frame_align, frame_align);
+              if(l_frame) {
+                  *reinterpret_cast<fragment**>(reinterpret_cast<char*>(l_frame) + l_size) = resource;
+                  return l_frame;
+              }
+          }
+          return nullptr;
+  }
+
+  public:
+  inline  task_promise_base() noexcept:
+          m_continuation(nullptr),
+          m_state(state_running) {
+  }
+
+  static  void* operator new(std::size_t size) noexcept {
+          return get_frame(size, fragment::get_default());
+  }
+
+  /* operator new()
+     frames of coroutines taking (std::allocator_arg, fragment*, ...) as their first parameters
+     are allocated from that fragment
+  */
+  template<typename... Args>
+  static  void* operator new(std::size_t size, std::allocator_arg_t, fragment* resource, Args&&...) noexcept {
+          return get_frame(size, resource);
+  }
+
+  static  void  operator delete(void* frame, std::size_t size) noexcept {
+          std::size_t l_size = global::get_round_value(size, frame_align);
+          fragment*   l_resource = *reinterpret_cast<fragment**>(reinterpret_cast<char*>(frame) + l_size);
+          l_resource->deallocate(frame, l_size + frame_align, frame_align);
+  }
+
+  inline  std::suspend_always initial_suspend() const noexcept {
+          return {};
+  }
+
+  inline  final_awaiter final_suspend() const noexcept {
+          return {};
+  }
+
+  inline  void  unhandled_exception() const noexcept {
+          std::terminate();
+  }
+
+  inline  void  set_continuation(std::coroutine_handle<> continuation) noexcept {
+          m_continuation = continuation;
+  }
+
+  inline  bool  is_ready() const noexcept {
+          return m_state.load(std::memory_order_acquire) == state_ready;
+  }
+
+  /* wait()
+     block until the coroutine has completed
+  */
+  inline  void  wait() const noexcept {
+          unsigned int l_state = m_state.load(std::memory_order_acquire);
+          while(l_state != state_ready) {
+              if(l_state == state_running) {
+                  m_state.wait(state_running, std::memory_order_acquire);
+              } else
+                  sched_yield();
+              l_state = m_state.load(std::memory_order_acquire);
+          }
+  }
+};
+
+/* task_promise
+*/
+template<typename Xt>
+class task_promise: public task_promise_base
+{
+  std::optional<Xt> m_value;
+
+  public:
+  inline  task<Xt> get_return_object() noexcept;
+
+  static  task<Xt> get_return_object_on_allocation_failure() noexcept;
+
+  template<typename Vt>
+  inline  void  return_value(Vt&& value) noexcept {
+          m_value.emplace(std::forward<Vt>(value));
+  }
+
+  inline  Xt&   get_value() noexcept {
+          return *m_value;
+  }
+};
+
+template<>
+class task_promise<void>: public task_promise_base
+{
+  public:
+  inline  task<void> get_return_object() noexcept;
+
+  static  task<void> get_return_object_on_allocation_failure() noexcept;
+
+  inline  void  return_void() const noexcept {
+  }
+
+  inline  void  get_value() const noexcept {
+  }
+};
+
+/* task
+   lazily started coroutine returning <Xt>
+   The coroutine frame is allocated from the default fragment, or from the fragment passed as
+   the second argument of coroutines declared as fn(std::allocator_arg_t, fragment*, ...). A
+   task starts when awaited from another coroutine (which then resumes once the task completes)
+   or when start() is called; in the latter case the owner can block on wait() from any thread.
+   A task that failed to allocate its frame is null and considered ready.
+*/
+template<typename Xt>
+class task
+{
+  public:
+  using promise_type = task_promise<Xt>;
+  using handle_type  = std::coroutine_handle<promise_type>;
+
+  private:
+  handle_type   m_handle;
+
+  private:
+  struct awaiter
+  {
+    handle_type m_handle;
+
+    inline  bool  await_ready() const noexcept {
+            return !m_handle || m_handle.done();
+    }
+
+    inline  std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept {
+            m_handle.promise().set_continuation(continuation);
+            return m_handle;
+    }
+
+    inline  decltype(auto) await_resume() noexcept {
+            if constexpr (std::is_void<Xt>::value) {
+                return;
+            } else
+                return std::move(m_handle.promise().get_value());
+    }
+  };
+
+  public:
+  inline  task() noexcept:
+          m_handle(nullptr) {
+  }
+
+  inline  explicit task(handle_type handle) noexcept:
+          m_handle(handle) {
+  }
+
+          task(const task&) noexcept = delete;
+
+  inline  task(task&& copy) noexcept:
+          m_handle(copy.m_handle) {
+          copy.m_handle = nullptr;
+  }
+
+  inline  ~task() {
+          if(m_handle) {
+              m_handle.destroy();
+          }
+  }
+
+  /* start()
+     run the coroutine up to its first suspension point, on the calling thread
+  */
+  inline  void  start() noexcept {
+          if(m_handle) {
+              m_handle.resume();
+          }
+  }
+
+  /* wait()
+     block until a started task has completed
+  */
+  inline  void  wait() const noexcept {
+          if(m_handle) {
+              m_handle.promise().wait();
+          }
+  }
+
+  inline  bool  is_ready() const noexcept {
+          if(m_handle) {
+              return m_handle.promise().is_ready();
+          }
+          return true;
+  }
+
+  /* get_value()
+     result of a completed task
+  */
+  inline  decltype(auto) get_value() noexcept {
+          return m_handle.promise().get_value();
+  }
+
+  inline  awaiter operator co_await() && noexcept {
+          return awaiter{m_handle};
+  }
+
+  inline  awaiter operator co_await() & noexcept {
+          return awaiter{m_handle};
+  }
+
+  inline  operator bool() const noexcept {
+          return static_cast<bool>(m_handle);
+  }
+
+          task& operator=(const task&) noexcept = delete;
+
+  inline  task& operator=(task&& rhs) noexcept {
+          if(this != std::addressof(rhs)) {
+              if(m_handle) {
+                  m_handle.destroy();
+              }
+              m_handle = rhs.m_handle;
+              rhs.m_handle = nullptr;
+          }
+          return *this;
+  }
+};
+
+template<typename Xt>
+inline  task<Xt> task_promise<Xt>::get_return_object() noexcept
+{
+        return task<Xt>(task<Xt>::handle_type::from_promise(*this));
+}
+
+template<typename Xt>
+inline  task<Xt> task_promise<Xt>::get_return_object_on_allocation_failure() noexcept
+{
+        return task<Xt>();
+}
+
+inline  task<void> task_promise<void>::get_return_object() noexcept
+{
+        return task<void>(task<void>::handle_type::from_promise(*this));
+}
+
+inline  task<void> task_promise<void>::get_return_object_on_allocation_failure() noexcept
+{
+        return task<void>();
+}
+
+/* resume_on_awaiter
+*/
+template<typename Qt>
+class resume_on_awaiter
+{
+  Qt*   m_queue;
+
+  public:
+  inline  resume_on_awaiter(Qt& queue) noexcept:
+          m_queue(std::addressof(queue)) {
+  }
+
+  inline  bool  await_ready() const noexcept {
+          return false;
+  }
+
+  inline  bool  await_suspend(std::coroutine_handle<> handle) noexcept {
+          return m_queue->enqueue(handle);
+  }
+
+  inline  void  await_resume() const noexcept {
+  }
+};
+
+/* resume_on()
+   co_await resume_on(queue) suspends the coroutine and enqueues its handle onto <queue> (any of
+   the parallel queues or executors whose tasks can be constructed from, and invoked as, a
+   std::coroutine_handle<>); the coroutine continues on the consumer thread. If the queue
+   rejects the handle, the coroutine simply continues on the current thread.
+*/
+template<typename Qt>
+inline  resume_on_awaiter<Qt> resume_on(Qt& queue) noexcept
+{
+        return resume_on_awaiter<Qt>(queue);
+}
+
+/* resume_after_awaiter
+*/
+template<typename Wt>
+class resume_after_awaiter
+{
+  Wt*           m_wheel;
+  std::uint64_t m_delay;
+
+  public:
+  inline  resume_after_awaiter(Wt& wheel, std::uint64_t delay) noexcept:
+          m_wheel(std::addressof(wheel)),
+          m_delay(delay) {
+  }
+
+  inline  bool  await_ready() const noexcept {
+          return false;
+  }
+
+  inline  bool  await_suspend(std::coroutine_handle<> handle) noexcept {
+          return m_wheel->insert(m_delay, handle);
+  }
+
+  inline  void  await_resume() const noexcept {
+  }
+};
+
+/* resume_after()
+   co_await resume_after(wheel, delay) suspends the coroutine until <delay> ticks of the timer
+   wheel have passed; it is then resumed by the consumer of the wheel's target queue. Since the
+   wheel is not thread safe, this is only to be awaited on the thread owning the wheel.
+*/
+template<typename Wt>
+inline  resume_after_awaiter<Wt> resume_after(Wt& wheel, std::uint64_t delay) noexcept
+{
+        return resume_after_awaiter<Wt>(wheel, delay);
+}
+
+/*namespace parallel*/ }
+#endif
@@ -0,0 +1,421 @@
+#ifndef parallel_timer_wheel_h
+#define parallel_timer_wheel_h
+/**
+    Copyright (c) 2020, wicked systems
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright notice, this list of
+    conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, this list
+    of conditions and the following disclaimer in the documentation and/or other materials
+    provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+    THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+    OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+    HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+    TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**/
+#include <parallel.h>
+#include <memory.h>
+#include <memory/fragment.h>
+#include <limits>
+#include <time.h>
+
+namespace parallel {
+
+/* timer_id
+   handle of a scheduled timer; stays safe to cancel after the timer has expired or its node
+   has been reused
+*/
+struct timer_id
+{
+  void*         m_node;
+  std::uint32_t m_sequence;
+
+  inline  operator bool() const noexcept {
+          return m_node;
+  }
+};
+
+/* timer_wheel
+   hierarchical timing wheel
+   Xt - callback type, handed over to the target queue on expiry
+   Qt - target queue type: any of the parallel queues, or any type with an enqueue(Xt&&) method
+
+   Time is measured in ticks of a fixed resolution. The wheel has four levels of 256 slots
+   each; level N holds the timers due within 256^(N + 1) ticks, placed by bits [8N, 8N + 8) of
+   their expiry tick. Insertion and cancellation are O(1) list operations on a slot; when the
+   lowest level wraps around, the matching slot of the level above is cascaded down. advance()
+   skips runs of empty slots using a per level occupancy bitmap, and expires a whole slot at a
+   time, enqueueing its callbacks onto the target queue. Timer nodes are recycled through a free
+   list, their blocks are allocated from <resource> and only released with the wheel.
+   The wheel itself is not thread safe: it is meant to be owned (inserted into and advanced) by
+   a single thread, e.g. an event loop, while the callbacks execute on the queue's consumers.
+*/
+template<typename Xt, typename Qt>
+class timer_wheel
+{
+  static constexpr unsigned int  level_count = 4;
+  static constexpr unsigned int  slot_bits = 8;
+  static constexpr unsigned int  slot_count = 1u << slot_bits;
+  static constexpr unsigned int  slot_mask = slot_count - 1;
+  static constexpr std::size_t   block_size = 256;
+
+  struct timer_t
+  {
+    timer_t*      prev;
+    timer_t*      next;
+    std::uint64_t expiry;
+    std::uint64_t period;
+    std::uint32_t sequence;
+    std::uint16_t level;
+    std::uint16_t slot;
+    bool          armed;
+    alignas(Xt) unsigned char value[sizeof(Xt)];
+
+    inline  Xt&   get_value() noexcept {
+            return *std::launder(reinterpret_cast<Xt*>(value));
+    }
+  };
+
+  struct block_t
+  {
+    block_t*      next;
+    timer_t       timers[block_size];
+  };
+
+  Qt*           m_target;
+  fragment*     m_resource;
+  std::uint64_t m_resolution;
+  std::uint64_t m_tick;
+  std::size_t   m_timer_count;
+  block_t*      m_blocks;
+  timer_t*      m_free;
+  timer_t*      m_slots[level_count][slot_count];
+  std::uint64_t m_bits[level_count][slot_count / 64];
+
+  private:
+  static inline std::uint64_t get_time() noexcept {
+          timespec l_time;
+          clock_gettime(CLOCK_MONOTONIC, std::addressof(l_time));
+          return l_time.tv_sec * static_cast<std::uint64_t>(nsps) + l_time.tv_nsec;
+  }
+
+  /* get_timer()
+     take a node off the free list, allocating a new block if needed
+  */
+  inline  timer_t* get_timer() noexcept {
+          if(m_free == nullptr) {
+              if(m_resource == nullptr) {
+                  return nullptr;
+              }
+              block_t* l_block = reinterpret_cast<block_t*>(m_resource->allocate(sizeof(block_t), alignof(block_t)));
+              if(l_block == nullptr) {
+                  return nullptr;
+              }
+              l_block->next = m_blocks;
+              m_blocks = l_block;
+              for(std::size_t l_index = 0; l_index < block_size; l_index++) {
+                  timer_t* l_timer = l_block->timers + l_index;
+                  l_timer->next = m_free;
+                  l_timer->sequence = 0;
+                  l_timer->armed = false;
+                  m_free = l_timer;
+              }
+          }
+          timer_t* l_timer = m_free;
+          m_free = l_timer->next;
+          return l_timer;
+  }
+
+  /* release()
+     destroy the callback of a timer and put its node back on the free list; bumping the
+     sequence invalidates any outstanding timer_id
+  */
+  inline  void  release(timer_t* timer) noexcept {
+          timer->get_value().~Xt();
+          timer->sequence++;
+          timer->armed = false;
+          timer->next = m_free;
+          m_free = timer;
+          m_timer_count--;
+  }
+
+  /* link()
+     place a timer into the slot matching its expiry, relative to the current tick
+  */
+  inline  void  link(timer_t* timer) noexcept {
+          std::uint64_t l_expiry = timer->expiry;
+          if(l_expiry < m_tick) {
+              l_expiry = m_tick;
+          }
+          std::uint64_t l_delta = l_expiry - m_tick;
+          unsigned int  l_level = 0;
+          while(l_delta >= (std::uint64_t(1) << (slot_bits * (l_level + 1)))) {
+              if(l_level == level_count - 1) {
+                  // beyond the range of the wheel: park in the farthest slot, the timer will be
+                  // placed again when that slot is cascaded
+                  l_expiry = m_tick + (std::uint64_t(1) << (slot_bits * level_count)) - 1;
+                  break;
+              }
+              l_level++;
+          }
+          unsigned int  l_slot = (l_expiry >> (slot_bits * l_level)) & slot_mask;
+          timer_t*&     l_head = m_slots[l_level][l_slot];
+          timer->prev = nullptr;
+          timer->next = l_head;
+          timer->level = l_level;
+          timer->slot = l_slot;
+          if(l_head) {
+              l_head->prev = timer;
+          }
+          l_head = timer;
+          m_bits[l_level][l_slot / 64] |= std::uint64_t(1) << (l_slot % 64);
+  }
+
+  /* unlink()
+  */
+  inline  void  unlink(timer_t* timer) noexcept {
+          if(timer->next) {
+              timer->next->prev = timer->prev;
+          }
+          if(timer->prev) {
+              timer->prev->next = timer->next;
+          } else {
+              m_slots[timer->level][timer->slot] = timer->next;
+              if(timer->next == nullptr) {
+                  m_bits[timer->level][timer->slot / 64] &= ~(std::uint64_t(1) << (timer->slot % 64));
+              }
+          }
+  }
+
+  /* get_next_slot()
+     index of the first occupied slot of level 0 at or after <slot>, or slot_count if none
+  */
+  inline  unsigned int get_next_slot(unsigned int slot) const noexcept {
+          unsigned int  l_word = slot / 64;
+          std::uint64_t l_bits = m_bits[0][l_word] & (~std::uint64_t(0) << (slot % 64));
+          while(l_bits == 0) {
+              if(++l_word == slot_count / 64) {
+                  return slot_count;
+              }
+              l_bits = m_bits[0][l_word];
+          }
+          return l_word * 64 + __builtin_ctzll(l_bits);
+  }
+
+  /* cascade()
+     redistribute the timers of the level <level> slot reached by the current tick
+  */
+  inline  void  cascade(unsigned int level) noexcept {
+          unsigned int l_slot = (m_tick >> (slot_bits * level)) & slot_mask;
+          timer_t*     l_timer = m_slots[level][l_slot];
+          m_slots[level][l_slot] = nullptr;
+          m_bits[level][l_slot / 64] &= ~(std::uint64_t(1) << (l_slot % 64));
+          while(l_timer) {
+              timer_t* l_next = l_timer->next;
+              link(l_timer);
+              l_timer = l_next;
+          }
+          if((l_slot == 0) &&
+              (level < level_count - 1)) {
+              cascade(level + 1);
+          }
+  }
+
+  /* expire()
+     hand over the callbacks of all timers in the level 0 slot of tick <tick>; periodic timers
+     are rearmed
+  */
+  template<typename Fn>
+  inline  std::size_t expire(std::uint64_t tick, Fn& fn) noexcept {
+          std::size_t   l_count = 0;
+          unsigned int  l_slot = tick & slot_mask;
+          while(timer_t* l_timer = m_slots[0][l_slot]) {
+              // the timer is settled (rearmed or released) before <fn> runs, so that <fn> may
+              // insert or cancel timers, including this one
+              unlink(l_timer);
+              if(l_timer->period) {
+                  Xt l_value(static_cast<const Xt&>(l_timer->get_value()));
+                  l_timer->expiry = tick + l_timer->period;
+                  link(l_timer);
+                  fn(std::move(l_value));
+              } else {
+                  Xt l_value(std::move(l_timer->get_value()));
+                  release(l_timer);
+                  fn(std::move(l_value));
+              }
+              l_count++;
+          }
+          return l_count;
+  }
+
+  public:
+  /* timer_wheel()
+     create a wheel delivering expired callbacks to <target>, with a tick of <resolution>
+     nanoseconds
+  */
+  inline  timer_wheel(Qt* target, std::uint64_t resolution = nspms, fragment* resource = fragment::get_default()) noexcept:
+          m_target(target),
+          m_resource(resource),
+          m_resolution(resolution ? resolution : 1),
+          m_tick(get_time() / m_resolution),
+          m_timer_count(0),
+          m_blocks(nullptr),
+          m_free(nullptr),
+          m_slots(),
+          m_bits() {
+  }
+
+          timer_wheel(const timer_wheel&) noexcept = delete;
+          timer_wheel(timer_wheel&&) noexcept = delete;
+
+  inline  ~timer_wheel() {
+          for(unsigned int l_level = 0; l_level < level_count; l_level++) {
+              for(unsigned int l_slot = 0; l_slot < slot_count; l_slot++) {
+                  while(timer_t* l_timer = m_slots[l_level][l_slot]) {
+                      unlink(l_timer);
+                      release(l_timer);
+                  }
+              }
+          }
+          while(m_blocks) {
+              block_t* l_block = m_blocks;
+              m_blocks = l_block->next;
+              m_resource->deallocate(l_block, sizeof(block_t), alignof(block_t));
+          }
+  }
+
+  /* insert()
+     schedule a callback constructed from <args> to expire <delay> ticks after the current
+     tick; returns a null id on allocation failure
+  */
+  template<typename... Args>
+  inline  timer_id insert(std::uint64_t delay, Args&&... args) noexcept {
+          return insert_periodic(delay, 0, std::forward<Args>(args)...);
+  }
+
+  /* insert_periodic()
+     schedule a callback to expire after <delay> ticks and every <period> ticks after that,
+     until cancelled; the callback is copied into the target queue on every expiry
+  */
+  template<typename... Args>
+  inline  timer_id insert_periodic(std::uint64_t delay, std::uint64_t period, Args&&... args) noexcept {
+          timer_t* l_timer = get_timer();
+          if(l_timer) {
+              new(l_timer->value) Xt(std::forward<Args>(args)...);
+              l_timer->expiry = m_tick + delay;
+              l_timer->period = period;
+              l_timer->armed = true;
+              link(l_timer);
+              m_timer_count++;
+              return {l_timer, l_timer->sequence};
+          }
+          return {nullptr, 0};
+  }
+
+  /* cancel()
+     remove a timer before it expires; returns false if it has already expired or been
+     cancelled
+  */
+  inline  bool  cancel(const timer_id& id) noexcept {
+          timer_t* l_timer = reinterpret_cast<timer_t*>(id.m_node);
+          if(l_timer &&
+              l_timer->armed &&
+              (l_timer->sequence == id.m_sequence)) {
+              unlink(l_timer);
+              release(l_timer);
+              return true;
+          }
+          return false;
+  }
+
+  /* advance()
+     move the wheel forward up to (and including) tick <tick>, passing the callback of every
+     expired timer to <fn>; returns the number of expired timers
+  */
+  template<typename Fn>
+          std::size_t advance(std::uint64_t tick, Fn&& fn) noexcept {
+          std::size_t l_count = 0;
+          while(m_tick <= tick) {
+              // jump over empty slots, but never past the next level 0 wrap-around, where the
+              // upper levels need to be cascaded
+              std::uint64_t l_base = m_tick & ~std::uint64_t(slot_mask);
+              unsigned int  l_slot = get_next_slot(m_tick & slot_mask);
+              std::uint64_t l_next = l_base + l_slot;
+              if(l_next > tick) {
+                  m_tick = tick + 1;
+                  if((m_tick & slot_mask) == 0) {
+                      cascade(1);
+                  }
+                  break;
+              }
+              if(l_slot == slot_count) {
+                  m_tick = l_next;
+                  cascade(1);
+                  continue;
+              }
+              // inserts made while the slot is being processed are relative to the next tick
+              m_tick = l_next + 1;
+              l_count += expire(l_next, fn);
+              if((m_tick & slot_mask) == 0) {
+                  cascade(1);
+              }
+          }
+          return l_count;
+  }
+
+  /* advance()
+     move the wheel forward up to tick <tick>, enqueueing the expired callbacks onto the target
+     queue
+  */
+  inline  std::size_t advance(std::uint64_t tick) noexcept {
+          return advance(tick, [this](auto&& value) { m_target->enqueue(std::forward<decltype(value)>(value)); });
+  }
+
+  /* advance()
+     move the wheel forward up to the current time
+  */
+  inline  std::size_t advance() noexcept {
+          return advance(get_time() / m_resolution);
+  }
+
+  /* get_next_delay()
+     number of ticks from the current one until advance() may have any work to do: a lower
+     bound of the time until the next expiry, suitable as a sleep timeout
+  */
+  inline  std::uint64_t get_next_delay() const noexcept {
+          if(m_timer_count == 0) {
+              return std::numeric_limits<std::uint64_t>::max();
+          }
+          unsigned int l_slot = get_next_slot(m_tick & slot_mask);
+          return l_slot - (m_tick & slot_mask);
+  }
+
+  /* get_tick()
+     next tick to be processed
+  */
+  inline  std::uint64_t get_tick() const noexcept {
+          return m_tick;
+  }
+
+  inline  std::uint64_t get_resolution() const noexcept {
+          return m_resolution;
+  }
+
+  inline  std::size_t get_timer_count() const noexcept {
+          return m_timer_count;
+  }
+
+          timer_wheel& operator=(const timer_wheel&) noexcept = delete;
+          timer_wheel& operator=(timer_wheel&&) noexcept = delete;
+};
+
+/*namespace parallel*/ }
+#endif
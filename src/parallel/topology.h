@@ -0,0 +1,133 @@
+#ifndef parallel_topology_h
+#define parallel_topology_h
+/**
+    Copyright (c) 2020, wicked systems
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright notice, this list of
+    conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, this list
+    of conditions and the following disclaimer in the documentation and/or other materials
+    provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+    THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+    OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+    HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+    TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**/
+#include <parallel.h>
+#include <memory.h>
+#include <memory/fragment.h>
+
+namespace parallel {
+
+/* placement_policy
+   how a set of worker threads is spread over the machine
+*/
+enum placement_policy
+{
+  place_none,           // leave threads to the scheduler
+  place_compact,        // fill cores, SMT siblings included, one cache and node after another
+  place_scatter,        // spread over nodes and last level caches first, SMT siblings last
+  place_physical_core,  // one thread per physical core before any SMT sibling is used
+  place_same_llc        // only cpus sharing the last level cache with the producer
+};
+
+/* cpu_info
+   position of a logical cpu in the machine; all indices are dense, except for <node> which is
+   the system's NUMA node number
+*/
+struct cpu_info
+{
+  int   cpu;        // logical cpu number
+  int   thread;     // index among the SMT siblings of the core
+  int   core;       // physical core
+  int   core_rank;  // index of the core within its last level cache domain
+  int   llc;        // last level cache domain
+  int   llc_rank;   // index of the cache domain within its node
+  int   package;    // physical package
+  int   node;       // NUMA node
+};
+
+/* topology
+   logical cpus, SMT siblings, last level cache domains and NUMA nodes, as found under
+   /sys/devices/system/cpu; information missing there is filled in conservatively (a core per
+   cpu, a single cache domain and node)
+*/
+class topology
+{
+  fragment*     m_resource;
+  cpu_info*     m_cpus;
+  int           m_cpu_count;
+  int           m_core_count;
+  int           m_llc_count;
+  int           m_package_count;
+  int           m_node_count;
+
+  private:
+          void  reset() noexcept;
+
+  public:
+          topology(fragment* = fragment::get_default()) noexcept;
+          topology(const topology&) noexcept = delete;
+          topology(topology&&) noexcept = delete;
+          ~topology();
+
+  /* load()
+     discover the online cpus from the sysfs cpu directory at <path>
+  */
+          bool  load(const char* path = "/sys/devices/system/cpu") noexcept;
+
+  /* get_cpu_info()
+     information about logical cpu <cpu>, nullptr if not online
+  */
+          const cpu_info* get_cpu_info(int cpu) const noexcept;
+
+  /* get_placement()
+     fill <cpus> with the cpus for <count> threads under <policy>, wrapping around if there are
+     more threads than cpus eligible; <producer> is the cpu place_same_llc refers to (the
+     calling thread's cpu if negative). Returns the number of cpus written, 0 for place_none.
+  */
+          std::size_t get_placement(placement_policy policy, std::size_t count, int* cpus, int producer = -1) const noexcept;
+
+  inline  const cpu_info* get_cpu(int index) const noexcept {
+          return (index >= 0) && (index < m_cpu_count) ? m_cpus + index : nullptr;
+  }
+
+  inline  int   get_cpu_count() const noexcept {
+          return m_cpu_count;
+  }
+
+  inline  int   get_core_count() const noexcept {
+          return m_core_count;
+  }
+
+  inline  int   get_llc_count() const noexcept {
+          return m_llc_count;
+  }
+
+  inline  int   get_package_count() const noexcept {
+          return m_package_count;
+  }
+
+  inline  int   get_node_count() const noexcept {
+          return m_node_count;
+  }
+
+  /* get_default()
+     topology of the running machine, discovered on first use
+  */
+  static  const topology& get_default() noexcept;
+
+          topology& operator=(const topology&) noexcept = delete;
+          topology& operator=(topology&&) noexcept = delete;
+};
+
+/*namespace parallel*/ }
+#endif
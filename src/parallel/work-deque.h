@@ -0,0 +1,214 @@
+#ifndef parallel_work_deque_h
+#define parallel_work_deque_h
+/**
+    Copyright (c) 2020, wicked systems
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+    1. Redistributions of source code must retain the above copyright notice, this list of
+    conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice, this list
+    of conditions and the following disclaimer in the documentation and/or other materials
+    provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+    EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+    THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+    OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+    HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+    TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**/
+#include <global.h>
+#include <memory.h>
+#include <memory/fragment.h>
+#include <atomic>
+#include <bit>
+#include <type_traits>
+
+namespace parallel {
+
+/* work_deque
+   Chase-Lev work stealing deque: the owning thread push()-es and pop()-s at the bottom end,
+   any other thread may steal() from the top end
+   Xt - element type; must be trivially copyable (typically a pointer to the task)
+
+   The ring grows on demand; retired rings are kept on a list until the deque is destroyed,
+   since a concurrent thief may still be reading from them.
+*/
+template<typename Xt>
+class work_deque
+{
+  static_assert(std::is_trivially_copyable<Xt>::value, "work_deque requires a trivially copyable element type");
+
+  struct ring_t
+  {
+    ring_t*           prev;
+    std::int64_t      mask;
+    std::atomic<Xt>   data[1];
+
+    inline  Xt    get(std::int64_t index) const noexcept {
+            return data[index & mask].load(std::memory_order_acquire);
+    }
+
+    inline  void  put(std::int64_t index, Xt value) noexcept {
+            data[index & mask].store(value, std::memory_order_release);
+    }
+
+    static constexpr std::size_t get_alloc_size(std::size_t capacity) noexcept {
+            return global::get_round_value(
+                sizeof(ring_t) + (capacity - 1u) * sizeof(std::atomic<Xt>),
+                global::cache_line_size
+            );
+    }
+  };
+
+  fragment*     m_resource;
+
+  alignas(global::cache_line_size)
+  std::atomic<std::int64_t>   m_top;
+
+  alignas(global::cache_line_size)
+  std::atomic<std::int64_t>   m_bottom;
+  std::atomic<ring_t*>        m_ring;
+
+  private:
+          ring_t* make_ring(std::size_t capacity, ring_t* prev) noexcept {
+          ring_t* l_ring = reinterpret_cast<ring_t*>(m_resource->allocate(ring_t::get_alloc_size(capacity), global::cache_line_size));
+          if(l_ring) {
+              l_ring->prev = prev;
+              l_ring->mask = capacity - 1u;
+              for(std::size_t l_index = 0; l_index < capacity; l_index++) {
+                  new(l_ring->data + l_index) std::atomic<Xt>();
+              }
+          }
+          return l_ring;
+  }
+
+  /* grow()
+     owner: double the ring, copying the live range [top, bottom)
+  */
+          ring_t* grow(ring_t* ring, std::int64_t top, std::int64_t bottom) noexcept {
+          ring_t* l_ring = make_ring((ring->mask + 1) * 2, ring);
+          if(l_ring) {
+              for(std::int64_t l_index = top; l_index < bottom; l_index++) {
+                  l_ring->put(l_index, ring->get(l_index));
+              }
+              m_ring.store(l_ring, std::memory_order_release);
+          }
+          return l_ring;
+  }
+
+  public:
+  inline  work_deque(fragment* resource = fragment::get_default(), std::size_t capacity = 256u) noexcept:
+          m_resource(resource),
+          m_top(0),
+          m_bottom(0),
+          m_ring(nullptr) {
+          if(m_resource) {
+              m_ring.store(make_ring(std::bit_ceil(capacity | 1u), nullptr), std::memory_order_relaxed);
+          }
+  }
+
+          work_deque(const work_deque&) noexcept = delete;
+          work_deque(work_deque&&) noexcept = delete;
+
+  inline  ~work_deque() {
+          ring_t* l_ring = m_ring.load(std::memory_order_relaxed);
+          while(l_ring) {
+              ring_t* l_prev = l_ring->prev;
+              m_resource->deallocate(l_ring, ring_t::get_alloc_size(l_ring->mask + 1), global::cache_line_size);
+              l_ring = l_prev;
+          }
+  }
+
+  /* push()
+     owner: add an element at the bottom; fails only if the ring needs to grow and there is no
+     memory left
+  */
+  inline  bool  push(Xt value) noexcept {
+          std::int64_t l_bottom = m_bottom.load(std::memory_order_relaxed);
+          std::int64_t l_top = m_top.load(std::memory_order_acquire);
+          ring_t*      l_ring = m_ring.load(std::memory_order_relaxed);
+          if(l_ring == nullptr) {
+              return false;
+          }
+          if(l_bottom - l_top > l_ring->mask) {
+              l_ring = grow(l_ring, l_top, l_bottom);
+              if(l_ring == nullptr) {
+                  return false;
+              }
+          }
+          l_ring->put(l_bottom, value);
+          std::atomic_thread_fence(std::memory_order_release);
+          m_bottom.store(l_bottom + 1, std::memory_order_relaxed);
+          return true;
+  }
+
+  /* pop()
+     owner: take the most recently pushed element
+  */
+  inline  bool  pop(Xt& value) noexcept {
+          std::int64_t l_bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+          ring_t*      l_ring = m_ring.load(std::memory_order_relaxed);
+          m_bottom.store(l_bottom, std::memory_order_relaxed);
+          std::atomic_thread_fence(std::memory_order_seq_cst);
+          std::int64_t l_top = m_top.load(std::memory_order_relaxed);
+          if(l_top <= l_bottom) {
+              value = l_ring->get(l_bottom);
+              if(l_top == l_bottom) {
+                  // last element: race against thieves for it
+                  bool l_result = m_top.compare_exchange_strong(l_top, l_top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+                  m_bottom.store(l_bottom + 1, std::memory_order_relaxed);
+                  return l_result;
+              }
+              return true;
+          }
+          m_bottom.store(l_bottom + 1, std::memory_order_relaxed);
+          return false;
+  }
+
+  /* steal()
+     any thread: take the oldest element; may fail spuriously when racing with another thief
+     or with the owner
+  */
+  inline  bool  steal(Xt& value) noexcept {
+          std::int64_t l_top = m_top.load(std::memory_order_acquire);
+          std::atomic_thread_fence(std::memory_order_seq_cst);
+          std::int64_t l_bottom = m_bottom.load(std::memory_order_acquire);
+          if(l_top < l_bottom) {
+              ring_t* l_ring = m_ring.load(std::memory_order_acquire);
+              value = l_ring->get(l_top);
+              return m_top.compare_exchange_strong(l_top, l_top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+          }
+          return false;
+  }
+
+  /* get_size()
+     approximate number of elements
+  */
+  inline  std::size_t get_size() const noexcept {
+          std::int64_t l_bottom = m_bottom.load(std::memory_order_relaxed);
+          std::int64_t l_top = m_top.load(std::memory_order_relaxed);
+          if(l_bottom > l_top) {
+              return l_bottom - l_top;
+          }
+          return 0;
+  }
+
+  inline  bool  is_empty() const noexcept {
+          return get_size() == 0;
+  }
+
+  inline  operator bool() const noexcept {
+          return m_ring.load(std::memory_order_relaxed);
+  }
+
+          work_deque& operator=(const work_deque&) noexcept = delete;
+          work_deque& operator=(work_deque&&) noexcept = delete;
+};
+
+/*namespace parallel*/ }
+#endif
@@ -29,6 +29,9 @@
 class sio;
 class fio;
 class bio;
+class cio;
+class uio;
+class mio;
 
 namespace sys {
 
@@ -20,6 +20,244 @@
     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 **/
 #include "ios.h"
+#include "ios/fio.h"
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+
+namespace {
+
+      constexpr std::size_t s_move_max = 1073741824;
+      constexpr std::size_t s_pipe_max = 65536;
+      constexpr std::size_t s_copy_max = 16384;
+
+/* is_unsupported()
+   tell the errors a zero-copy call fails with when it does not apply to the given pair of
+   descriptors from the actual I/O errors
+*/
+bool  is_unsupported(int error) noexcept
+{
+      return (error == EINVAL) ||
+          (error == ENOSYS) ||
+          (error == EXDEV) ||
+          (error == EOPNOTSUPP) ||
+          (error == EBADF) ||
+          (error == ESPIPE);
+}
+
+/* is_again()
+   tell whether a call on <desc> that failed with <error> should simply be repeated: it was
+   interrupted, or <desc> is non-blocking and not ready yet, in which case wait until it is
+*/
+bool  is_again(int desc, short int events, int error) noexcept
+{
+      if(error == EINTR) {
+          return true;
+      }
+      if((error == EAGAIN) ||
+          (error == EWOULDBLOCK)) {
+          pollfd l_poll{desc, events, 0};
+          while(::poll(std::addressof(l_poll), 1, -1) < 0) {
+              if(errno != EINTR) {
+                  return false;
+              }
+          }
+          return true;
+      }
+      return false;
+}
+
+bool  is_pipe(int desc) noexcept
+{
+      struct stat l_stat;
+      if(fstat(desc, std::addressof(l_stat)) == 0) {
+          return S_ISFIFO(l_stat.st_mode);
+      }
+      return false;
+}
+
+/* move_range()
+   copy_file_range() between two regular files, possibly sharing the blocks on filesystems
+   that allow it; <next> is set if the descriptors are not supported
+*/
+std::int64_t  move_range(int src, int dst, std::int64_t size, bool& next, bool&) noexcept
+{
+      std::int64_t l_result = 0;
+      while(l_result < size) {
+          std::size_t l_move_size = size - l_result < static_cast<std::int64_t>(s_move_max) ? size - l_result : s_move_max;
+          ssize_t     l_done_size = ::copy_file_range(src, nullptr, dst, nullptr, l_move_size, 0);
+          if(l_done_size > 0) {
+              l_result += l_done_size;
+          } else
+          if(l_done_size < 0) {
+              int l_error = errno;
+              if(is_again(dst, POLLOUT, l_error)) {
+                  continue;
+              }
+              next = is_unsupported(l_error);
+              break;
+          } else
+              break;
+      }
+      return l_result;
+}
+
+/* move_file()
+   sendfile() from a file that can be mapped, into anything
+*/
+std::int64_t  move_file(int src, int dst, std::int64_t size, bool& next, bool&) noexcept
+{
+      std::int64_t l_result = 0;
+      while(l_result < size) {
+          std::size_t l_move_size = size - l_result < static_cast<std::int64_t>(s_move_max) ? size - l_result : s_move_max;
+          ssize_t     l_done_size = ::sendfile(dst, src, nullptr, l_move_size);
+          if(l_done_size > 0) {
+              l_result += l_done_size;
+          } else
+          if(l_done_size < 0) {
+              int l_error = errno;
+              if(is_again(dst, POLLOUT, l_error)) {
+                  continue;
+              }
+              next = is_unsupported(l_error);
+              break;
+          } else
+              break;
+      }
+      return l_result;
+}
+
+/* move_drain()
+   empty <size> bytes out of our own pipe into <dst>: splice() for as long as <dst> takes it,
+   then read() and write() for whatever splice() refused
+*/
+std::int64_t  move_drain(int pipe, int dst, std::int64_t size) noexcept
+{
+      std::int64_t l_result = 0;
+      while(l_result < size) {
+          ssize_t l_save_size = ::splice(pipe, nullptr, dst, nullptr, size - l_result, SPLICE_F_MOVE);
+          if(l_save_size > 0) {
+              l_result += l_save_size;
+          } else
+          if((l_save_size < 0) &&
+              is_again(dst, POLLOUT, errno)) {
+              continue;
+          } else
+              break;
+      }
+      while(l_result < size) {
+          char    l_data[s_copy_max];
+          ssize_t l_read_size = ::read(pipe, l_data, size - l_result < static_cast<std::int64_t>(s_copy_max) ? size - l_result : s_copy_max);
+          if(l_read_size <= 0) {
+              break;
+          }
+          ssize_t l_save_size = 0;
+          while(l_save_size < l_read_size) {
+              ssize_t l_done_size = ::write(dst, l_data + l_save_size, l_read_size - l_save_size);
+              if(l_done_size > 0) {
+                  l_save_size += l_done_size;
+              } else
+              if((l_done_size < 0) &&
+                  is_again(dst, POLLOUT, errno)) {
+                  continue;
+              } else
+                  return l_result + l_save_size;
+          }
+          l_result += l_read_size;
+      }
+      return l_result;
+}
+
+/* move_pipe()
+   splice(), either directly if one of the two ends is a pipe, or through a pipe of our own
+   otherwise; <fail> is set if data already taken into our pipe could not be written out
+*/
+std::int64_t  move_pipe(int src, int dst, std::int64_t size, bool& next, bool& fail) noexcept
+{
+      std::int64_t l_result = 0;
+      if(is_pipe(src) || is_pipe(dst)) {
+          while(l_result < size) {
+              std::size_t l_move_size = size - l_result < static_cast<std::int64_t>(s_move_max) ? size - l_result : s_move_max;
+              ssize_t     l_done_size = ::splice(src, nullptr, dst, nullptr, l_move_size, SPLICE_F_MOVE);
+              if(l_done_size > 0) {
+                  l_result += l_done_size;
+              } else
+              if(l_done_size < 0) {
+                  // either end may be the one not ready: wait for both
+                  int l_error = errno;
+                  if(is_again(src, POLLIN, l_error) &&
+                      is_again(dst, POLLOUT, l_error)) {
+                      continue;
+                  }
+                  next = is_unsupported(l_error);
+                  break;
+              } else
+                  break;
+          }
+          return l_result;
+      }
+      int l_pipe[2];
+      if(pipe2(l_pipe, O_CLOEXEC) != 0) {
+          next = true;
+          return 0;
+      }
+      while(l_result < size) {
+          std::size_t l_move_size = size - l_result < static_cast<std::int64_t>(s_pipe_max) ? size - l_result : s_pipe_max;
+          ssize_t     l_load_size = ::splice(src, nullptr, l_pipe[1], nullptr, l_move_size, SPLICE_F_MOVE);
+          if(l_load_size <= 0) {
+              if(l_load_size < 0) {
+                  int l_error = errno;
+                  if(is_again(src, POLLIN, l_error)) {
+                      continue;
+                  }
+                  next = is_unsupported(l_error);
+              }
+              break;
+          }
+          std::int64_t l_save_size = move_drain(l_pipe[0], dst, l_load_size);
+          l_result += l_save_size;
+          if(l_save_size < l_load_size) {
+              fail = true;
+              break;
+          }
+      }
+      close(l_pipe[0]);
+      close(l_pipe[1]);
+      return l_result;
+}
+
+/* move_copy()
+   the buffered fallback, through the streams' own read() and write(); <fail> is set if data
+   already read could not be written out
+*/
+std::int64_t  move_copy(sys::ios& src, sys::ios& dst, std::int64_t size, bool& fail) noexcept
+{
+      char         l_data[s_copy_max];
+      std::int64_t l_result = 0;
+      while(l_result < size) {
+          std::size_t  l_load_size = size - l_result < static_cast<std::int64_t>(s_copy_max) ? size - l_result : s_copy_max;
+          std::int64_t l_read_size = src.read(l_load_size, l_data);
+          if(l_read_size <= 0) {
+              break;
+          }
+          std::int64_t l_save_size = 0;
+          while(l_save_size < l_read_size) {
+              std::int64_t l_done_size = dst.write(l_read_size - l_save_size, l_data + l_save_size);
+              if(l_done_size <= 0) {
+                  fail = true;
+                  return l_result + l_save_size;
+              }
+              l_save_size += l_done_size;
+          }
+          l_result += l_read_size;
+      }
+      return l_result;
+}
+
+/*namespace*/ }
 
 namespace sys {
 
@@ -39,6 +277,36 @@ namespace sys {
 {
 }
 
+std::int64_t ios::readv(const iovec* list, std::size_t count) noexcept
+{
+      std::int64_t l_result = 0;
+      for(std::size_t l_index = 0; l_index < count; l_index++) {
+          std::int64_t l_read_size = read(list[l_index].iov_len, static_cast<char*>(list[l_index].iov_base));
+          if(l_read_size > 0) {
+              l_result += l_read_size;
+          }
+          if(l_read_size < static_cast<std::int64_t>(list[l_index].iov_len)) {
+              break;
+          }
+      }
+      return l_result;
+}
+
+std::int64_t ios::writev(const iovec* list, std::size_t count) noexcept
+{
+      std::int64_t l_result = 0;
+      for(std::size_t l_index = 0; l_index < count; l_index++) {
+          std::int64_t l_save_size = write(list[l_index].iov_len, static_cast<const char*>(list[l_index].iov_base));
+          if(l_save_size > 0) {
+              l_result += l_save_size;
+          }
+          if(l_save_size < static_cast<std::int64_t>(list[l_index].iov_len)) {
+              break;
+          }
+      }
+      return l_result;
+}
+
 bool  ios::is_serial() const noexcept
 {
       return is_seekable() == false;
@@ -54,4 +322,45 @@ ios&  ios::operator=(ios&&) noexcept
       return *this;
 }
 
+std::int64_t  transfer(ios& src, ios& dst, std::int64_t size) noexcept
+{
+      std::int64_t l_direct_size;
+      return transfer(src, dst, size, l_direct_size);
+}
+
+std::int64_t  transfer(ios& src, ios& dst, std::int64_t size, std::int64_t& direct_size) noexcept
+{
+      std::int64_t l_result = 0;
+      bool         l_fail = false;
+      direct_size = 0;
+      if(size <= 0) {
+          return 0;
+      }
+      fio* l_src = dynamic_cast<fio*>(std::addressof(src));
+      fio* l_dst = dynamic_cast<fio*>(std::addressof(dst));
+      if((l_src != nullptr) &&
+          (l_dst != nullptr)) {
+          // each method moves as much as it can and hands over to the next one only if the
+          // pair of descriptors is not supported: an end of file or an actual error stop the
+          // transfer
+          for(auto l_move : {move_range, move_file, move_pipe}) {
+              bool l_next = false;
+              l_result += l_move(l_src->get_fd(), l_dst->get_fd(), size - l_result, l_next, l_fail);
+              if(l_next == false) {
+                  direct_size = l_result;
+                  if(l_fail) {
+                      return -1;
+                  }
+                  return l_result;
+              }
+          }
+          direct_size = l_result;
+      }
+      l_result += move_copy(src, dst, size - l_result, l_fail);
+      if(l_fail) {
+          return -1;
+      }
+      return l_result;
+}
+
 /*namespace sys*/ }
@@ -24,6 +24,7 @@
 #include <os.h>
 #include <sys.h>
 #include <cstring>
+#include <sys/uio.h>
 
 namespace sys {
 
@@ -47,7 +48,7 @@ class ios
           ios(ios&&) noexcept;
   virtual ~ios();
 
-  virtual std::int32_t seek(std::int32_t, std::int32_t) noexcept = 0;
+  virtual std::int64_t seek(std::int64_t, std::int32_t) noexcept = 0;
  
   template<typename... Args>
   inline  std::int32_t lsb_get(char& value, Args&&... next) noexcept {
@@ -149,8 +150,14 @@ class ios
   */
   virtual unsigned int get_byte() noexcept = 0;
   
-  virtual std::int32_t read(std::size_t) noexcept = 0;
-  virtual std::int32_t read(std::size_t, char*) noexcept = 0;
+  virtual std::int64_t read(std::size_t) noexcept = 0;
+  virtual std::int64_t read(std::size_t, char*) noexcept = 0;
+
+  /* readv()
+     scatter read into a list of segments, in order; unless overridden, the segments are read
+     one at a time, up to the first short read
+  */
+  virtual std::int64_t readv(const iovec*, std::size_t) noexcept;
 
   inline  std::int32_t lsb_put() noexcept {
           return 0;
@@ -296,17 +303,34 @@ class ios
   */
   virtual std::int32_t put_byte(std::uint8_t) noexcept = 0;
 
-  virtual std::int32_t write(std::size_t, const char*) noexcept = 0;
+  virtual std::int64_t write(std::size_t, const char*) noexcept = 0;
+
+  /* writev()
+     gather write from a list of segments, in order; unless overridden, the segments are
+     written one at a time, up to the first short write
+  */
+  virtual std::int64_t writev(const iovec*, std::size_t) noexcept;
 
   virtual bool is_seekable() const noexcept = 0;
           bool is_serial() const noexcept;
   virtual bool is_readable() const noexcept = 0;
   virtual bool is_writable() const noexcept = 0;
-  virtual std::int32_t get_size() noexcept = 0;
+  virtual std::int64_t get_size() noexcept = 0;
 
           ios& operator=(const ios&) noexcept;
           ios& operator=(ios&&) noexcept;
 };
 
+/* transfer()
+   move up to <size> bytes from <src> to <dst>, from their current positions, and return how
+   many were moved; between two fio streams the data stays within the kernel, through
+   copy_file_range(), sendfile() or splice() - the first the two descriptors support - and is
+   copied through a buffer otherwise. <direct_size> receives the part moved without a copy.
+   Returns -1 if data already taken from <src> could not be written to <dst>, rather than a
+   short count that would read as the end of <src>.
+*/
+std::int64_t  transfer(ios& src, ios& dst, std::int64_t size) noexcept;
+std::int64_t  transfer(ios& src, ios& dst, std::int64_t size, std::int64_t& direct_size) noexcept;
+
 /*namespace sys*/ }
 #endif
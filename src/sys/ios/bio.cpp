@@ -21,14 +21,115 @@
 **/
 #include "bio.h"
 #include <cstring>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
 
       constexpr size_t s_lock_max = 255;
       constexpr size_t s_read_min = 64;
-      constexpr size_t s_read_max = std::numeric_limits<std::uint32_t>::max() / 4;
+      constexpr size_t s_line_min = 65536;
+      constexpr std::int64_t s_line_max = std::numeric_limits<std::int32_t>::max();
+      constexpr size_t s_read_max = std::numeric_limits<std::int64_t>::max() / 4;
+      constexpr size_t s_gather_max = 4096;
+      constexpr size_t s_list_max = 64;
 
       constexpr char   EOL ='\n';
       constexpr char   EOS = 0;
 
+namespace {
+
+#if defined(__x86_64__)
+/* eol_find_sse2()
+   compare 16 bytes at a time against the end of line character
+*/
+__attribute__((target("sse2")))
+const char* eol_find_sse2(const char* data, std::size_t size, char eol) noexcept
+{
+      const char*   l_tail = data + size;
+      const __m128i l_eol  = _mm_set1_epi8(eol);
+      while(data + 16 <= l_tail) {
+          __m128i l_data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+          if(int l_mask = _mm_movemask_epi8(_mm_cmpeq_epi8(l_data, l_eol)); l_mask != 0) {
+              return data + __builtin_ctz(l_mask);
+          }
+          data += 16;
+      }
+      while(data < l_tail) {
+          if(*data == eol) {
+              return data;
+          }
+          data++;
+      }
+      return nullptr;
+}
+
+/* eol_find_avx2()
+   compare 64 bytes at a time, as two 32 byte halves merged before the branch, then fall back
+   to SSE2 for the tail
+*/
+__attribute__((target("avx2")))
+const char* eol_find_avx2(const char* data, std::size_t size, char eol) noexcept
+{
+      const char*   l_tail = data + size;
+      const __m256i l_eol  = _mm256_set1_epi8(eol);
+      if(data + 32 <= l_tail) {
+          // most lines are short: look at the first 32 bytes on their own
+          __m256i l_data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+          if(unsigned int l_mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(l_data, l_eol)); l_mask != 0) {
+              return data + __builtin_ctz(l_mask);
+          }
+          data += 32;
+      }
+      while(data + 64 <= l_tail) {
+          __m256i l_cmp0 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)), l_eol);
+          __m256i l_cmp1 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 32)), l_eol);
+          if(_mm256_testz_si256(_mm256_or_si256(l_cmp0, l_cmp1), _mm256_or_si256(l_cmp0, l_cmp1)) == 0) {
+              if(unsigned int l_mask = _mm256_movemask_epi8(l_cmp0); l_mask != 0) {
+                  return data + __builtin_ctz(l_mask);
+              }
+              return data + 32 + __builtin_ctz(static_cast<unsigned int>(_mm256_movemask_epi8(l_cmp1)));
+          }
+          data += 64;
+      }
+      return eol_find_sse2(data, l_tail - data, eol);
+}
+#else
+/* eol_find_sw()
+   plain memchr(), for targets without a vector implementation here
+*/
+const char* eol_find_sw(const char* data, std::size_t size, char eol) noexcept
+{
+      return static_cast<const char*>(std::memchr(data, eol, size));
+}
+#endif
+
+using eol_find_t = const char* (*)(const char*, std::size_t, char) noexcept;
+
+eol_find_t eol_find_find() noexcept
+{
+#if defined(__x86_64__)
+      __builtin_cpu_init();
+      if(__builtin_cpu_supports("avx2")) {
+          return eol_find_avx2;
+      }
+      return eol_find_sse2;
+#else
+      return eol_find_sw;
+#endif
+}
+
+/* eol_find_get()
+   implementation in use; resolved once, on first call, and safely so if that first call comes
+   from several threads at once
+*/
+eol_find_t eol_find_get() noexcept
+{
+      static const eol_find_t s_eol_find = eol_find_find();
+      return s_eol_find;
+}
+
+/*namespace*/ }
+
       bio::bio() noexcept:
       bio(fragment::get_default(), nullptr)
 {
@@ -125,20 +226,20 @@ bool  bio::load(std::size_t count, bool force) noexcept
           // detect latent seek() operations and compute load size
           if(m_read_size > 0) {
               if(m_read_iter < m_read_size) {
-                  std::int32_t l_load_size = m_read_iter + l_load_size - m_read_size;
-                  std::int32_t l_copy_size = m_read_size - m_read_iter;
-                  std::int32_t l_free_size = m_data_tail - m_data_head - m_read_size;
+                  std::int64_t l_load_size = m_read_iter + l_load_size - m_read_size;
+                  std::int64_t l_copy_size = m_read_size - m_read_iter;
+                  std::int64_t l_free_size = m_data_tail - m_data_head - m_read_size;
                   //if(is_locked() == false) {
                   //}
-                  std::int32_t l_file_pos = m_read_pos + m_read_size;
+                  std::int64_t l_file_pos = m_read_pos + m_read_size;
                   if(l_file_pos != m_file_pos) {
-                      std::int32_t l_move_pos = m_io->seek(l_file_pos, SEEK_SET);
+                      std::int64_t l_move_pos = m_io->seek(l_file_pos, SEEK_SET);
                       if(l_move_pos) {
                           m_file_pos = l_move_pos;
                       } else
                           return false;
                   }
-                  std::int32_t l_read_size = m_io->read(l_free_size, m_data_head + m_read_size);
+                  std::int64_t l_read_size = m_io->read(l_free_size, m_data_head + m_read_size);
                   if(l_read_size >= 0) {
                       m_file_pos  += l_read_size;
                       m_read_size += l_read_size;
@@ -149,9 +250,9 @@ bool  bio::load(std::size_t count, bool force) noexcept
           }
           // no optimisation applied, proceed to compress and fully load
           if(l_load_size > 0) {
-              std::int32_t l_file_pos = m_read_pos + m_read_iter;
+              std::int64_t l_file_pos = m_read_pos + m_read_iter;
               if(l_file_pos != m_file_pos) {
-                  std::int32_t l_move_pos = m_io->seek(l_file_pos, SEEK_SET);
+                  std::int64_t l_move_pos = m_io->seek(l_file_pos, SEEK_SET);
                   if(l_move_pos) {
                       m_file_pos = l_move_pos;
                   } else
@@ -161,8 +262,8 @@ bool  bio::load(std::size_t count, bool force) noexcept
               m_read_iter = 0;
               m_read_size = 0;
               if(reserve(l_load_size)) {
-                  std::int32_t l_free_size = m_data_tail - m_data_head;
-                  std::int32_t l_read_size = m_io->read(l_free_size, m_data_head);
+                  std::int64_t l_free_size = m_data_tail - m_data_head;
+                  std::int64_t l_read_size = m_io->read(l_free_size, m_data_head);
                   if(l_read_size > 0) {
                       m_file_pos  += l_read_size;
                       m_read_size += l_read_size;
@@ -207,48 +308,42 @@ void  bio::set_source(ios* io) noexcept
    move the file cursor, as documented by ::lseek();
    seek() tries to be as lazy as possible, especially in relative mode (whence == SEEK_CUR)
 */
-std::int32_t bio::seek(std::int32_t offset, std::int32_t whence) noexcept
+std::int64_t bio::seek(std::int64_t offset, std::int32_t whence) noexcept
 {
       if(whence == SEEK_SET) {
           // seek at an absolute position within the file: if offset points inside our buffer
           // update m_read_pos and return success
           if(offset >= 0) {
               if(m_read_pos >= 0) {
-                  off_t l_read_iter = offset - m_read_pos;
-                  if(l_read_iter >= std::numeric_limits<std::int32_t>::min()) {
-                      if(l_read_iter <= std::numeric_limits<std::int32_t>::max()) {
-                          if(l_read_iter != m_read_iter) {
-                              if(m_lock_ctr != 0) {
-                                  return -1;
-                              }
-                              if(m_io->is_seekable()) {
-                                  flush();
-                                  m_read_iter = l_read_iter;
-                              }
-                          }
-                          return offset;
+                  std::int64_t l_read_iter = offset - m_read_pos;
+                  if(l_read_iter != m_read_iter) {
+                      if(m_lock_ctr != 0) {
+                          return -1;
+                      }
+                      if(m_io->is_seekable()) {
+                          flush();
+                          m_read_iter = l_read_iter;
                       }
                   }
+                  return offset;
               }
           }
       } else
       if(whence == SEEK_CUR) {
           if(m_read_pos >= 0) {
-              off_t l_read_iter = m_read_iter + offset;
-              if(l_read_iter >= std::numeric_limits<std::int32_t>::min()) {
-                  if(l_read_iter <= std::numeric_limits<std::int32_t>::max() - m_read_pos ) {
-                      off_t l_file_pos = m_read_pos + l_read_iter;
-                      if(l_read_iter != m_read_iter) {
-                          if(m_lock_ctr != 0) {
-                              return -1;
-                          }
-                          if(m_io->is_seekable()) {
-                              flush();
-                              m_read_iter = l_read_iter;
-                          }
+              std::int64_t l_read_iter = m_read_iter + offset;
+              if(l_read_iter >= 0 - m_read_pos) {
+                  std::int64_t l_file_pos = m_read_pos + l_read_iter;
+                  if(l_read_iter != m_read_iter) {
+                      if(m_lock_ctr != 0) {
+                          return -1;
+                      }
+                      if(m_io->is_seekable()) {
+                          flush();
+                          m_read_iter = l_read_iter;
                       }
-                      return l_file_pos;
                   }
+                  return l_file_pos;
               }
           }
       } else
@@ -256,7 +351,7 @@ std::int32_t bio::seek(std::int32_t offset, std::int32_t whence) noexcept
           // seek at the end of the file: no way to tell where that is unless the parent
           // stream supports it
           if(m_io->is_seekable()) {
-              off_t l_file_pos = m_io->seek(offset, SEEK_END);
+              std::int64_t l_file_pos = m_io->seek(0, SEEK_END);
               if(l_file_pos >= 0) {
                   return seek(l_file_pos + offset, SEEK_SET);
               }
@@ -267,7 +362,7 @@ std::int32_t bio::seek(std::int32_t offset, std::int32_t whence) noexcept
 
 /* lock()
 */
-std::int32_t bio::lock() noexcept
+std::int64_t bio::lock() noexcept
 {
       if(m_lock_ctr < s_lock_max) {
           m_lock_ctr++;
@@ -300,6 +395,58 @@ unsigned int bio::get_byte() noexcept
 }
 
 
+/* fill()
+   append to the buffer as much as the source has to give; the unread data is moved to the
+   front first, unless the buffer is locked, and the buffer grows only when full
+*/
+bool  bio::fill() noexcept
+{
+      if(m_read_pos < 0) {
+          return false;
+      }
+      if((m_read_iter < 0) ||
+          (m_read_iter > m_read_size)) {
+          // pending seek() outside the buffer: nothing in it is worth keeping
+          if(m_lock_ctr != 0) {
+              return false;
+          }
+          m_read_pos += m_read_iter;
+          m_read_iter = 0;
+          m_read_size = 0;
+      }
+      if((m_lock_ctr == 0) &&
+          (m_read_iter > 0)) {
+          std::memmove(m_data_head, m_data_head + m_read_iter, m_read_size - m_read_iter);
+          m_read_pos  += m_read_iter;
+          m_read_size -= m_read_iter;
+          m_read_iter  = 0;
+      }
+      if(m_data_head == nullptr) {
+          if(reserve(s_line_min) == false) {
+              return false;
+          }
+      } else
+      if(m_data_tail - m_data_head <= m_read_size) {
+          if(reserve(static_cast<std::size_t>(m_read_size) * 2) == false) {
+              return false;
+          }
+      }
+      std::int64_t l_file_pos = m_read_pos + m_read_size;
+      if(l_file_pos != m_file_pos) {
+          if(m_io->seek(l_file_pos, SEEK_SET) != l_file_pos) {
+              return false;
+          }
+          m_file_pos = l_file_pos;
+      }
+      std::int64_t l_read_size = m_io->read(m_data_tail - m_data_head - m_read_size, m_data_head + m_read_size);
+      if(l_read_size > 0) {
+          m_file_pos  += l_read_size;
+          m_read_size += l_read_size;
+          return true;
+      }
+      return false;
+}
+
 /* get_line()
    read from input stream into the memory buffer until reaching eol
 */
@@ -310,55 +457,101 @@ char* bio::get_line() noexcept
       return l_line;
 }
 
+/* get_line()
+   the next line, with the end of line character replaced by a zero; <length> is set to its
+   size, or to -1 at the end of the stream. A last line lacking the end of line character is
+   returned as is. A line longer than s_line_max (the largest <length> can hold) is not read:
+   nullptr is returned, with <length> set to -1 and the stream left at the start of that line.
+   The buffer is scanned a vector at a time and refilled only when no end of line is found in it.
+*/
 char* bio::get_line(std::int32_t& length) noexcept
 {
-      int          l_char;
-      char*        l_result = nullptr;
-      std::int32_t l_count;
-      std::int32_t l_offset;
-      if(load(1, true)) {
-          l_count = 0;
-          l_offset = m_read_iter;
-          lock();
-          for(;;) {
-              l_char = get_char();
-              if(l_char != EOF) {
-                  if(l_char != m_eol) {
-                      l_count++;
-                  } else
+      std::int64_t l_scan_size = 0;
+      flush();
+      for(;;) {
+          if((m_read_iter >= 0) &&
+              (m_read_iter < m_read_size)) {
+              std::int64_t l_scan_pos = m_read_iter + l_scan_size;
+              if(const char* l_eol = eol_find_get()(m_data_head + l_scan_pos, m_read_size - l_scan_pos, m_eol); l_eol != nullptr) {
+                  char*        l_line = m_data_head + m_read_iter;
+                  std::int64_t l_eol_pos = l_eol - m_data_head;
+                  if(l_eol_pos - m_read_iter > s_line_max) {
                       break;
-              } else
+                  }
+                  m_data_head[l_eol_pos] = EOS;
+                  length = l_eol_pos - m_read_iter;
+                  m_read_iter = l_eol_pos + 1;
+                  return l_line;
+              }
+              l_scan_size = m_read_size - m_read_iter;
+              if(l_scan_size > s_line_max) {
                   break;
-          }
-          unlock();
-          if(l_count > 0) {
-              m_data_head[m_read_iter - 1] = 0;
-              if(m_data_head[l_offset]) {
-                  l_result = m_data_head + l_offset;
               }
-              length = l_count;
-          } else
-          if(l_count == 0) {
-              if(l_char == EOF) {
-                  length = -1;
+          }
+          if(m_io == nullptr) {
+              break;
+          }
+          if(fill() == false) {
+              if((m_read_iter >= 0) &&
+                  (m_read_iter < m_read_size)) {
+                  if(reserve(m_read_size + 1)) {
+                      char* l_line = m_data_head + m_read_iter;
+                      m_data_head[m_read_size] = EOS;
+                      length = m_read_size - m_read_iter;
+                      m_read_iter = m_read_size;
+                      return l_line;
+                  }
               }
-              length = 0;
+              break;
           }
-          return l_result;
       }
       length = -1;
       return nullptr;
 }
 
+/* get_lines()
+   up to <count> lines at once, as get_line() would return them, into <lines> and their sizes
+   into <lengths>; all of them stay valid until the next operation on the stream. Only the
+   first line may cause a refill, so fewer lines than asked for may be returned before the end
+   of the stream.
+*/
+std::int32_t  bio::get_lines(char** lines, std::int32_t* lengths, std::int32_t count) noexcept
+{
+      std::int32_t l_count = 0;
+      if(count > 0) {
+          lines[0] = get_line(lengths[0]);
+          if(lines[0] != nullptr) {
+              l_count++;
+              while((l_count < count) &&
+                  (m_read_iter < m_read_size)) {
+                  const char* l_eol = eol_find_get()(m_data_head + m_read_iter, m_read_size - m_read_iter, m_eol);
+                  if(l_eol == nullptr) {
+                      break;
+                  }
+                  std::int64_t l_eol_pos = l_eol - m_data_head;
+                  if(l_eol_pos - m_read_iter > s_line_max) {
+                      break;
+                  }
+                  m_data_head[l_eol_pos] = EOS;
+                  lines[l_count] = m_data_head + m_read_iter;
+                  lengths[l_count] = l_eol_pos - m_read_iter;
+                  m_read_iter = l_eol_pos + 1;
+                  l_count++;
+              }
+          }
+      }
+      return l_count;
+}
+
 /* read()
    find the size of the file and fully read into the internal buffer
 */
-std::int32_t  bio::read() noexcept
+std::int64_t  bio::read() noexcept
 {
       flush();
       if(m_read_pos >= 0) {
           if(m_lock_ctr == 0) {
-              std::int32_t l_file_pos = m_read_pos + m_read_iter;
+              std::int64_t l_file_pos = m_read_pos + m_read_iter;
               if(l_file_pos != m_file_pos) {
                   if(m_io->seek(l_file_pos, SEEK_SET) != l_file_pos) {
                       return 0;
@@ -369,10 +562,10 @@ std::int32_t  bio::read() noexcept
               m_read_iter = 0;
               m_read_size = 0;
               if(true) {
-                  int  l_read_size; 
+                  std::int64_t l_read_size; 
                   do {
-                      int  l_load_size = 256;
-                      int  l_next_size = m_read_size + l_load_size;
+                      std::int64_t l_load_size = 256;
+                      std::int64_t l_next_size = m_read_size + l_load_size;
                       if(reserve(l_next_size)) {
                           l_read_size = m_io->read(l_load_size, m_data_head + m_read_size);
                           if(l_read_size > 0) {
@@ -393,7 +586,7 @@ std::int32_t  bio::read() noexcept
 /* read()
    read data into the internal buffer
 */
-std::int32_t  bio::read(std::size_t count) noexcept
+std::int64_t  bio::read(std::size_t count) noexcept
 {
       flush();
       if(count) {
@@ -410,15 +603,15 @@ std::int32_t  bio::read(std::size_t count) noexcept
    tries to optimise I/O by eliminating seeks() and replacing reads() with copies from the
    internal buffer, whenever positions and sizes allow.
 */
-std::int32_t  bio::read(std::size_t count, char* memory) noexcept
+std::int64_t  bio::read(std::size_t count, char* memory) noexcept
 {
       if(m_read_pos >= 0) {
           flush();
           if(count < s_read_max) {
-              off_t       l_file_pos  = m_file_pos + m_read_iter;
-              std::size_t l_copy_size = 0;
-              std::size_t l_load_size = 0;
-              off_t       l_result    = 0;
+              std::int64_t l_file_pos  = m_file_pos + m_read_iter;
+              std::size_t  l_copy_size = 0;
+              std::size_t  l_load_size = 0;
+              std::int64_t l_result    = 0;
               if(m_read_iter >= 0) {
                   // check if there's a latent seek() and if so, compute the copy and load
                   // sizes
@@ -433,7 +626,7 @@ std::int32_t  bio::read(std::size_t count, char* memory) noexcept
 
                   // seek and load the necessary data from file
                   if(l_load_size > 0) { 
-                      if(m_read_pos != l_file_pos + static_cast<std::int32_t>(l_copy_size)) {
+                      if(m_read_pos != l_file_pos + static_cast<std::int64_t>(l_copy_size)) {
                           if(m_io->is_seekable()) {
                               if(m_io->seek(l_file_pos, SEEK_SET) >= 0) {
                                   m_read_pos = l_file_pos;
@@ -458,7 +651,7 @@ std::int32_t  bio::read(std::size_t count, char* memory) noexcept
                   // the internal buffer then give up copying from internal bufer altogether
                   if(m_io->is_seekable()) {
                       if(m_read_iter + count > 0) {
-                          if(m_read_iter + static_cast<std::int32_t>(count) < m_read_size) {
+                          if(m_read_iter + static_cast<std::int64_t>(count) < m_read_size) {
                               l_copy_size = m_read_iter - m_file_pos + count;
                               l_load_size = m_file_pos - m_read_iter;
                           } else
@@ -471,7 +664,7 @@ std::int32_t  bio::read(std::size_t count, char* memory) noexcept
                   // copy the output buffer and update the internal file pointer
                   if(auto l_seek_ret = m_io->seek(l_file_pos, SEEK_SET); l_seek_ret >= 0) {
                       m_read_pos = l_seek_ret;
-                      if(auto l_load_ret = m_io->read(l_load_size, memory); l_load_ret >= static_cast<std::int32_t>(l_load_size)) {
+                      if(auto l_load_ret = m_io->read(l_load_size, memory); l_load_ret >= static_cast<std::int64_t>(l_load_size)) {
                           m_read_pos += l_load_ret;
                           l_result   += l_load_ret;
                           if(l_copy_size > 0) {
@@ -503,6 +696,99 @@ std::int32_t  bio::read(std::size_t count, char* memory) noexcept
       return 0;
 }
 
+/* readv()
+   scatter read: whatever the buffer holds is copied out first; past that, a remainder
+   smaller than s_gather_max is served through the buffer, a larger one is read straight into
+   the segments, with one readv() on the source for every s_list_max of them
+*/
+std::int64_t  bio::readv(const iovec* list, std::size_t count) noexcept
+{
+      std::int64_t l_result = 0;
+      std::size_t  l_index  = 0;
+      std::size_t  l_offset = 0;
+      if(m_read_pos < 0) {
+          return 0;
+      }
+      flush();
+      while(l_index < count) {
+          if(l_offset == list[l_index].iov_len) {
+              l_index++;
+              l_offset = 0;
+              continue;
+          }
+          if((m_read_iter >= 0) &&
+              (m_read_iter < m_read_size)) {
+              std::size_t l_copy_size = list[l_index].iov_len - l_offset;
+              if(l_copy_size > static_cast<std::size_t>(m_read_size - m_read_iter)) {
+                  l_copy_size = m_read_size - m_read_iter;
+              }
+              std::memcpy(static_cast<char*>(list[l_index].iov_base) + l_offset, m_data_head + m_read_iter, l_copy_size);
+              m_read_iter += l_copy_size;
+              l_offset    += l_copy_size;
+              l_result    += l_copy_size;
+              continue;
+          }
+          std::size_t l_load_size = 0;
+          for(std::size_t l_next = l_index; (l_next < count) && (l_load_size < s_gather_max + l_offset); l_next++) {
+              l_load_size += list[l_next].iov_len;
+          }
+          if(l_load_size - l_offset < s_gather_max) {
+              if(fill() == false) {
+                  break;
+              }
+              continue;
+          }
+          std::int64_t l_file_pos = m_read_pos + m_read_iter;
+          if(l_file_pos != m_file_pos) {
+              if(m_io->seek(l_file_pos, SEEK_SET) != l_file_pos) {
+                  break;
+              }
+              m_file_pos = l_file_pos;
+          }
+          iovec        l_list[s_list_max];
+          std::size_t  l_list_size = 0;
+          std::int64_t l_list_want = 0;
+          while((l_list_size < s_list_max) &&
+              (l_index + l_list_size < count)) {
+              const iovec& l_part = list[l_index + l_list_size];
+              std::size_t  l_skip = l_list_size ? 0 : l_offset;
+              l_list[l_list_size].iov_base = static_cast<char*>(l_part.iov_base) + l_skip;
+              l_list[l_list_size].iov_len  = l_part.iov_len - l_skip;
+              l_list_want += l_list[l_list_size].iov_len;
+              l_list_size++;
+          }
+          std::int64_t l_read_size = m_io->readv(l_list, l_list_size);
+          if(l_read_size <= 0) {
+              break;
+          }
+          m_file_pos  += l_read_size;
+          m_read_iter += l_read_size;
+          l_result    += l_read_size;
+          for(std::int64_t l_skip_size = l_read_size; l_skip_size > 0; ) {
+              std::size_t l_part_size = list[l_index].iov_len - l_offset;
+              if(static_cast<std::size_t>(l_skip_size) < l_part_size) {
+                  l_offset += l_skip_size;
+                  break;
+              }
+              l_skip_size -= l_part_size;
+              l_index++;
+              l_offset = 0;
+          }
+          if(l_read_size < l_list_want) {
+              break;
+          }
+      }
+      // data read past the buffer leaves the cursor outside of it: drop the buffer, unless
+      // it's locked
+      if((m_lock_ctr == 0) &&
+          (m_read_iter > m_read_size)) {
+          m_read_pos += m_read_iter;
+          m_read_iter = 0;
+          m_read_size = 0;
+      }
+      return l_result;
+}
+
 std::int32_t  bio::put_char(char value) noexcept
 {
       return write(1, std::addressof(value));
@@ -513,20 +799,20 @@ std::int32_t  bio::put_byte(unsigned char value) noexcept
       return write(1, reinterpret_cast<char*>(std::addressof(value)));
 }
 
-std::int32_t  bio::write(std::size_t size, const char* data) noexcept
+std::int64_t  bio::write(std::size_t size, const char* data) noexcept
 {
       if(data && size) {
           if(m_read_pos >= 0) {
               std::size_t  l_used_size;
-              std::int32_t l_result    = size;
+              std::int64_t l_result    = size;
               if(size > s_read_max) {
                   return 0;
               }
               // in text mode find an EOL do an early flush if found
               if(m_eol == EOL) {
                   if(m_lock_ctr == 0) {
-                      std::int32_t l_last = size - 1;
-                      std::int32_t l_iter = l_last;
+                      std::int64_t l_last = size - 1;
+                      std::int64_t l_iter = l_last;
                       while(l_iter >= 0) {
                           if(data[l_iter] == EOL) {
                               if(m_save_size > 0) {
@@ -572,6 +858,80 @@ std::int32_t  bio::write(std::size_t size, const char* data) noexcept
       return 0;
 }
 
+/* writev()
+   gather write: segments smaller than s_gather_max are copied into the buffer, as write()
+   would; runs of larger ones are handed to the source right away, in one writev() together
+   with the data still pending. In text mode the buffer is then flushed up to its last end of
+   line, the same as write() does.
+*/
+std::int64_t  bio::writev(const iovec* list, std::size_t count) noexcept
+{
+      std::int64_t l_result = 0;
+      std::size_t  l_index  = 0;
+      if(m_read_pos < 0) {
+          return 0;
+      }
+      while(l_index < count) {
+          if(list[l_index].iov_len < s_gather_max) {
+              if(list[l_index].iov_len > 0) {
+                  std::size_t l_used_size = m_save_size + list[l_index].iov_len;
+                  unload();
+                  if(reserve(l_used_size) == false) {
+                      return l_result;
+                  }
+                  std::memcpy(m_data_head + m_save_size, list[l_index].iov_base, list[l_index].iov_len);
+                  m_save_size = l_used_size;
+                  l_result   += list[l_index].iov_len;
+              }
+              l_index++;
+          } else {
+              iovec        l_list[s_list_max];
+              std::size_t  l_list_size = 0;
+              std::int64_t l_list_save = m_save_size;
+              std::int64_t l_list_want = m_save_size;
+              unload();
+              if(m_save_size > 0) {
+                  l_list[0].iov_base = m_data_head;
+                  l_list[0].iov_len  = m_save_size;
+                  l_list_size++;
+              }
+              while((l_index < count) &&
+                  (l_list_size < s_list_max) &&
+                  (list[l_index].iov_len >= s_gather_max)) {
+                  l_list[l_list_size++] = list[l_index];
+                  l_list_want += list[l_index].iov_len;
+                  l_index++;
+              }
+              std::int64_t l_save_size = m_io->writev(l_list, l_list_size);
+              if(l_save_size < l_list_save) {
+                  // short write within the pending data: keep what the source did not take
+                  if(l_save_size > 0) {
+                      std::memmove(m_data_head, m_data_head + l_save_size, l_list_save - l_save_size);
+                      m_save_size = l_list_save - l_save_size;
+                  }
+                  return l_result;
+              }
+              l_result   += l_save_size - l_list_save;
+              m_save_size = 0;
+              if(l_save_size != l_list_want) {
+                  return l_result;
+              }
+          }
+      }
+      if((m_eol == EOL) &&
+          (m_lock_ctr == 0) &&
+          (m_save_size > 0)) {
+          if(auto l_eol = static_cast<char*>(memrchr(m_data_head, EOL, m_save_size)); l_eol != nullptr) {
+              std::int64_t l_line_size = l_eol - m_data_head + 1;
+              if(m_io->write(l_line_size, m_data_head) == l_line_size) {
+                  std::memmove(m_data_head, m_data_head + l_line_size, m_save_size - l_line_size);
+                  m_save_size -= l_line_size;
+              }
+          }
+      }
+      return l_result;
+}
+
 void  bio::flush() noexcept
 {
       if(m_save_size) {
@@ -591,7 +951,7 @@ char* bio::get_data() noexcept
       return nullptr;
 }
 
-std::int32_t  bio::get_size() noexcept
+std::int64_t  bio::get_size() noexcept
 {
       if(m_io) {
           return m_io->get_size();
@@ -651,7 +1011,7 @@ bool  bio::reserve(std::size_t size) noexcept
                   l_size_next = m_resource->get_alloc_size(size);
               } else
               if(m_lock_ctr == 0) {
-                  if(std::size_t l_size_exp = m_resource->get_alloc_size(size); l_size_exp <= (std::size_t)std::numeric_limits<std::int32_t>::max()) {
+                  if(std::size_t l_size_exp = m_resource->get_alloc_size(size); l_size_exp <= (std::size_t)std::numeric_limits<std::int64_t>::max()) {
                       auto  l_size_new = l_size_exp;
                       auto  l_copy_ptr = reinterpret_cast<char*>(m_resource->reallocate(m_data_head, l_size_prev, l_size_exp, alignof(std::size_t)));
                       if(l_copy_ptr) {
@@ -672,7 +1032,7 @@ bool  bio::reserve(std::size_t size) noexcept
               return false;
 
           if(l_size_next > l_size_prev) {
-              if(l_size_next <= (std::size_t)std::numeric_limits<int>::max()) {
+              if(l_size_next <= (std::size_t)std::numeric_limits<std::int64_t>::max()) {
                   auto  l_size_new = l_size_next;
                   auto  l_copy_ptr = reinterpret_cast<char*>(m_resource->allocate(l_size_next, alignof(std::size_t)));
                   if(l_copy_ptr) {
@@ -728,7 +1088,7 @@ void  bio::release() noexcept
       m_commit_bit = false;
 }
 
-std::int32_t bio::get_capacity() const noexcept
+std::int64_t bio::get_capacity() const noexcept
 {
       return m_data_tail - m_data_head;
 }
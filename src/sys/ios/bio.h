@@ -34,11 +34,11 @@ class bio: public sys::ios
 
   protected:
   char*         m_data_head;
-  std::int32_t  m_file_pos;         // actual file pointer, before the last read operation
-  std::int32_t  m_read_pos;         // internal file pointer (buffer base)
-  std::int32_t  m_read_iter;        // current position, relative to m_read_pos
-  std::int32_t  m_read_size;        // size of the read data, relative to m_read_pos
-  std::int32_t  m_save_size;        // size of the data pending write
+  std::int64_t  m_file_pos;         // actual file pointer, before the last read operation
+  std::int64_t  m_read_pos;         // internal file pointer (buffer base)
+  std::int64_t  m_read_iter;        // current position, relative to m_read_pos
+  std::int64_t  m_read_size;        // size of the read data, relative to m_read_pos
+  std::int64_t  m_save_size;        // size of the data pending write
   char*         m_data_tail;
   char          m_eol;
   unsigned int  m_lock_ctr:8;       // lock the buffer
@@ -50,6 +50,7 @@ class bio: public sys::ios
 
   protected:
           bool  load(std::size_t, bool) noexcept;
+          bool  fill() noexcept;
           void  unload() noexcept;
 
   public:
@@ -62,28 +63,31 @@ class bio: public sys::ios
 
           void          set_source(ios*) noexcept;
 
-  virtual std::int32_t  seek(std::int32_t, std::int32_t) noexcept override;
+  virtual std::int64_t  seek(std::int64_t, std::int32_t) noexcept override;
 
-          std::int32_t  lock() noexcept;
+          std::int64_t  lock() noexcept;
   
   virtual int           get_char() noexcept override;
   virtual unsigned int  get_byte() noexcept override;
 
           char*         get_line() noexcept;
           char*         get_line(std::int32_t&) noexcept;
+          std::int32_t  get_lines(char**, std::int32_t*, std::int32_t) noexcept;
    
-          std::int32_t  read() noexcept;
-  virtual std::int32_t  read(std::size_t) noexcept override;
-  virtual std::int32_t  read(std::size_t, char*) noexcept override;
+          std::int64_t  read() noexcept;
+  virtual std::int64_t  read(std::size_t) noexcept override;
+  virtual std::int64_t  read(std::size_t, char*) noexcept override;
+  virtual std::int64_t  readv(const iovec*, std::size_t) noexcept override;
 
   virtual std::int32_t  put_char(char) noexcept override;
   virtual std::int32_t  put_byte(unsigned char) noexcept override;
-  virtual std::int32_t  write(std::size_t, const char*) noexcept override;
+  virtual std::int64_t  write(std::size_t, const char*) noexcept override;
+  virtual std::int64_t  writev(const iovec*, std::size_t) noexcept override;
 
           void          flush() noexcept;
 
           char*         get_data() noexcept;
-  virtual std::int32_t  get_size() noexcept override;
+  virtual std::int64_t  get_size() noexcept override;
           void          unlock() noexcept;
 
   virtual bool  is_seekable() const noexcept override;
@@ -95,7 +99,7 @@ class bio: public sys::ios
           void  reset(bool = true) noexcept;
           void  release() noexcept;
 
-          std::int32_t  get_capacity() const noexcept;
+          std::int64_t  get_capacity() const noexcept;
 
           operator ios*() noexcept;
           operator bool() const noexcept;
@@ -0,0 +1,252 @@
+/** 
+    Copyright (c) 2016-2020, wicked systems
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+    conditions are met:
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+      disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following 
+      disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of wicked systems nor the names of its contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+    INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+    EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**/
+#include "cio.h"
+
+      cio::cio() noexcept:
+      cio(nullptr)
+{
+}
+
+      cio::cio(ios* io) noexcept:
+      m_io(io),
+      m_read_sum(0),
+      m_save_sum(0)
+{
+      reset_sum();
+}
+
+      cio::cio(const cio& copy) noexcept:
+      m_io(copy.m_io),
+      m_read_sum(copy.m_read_sum),
+      m_save_sum(copy.m_save_sum)
+{
+}
+
+      cio::cio(cio&& copy) noexcept:
+      m_io(copy.m_io),
+      m_read_sum(copy.m_read_sum),
+      m_save_sum(copy.m_save_sum)
+{
+      copy.release();
+}
+
+      cio::~cio()
+{
+}
+
+/* set_source()
+   attach to a new source stream; the checksums are restarted
+*/
+void  cio::set_source(ios* io) noexcept
+{
+      m_io = io;
+      reset_sum();
+}
+
+int   cio::get_char() noexcept
+{
+      if(m_io) {
+          int l_result = m_io->get_char();
+          if(l_result != EOF) {
+              char l_char = l_result;
+              crc32c::add(m_read_sum, std::addressof(l_char), 1);
+          }
+          return l_result;
+      }
+      return EOF;
+}
+
+unsigned int cio::get_byte() noexcept
+{
+      if(m_io) {
+          unsigned int l_result = m_io->get_byte();
+          if(l_result != static_cast<unsigned int>(EOF)) {
+              char l_char = l_result;
+              crc32c::add(m_read_sum, std::addressof(l_char), 1);
+          }
+          return l_result;
+      }
+      return static_cast<unsigned int>(EOF);
+}
+
+/* seek()
+   seeking is passed through to the source stream and does not affect the checksums
+*/
+std::int64_t cio::seek(std::int64_t offset, std::int32_t whence) noexcept
+{
+      if(m_io) {
+          return m_io->seek(offset, whence);
+      }
+      return -1;
+}
+
+/* read()
+   skip <count> bytes; the data has to be pulled through a local buffer so that it still
+   counts towards the read checksum
+*/
+std::int64_t cio::read(std::size_t count) noexcept
+{
+      char         l_data[256];
+      std::int64_t l_result = 0;
+      while(count) {
+          std::size_t  l_load_size = count;
+          if(l_load_size > sizeof(l_data)) {
+              l_load_size = sizeof(l_data);
+          }
+          std::int64_t l_read_size = read(l_load_size, l_data);
+          if(l_read_size > 0) {
+              l_result += l_read_size;
+              count    -= l_read_size;
+          } else
+              break;
+      }
+      return l_result;
+}
+
+std::int64_t cio::read(std::size_t count, char* memory) noexcept
+{
+      if(memory == nullptr) {
+          return read(count);
+      }
+      if(m_io) {
+          std::int64_t l_result = m_io->read(count, memory);
+          if(l_result > 0) {
+              crc32c::add(m_read_sum, memory, l_result);
+          }
+          return l_result;
+      }
+      return 0;
+}
+
+std::int32_t cio::put_char(char value) noexcept
+{
+      return write(1, std::addressof(value));
+}
+
+std::int32_t cio::put_byte(unsigned char value) noexcept
+{
+      return write(1, reinterpret_cast<char*>(std::addressof(value)));
+}
+
+/* write()
+   only the bytes accepted by the source stream are accounted for
+*/
+std::int64_t cio::write(std::size_t size, const char* data) noexcept
+{
+      if(m_io) {
+          std::int64_t l_result = m_io->write(size, data);
+          if(l_result > 0) {
+              crc32c::add(m_save_sum, data, l_result);
+          }
+          return l_result;
+      }
+      return 0;
+}
+
+std::int64_t cio::get_size() noexcept
+{
+      if(m_io) {
+          return m_io->get_size();
+      }
+      return 0;
+}
+
+/* get_read_sum()
+   finalized crc32c of all the data read so far
+*/
+std::uint32_t cio::get_read_sum() const noexcept
+{
+      return crc32c::get(m_read_sum);
+}
+
+/* get_save_sum()
+   finalized crc32c of all the data written so far
+*/
+std::uint32_t cio::get_save_sum() const noexcept
+{
+      return crc32c::get(m_save_sum);
+}
+
+void  cio::reset_sum() noexcept
+{
+      crc32c::set(m_read_sum);
+      crc32c::set(m_save_sum);
+}
+
+bool  cio::is_seekable() const noexcept
+{
+      if(m_io) {
+          return m_io->is_seekable();
+      }
+      return false;
+}
+
+bool  cio::is_readable() const noexcept
+{
+      if(m_io) {
+          return m_io->is_readable();
+      }
+      return false;
+}
+
+bool  cio::is_writable() const noexcept
+{
+      if(m_io) {
+          return m_io->is_writable();
+      }
+      return false;
+}
+
+void  cio::release() noexcept
+{
+      m_io = nullptr;
+      reset_sum();
+}
+
+      cio::operator ios*() noexcept
+{
+      return this;
+}
+
+      cio::operator bool() const noexcept
+{
+      return m_io;
+}
+
+cio&  cio::operator=(const cio& rhs) noexcept
+{
+      m_io       = rhs.m_io;
+      m_read_sum = rhs.m_read_sum;
+      m_save_sum = rhs.m_save_sum;
+      return *this;
+}
+
+cio&  cio::operator=(cio&& rhs) noexcept
+{
+      if(std::addressof(rhs) != this) {
+          m_io       = rhs.m_io;
+          m_read_sum = rhs.m_read_sum;
+          m_save_sum = rhs.m_save_sum;
+          rhs.release();
+      }
+      return *this;
+}
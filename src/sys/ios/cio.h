@@ -0,0 +1,75 @@
+#ifndef sys_cio_h
+#define sys_cio_h
+/** 
+    Copyright (c) 2016-2020, wicked systems
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+    conditions are met:
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+      disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following 
+      disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of wicked systems nor the names of its contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+    INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+    EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**/
+#include <sys.h>
+#include <sys/ios.h>
+#include <hash.h>
+
+/* cio
+   checksum filter: passes all traffic through to a source stream, while accumulating a
+   crc32c of the data read from it and of the data written to it
+*/
+class cio: public sys::ios
+{
+  ios*          m_io;
+  std::uint32_t m_read_sum;
+  std::uint32_t m_save_sum;
+
+  public:
+          cio() noexcept;
+          cio(ios*) noexcept;
+          cio(const cio&) noexcept;
+          cio(cio&&) noexcept;
+  virtual ~cio();
+
+          void          set_source(ios*) noexcept;
+
+  virtual int           get_char() noexcept override;
+  virtual unsigned int  get_byte() noexcept override;
+
+  virtual std::int64_t  seek(std::int64_t, std::int32_t) noexcept override;
+  virtual std::int64_t  read(std::size_t) noexcept override;
+  virtual std::int64_t  read(std::size_t, char*) noexcept override;
+
+  virtual std::int32_t  put_char(char) noexcept override;
+  virtual std::int32_t  put_byte(unsigned char) noexcept override;
+  virtual std::int64_t  write(std::size_t, const char*) noexcept override;
+
+  virtual std::int64_t  get_size() noexcept override;
+
+          std::uint32_t get_read_sum() const noexcept;
+          std::uint32_t get_save_sum() const noexcept;
+          void          reset_sum() noexcept;
+
+  virtual bool  is_seekable() const noexcept override;
+  virtual bool  is_readable() const noexcept override;
+  virtual bool  is_writable() const noexcept override;
+
+          void  release() noexcept;
+
+          operator ios*() noexcept;
+          operator bool() const noexcept;
+          cio& operator=(const cio&) noexcept;
+          cio& operator=(cio&&) noexcept;
+};
+#endif
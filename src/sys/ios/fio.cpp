@@ -22,6 +22,7 @@
 #include "fio.h"
 #include <unistd.h>
 #include <fcntl.h>
+#include <climits>
 
       fio::fio() noexcept:
       m_desc(undef),
@@ -41,7 +42,7 @@
           if(mode & O_NONBLOCK) {
               set_blocking(false);
           }
-          m_seekable = seek(SEEK_CUR, 0) >= 0;
+          m_seekable = seek(0, SEEK_CUR) >= 0;
       }
 }
 
@@ -105,7 +106,7 @@ bool  fio::open(const char* name, int mode, int permissions) noexcept
           if(m_desc > undef) {
               m_mode = mode & 65535;
               m_own = true;
-              m_seekable = seek(SEEK_CUR, 0) >= 0;
+              m_seekable = seek(0, SEEK_CUR) >= 0;
               if(mode & O_NONBLOCK) {
                   set_blocking(false);
               }
@@ -122,7 +123,7 @@ bool  fio::copy(int desc, int mode) noexcept
       m_desc     = dup(desc);
       m_mode     = mode & 65535;
       m_own      = true;
-      m_seekable = seek(SEEK_CUR, 0) >= 0;
+      m_seekable = seek(0, SEEK_CUR) >= 0;
       if(mode & O_NONBLOCK) {
           set_blocking(false);
       }
@@ -135,7 +136,7 @@ bool  fio::move(int& desc, int mode) noexcept
       m_desc     = desc;
       m_mode     = mode & 65535;
       m_own      = true;
-      m_seekable = seek(SEEK_CUR, 0) >= 0;
+      m_seekable = seek(0, SEEK_CUR) >= 0;
       if(m_desc > undef) {
           if(mode & O_NONBLOCK) {
               set_blocking(false);
@@ -166,21 +167,32 @@ unsigned int  fio::get_byte() noexcept
           return EOF;
 }
 
-std::int32_t fio::seek(std::int32_t offset, std::int32_t whence) noexcept
+std::int64_t fio::seek(std::int64_t offset, std::int32_t whence) noexcept
 {
       return ::lseek(m_desc, offset, whence);
 }
 
-std::int32_t fio::read(std::size_t count) noexcept
+std::int64_t fio::read(std::size_t count) noexcept
 {
       return ::lseek(m_desc, count, SEEK_CUR);
 }
 
-std::int32_t fio::read(std::size_t count, char* memory) noexcept
+std::int64_t fio::read(std::size_t count, char* memory) noexcept
 {
       return ::read(m_desc, memory, count);
 }
 
+/* readv()
+   a single ::readv() call, for up to IOV_MAX segments
+*/
+std::int64_t fio::readv(const iovec* list, std::size_t count) noexcept
+{
+      if(count > IOV_MAX) {
+          count = IOV_MAX;
+      }
+      return ::readv(m_desc, list, count);
+}
+
 std::int32_t fio::put_char(char value) noexcept
 {
       return write(1, std::addressof(value));
@@ -191,12 +203,23 @@ std::int32_t fio::put_byte(unsigned char value) noexcept
       return write(1, reinterpret_cast<char*>(std::addressof(value)));
 }
 
-std::int32_t fio::write(std::size_t size, const char* data) noexcept
+std::int64_t fio::write(std::size_t size, const char* data) noexcept
 {
       return ::write(m_desc, data, size);
 }
 
-std::int32_t fio::get_size() noexcept
+/* writev()
+   a single ::writev() call, for up to IOV_MAX segments
+*/
+std::int64_t fio::writev(const iovec* list, std::size_t count) noexcept
+{
+      if(count > IOV_MAX) {
+          count = IOV_MAX;
+      }
+      return ::writev(m_desc, list, count);
+}
+
+std::int64_t fio::get_size() noexcept
 {
       if(m_desc > undef) {
           off_t l_pos = ::lseek(m_desc, 0, SEEK_CUR);
@@ -205,7 +228,7 @@ std::int32_t fio::get_size() noexcept
               if(l_pos != l_size) {
                   ::lseek(m_desc, l_pos, SEEK_SET);
               }
-              if(l_size < std::numeric_limits<std::int32_t>::max()) {
+              if(l_size >= 0) {
                   return l_size;
               }
           }
@@ -57,16 +57,18 @@ class fio: public sys::ios
   virtual int           get_char() noexcept override;
   virtual unsigned int  get_byte() noexcept override;
 
-  virtual std::int32_t  seek(std::int32_t, std::int32_t) noexcept override;
-  virtual std::int32_t  read(std::size_t) noexcept override;
-  virtual std::int32_t  read(std::size_t, char*) noexcept override;
+  virtual std::int64_t  seek(std::int64_t, std::int32_t) noexcept override;
+  virtual std::int64_t  read(std::size_t) noexcept override;
+  virtual std::int64_t  read(std::size_t, char*) noexcept override;
+  virtual std::int64_t  readv(const iovec*, std::size_t) noexcept override;
 
   virtual std::int32_t  put_char(char) noexcept override;
   virtual std::int32_t  put_byte(unsigned char) noexcept override;
 
-  virtual std::int32_t  write(std::size_t, const char*) noexcept override;
+  virtual std::int64_t  write(std::size_t, const char*) noexcept override;
+  virtual std::int64_t  writev(const iovec*, std::size_t) noexcept override;
 
-  virtual std::int32_t  get_size()  noexcept override;
+  virtual std::int64_t  get_size()  noexcept override;
 
           bool  set_blocking(bool = true) noexcept;
           bool  set_nonblocking() noexcept;
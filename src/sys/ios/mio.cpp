@@ -0,0 +1,412 @@
+/** 
+    Copyright (c) 2016-2020, wicked systems
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+    conditions are met:
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+      disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following 
+      disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of wicked systems nor the names of its contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+    INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+    EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**/
+#include "mio.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+
+static std::size_t get_page_size() noexcept
+{
+      static std::size_t s_page_size = sysconf(_SC_PAGESIZE);
+      return s_page_size;
+}
+
+      mio::mio() noexcept:
+      m_file(),
+      m_map_data(nullptr),
+      m_map_pos(0),
+      m_map_size(0),
+      m_file_pos(0),
+      m_file_size(0),
+      m_window_size(0),
+      m_advice(MADV_SEQUENTIAL),
+      m_eol('\n')
+{
+}
+
+      mio::mio(int desc, int mode, std::size_t window_size) noexcept:
+      mio()
+{
+      move(desc, mode, window_size);
+}
+
+      mio::mio(const char* name, int mode, std::size_t window_size) noexcept:
+      mio()
+{
+      open(name, mode, window_size);
+}
+
+      mio::mio(mio&& copy) noexcept:
+      m_file(std::move(copy.m_file)),
+      m_map_data(copy.m_map_data),
+      m_map_pos(copy.m_map_pos),
+      m_map_size(copy.m_map_size),
+      m_file_pos(copy.m_file_pos),
+      m_file_size(copy.m_file_size),
+      m_window_size(copy.m_window_size),
+      m_advice(copy.m_advice),
+      m_eol(copy.m_eol)
+{
+      copy.m_map_data = nullptr;
+      copy.close();
+}
+
+      mio::~mio()
+{
+      close();
+}
+
+/* setup()
+   check that the file can be mapped and find its size
+*/
+bool  mio::setup(std::size_t window_size) noexcept
+{
+      struct stat l_stat;
+      if((fstat(m_file.get_fd(), std::addressof(l_stat)) != 0) ||
+          (S_ISREG(l_stat.st_mode) == false)) {
+          close();
+          return false;
+      }
+      std::size_t l_page_size = get_page_size();
+      m_file_size = l_stat.st_size;
+      m_window_size = (window_size + l_page_size - 1) & ~(l_page_size - 1);
+      if(m_window_size == 0) {
+          m_window_size = l_page_size;
+      }
+      return true;
+}
+
+/* map()
+   make sure the range of <size> bytes at <offset>, up to the end of the file, is mapped; a new
+   mapping starts at the page holding <offset> and spans at least a window
+*/
+bool  mio::map(std::int64_t offset, std::size_t size) noexcept
+{
+      if(offset + static_cast<std::int64_t>(size) > m_file_size) {
+          // the file may have grown since
+          struct stat l_stat;
+          if(fstat(m_file.get_fd(), std::addressof(l_stat)) == 0) {
+              m_file_size = l_stat.st_size;
+          }
+      }
+      std::int64_t l_tail = offset + static_cast<std::int64_t>(size);
+      if(l_tail > m_file_size) {
+          l_tail = m_file_size;
+      }
+      if((offset < 0) ||
+          (offset >= l_tail)) {
+          return false;
+      }
+      if(m_map_data) {
+          if((offset >= m_map_pos) &&
+              (l_tail <= m_map_pos + static_cast<std::int64_t>(m_map_size))) {
+              return true;
+          }
+          unmap();
+      }
+      std::int64_t l_map_pos = offset & ~static_cast<std::int64_t>(get_page_size() - 1);
+      std::int64_t l_map_tail = l_map_pos + m_window_size;
+      if(l_map_tail < l_tail) {
+          l_map_tail = l_tail;
+      }
+      if(l_map_tail > m_file_size) {
+          l_map_tail = m_file_size;
+      }
+      std::size_t l_map_size = l_map_tail - l_map_pos;
+      void* l_map_data = mmap(nullptr, l_map_size, PROT_READ, MAP_SHARED, m_file.get_fd(), l_map_pos);
+      if(l_map_data == MAP_FAILED) {
+          return false;
+      }
+      if(m_advice != MADV_NORMAL) {
+          madvise(l_map_data, l_map_size, m_advice);
+          if(m_advice == MADV_SEQUENTIAL) {
+              // start reading the whole window in, rather than waiting for the first faults
+              madvise(l_map_data, l_map_size, MADV_WILLNEED);
+          }
+      }
+      m_map_data = static_cast<char*>(l_map_data);
+      m_map_pos  = l_map_pos;
+      m_map_size = l_map_size;
+      return true;
+}
+
+void  mio::unmap() noexcept
+{
+      if(m_map_data) {
+          munmap(m_map_data, m_map_size);
+          m_map_data = nullptr;
+          m_map_pos  = 0;
+          m_map_size = 0;
+      }
+}
+
+bool  mio::open(const char* name, int mode, std::size_t window_size) noexcept
+{
+      close();
+      if(m_file.open(name, (mode & ~(O_ACCMODE | O_CREAT | O_TRUNC)) | O_RDONLY, 0)) {
+          return setup(window_size);
+      }
+      return false;
+}
+
+bool  mio::move(int& desc, int mode, std::size_t window_size) noexcept
+{
+      close();
+      if(m_file.move(desc, mode)) {
+          if(setup(window_size)) {
+              m_file_pos = ::lseek(m_file.get_fd(), 0, SEEK_CUR);
+              if(m_file_pos < 0) {
+                  m_file_pos = 0;
+              }
+              return true;
+          }
+      }
+      return false;
+}
+
+void  mio::set_advice(int advice) noexcept
+{
+      m_advice = advice;
+      if(m_map_data) {
+          madvise(m_map_data, m_map_size, m_advice);
+      }
+}
+
+int   mio::get_char() noexcept
+{
+      if(map(m_file_pos, 1)) {
+          return m_map_data[m_file_pos++ - m_map_pos];
+      }
+      return EOF;
+}
+
+unsigned int mio::get_byte() noexcept
+{
+      if(map(m_file_pos, 1)) {
+          return static_cast<unsigned char>(m_map_data[m_file_pos++ - m_map_pos]);
+      }
+      return static_cast<unsigned int>(EOF);
+}
+
+char* mio::get_span(std::size_t count, std::int32_t& length) noexcept
+{
+      if(count > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max())) {
+          count = std::numeric_limits<std::int32_t>::max();
+      }
+      if(map(m_file_pos, count)) {
+          char*        l_result = m_map_data + (m_file_pos - m_map_pos);
+          std::int64_t l_size   = m_file_size - m_file_pos;
+          if(l_size > static_cast<std::int64_t>(count)) {
+              l_size = count;
+          }
+          m_file_pos += l_size;
+          length = l_size;
+          return l_result;
+      }
+      length = 0;
+      return nullptr;
+}
+
+char* mio::get_line(std::int32_t& length) noexcept
+{
+      std::size_t l_scan_size = 0;
+      while(map(m_file_pos, l_scan_size + 1)) {
+          char*       l_line = m_map_data + (m_file_pos - m_map_pos);
+          std::size_t l_size = m_map_pos + m_map_size - m_file_pos;
+          if(void* l_eol = std::memchr(l_line + l_scan_size, m_eol, l_size - l_scan_size); l_eol != nullptr) {
+              length = static_cast<char*>(l_eol) - l_line;
+              m_file_pos += length + 1;
+              return l_line;
+          }
+          if(m_map_pos + static_cast<std::int64_t>(m_map_size) >= m_file_size) {
+              // last line, without an end of line character
+              length = l_size;
+              m_file_pos += l_size;
+              return l_line;
+          }
+          // the line runs past the mapping: map again from its start, at least twice as far
+          l_scan_size = l_size;
+          if(map(m_file_pos, l_scan_size * 2) == false) {
+              break;
+          }
+      }
+      length = -1;
+      return nullptr;
+}
+
+/* seek()
+   move the file position, as documented by ::lseek(); nothing is mapped until data is asked for
+*/
+std::int64_t mio::seek(std::int64_t offset, std::int32_t whence) noexcept
+{
+      std::int64_t l_file_pos;
+      if(whence == SEEK_SET) {
+          l_file_pos = offset;
+      } else
+      if(whence == SEEK_CUR) {
+          l_file_pos = m_file_pos + offset;
+      } else
+      if(whence == SEEK_END) {
+          l_file_pos = get_size() + offset;
+      } else
+          return -1;
+      if(l_file_pos < 0) {
+          return -1;
+      }
+      m_file_pos = l_file_pos;
+      return m_file_pos;
+}
+
+/* read()
+   skip <count> bytes, up to the end of the file
+*/
+std::int64_t mio::read(std::size_t count) noexcept
+{
+      std::int64_t l_size = get_size() - m_file_pos;
+      if(l_size <= 0) {
+          return 0;
+      }
+      if(l_size > static_cast<std::int64_t>(count)) {
+          l_size = count;
+      }
+      m_file_pos += l_size;
+      return l_size;
+}
+
+std::int64_t mio::read(std::size_t count, char* memory) noexcept
+{
+      std::int64_t l_result = 0;
+      while(count) {
+          std::size_t l_load_size = count < m_window_size ? count : m_window_size;
+          if(map(m_file_pos, l_load_size) == false) {
+              break;
+          }
+          std::size_t l_copy_size = m_map_pos + m_map_size - m_file_pos;
+          if(l_copy_size > count) {
+              l_copy_size = count;
+          }
+          std::memcpy(memory, m_map_data + (m_file_pos - m_map_pos), l_copy_size);
+          m_file_pos += l_copy_size;
+          memory     += l_copy_size;
+          count      -= l_copy_size;
+          l_result   += l_copy_size;
+      }
+      return l_result;
+}
+
+std::int32_t mio::put_char(char) noexcept
+{
+      return 0;
+}
+
+std::int32_t mio::put_byte(unsigned char) noexcept
+{
+      return 0;
+}
+
+std::int64_t mio::write(std::size_t, const char*) noexcept
+{
+      return 0;
+}
+
+char* mio::get_data() noexcept
+{
+      if(map(m_file_pos, 1)) {
+          return m_map_data + (m_file_pos - m_map_pos);
+      }
+      return nullptr;
+}
+
+std::int64_t mio::get_data_size() noexcept
+{
+      if(map(m_file_pos, 1)) {
+          return m_map_pos + m_map_size - m_file_pos;
+      }
+      return 0;
+}
+
+std::int64_t mio::get_size() noexcept
+{
+      struct stat l_stat;
+      if(fstat(m_file.get_fd(), std::addressof(l_stat)) == 0) {
+          m_file_size = l_stat.st_size;
+      }
+      return m_file_size;
+}
+
+int   mio::get_fd() const noexcept
+{
+      return m_file.get_fd();
+}
+
+bool  mio::is_seekable() const noexcept
+{
+      return true;
+}
+
+bool  mio::is_readable() const noexcept
+{
+      return true;
+}
+
+bool  mio::is_writable() const noexcept
+{
+      return false;
+}
+
+void  mio::close() noexcept
+{
+      unmap();
+      m_file.close(true);
+      m_file_pos  = 0;
+      m_file_size = 0;
+}
+
+      mio::operator sys::ios*() noexcept
+{
+      return this;
+}
+
+      mio::operator bool() const noexcept
+{
+      return m_file;
+}
+
+mio&  mio::operator=(mio&& rhs) noexcept
+{
+      if(this != std::addressof(rhs)) {
+          close();
+          m_file = std::move(rhs.m_file);
+          m_map_data = rhs.m_map_data;
+          m_map_pos = rhs.m_map_pos;
+          m_map_size = rhs.m_map_size;
+          m_file_pos = rhs.m_file_pos;
+          m_file_size = rhs.m_file_size;
+          m_window_size = rhs.m_window_size;
+          m_advice = rhs.m_advice;
+          m_eol = rhs.m_eol;
+          rhs.m_map_data = nullptr;
+          rhs.close();
+      }
+      return *this;
+}
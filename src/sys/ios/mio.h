@@ -0,0 +1,113 @@
+#ifndef sys_mio_h
+#define sys_mio_h
+/** 
+    Copyright (c) 2016-2020, wicked systems
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+    conditions are met:
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+      disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following 
+      disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of wicked systems nor the names of its contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+    INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+    EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**/
+#include <sys.h>
+#include <sys/ios.h>
+#include <sys/ios/fio.h>
+#include <fcntl.h>
+
+/* mio
+   read-only file stream over a memory mapping; get_data(), get_span() and get_line() hand out
+   pointers into the mapping instead of copying. Large files are mapped one window at a time,
+   so pointers stay valid only until the next call that moves past the current window.
+   The file must not be truncated while mapped.
+*/
+class mio: public sys::ios
+{
+  fio           m_file;
+  char*         m_map_data;
+  std::int64_t  m_map_pos;          // file offset of the mapping
+  std::size_t   m_map_size;
+  std::int64_t  m_file_pos;
+  std::int64_t  m_file_size;
+  std::size_t   m_window_size;
+  int           m_advice;
+  char          m_eol;
+
+  public:
+  static constexpr std::size_t window_size_default = 67108864;
+
+  private:
+          bool  setup(std::size_t) noexcept;
+          bool  map(std::int64_t, std::size_t) noexcept;
+          void  unmap() noexcept;
+
+  public:
+          mio() noexcept;
+          mio(int, int = O_RDONLY, std::size_t = window_size_default) noexcept;
+          mio(const char*, int = O_RDONLY, std::size_t = window_size_default) noexcept;
+          mio(const mio&) noexcept = delete;
+          mio(mio&&) noexcept;
+  virtual ~mio();
+
+          bool  open(const char*, int = O_RDONLY, std::size_t = window_size_default) noexcept;
+          bool  move(int&, int = O_RDONLY, std::size_t = window_size_default) noexcept;
+
+  /* set_advice()
+     access pattern hint applied to every window mapped, MADV_SEQUENTIAL by default
+  */
+          void  set_advice(int) noexcept;
+
+  virtual int           get_char() noexcept override;
+  virtual unsigned int  get_byte() noexcept override;
+
+  /* get_span()
+     map the next <count> bytes as one contiguous span and move past them; <length> is set to
+     the size of the span, short at the end of the file
+  */
+          char*         get_span(std::size_t, std::int32_t&) noexcept;
+
+  /* get_line()
+     the next line, up to and excluding the end of line character; the line is not zero
+     terminated, <length> is set to its size, or to -1 at the end of the file
+  */
+          char*         get_line(std::int32_t&) noexcept;
+
+  virtual std::int64_t  seek(std::int64_t, std::int32_t) noexcept override;
+  virtual std::int64_t  read(std::size_t) noexcept override;
+  virtual std::int64_t  read(std::size_t, char*) noexcept override;
+
+  virtual std::int32_t  put_char(char) noexcept override;
+  virtual std::int32_t  put_byte(unsigned char) noexcept override;
+  virtual std::int64_t  write(std::size_t, const char*) noexcept override;
+
+  /* get_data()
+     data at the current position, valid for get_data_size() bytes
+  */
+          char*         get_data() noexcept;
+          std::int64_t  get_data_size() noexcept;
+  virtual std::int64_t  get_size() noexcept override;
+
+          int   get_fd() const noexcept;
+
+  virtual bool  is_seekable() const noexcept override;
+  virtual bool  is_readable() const noexcept override;
+  virtual bool  is_writable() const noexcept override;
+
+          void  close() noexcept;
+          operator ios*() noexcept;
+          operator bool() const noexcept;
+          mio&  operator=(const mio&) noexcept = delete;
+          mio&  operator=(mio&&) noexcept;
+};
+#endif
@@ -114,14 +114,11 @@ unsigned int sio::get_byte() noexcept
       return l_result;
 }
 
-std::int32_t sio::load(const char* data, std::size_t size) noexcept
+std::int64_t sio::load(const char* data, std::size_t size) noexcept
 {
       if(data) {
           if(size == 0) {
               size = std::strlen(data) + 1;
-              if(size > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max())) {
-                  return 0;
-              }
           }
           if(reserve(size)) {
               std::memcpy(m_data_head, data, size);
@@ -133,7 +130,7 @@ std::int32_t sio::load(const char* data, std::size_t size) noexcept
       return 0;
 }
 
-std::int32_t sio::seek(std::int32_t offset, std::int32_t whence) noexcept
+std::int64_t sio::seek(std::int64_t offset, std::int32_t whence) noexcept
 {
       if(whence == SEEK_SET) {
           if(offset < m_read_size) {
@@ -142,7 +139,7 @@ std::int32_t sio::seek(std::int32_t offset, std::int32_t whence) noexcept
               return -1;
       } else
       if(whence == SEEK_CUR) {
-          std::int32_t l_pos = m_read_iter - m_data_head;
+          std::int64_t l_pos = m_read_iter - m_data_head;
           if(offset > 0) {
               if(l_pos > 0) {
                   if(offset > m_read_size - l_pos) {
@@ -171,12 +168,12 @@ std::int32_t sio::seek(std::int32_t offset, std::int32_t whence) noexcept
       return m_read_iter - m_data_head;
 }
 
-std::int32_t sio::read(std::size_t count) noexcept
+std::int64_t sio::read(std::size_t count) noexcept
 {
       if(count > 0) {
-          std::int32_t l_result;
-          std::int32_t l_offset_0 = m_read_iter - m_data_head;
-          std::int32_t l_offset_1 = l_offset_0 + count;
+          std::int64_t l_result;
+          std::int64_t l_offset_0 = m_read_iter - m_data_head;
+          std::int64_t l_offset_1 = l_offset_0 + count;
           if(l_offset_1 <= m_read_size) {
               l_result = count;
           } else
@@ -187,22 +184,19 @@ std::int32_t sio::read(std::size_t count) noexcept
       return 0;
 }
 
-std::int32_t sio::read(std::size_t count, char* memory) noexcept
+std::int64_t sio::read(std::size_t count, char* memory) noexcept
 {
       if(memory != nullptr) {
-          char* l_copy_ptr = memory;
-          char* l_copy_pos = memory;
-          int   l_char;
-          while(count) {
-              l_char = get_char();
-              if(l_char != EOF) {
-                  *l_copy_pos = l_char;
-                  l_copy_pos++;
-              } else
-                  break;
-              count--;
+          std::int64_t l_copy_size = m_read_size - (m_read_iter - m_data_head);
+          if(l_copy_size > 0) {
+              if(l_copy_size > static_cast<std::int64_t>(count)) {
+                  l_copy_size = count;
+              }
+              std::memcpy(memory, m_read_iter, l_copy_size);
+              m_read_iter += l_copy_size;
+              return l_copy_size;
           }
-          return l_copy_pos - l_copy_ptr;
+          return 0;
       }
       return read(count);
 }
@@ -217,11 +211,11 @@ std::int32_t sio::put_byte(unsigned char value) noexcept
       return write(1, reinterpret_cast<char*>(std::addressof(value)));
 }
 
-std::int32_t sio::write(std::size_t size, const char* data) noexcept
+std::int64_t sio::write(std::size_t size, const char* data) noexcept
 {
       if(data) {
           if(size) {
-              std::int32_t l_read_size = m_read_size + size;
+              std::int64_t l_read_size = m_read_size + size;
               if(reserve(l_read_size)) {
                   std::memcpy(m_data_head + m_read_size, data, size);
                   m_read_size = l_read_size;
@@ -232,12 +226,37 @@ std::int32_t sio::write(std::size_t size, const char* data) noexcept
       return 0;
 }
 
-std::int32_t sio::get_size() noexcept
+/* writev()
+   append all the segments, with a single reserve() for all of them
+*/
+std::int64_t sio::writev(const iovec* list, std::size_t count) noexcept
+{
+      std::size_t l_save_size = 0;
+      for(std::size_t l_index = 0; l_index < count; l_index++) {
+          if(list[l_index].iov_base) {
+              l_save_size += list[l_index].iov_len;
+          }
+      }
+      if(l_save_size) {
+          if(reserve(m_read_size + l_save_size)) {
+              for(std::size_t l_index = 0; l_index < count; l_index++) {
+                  if(list[l_index].iov_base) {
+                      std::memcpy(m_data_head + m_read_size, list[l_index].iov_base, list[l_index].iov_len);
+                      m_read_size += list[l_index].iov_len;
+                  }
+              }
+              return l_save_size;
+          }
+      }
+      return 0;
+}
+
+std::int64_t sio::get_size() noexcept
 {
       return m_read_size;
 }
 
-std::int32_t  sio::get_capacity() const noexcept
+std::int64_t  sio::get_capacity() const noexcept
 {
       return m_data_size;
 }
@@ -259,9 +278,9 @@ bool  sio::is_writable() const noexcept
 
 bool  sio::reserve(std::size_t size) noexcept
 {
-      char*         l_data_head;
-      std::uint32_t l_size_next = 0;
-      std::uint32_t l_size_prev = m_data_size;
+      char*       l_data_head;
+      std::size_t l_size_next = 0;
+      std::size_t l_size_prev = m_data_size;
       if(size > l_size_prev) {
           if(m_resource->has_fixed_size()) {
           // resource is static (a fixed block of memory has already been reserved for it)
@@ -281,7 +300,7 @@ bool  sio::reserve(std::size_t size) noexcept
               if(m_read_size == 0) {
                   l_size_next = m_resource->get_alloc_size(size);
               } else
-              if(std::size_t l_size_exp = m_resource->get_alloc_size(size); l_size_exp <= (std::size_t)std::numeric_limits<std::int32_t>::max()) {
+              if(std::size_t l_size_exp = m_resource->get_alloc_size(size); l_size_exp <= (std::size_t)std::numeric_limits<std::int64_t>::max()) {
                   auto  l_size_new = l_size_exp;
                   auto  l_copy_ptr = reinterpret_cast<char*>(m_resource->reallocate(m_data_head, l_size_prev, l_size_exp, alignof(std::size_t)));
                   if(l_copy_ptr) {
@@ -302,7 +321,7 @@ bool  sio::reserve(std::size_t size) noexcept
               return false;
 
           if(l_size_next > l_size_prev) {
-              if(l_size_next <= (std::size_t)std::numeric_limits<int>::max()) {
+              if(l_size_next <= (std::size_t)std::numeric_limits<std::int64_t>::max()) {
                   auto  l_size_new = l_size_next;
                   auto  l_copy_ptr = reinterpret_cast<char*>(m_resource->allocate(l_size_next, alignof(std::size_t)));
                   if(l_copy_ptr) {
@@ -34,8 +34,8 @@ class sio: public sys::ios
   protected:
   char*         m_data_head;
   char*         m_read_iter;
-  std::int32_t  m_read_size;
-  std::int32_t  m_data_size;
+  std::int64_t  m_read_size;
+  std::int64_t  m_data_size;
 
   protected:
           void   assign(const sio&) noexcept;
@@ -53,17 +53,18 @@ class sio: public sys::ios
   virtual int           get_char() noexcept override;
   virtual unsigned int  get_byte() noexcept override;
 
-          std::int32_t  load(const char*, std::size_t = 0) noexcept;
-  virtual std::int32_t  seek(std::int32_t, std::int32_t) noexcept override;
-  virtual std::int32_t  read(std::size_t) noexcept override;
-  virtual std::int32_t  read(std::size_t, char*) noexcept override;
+          std::int64_t  load(const char*, std::size_t = 0) noexcept;
+  virtual std::int64_t  seek(std::int64_t, std::int32_t) noexcept override;
+  virtual std::int64_t  read(std::size_t) noexcept override;
+  virtual std::int64_t  read(std::size_t, char*) noexcept override;
 
   virtual std::int32_t  put_char(char) noexcept override;
   virtual std::int32_t  put_byte(unsigned char) noexcept override;
-  virtual std::int32_t  write(std::size_t, const char*) noexcept override;
+  virtual std::int64_t  write(std::size_t, const char*) noexcept override;
+  virtual std::int64_t  writev(const iovec*, std::size_t) noexcept override;
 
-  virtual std::int32_t  get_size() noexcept override;
-          std::int32_t  get_capacity() const noexcept;
+  virtual std::int64_t  get_size() noexcept override;
+          std::int64_t  get_capacity() const noexcept;
 
   virtual bool  is_seekable() const noexcept override;
   virtual bool  is_readable() const noexcept override;
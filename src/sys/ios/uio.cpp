@@ -0,0 +1,974 @@
+/** 
+    Copyright (c) 2016-2020, wicked systems
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+    conditions are met:
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+      disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following 
+      disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of wicked systems nor the names of its contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+    INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+    EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**/
+#include "uio.h"
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+
+/* io_uring system calls, issued directly so as not to depend on liburing
+*/
+static int   io_uring_setup(unsigned int entries, io_uring_params* params) noexcept
+{
+      return syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int   io_uring_enter(int ring, unsigned int submit, unsigned int wait, unsigned int flags) noexcept
+{
+      return syscall(__NR_io_uring_enter, ring, submit, wait, flags, nullptr, 0);
+}
+
+static int   io_uring_register(int ring, unsigned int opcode, const void* args, unsigned int count) noexcept
+{
+      return syscall(__NR_io_uring_register, ring, opcode, args, count);
+}
+
+      uio::uio() noexcept:
+      m_file(),
+      m_resource(fragment::get_default()),
+      m_ring(undef),
+      m_file_index(undef),
+      m_depth(0),
+      m_file_pos(0),
+      m_sq_map(nullptr),
+      m_sq_map_size(0),
+      m_cq_map(nullptr),
+      m_cq_map_size(0),
+      m_sqe_map(nullptr),
+      m_sqe_map_size(0),
+      m_sq_head(nullptr),
+      m_sq_tail(nullptr),
+      m_sq_mask(0),
+      m_sq_entries(0),
+      m_sq_array(nullptr),
+      m_cq_head(nullptr),
+      m_cq_tail(nullptr),
+      m_cq_mask(0),
+      m_cqes(nullptr),
+      m_sq_pending(0),
+      m_inflight(0),
+      m_requests(nullptr),
+      m_free_list(nullptr),
+      m_free_count(0),
+      m_done_list(nullptr),
+      m_done_head(0),
+      m_done_count(0),
+      m_user_count(0),
+      m_buffers(nullptr),
+      m_buffer_count(0),
+      m_buffer_registered(false),
+      m_ahead_data(nullptr),
+      m_blocks(nullptr),
+      m_block_size(0),
+      m_block_count(0),
+      m_block_head(0),
+      m_block_idle(0)
+{
+}
+
+      uio::uio(int desc, int mode, unsigned int depth) noexcept:
+      uio()
+{
+      move(desc, mode, depth);
+}
+
+      uio::uio(const char* name, int mode, int permissions, unsigned int depth) noexcept:
+      uio()
+{
+      open(name, mode, permissions, depth);
+}
+
+      uio::~uio()
+{
+      close();
+}
+
+/* ring_open()
+   allocate the request slots and, unless <depth> is 0, set up the ring and register the file
+   with it; without a ring, requests complete synchronously as they are posted
+*/
+bool  uio::ring_open(unsigned int depth) noexcept
+{
+      m_depth = depth ? depth : depth_default;
+      m_requests = static_cast<request_t*>(m_resource->allocate(m_depth * sizeof(request_t), alignof(request_t)));
+      m_free_list = static_cast<int*>(m_resource->allocate(m_depth * sizeof(int), alignof(int)));
+      m_done_list = static_cast<int*>(m_resource->allocate(m_depth * sizeof(int), alignof(int)));
+      if((m_requests == nullptr) ||
+          (m_free_list == nullptr) ||
+          (m_done_list == nullptr)) {
+          ring_close();
+          return false;
+      }
+      for(unsigned int l_index = 0; l_index < m_depth; l_index++) {
+          m_free_list[l_index] = m_depth - l_index - 1;
+      }
+      m_free_count = m_depth;
+      if(depth == 0) {
+          return true;
+      }
+      io_uring_params l_params;
+      std::memset(std::addressof(l_params), 0, sizeof(l_params));
+      l_params.flags = IORING_SETUP_CLAMP;
+      m_ring = io_uring_setup(m_depth, std::addressof(l_params));
+      if(m_ring < 0) {
+          m_ring = undef;
+          return true;
+      }
+      m_sq_map_size = l_params.sq_off.array + l_params.sq_entries * sizeof(unsigned int);
+      m_cq_map_size = l_params.cq_off.cqes + l_params.cq_entries * sizeof(io_uring_cqe);
+      if(l_params.features & IORING_FEAT_SINGLE_MMAP) {
+          if(m_cq_map_size > m_sq_map_size) {
+              m_sq_map_size = m_cq_map_size;
+          }
+          m_cq_map_size = 0;
+      }
+      m_sqe_map_size = l_params.sq_entries * sizeof(io_uring_sqe);
+      m_sq_map = mmap(nullptr, m_sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_SQ_RING);
+      if(m_sq_map == MAP_FAILED) {
+          m_sq_map = nullptr;
+      }
+      if(m_cq_map_size) {
+          m_cq_map = mmap(nullptr, m_cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_CQ_RING);
+          if(m_cq_map == MAP_FAILED) {
+              m_cq_map = nullptr;
+          }
+      } else
+          m_cq_map = m_sq_map;
+      m_sqe_map = mmap(nullptr, m_sqe_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_SQES);
+      if(m_sqe_map == MAP_FAILED) {
+          m_sqe_map = nullptr;
+      }
+      if((m_sq_map == nullptr) ||
+          (m_cq_map == nullptr) ||
+          (m_sqe_map == nullptr)) {
+          ring_free();
+          return true;
+      }
+      char* l_sq_base = static_cast<char*>(m_sq_map);
+      char* l_cq_base = static_cast<char*>(m_cq_map);
+      m_sq_head = reinterpret_cast<unsigned int*>(l_sq_base + l_params.sq_off.head);
+      m_sq_tail = reinterpret_cast<unsigned int*>(l_sq_base + l_params.sq_off.tail);
+      m_sq_mask = *reinterpret_cast<unsigned int*>(l_sq_base + l_params.sq_off.ring_mask);
+      m_sq_entries = l_params.sq_entries;
+      m_sq_array = reinterpret_cast<unsigned int*>(l_sq_base + l_params.sq_off.array);
+      m_cq_head = reinterpret_cast<unsigned int*>(l_cq_base + l_params.cq_off.head);
+      m_cq_tail = reinterpret_cast<unsigned int*>(l_cq_base + l_params.cq_off.tail);
+      m_cq_mask = *reinterpret_cast<unsigned int*>(l_cq_base + l_params.cq_off.ring_mask);
+      m_cqes = l_cq_base + l_params.cq_off.cqes;
+      // registered file: requests refer to it by index, saving the descriptor lookup
+      int l_desc = m_file.get_fd();
+      if(io_uring_register(m_ring, IORING_REGISTER_FILES, std::addressof(l_desc), 1) == 0) {
+          m_file_index = 0;
+      }
+      return true;
+}
+
+/* ring_free()
+   unmap the rings and close the ring descriptor
+*/
+void  uio::ring_free() noexcept
+{
+      if(m_ring != undef) {
+          if(m_sqe_map) {
+              munmap(m_sqe_map, m_sqe_map_size);
+              m_sqe_map = nullptr;
+          }
+          if(m_cq_map && (m_cq_map != m_sq_map)) {
+              munmap(m_cq_map, m_cq_map_size);
+          }
+          m_cq_map = nullptr;
+          if(m_sq_map) {
+              munmap(m_sq_map, m_sq_map_size);
+              m_sq_map = nullptr;
+          }
+          ::close(m_ring);
+          m_ring = undef;
+      }
+      m_file_index = undef;
+      m_buffer_registered = false;
+}
+
+void  uio::ring_close() noexcept
+{
+      ring_free();
+      if(m_requests) {
+          m_resource->deallocate(m_requests, m_depth * sizeof(request_t), alignof(request_t));
+          m_requests = nullptr;
+      }
+      if(m_free_list) {
+          m_resource->deallocate(m_free_list, m_depth * sizeof(int), alignof(int));
+          m_free_list = nullptr;
+      }
+      if(m_done_list) {
+          m_resource->deallocate(m_done_list, m_depth * sizeof(int), alignof(int));
+          m_done_list = nullptr;
+      }
+      m_depth = 0;
+      m_sq_pending = 0;
+      m_inflight = 0;
+      m_free_count = 0;
+      m_done_head = 0;
+      m_done_count = 0;
+      m_user_count = 0;
+}
+
+/* ring_register_buffers()
+   register the readahead buffer, followed by the user buffers
+*/
+bool  uio::ring_register_buffers() noexcept
+{
+      if(m_ring == undef) {
+          return false;
+      }
+      if(m_buffer_registered) {
+          io_uring_register(m_ring, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+          m_buffer_registered = false;
+      }
+      unsigned int l_count = m_buffer_count + 1;
+      auto l_table = static_cast<struct iovec*>(m_resource->allocate(l_count * sizeof(struct iovec), alignof(struct iovec)));
+      if(l_table == nullptr) {
+          return false;
+      }
+      // an empty slot 0 still has to point somewhere: a readahead buffer of zero length is not
+      // accepted by the kernel
+      static char s_none[1];
+      l_table[0].iov_base = m_ahead_data ? m_ahead_data : s_none;
+      l_table[0].iov_len  = m_ahead_data ? m_block_count * m_block_size : sizeof(s_none);
+      for(unsigned int l_index = 0; l_index < m_buffer_count; l_index++) {
+          l_table[l_index + 1] = m_buffers[l_index];
+      }
+      m_buffer_registered = io_uring_register(m_ring, IORING_REGISTER_BUFFERS, l_table, l_count) == 0;
+      m_resource->deallocate(l_table, l_count * sizeof(struct iovec), alignof(struct iovec));
+      return m_buffer_registered;
+}
+
+/* ring_prepare()
+   fill in the next submission queue entry; the entry is sent by the next ring_submit()
+*/
+bool  uio::ring_prepare(int opcode, std::int64_t offset, std::size_t size, char* data, int slot, bool link) noexcept
+{
+      unsigned int l_tail = *m_sq_tail;
+      if(l_tail - __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE) >= m_sq_entries) {
+          // the submission queue is full: flush it, which also makes it a natural batch size
+          if(ring_submit(0) < 0) {
+              return false;
+          }
+          if(l_tail - __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE) >= m_sq_entries) {
+              return false;
+          }
+      }
+      unsigned int  l_index = l_tail & m_sq_mask;
+      io_uring_sqe* l_sqe = static_cast<io_uring_sqe*>(m_sqe_map) + l_index;
+      std::memset(l_sqe, 0, sizeof(io_uring_sqe));
+      l_sqe->opcode = opcode;
+      if(m_file_index != undef) {
+          l_sqe->fd = m_file_index;
+          l_sqe->flags |= IOSQE_FIXED_FILE;
+      } else
+          l_sqe->fd = m_file.get_fd();
+      l_sqe->off = static_cast<std::uint64_t>(offset);
+      l_sqe->addr = reinterpret_cast<std::uintptr_t>(data);
+      l_sqe->len = size;
+      l_sqe->user_data = slot;
+      if(link) {
+          l_sqe->flags |= IOSQE_IO_LINK;
+      }
+      if(m_buffer_registered) {
+          // requests that fit in a registered buffer use its pinned pages
+          for(unsigned int l_buffer = 0; l_buffer <= m_buffer_count; l_buffer++) {
+              char*       l_base;
+              std::size_t l_size;
+              if(l_buffer == 0) {
+                  l_base = m_ahead_data;
+                  l_size = m_ahead_data ? m_block_count * m_block_size : 0;
+              } else {
+                  l_base = static_cast<char*>(m_buffers[l_buffer - 1].iov_base);
+                  l_size = m_buffers[l_buffer - 1].iov_len;
+              }
+              if((data >= l_base) &&
+                  (data + size <= l_base + l_size)) {
+                  l_sqe->opcode = opcode == IORING_OP_READ ? IORING_OP_READ_FIXED : IORING_OP_WRITE_FIXED;
+                  l_sqe->buf_index = l_buffer;
+                  break;
+              }
+          }
+      }
+      m_sq_array[l_index] = l_index;
+      __atomic_store_n(m_sq_tail, l_tail + 1, __ATOMIC_RELEASE);
+      m_sq_pending++;
+      m_inflight++;
+      return true;
+}
+
+/* ring_submit()
+   send the prepared entries to the kernel, optionally waiting for <wait> completions
+*/
+int   uio::ring_submit(unsigned int wait) noexcept
+{
+      int l_result;
+      do {
+          l_result = io_uring_enter(m_ring, m_sq_pending, wait, wait ? IORING_ENTER_GETEVENTS : 0);
+      }
+      while((l_result < 0) && (errno == EINTR));
+      if(l_result >= 0) {
+          m_sq_pending -= l_result;
+      }
+      return l_result;
+}
+
+/* ring_harvest()
+   take all available entries off the completion queue: readahead blocks are updated, user
+   requests are moved onto the done list
+*/
+unsigned int uio::ring_harvest() noexcept
+{
+      unsigned int l_count = 0;
+      unsigned int l_head  = *m_cq_head;
+      unsigned int l_tail  = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+      while(l_head != l_tail) {
+          io_uring_cqe* l_cqe = static_cast<io_uring_cqe*>(m_cqes) + (l_head & m_cq_mask);
+          int        l_slot = l_cqe->user_data;
+          request_t& l_request = m_requests[l_slot];
+          l_request.result = l_cqe->res;
+          if(l_request.block >= 0) {
+              block_t& l_block = m_blocks[l_request.block];
+              l_block.size = l_cqe->res;
+              l_block.busy = false;
+              m_free_list[m_free_count++] = l_slot;
+          } else
+              m_done_list[(m_done_head + m_done_count++) % m_depth] = l_slot;
+          m_inflight--;
+          l_head++;
+          l_count++;
+      }
+      __atomic_store_n(m_cq_head, l_head, __ATOMIC_RELEASE);
+      return l_count;
+}
+
+/* ring_wait()
+   submit what is pending and wait for at least one completion
+*/
+bool  uio::ring_wait() noexcept
+{
+      if(ring_harvest()) {
+          return true;
+      }
+      if(m_inflight == 0) {
+          return false;
+      }
+      if(ring_submit(1) < 0) {
+          return false;
+      }
+      ring_harvest();
+      return true;
+}
+
+/* ahead_reset()
+   wait for the blocks still loading and empty the readahead window
+*/
+void  uio::ahead_reset() noexcept
+{
+      for(unsigned int l_index = 0; l_index < m_block_count; l_index++) {
+          while(m_blocks[l_index].busy) {
+              if(ring_wait() == false) {
+                  break;
+              }
+          }
+          m_blocks[l_index].offset = -1;
+          m_blocks[l_index].size = -1;
+          m_blocks[l_index].busy = false;
+      }
+      m_block_head = 0;
+      m_block_idle = m_block_count;
+}
+
+/* ahead_restart()
+   start a new readahead window at <offset>
+*/
+bool  uio::ahead_restart(std::int64_t offset) noexcept
+{
+      ahead_reset();
+      m_blocks[0].offset = offset;
+      return ahead_load();
+}
+
+/* ahead_load()
+   load the idle blocks past the end of the window, as a single chain of linked reads: the
+   kernel runs them in order and stops the chain at the end of file
+*/
+bool  uio::ahead_load() noexcept
+{
+      if(m_block_idle == 0) {
+          return true;
+      }
+      unsigned int l_first = (m_block_head + m_block_count - m_block_idle) % m_block_count;
+      std::int64_t l_offset = m_blocks[l_first].offset;
+      if(m_block_idle < m_block_count) {
+          const block_t& l_last = m_blocks[(l_first + m_block_count - 1) % m_block_count];
+          l_offset = l_last.offset + m_block_size;
+      }
+      for(unsigned int l_count = 0; l_count < m_block_idle; l_count++) {
+          unsigned int l_index = (l_first + l_count) % m_block_count;
+          block_t&     l_block = m_blocks[l_index];
+          int          l_slot  = m_free_list[--m_free_count];
+          request_t&   l_request = m_requests[l_slot];
+          l_request.user = nullptr;
+          l_request.data = m_ahead_data + l_index * m_block_size;
+          l_request.offset = l_offset;
+          l_request.block = l_index;
+          l_request.result = 0;
+          l_block.offset = l_offset;
+          l_block.size = -1;
+          l_block.busy = true;
+          if(ring_prepare(IORING_OP_READ, l_offset, m_block_size, l_request.data, l_slot, l_count + 1 < m_block_idle) == false) {
+              m_free_list[m_free_count++] = l_slot;
+              l_block.busy = false;
+              m_block_idle -= l_count;
+              return false;
+          }
+          l_offset += m_block_size;
+      }
+      m_block_idle = 0;
+      return ring_submit(0) >= 0;
+}
+
+/* ahead_release()
+   drop the block at the start of the window, once consumed
+*/
+void  uio::ahead_release() noexcept
+{
+      m_blocks[m_block_head].size = -1;
+      m_block_head = (m_block_head + 1) % m_block_count;
+      m_block_idle++;
+      if(m_block_idle * 2 >= m_block_count) {
+          ahead_load();
+      }
+}
+
+/* ahead_read()
+   copy from the readahead window, moving it along with the file position
+*/
+std::int64_t uio::ahead_read(std::size_t size, char* data) noexcept
+{
+      std::int64_t l_result = 0;
+      bool         l_retry  = true;
+      while(size > 0) {
+          block_t*     l_head = m_blocks + m_block_head;
+          std::int64_t l_window_end = l_head->offset + static_cast<std::int64_t>(m_block_count - m_block_idle) * m_block_size;
+          if((l_head->offset < 0) ||
+              (m_file_pos < l_head->offset) ||
+              (m_file_pos >= l_window_end)) {
+              if(ahead_restart(m_file_pos) == false) {
+                  return l_result ? l_result : -1;
+              }
+              continue;
+          }
+          if(m_file_pos >= l_head->offset + m_block_size) {
+              // skipped past the first block
+              while(l_head->busy) {
+                  if(ring_wait() == false) {
+                      return l_result ? l_result : -1;
+                  }
+              }
+              ahead_release();
+              continue;
+          }
+          while(l_head->busy) {
+              if(ring_wait() == false) {
+                  return l_result ? l_result : -1;
+              }
+          }
+          if(l_head->size == -ECANCELED) {
+              // a read earlier in the chain came up short, but the file may have grown since
+              if(ahead_restart(m_file_pos) == false) {
+                  return l_result ? l_result : -1;
+              }
+              continue;
+          }
+          if(l_head->size < 0) {
+              return l_result ? l_result : -1;
+          }
+          std::int64_t l_copy_size = l_head->offset + l_head->size - m_file_pos;
+          if(l_copy_size <= 0) {
+              // end of file, as of the last time this block was loaded
+              if(l_retry && (l_result == 0)) {
+                  l_retry = false;
+                  if(ahead_restart(m_file_pos) == false) {
+                      return -1;
+                  }
+                  continue;
+              }
+              break;
+          }
+          if(l_copy_size > static_cast<std::int64_t>(size)) {
+              l_copy_size = size;
+          }
+          std::memcpy(data, m_ahead_data + m_block_head * m_block_size + (m_file_pos - l_head->offset), l_copy_size);
+          m_file_pos += l_copy_size;
+          l_result   += l_copy_size;
+          data       += l_copy_size;
+          size       -= l_copy_size;
+          if(m_file_pos >= l_head->offset + m_block_size) {
+              ahead_release();
+          }
+      }
+      return l_result;
+}
+
+/* post()
+   take a request slot and queue the request with the ring, or carry it out right away when
+   running without one
+*/
+bool  uio::post(int opcode, std::int64_t offset, std::size_t size, char* data, void* user, bool link) noexcept
+{
+      if((m_requests == nullptr) ||
+          (m_user_count + m_block_count >= m_depth)) {
+          return false;
+      }
+      int        l_slot = m_free_list[--m_free_count];
+      request_t& l_request = m_requests[l_slot];
+      l_request.user = user;
+      l_request.data = data;
+      l_request.offset = offset;
+      l_request.block = -1;
+      l_request.result = 0;
+      if(m_ring != undef) {
+          if(ring_prepare(opcode, offset, size, data, l_slot, link) == false) {
+              m_free_list[m_free_count++] = l_slot;
+              return false;
+          }
+      } else {
+          ssize_t l_result;
+          int     l_desc = m_file.get_fd();
+          if(opcode == IORING_OP_READ) {
+              l_result = offset < 0 ? ::read(l_desc, data, size) : ::pread(l_desc, data, size, offset);
+          } else
+              l_result = offset < 0 ? ::write(l_desc, data, size) : ::pwrite(l_desc, data, size, offset);
+          l_request.result = l_result >= 0 ? l_result : -errno;
+          m_done_list[(m_done_head + m_done_count++) % m_depth] = l_slot;
+      }
+      m_user_count++;
+      return true;
+}
+
+/* open()
+*/
+bool  uio::open(const char* name, int mode, int permissions, unsigned int depth) noexcept
+{
+      close();
+      if(m_file.open(name, mode, permissions)) {
+          m_file_pos = 0;
+          ring_open(depth);
+          if(m_file.is_seekable() && ((mode & O_ACCMODE) != O_WRONLY)) {
+              set_readahead();
+          }
+          return true;
+      }
+      return false;
+}
+
+/* move()
+   take ownership of the file descriptor <desc>
+*/
+bool  uio::move(int& desc, int mode, unsigned int depth) noexcept
+{
+      close();
+      if(m_file.move(desc, mode)) {
+          m_file_pos = m_file.is_seekable() ? ::lseek(m_file.get_fd(), 0, SEEK_CUR) : 0;
+          ring_open(depth);
+          if(m_file.is_seekable() && ((mode & O_ACCMODE) != O_WRONLY)) {
+              set_readahead();
+          }
+          return true;
+      }
+      return false;
+}
+
+bool  uio::set_readahead(unsigned int count, std::int32_t size) noexcept
+{
+      if(m_blocks) {
+          ahead_reset();
+          m_resource->deallocate(m_blocks, m_block_count * sizeof(block_t), alignof(block_t));
+          m_resource->deallocate(m_ahead_data, m_block_count * m_block_size, alignof(std::max_align_t));
+          m_blocks = nullptr;
+          m_ahead_data = nullptr;
+          m_block_count = 0;
+          m_block_size = 0;
+      }
+      if((m_ring == undef) ||
+          (count == 0) ||
+          (size <= 0)) {
+          if(m_buffer_registered) {
+              ring_register_buffers();
+          }
+          return false;
+      }
+      // leave at least half of the request slots to the user
+      if(count > m_depth / 2) {
+          count = m_depth / 2;
+      }
+      if(count == 0) {
+          return false;
+      }
+      m_blocks = static_cast<block_t*>(m_resource->allocate(count * sizeof(block_t), alignof(block_t)));
+      m_ahead_data = static_cast<char*>(m_resource->allocate(count * size, alignof(std::max_align_t)));
+      if((m_blocks == nullptr) ||
+          (m_ahead_data == nullptr)) {
+          if(m_blocks) {
+              m_resource->deallocate(m_blocks, count * sizeof(block_t), alignof(block_t));
+              m_blocks = nullptr;
+          }
+          if(m_ahead_data) {
+              m_resource->deallocate(m_ahead_data, count * size, alignof(std::max_align_t));
+              m_ahead_data = nullptr;
+          }
+          return false;
+      }
+      m_block_count = count;
+      m_block_size = size;
+      for(unsigned int l_index = 0; l_index < m_block_count; l_index++) {
+          m_blocks[l_index].busy = false;
+      }
+      ahead_reset();
+      ring_register_buffers();
+      return true;
+}
+
+bool  uio::register_buffers(const struct iovec* buffers, unsigned int count) noexcept
+{
+      if(m_ring == undef) {
+          return false;
+      }
+      if(m_buffers) {
+          m_resource->deallocate(m_buffers, m_buffer_count * sizeof(struct iovec), alignof(struct iovec));
+          m_buffers = nullptr;
+          m_buffer_count = 0;
+      }
+      if(count) {
+          m_buffers = static_cast<struct iovec*>(m_resource->allocate(count * sizeof(struct iovec), alignof(struct iovec)));
+          if(m_buffers == nullptr) {
+              return false;
+          }
+          std::memcpy(m_buffers, buffers, count * sizeof(struct iovec));
+          m_buffer_count = count;
+      }
+      return ring_register_buffers();
+}
+
+bool  uio::post_read(std::int64_t offset, std::size_t size, char* data, void* user, bool link) noexcept
+{
+      return post(IORING_OP_READ, offset, size, data, user, link);
+}
+
+bool  uio::post_write(std::int64_t offset, std::size_t size, const char* data, void* user, bool link) noexcept
+{
+      return post(IORING_OP_WRITE, offset, size, const_cast<char*>(data), user, link);
+}
+
+int   uio::submit() noexcept
+{
+      if(m_ring != undef) {
+          if(m_sq_pending) {
+              return ring_submit(0);
+          }
+      }
+      return 0;
+}
+
+std::size_t uio::reap(completion* list, std::size_t count, std::size_t wait) noexcept
+{
+      std::size_t l_result = 0;
+      if(wait > count) {
+          wait = count;
+      }
+      if(m_ring != undef) {
+          ring_harvest();
+          while((m_done_count < wait) &&
+              (m_done_count < m_user_count)) {
+              if(ring_submit(wait - m_done_count) < 0) {
+                  break;
+              }
+              ring_harvest();
+          }
+      }
+      while((l_result < count) &&
+          (m_done_count > 0)) {
+          int        l_slot = m_done_list[m_done_head];
+          request_t& l_request = m_requests[l_slot];
+          list[l_result].user = l_request.user;
+          list[l_result].data = l_request.data;
+          list[l_result].offset = l_request.offset;
+          list[l_result].result = l_request.result;
+          m_free_list[m_free_count++] = l_slot;
+          m_done_head = (m_done_head + 1) % m_depth;
+          m_done_count--;
+          m_user_count--;
+          l_result++;
+      }
+      return l_result;
+}
+
+int   uio::get_char() noexcept
+{
+      char l_result;
+      if(read(1, std::addressof(l_result)) == 1) {
+          return l_result;
+      } else
+          return EOF;
+}
+
+unsigned int uio::get_byte() noexcept
+{
+      unsigned char l_result;
+      if(read(1, reinterpret_cast<char*>(std::addressof(l_result))) == 1) {
+          return l_result;
+      } else
+          return EOF;
+}
+
+/* seek()
+   move the file position, as documented by ::lseek(); the position is kept here and passed
+   with every request, serial streams are left to fio
+*/
+std::int64_t uio::seek(std::int64_t offset, std::int32_t whence) noexcept
+{
+      if(m_file.is_seekable()) {
+          std::int64_t l_file_pos;
+          if(whence == SEEK_SET) {
+              l_file_pos = offset;
+          } else
+          if(whence == SEEK_CUR) {
+              l_file_pos = m_file_pos + offset;
+          } else
+          if(whence == SEEK_END) {
+              struct stat l_stat;
+              if(fstat(m_file.get_fd(), std::addressof(l_stat)) != 0) {
+                  return -1;
+              }
+              l_file_pos = l_stat.st_size + offset;
+          } else
+              return -1;
+          if(l_file_pos < 0) {
+              return -1;
+          }
+          m_file_pos = l_file_pos;
+          return m_file_pos;
+      }
+      return m_file.seek(offset, whence);
+}
+
+/* read()
+   skip <count> bytes
+*/
+std::int64_t uio::read(std::size_t count) noexcept
+{
+      if(m_file.is_seekable()) {
+          m_file_pos += count;
+          return count;
+      }
+      char         l_data[256];
+      std::int64_t l_result = 0;
+      while(count) {
+          std::size_t  l_load_size = count < sizeof(l_data) ? count : sizeof(l_data);
+          std::int64_t l_read_size = read(l_load_size, l_data);
+          if(l_read_size > 0) {
+              l_result += l_read_size;
+              count    -= l_read_size;
+          } else
+              break;
+      }
+      return l_result;
+}
+
+std::int64_t uio::read(std::size_t size, char* data) noexcept
+{
+      if(m_file.is_seekable()) {
+          if(m_block_count) {
+              return ahead_read(size, data);
+          }
+          ssize_t l_result = ::pread(m_file.get_fd(), data, size, m_file_pos);
+          if(l_result > 0) {
+              m_file_pos += l_result;
+          }
+          return l_result;
+      }
+      return m_file.read(size, data);
+}
+
+/* readv()
+   a single ::preadv() at the current position, unless readahead is on - then the segments go
+   through the readahead window one by one
+*/
+std::int64_t uio::readv(const iovec* list, std::size_t count) noexcept
+{
+      if(m_file.is_seekable()) {
+          if(m_block_count) {
+              return ios::readv(list, count);
+          }
+          if(count > IOV_MAX) {
+              count = IOV_MAX;
+          }
+          ssize_t l_result = ::preadv(m_file.get_fd(), list, count, m_file_pos);
+          if(l_result > 0) {
+              m_file_pos += l_result;
+          }
+          return l_result;
+      }
+      return m_file.readv(list, count);
+}
+
+std::int32_t uio::put_char(char value) noexcept
+{
+      return write(1, std::addressof(value));
+}
+
+std::int32_t uio::put_byte(unsigned char value) noexcept
+{
+      return write(1, reinterpret_cast<char*>(std::addressof(value)));
+}
+
+/* write()
+   blocking write at the current position; the readahead window is dropped, so that data
+   read back afterwards is current
+*/
+std::int64_t uio::write(std::size_t size, const char* data) noexcept
+{
+      if(m_file.is_seekable()) {
+          if(m_block_count) {
+              ahead_reset();
+          }
+          ssize_t l_result = ::pwrite(m_file.get_fd(), data, size, m_file_pos);
+          if(l_result > 0) {
+              m_file_pos += l_result;
+          }
+          return l_result;
+      }
+      return m_file.write(size, data);
+}
+
+/* writev()
+   blocking ::pwritev() at the current position, as write()
+*/
+std::int64_t uio::writev(const iovec* list, std::size_t count) noexcept
+{
+      if(m_file.is_seekable()) {
+          if(m_block_count) {
+              ahead_reset();
+          }
+          if(count > IOV_MAX) {
+              count = IOV_MAX;
+          }
+          ssize_t l_result = ::pwritev(m_file.get_fd(), list, count, m_file_pos);
+          if(l_result > 0) {
+              m_file_pos += l_result;
+          }
+          return l_result;
+      }
+      return m_file.writev(list, count);
+}
+
+std::int64_t uio::get_size() noexcept
+{
+      return m_file.get_size();
+}
+
+int   uio::get_fd() const noexcept
+{
+      return m_file.get_fd();
+}
+
+/* get_pending_count()
+   number of user requests posted and not yet reaped
+*/
+unsigned int uio::get_pending_count() const noexcept
+{
+      return m_user_count;
+}
+
+/* has_ring()
+   true if requests go through io_uring, false if served by blocking calls
+*/
+bool  uio::has_ring() const noexcept
+{
+      return m_ring != undef;
+}
+
+bool  uio::is_seekable() const noexcept
+{
+      return m_file.is_seekable();
+}
+
+bool  uio::is_readable() const noexcept
+{
+      return m_file.is_readable();
+}
+
+bool  uio::is_writable() const noexcept
+{
+      return m_file.is_writable();
+}
+
+/* close()
+   wait for all requests in flight, then release the ring and the file
+*/
+void  uio::close() noexcept
+{
+      if(m_ring != undef) {
+          while(m_inflight) {
+              if(ring_wait() == false) {
+                  break;
+              }
+          }
+      }
+      if(m_blocks) {
+          m_resource->deallocate(m_blocks, m_block_count * sizeof(block_t), alignof(block_t));
+          m_resource->deallocate(m_ahead_data, m_block_count * m_block_size, alignof(std::max_align_t));
+          m_blocks = nullptr;
+          m_ahead_data = nullptr;
+          m_block_count = 0;
+          m_block_size = 0;
+          m_block_head = 0;
+          m_block_idle = 0;
+      }
+      if(m_buffers) {
+          m_resource->deallocate(m_buffers, m_buffer_count * sizeof(struct iovec), alignof(struct iovec));
+          m_buffers = nullptr;
+          m_buffer_count = 0;
+      }
+      ring_close();
+      m_file.close(true);
+      m_file_pos = 0;
+}
+
+      uio::operator sys::ios*() noexcept
+{
+      return this;
+}
+
+      uio::operator bool() const noexcept
+{
+      return m_file;
+}
@@ -0,0 +1,240 @@
+#ifndef sys_uio_h
+#define sys_uio_h
+/** 
+    Copyright (c) 2016-2020, wicked systems
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following
+    conditions are met:
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+      disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following 
+      disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the name of wicked systems nor the names of its contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+    INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN 
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+    EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**/
+#include <sys.h>
+#include <sys/ios.h>
+#include <sys/ios/fio.h>
+#include <fcntl.h>
+#include <sys/uio.h>
+
+/* uio
+   file stream backed by an io_uring submission and completion queue pair; on top of the
+   blocking sys::ios interface, which reads ahead from seekable files through chains of linked
+   reads, it offers asynchronous reads and writes that are submitted in batches and reaped
+   either directly or into a queue.
+   When io_uring is unavailable (or <depth> is 0) the same interface is served by blocking
+   calls on the underlying fio.
+*/
+class uio: public sys::ios
+{
+  public:
+  /* completion
+     result of an asynchronous request: <result> is the byte count transferred, or a negative
+     errno value
+  */
+  struct completion
+  {
+    void*         user;
+    char*         data;
+    std::int64_t  offset;
+    std::int32_t  result;
+  };
+
+  private:
+  /* request_t
+     a request slot; <block> is the readahead block the request fills, or -1 for user requests
+     which keep their slot until reaped
+  */
+  struct request_t
+  {
+    void*         user;
+    char*         data;
+    std::int64_t  offset;
+    std::int32_t  block;
+    std::int32_t  result;
+  };
+
+  /* block_t
+     readahead block: <size> is the number of bytes loaded, or negative while idle and after a
+     failed or cancelled read
+  */
+  struct block_t
+  {
+    std::int64_t  offset;
+    std::int32_t  size;
+    bool          busy;
+  };
+
+  fio           m_file;
+  fragment*     m_resource;
+  int           m_ring;
+  int           m_file_index;       // registered file index, or undef
+  unsigned int  m_depth;
+  std::int64_t  m_file_pos;
+
+  // submission and completion rings, shared with the kernel
+  void*         m_sq_map;
+  std::size_t   m_sq_map_size;
+  void*         m_cq_map;
+  std::size_t   m_cq_map_size;
+  void*         m_sqe_map;
+  std::size_t   m_sqe_map_size;
+  unsigned int* m_sq_head;
+  unsigned int* m_sq_tail;
+  unsigned int  m_sq_mask;
+  unsigned int  m_sq_entries;
+  unsigned int* m_sq_array;
+  unsigned int* m_cq_head;
+  unsigned int* m_cq_tail;
+  unsigned int  m_cq_mask;
+  void*         m_cqes;
+  unsigned int  m_sq_pending;       // prepared, not yet submitted
+  unsigned int  m_inflight;         // submitted or prepared, not yet completed
+
+  // request slots, and user requests completed but not yet reaped
+  request_t*    m_requests;
+  int*          m_free_list;
+  unsigned int  m_free_count;
+  int*          m_done_list;
+  unsigned int  m_done_head;
+  unsigned int  m_done_count;
+  unsigned int  m_user_count;
+
+  // user buffers; registered with the ring after the readahead buffer
+  struct iovec* m_buffers;
+  unsigned int  m_buffer_count;
+  bool          m_buffer_registered;
+
+  // readahead window
+  char*         m_ahead_data;
+  block_t*      m_blocks;
+  std::int32_t  m_block_size;
+  unsigned int  m_block_count;
+  unsigned int  m_block_head;       // block holding the start of the window
+  unsigned int  m_block_idle;       // blocks past the end of the window, waiting to be loaded
+
+  public:
+  static constexpr int undef = -1;
+  static constexpr unsigned int depth_default = 64;
+  static constexpr std::int32_t block_size_default = 65536;
+  static constexpr unsigned int block_count_default = 4;
+
+  private:
+          bool  ring_open(unsigned int) noexcept;
+          void  ring_free() noexcept;
+          void  ring_close() noexcept;
+          bool  ring_register_buffers() noexcept;
+          bool  ring_prepare(int, std::int64_t, std::size_t, char*, int, bool) noexcept;
+          int   ring_submit(unsigned int) noexcept;
+          unsigned int ring_harvest() noexcept;
+          bool  ring_wait() noexcept;
+
+          void  ahead_reset() noexcept;
+          bool  ahead_restart(std::int64_t) noexcept;
+          bool  ahead_load() noexcept;
+          void  ahead_release() noexcept;
+          std::int64_t ahead_read(std::size_t, char*) noexcept;
+
+          bool  post(int, std::int64_t, std::size_t, char*, void*, bool) noexcept;
+
+  public:
+          uio() noexcept;
+          uio(int, int = O_RDONLY, unsigned int = depth_default) noexcept;
+          uio(const char*, int = O_RDONLY, int = 0777, unsigned int = depth_default) noexcept;
+          uio(const uio&) noexcept = delete;
+          uio(uio&&) noexcept = delete;
+  virtual ~uio();
+
+          bool  open(const char*, int = O_RDONLY, int = 0777, unsigned int = depth_default) noexcept;
+          bool  move(int&, int = O_RDONLY, unsigned int = depth_default) noexcept;
+
+  /* set_readahead()
+     read sequentially through <count> blocks of <size> bytes; 0 for either disables readahead
+  */
+          bool  set_readahead(unsigned int = block_count_default, std::int32_t = block_size_default) noexcept;
+
+  /* register_buffers()
+     register user memory with the ring, so that requests landing entirely within one of the
+     <count> buffers skip the per-request page mapping
+  */
+          bool  register_buffers(const struct iovec*, unsigned int) noexcept;
+
+  /* post_read(), post_write()
+     queue an asynchronous transfer of <size> bytes at <offset> (-1 for the current position of
+     a serial stream); with <link> set, the next request posted only starts after this one
+     completes in full. Requests are sent to the kernel in batches, at the latest by submit().
+     Fails while <depth> requests are outstanding; reap() to make room.
+  */
+          bool  post_read(std::int64_t, std::size_t, char*, void* = nullptr, bool = false) noexcept;
+          bool  post_write(std::int64_t, std::size_t, const char*, void* = nullptr, bool = false) noexcept;
+
+  /* submit()
+     send the requests posted so far to the kernel in one call; returns the number sent
+  */
+          int   submit() noexcept;
+
+  /* reap()
+     move up to <count> completions into <list>, waiting for at least <wait> of them;
+     returns the number moved
+  */
+          std::size_t reap(completion*, std::size_t, std::size_t = 0) noexcept;
+
+  /* reap()
+     hand completions to <queue>, through its enqueue(), as they become available
+  */
+  template<typename Qt>
+  inline  std::size_t reap(Qt& queue, std::size_t wait = 0) noexcept {
+          completion  l_list[16];
+          std::size_t l_result = 0;
+          std::size_t l_count;
+          do {
+              l_count = reap(l_list, 16, wait > l_result ? wait - l_result : 0);
+              for(std::size_t l_index = 0; l_index < l_count; l_index++) {
+                  queue.enqueue(l_list[l_index]);
+              }
+              l_result += l_count;
+          }
+          while(l_count == 16);
+          return l_result;
+  }
+
+  virtual int           get_char() noexcept override;
+  virtual unsigned int  get_byte() noexcept override;
+
+  virtual std::int64_t  seek(std::int64_t, std::int32_t) noexcept override;
+  virtual std::int64_t  read(std::size_t) noexcept override;
+  virtual std::int64_t  read(std::size_t, char*) noexcept override;
+  virtual std::int64_t  readv(const iovec*, std::size_t) noexcept override;
+
+  virtual std::int32_t  put_char(char) noexcept override;
+  virtual std::int32_t  put_byte(unsigned char) noexcept override;
+  virtual std::int64_t  write(std::size_t, const char*) noexcept override;
+  virtual std::int64_t  writev(const iovec*, std::size_t) noexcept override;
+
+  virtual std::int64_t  get_size() noexcept override;
+
+          int   get_fd() const noexcept;
+          unsigned int get_pending_count() const noexcept;
+          bool  has_ring() const noexcept;
+
+  virtual bool  is_seekable() const noexcept override;
+  virtual bool  is_readable() const noexcept override;
+  virtual bool  is_writable() const noexcept override;
+
+          void  close() noexcept;
+          operator ios*() noexcept;
+          operator bool() const noexcept;
+          uio& operator=(const uio&) noexcept = delete;
+          uio& operator=(uio&&) noexcept = delete;
+};
+#endif
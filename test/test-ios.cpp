@@ -5,9 +5,17 @@
 #include <sys/un.h>
 #include <sys/ios/sio.h>
 #include <sys/ios/bio.h>
+#include <sys/ios/cio.h>
+#include <sys/ios/uio.h>
+#include <sys/ios/mio.h>
 #include <sys/asio.h>
+#include <parallel/queue.h>
 #include <poll.h>
+#include <chrono>
+#include <csignal>
 #include <cstring>
+#include <string>
+#include <thread>
 
 /* sys::sio tests
 */
@@ -349,7 +357,7 @@ bool  test_31() noexcept
 {
       sio  l_sio;
       bio  l_bio(l_sio);
-      std::size_t l_memory_baseline;
+      std::int64_t l_memory_baseline;
 
       l_bio.reserve(5);
       l_memory_baseline = l_bio.get_capacity();
@@ -408,6 +416,1091 @@ bool  test_32() noexcept
       return false;
 }
 
+/* test files
+*/
+static char get_test_byte(std::int64_t offset) noexcept
+{
+      return (offset * 7 + offset / 251) & 255;
+}
+
+/* make_test_file()
+   create a temporary file of <size> bytes, filled by get_test_byte() unless <text> is given
+*/
+static bool  make_test_file(char* name, std::size_t size, const char* text = nullptr) noexcept
+{
+      std::strcpy(name, "/tmp/test-uio-XXXXXX");
+      int l_desc = mkstemp(name);
+      if(l_desc < 0) {
+          return false;
+      }
+      char        l_data[4096];
+      std::size_t l_offset = 0;
+      while(l_offset < size) {
+          std::size_t l_size = size - l_offset < sizeof(l_data) ? size - l_offset : sizeof(l_data);
+          for(std::size_t l_index = 0; l_index < l_size; l_index++) {
+              l_data[l_index] = text ? text[(l_offset + l_index) % std::strlen(text)] : get_test_byte(l_offset + l_index);
+          }
+          if(write(l_desc, l_data, l_size) != static_cast<ssize_t>(l_size)) {
+              close(l_desc);
+              return false;
+          }
+          l_offset += l_size;
+      }
+      close(l_desc);
+      return true;
+}
+
+static bool  has_test_bytes(std::int64_t offset, const char* data, std::size_t size) noexcept
+{
+      for(std::size_t l_index = 0; l_index < size; l_index++) {
+          if(data[l_index] != get_test_byte(offset + l_index)) {
+              return false;
+          }
+      }
+      return true;
+}
+
+bool  test_33() noexcept
+{
+      char l_name[32];
+      if(make_test_file(l_name, 0) == false) {
+          return false;
+      }
+      // lines of growing length, up to several times the initial buffer size, some of them
+      // empty, and a last one without end of line
+      std::string l_text;
+      std::size_t l_line_count = 80;
+      for(std::size_t l_line = 0; l_line < l_line_count; l_line++) {
+          l_text.append(l_line * l_line * 37 % 300000, 'a' + l_line % 26);
+          l_text.push_back('\n');
+      }
+      l_text.append("last");
+      if(true) {
+          fio l_file(l_name, O_WRONLY);
+          l_file.write(l_text.size(), l_text.data());
+      }
+      bool l_result = true;
+      for(int l_source = 0; l_source < 2; l_source++) {
+          fio  l_file(l_name, O_RDONLY);
+          sio  l_sio(l_text.data(), l_text.size());
+          bio  l_bio(l_source ? static_cast<sys::ios*>(l_sio) : static_cast<sys::ios*>(l_file));
+          std::size_t  l_count = 0;
+          std::int32_t l_length;
+          if(l_source) {
+              l_bio.reserve(5);
+          }
+          while(char* l_line = l_bio.get_line(l_length)) {
+              std::size_t l_want = l_count < l_line_count ? l_count * l_count * 37 % 300000 : 4;
+              if((static_cast<std::size_t>(l_length) != l_want) ||
+                  (std::strlen(l_line) != l_want) ||
+                  ((l_count < l_line_count) && l_length && ((l_line[0] != 'a' + static_cast<char>(l_count % 26)) || (l_line[l_length - 1] != l_line[0]))) ||
+                  ((l_count == l_line_count) && std::strcmp(l_line, "last"))) {
+                  l_result = false;
+              }
+              l_count++;
+          }
+          if((l_count != l_line_count + 1) ||
+              (l_length != -1)) {
+              l_result = false;
+          }
+      }
+      unlink(l_name);
+      return l_result;
+}
+
+bool  test_34() noexcept
+{
+      char        l_name[32];
+      const char* l_text = "one\ntwo\n\nfour\nthe fifth line, which is longer than the others\n";
+      if(make_test_file(l_name, 62 * 10007 + 17, l_text) == false) {
+          return false;
+      }
+      bool         l_result = true;
+      fio          l_file_0(l_name, O_RDONLY);
+      fio          l_file_1(l_name, O_RDONLY);
+      bio          l_bio_0(l_file_0);
+      bio          l_bio_1(l_file_1);
+      std::size_t  l_count = 0;
+      char*        l_lines[64];
+      std::int32_t l_lengths[64];
+      while(std::int32_t l_line_count = l_bio_0.get_lines(l_lines, l_lengths, 64)) {
+          // all of the batch is still there once the batch is complete
+          for(std::int32_t l_index = 0; l_index < l_line_count; l_index++) {
+              std::int32_t l_length;
+              char*        l_line = l_bio_1.get_line(l_length);
+              if((l_line == nullptr) ||
+                  (l_length != l_lengths[l_index]) ||
+                  (std::strcmp(l_line, l_lines[l_index]) != 0)) {
+                  l_result = false;
+              }
+          }
+          l_count += l_line_count;
+      }
+      std::int32_t l_length;
+      if((l_count != 5 * 10007 + 5) ||
+          (l_bio_1.get_line(l_length) != nullptr)) {
+          l_result = false;
+      }
+      unlink(l_name);
+      return l_result;
+}
+
+bool  test_35() noexcept
+{
+      char        l_name[32];
+      const char* l_text = "the quick brown fox jumps over the lazy dog\n";
+      std::size_t l_size = 67108864;
+      if(make_test_file(l_name, l_size, l_text) == false) {
+          return false;
+      }
+      bool        l_result = true;
+      std::size_t l_line_count = (l_size + 43) / 44;
+      auto l_report = [&](const char* name, std::size_t count, auto start) {
+          double l_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+          printf("    %-24s: %.1f MiB/s\n", name, l_size / l_time / 1048576.0);
+          if(count != l_line_count) {
+              l_result = false;
+          }
+      };
+      if(true) {
+          FILE*       l_file = fopen(l_name, "r");
+          char*       l_line = nullptr;
+          std::size_t l_line_size = 0;
+          std::size_t l_count = 0;
+          auto        l_start = std::chrono::steady_clock::now();
+          while(getline(std::addressof(l_line), std::addressof(l_line_size), l_file) >= 0) {
+              l_count++;
+          }
+          l_report("getline(3)", l_count, l_start);
+          free(l_line);
+          fclose(l_file);
+      }
+      if(true) {
+          fio          l_file(l_name, O_RDONLY);
+          bio          l_bio(l_file);
+          std::size_t  l_count = 0;
+          std::int32_t l_length;
+          auto         l_start = std::chrono::steady_clock::now();
+          while(l_bio.get_line(l_length)) {
+              l_count++;
+          }
+          l_report("bio::get_line()", l_count, l_start);
+      }
+      if(true) {
+          fio          l_file(l_name, O_RDONLY);
+          bio          l_bio(l_file);
+          std::size_t  l_count = 0;
+          char*        l_lines[64];
+          std::int32_t l_lengths[64];
+          auto         l_start = std::chrono::steady_clock::now();
+          while(std::int32_t l_batch_count = l_bio.get_lines(l_lines, l_lengths, 64)) {
+              l_count += l_batch_count;
+          }
+          l_report("bio::get_lines(64)", l_count, l_start);
+      }
+      if(true) {
+          sys::asio<uio> l_bio(l_name, O_RDONLY);
+          std::size_t    l_count = 0;
+          std::int32_t   l_length;
+          auto           l_start = std::chrono::steady_clock::now();
+          while(l_bio.get_line(l_length)) {
+              l_count++;
+          }
+          l_report("asio<uio>::get_line()", l_count, l_start);
+      }
+      unlink(l_name);
+      return l_result;
+}
+
+bool  test_36() noexcept
+{
+      char         l_name[32];
+      std::int64_t l_size = 6442450944;
+      std::int64_t l_mark = 5368709120 - 3;
+      if(make_test_file(l_name, 0) == false) {
+          return false;
+      }
+      // a sparse file, with a line straddling the 5GiB mark
+      if(true) {
+          fio l_file(l_name, O_WRONLY);
+          if((l_file.seek(l_mark, SEEK_SET) != l_mark) ||
+              (l_file.write(9, "offsets\n!") != 9) ||
+              (ftruncate(l_file.get_fd(), l_size) != 0)) {
+              unlink(l_name);
+              return false;
+          }
+      }
+      bool l_result = true;
+      auto l_check = [&](sys::ios& source) {
+          char l_data[8];
+          if((source.get_size() != l_size) ||
+              (source.seek(l_mark, SEEK_SET) != l_mark) ||
+              (source.read(sizeof(l_data), l_data) != sizeof(l_data)) ||
+              (std::memcmp(l_data, "offsets\n", sizeof(l_data)) != 0) ||
+              (source.seek(0, SEEK_CUR) != l_mark + 8) ||
+              (source.get_char() != '!') ||
+              (source.seek(-1, SEEK_END) != l_size - 1) ||
+              (source.get_char() != 0) ||
+              (source.get_char() != EOF)) {
+              l_result = false;
+          }
+      };
+      if(true) {
+          fio  l_file(l_name, O_RDONLY);
+          l_check(l_file);
+      }
+      if(true) {
+          sys::asio<fio> l_file(l_name, O_RDONLY);
+          l_check(l_file);
+          std::int32_t   l_length;
+          char*          l_line;
+          if((l_file.seek(l_mark - 1, SEEK_SET) != l_mark - 1) ||
+              ((l_line = l_file.get_line(l_length)) == nullptr) ||
+              (l_length != 8) ||
+              (std::strcmp(l_line + 1, "offsets") != 0) ||
+              (l_file.lock() != l_mark + 8)) {
+              l_result = false;
+          }
+          l_file.unlock();
+      }
+      if(true) {
+          uio  l_file(l_name, O_RDONLY);
+          l_check(l_file);
+      }
+      if(true) {
+          mio  l_file(l_name, O_RDONLY);
+          l_check(l_file);
+      }
+      unlink(l_name);
+      return l_result;
+}
+
+/* short_sio
+   memory stream taking no more than <m_save_max> bytes per writev(), as a full pipe or socket
+   would
+*/
+class short_sio: public sio
+{
+  public:
+  std::size_t m_save_max = 0;
+
+  public:
+  virtual std::int64_t writev(const iovec* list, std::size_t count) noexcept override {
+          std::int64_t l_result = 0;
+          for(std::size_t l_index = 0; (l_index < count) && (l_result < static_cast<std::int64_t>(m_save_max)); l_index++) {
+              std::size_t l_save_size = std::min(list[l_index].iov_len, m_save_max - l_result);
+              l_result += write(l_save_size, static_cast<const char*>(list[l_index].iov_base));
+          }
+          return l_result;
+  }
+};
+
+bool  test_37() noexcept
+{
+      char         l_name[32];
+      std::int64_t l_size = 1048576;
+      if(make_test_file(l_name, l_size) == false) {
+          return false;
+      }
+      bool l_result = true;
+      // scatter reads of a small header, a large payload and a small trailer, then of two small
+      // parts only and finally across the end of the file
+      auto l_check_readv = [&](sys::ios& source) {
+          char  l_head[12];
+          char  l_body[20000];
+          char  l_tail[5];
+          iovec l_list[3] = {{l_head, sizeof(l_head)}, {l_body, sizeof(l_body)}, {l_tail, sizeof(l_tail)}};
+          for(std::int64_t l_seek: {0l, 7l, 100000l, 500000l}) {
+              std::int64_t l_pos = l_seek + 1;
+              if((source.seek(l_seek, SEEK_SET) != l_seek) ||
+                  (source.get_char() != get_test_byte(l_seek)) ||
+                  (source.readv(l_list, 3) != sizeof(l_head) + sizeof(l_body) + sizeof(l_tail)) ||
+                  (has_test_bytes(l_pos, l_head, sizeof(l_head)) == false) ||
+                  (has_test_bytes(l_pos + sizeof(l_head), l_body, sizeof(l_body)) == false) ||
+                  (has_test_bytes(l_pos + sizeof(l_head) + sizeof(l_body), l_tail, sizeof(l_tail)) == false) ||
+                  (source.readv(l_list, 1) != sizeof(l_head)) ||
+                  (source.readv(l_list + 2, 1) != sizeof(l_tail)) ||
+                  (has_test_bytes(l_pos + sizeof(l_head) + sizeof(l_body) + sizeof(l_tail), l_head, sizeof(l_head)) == false) ||
+                  (has_test_bytes(l_pos + sizeof(l_head) * 2 + sizeof(l_body) + sizeof(l_tail), l_tail, sizeof(l_tail)) == false) ||
+                  (source.get_char() != get_test_byte(l_pos + sizeof(l_head) * 2 + sizeof(l_body) + sizeof(l_tail) * 2))) {
+                  l_result = false;
+              }
+          }
+          if((source.seek(l_size - 10000, SEEK_SET) != l_size - 10000) ||
+              (source.readv(l_list, 3) != 10000) ||
+              (has_test_bytes(l_size - 10000, l_head, sizeof(l_head)) == false) ||
+              (has_test_bytes(l_size - 10000 + sizeof(l_head), l_body, 10000 - sizeof(l_head)) == false)) {
+              l_result = false;
+          }
+      };
+      if(true) {
+          fio  l_file(l_name, O_RDONLY);
+          l_check_readv(l_file);
+      }
+      if(true) {
+          sys::asio<fio> l_file(l_name, O_RDONLY);
+          l_check_readv(l_file);
+      }
+      if(true) {
+          uio  l_file(l_name, O_RDONLY);
+          l_check_readv(l_file);
+          l_file.set_readahead();
+          l_check_readv(l_file);
+      }
+      // gather writes of the same frame through every stream, read back afterwards
+      std::string l_body(20000, 0);
+      for(std::size_t l_index = 0; l_index < l_body.size(); l_index++) {
+          l_body[l_index] = get_test_byte(l_index);
+      }
+      char  l_head[] = "head:";
+      char  l_tail[] = ":tail\n";
+      iovec l_list[3] = {{l_head, 5}, {l_body.data(), l_body.size()}, {l_tail, 6}};
+      std::string l_frame = std::string(l_head) + l_body + l_tail;
+      if(true) {
+          sio  l_sio;
+          if((l_sio.writev(l_list, 3) != static_cast<std::int64_t>(l_frame.size())) ||
+              (l_sio.writev(l_list, 1) != 5) ||
+              (l_sio.get_size() != static_cast<std::int64_t>(l_frame.size()) + 5)) {
+              l_result = false;
+          }
+          std::string l_data(l_frame.size() + 5, 0);
+          if((l_sio.read(l_data.size(), l_data.data()) != static_cast<std::int64_t>(l_data.size())) ||
+              (l_data != l_frame + l_head)) {
+              l_result = false;
+          }
+      }
+      auto l_check_writev = [&](auto&& make) {
+          if(true) {
+              auto l_file = make();
+              for(int l_iter = 0; l_iter < 3; l_iter++) {
+                  if(l_file.writev(l_list, 3) != static_cast<std::int64_t>(l_frame.size())) {
+                      l_result = false;
+                  }
+              }
+              // small segments only, which a bio keeps until flushed
+              if(l_file.writev(l_list, 1) != 5) {
+                  l_result = false;
+              }
+              if constexpr (std::is_base_of<bio, decltype(l_file)>::value) {
+                  l_file.flush();
+              }
+          }
+          fio         l_file(l_name, O_RDONLY);
+          std::string l_data(l_frame.size() * 3 + 5, 0);
+          if((l_file.get_size() != static_cast<std::int64_t>(l_data.size())) ||
+              (l_file.read(l_data.size(), l_data.data()) != static_cast<std::int64_t>(l_data.size())) ||
+              (l_data != l_frame + l_frame + l_frame + l_head)) {
+              l_result = false;
+          }
+      };
+      l_check_writev([&]() { return fio(l_name, O_WRONLY | O_TRUNC); });
+      l_check_writev([&]() { return sys::asio<fio>(l_name, O_WRONLY | O_TRUNC); });
+      l_check_writev([&]() { return uio(l_name, O_WRONLY | O_TRUNC); });
+      // short gather writes through a bio: the data the source did not take stays pending and
+      // only the caller's bytes actually written are counted
+      if(true) {
+          short_sio   l_sink;
+          bio         l_bio(std::addressof(l_sink));
+          std::string l_large(8192, 'x');
+          iovec       l_large_list[1] = {{l_large.data(), l_large.size()}};
+          l_sink.m_save_max = 3;
+          if((l_bio.writev(l_list, 1) != 5) ||
+              (l_bio.writev(l_large_list, 1) != 0) ||
+              (l_sink.get_size() != 3)) {
+              l_result = false;
+          }
+          l_sink.m_save_max = 2 + 100;
+          if((l_bio.writev(l_large_list, 1) != 100) ||
+              (l_sink.get_size() != 5 + 100)) {
+              l_result = false;
+          }
+          std::string l_data(5 + 100, 0);
+          if((l_sink.seek(0, SEEK_SET) != 0) ||
+              (l_sink.read(l_data.size(), l_data.data()) != static_cast<std::int64_t>(l_data.size())) ||
+              (l_data != std::string(l_head, 5) + l_large.substr(0, 100))) {
+              l_result = false;
+          }
+      }
+      unlink(l_name);
+      return l_result;
+}
+
+bool  test_38() noexcept
+{
+      char         l_src_name[32];
+      char         l_dst_name[32];
+      std::int64_t l_size = 300000;
+      if(make_test_file(l_src_name, l_size) == false) {
+          return false;
+      }
+      if(make_test_file(l_dst_name, 0) == false) {
+          unlink(l_src_name);
+          return false;
+      }
+      bool         l_result = true;
+      std::int64_t l_direct_size;
+      std::string  l_data(l_size, 0);
+      // file to file, from the middle of the source and past its end
+      if(true) {
+          fio  l_src(l_src_name, O_RDONLY);
+          fio  l_dst(l_dst_name, O_WRONLY | O_TRUNC);
+          if((l_src.seek(1000, SEEK_SET) != 1000) ||
+              (sys::transfer(l_src, l_dst, 5000, l_direct_size) != 5000) ||
+              (l_direct_size != 5000) ||
+              (sys::transfer(l_src, l_dst, l_size, l_direct_size) != l_size - 6000) ||
+              (l_direct_size != l_size - 6000) ||
+              (sys::transfer(l_src, l_dst, l_size, l_direct_size) != 0)) {
+              l_result = false;
+          }
+      }
+      if(true) {
+          fio  l_dst(l_dst_name, O_RDONLY);
+          if((l_dst.read(l_size, l_data.data()) != l_size - 1000) ||
+              (has_test_bytes(1000, l_data.data(), l_size - 1000) == false)) {
+              l_result = false;
+          }
+      }
+      // file to pipe and pipe to file, each within the capacity of the pipe
+      if(true) {
+          int  l_pipe[2];
+          if(pipe(l_pipe) != 0) {
+              return false;
+          }
+          fio  l_src(l_src_name, O_RDONLY);
+          fio  l_dst(l_dst_name, O_WRONLY | O_TRUNC);
+          fio  l_pipe_src(l_pipe[0], O_RDONLY);
+          fio  l_pipe_dst(l_pipe[1], O_WRONLY);
+          if((sys::transfer(l_src, l_pipe_dst, 60000, l_direct_size) != 60000) ||
+              (l_direct_size != 60000)) {
+              l_result = false;
+          }
+          close(l_pipe[1]);
+          if((sys::transfer(l_pipe_src, l_dst, l_size, l_direct_size) != 60000) ||
+              (l_direct_size != 60000)) {
+              l_result = false;
+          }
+          close(l_pipe[0]);
+      }
+      if(true) {
+          fio  l_dst(l_dst_name, O_RDONLY);
+          if((l_dst.read(l_size, l_data.data()) != 60000) ||
+              (has_test_bytes(0, l_data.data(), 60000) == false)) {
+              l_result = false;
+          }
+      }
+      // socket to file, through a pipe of its own
+      if(true) {
+          int  l_pair[2];
+          if(socketpair(AF_UNIX, SOCK_STREAM, 0, l_pair) != 0) {
+              return false;
+          }
+          fio  l_src(l_pair[1], O_RDONLY);
+          fio  l_dst(l_dst_name, O_WRONLY | O_TRUNC);
+          if(write(l_pair[0], l_data.data(), 60000) != 60000) {
+              l_result = false;
+          }
+          shutdown(l_pair[0], SHUT_WR);
+          if((sys::transfer(l_src, l_dst, l_size, l_direct_size) != 60000) ||
+              (l_direct_size != 60000) ||
+              (l_dst.seek(0, SEEK_CUR) != 60000)) {
+              l_result = false;
+          }
+          close(l_pair[0]);
+          close(l_pair[1]);
+      }
+      if(true) {
+          fio  l_dst(l_dst_name, O_RDONLY);
+          if((l_dst.read(l_size, l_data.data()) != 60000) ||
+              (has_test_bytes(0, l_data.data(), 60000) == false)) {
+              l_result = false;
+          }
+      }
+      // socket to a non-blocking socket through a pipe of its own, the output filling up while
+      // the peer catches up, then to a socket the peer has closed
+      if(true) {
+          int  l_src_pair[2];
+          int  l_dst_pair[2];
+          if(socketpair(AF_UNIX, SOCK_STREAM, 0, l_src_pair) != 0) {
+              return false;
+          }
+          if(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, l_dst_pair) != 0) {
+              return false;
+          }
+          fio         l_src(l_src_pair[1], O_RDONLY);
+          fio         l_dst(l_dst_pair[0], O_WRONLY);
+          std::string l_save(l_size, 0);
+          std::string l_load;
+          for(std::int64_t l_index = 0; l_index < l_size; l_index++) {
+              l_save[l_index] = get_test_byte(l_index);
+          }
+          std::thread l_writer([&]() {
+              write(l_src_pair[0], l_save.data(), l_save.size());
+          });
+          std::thread l_reader([&]() {
+              char    l_data[4096];
+              ssize_t l_read_size;
+              pollfd  l_poll{l_dst_pair[1], POLLIN, 0};
+              while(poll(std::addressof(l_poll), 1, -1) > 0) {
+                  l_read_size = read(l_dst_pair[1], l_data, sizeof(l_data));
+                  if(l_read_size <= 0) {
+                      if((l_read_size < 0) && (errno == EAGAIN)) {
+                          continue;
+                      }
+                      break;
+                  }
+                  l_load.append(l_data, l_read_size);
+                  std::this_thread::sleep_for(std::chrono::microseconds(50));
+              }
+          });
+          if((sys::transfer(l_src, l_dst, l_size, l_direct_size) != l_size) ||
+              (l_direct_size != l_size)) {
+              l_result = false;
+          }
+          shutdown(l_dst_pair[0], SHUT_WR);
+          l_writer.join();
+          l_reader.join();
+          if(l_load != l_save) {
+              l_result = false;
+          }
+          auto l_pipe_handler = std::signal(SIGPIPE, SIG_IGN);
+          close(l_dst_pair[1]);
+          if((write(l_src_pair[0], l_save.data(), 1000) != 1000) ||
+              (sys::transfer(l_src, l_dst, 1000, l_direct_size) != -1)) {
+              l_result = false;
+          }
+          std::signal(SIGPIPE, l_pipe_handler);
+          close(l_src_pair[0]);
+          close(l_src_pair[1]);
+          close(l_dst_pair[0]);
+      }
+      // file to a non-blocking socket through sendfile(), the output filling up while the peer
+      // catches up
+      if(true) {
+          int  l_pair[2];
+          if(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, l_pair) != 0) {
+              return false;
+          }
+          fio         l_src(l_src_name, O_RDONLY);
+          fio         l_dst(l_pair[0], O_WRONLY);
+          std::string l_load;
+          std::thread l_reader([&]() {
+              char    l_data[4096];
+              ssize_t l_read_size;
+              pollfd  l_poll{l_pair[1], POLLIN, 0};
+              while(poll(std::addressof(l_poll), 1, -1) > 0) {
+                  l_read_size = read(l_pair[1], l_data, sizeof(l_data));
+                  if(l_read_size <= 0) {
+                      if((l_read_size < 0) && (errno == EAGAIN)) {
+                          continue;
+                      }
+                      break;
+                  }
+                  l_load.append(l_data, l_read_size);
+                  std::this_thread::sleep_for(std::chrono::microseconds(50));
+              }
+          });
+          if((sys::transfer(l_src, l_dst, l_size, l_direct_size) != l_size) ||
+              (l_direct_size != l_size)) {
+              l_result = false;
+          }
+          shutdown(l_pair[0], SHUT_WR);
+          l_reader.join();
+          if((static_cast<std::int64_t>(l_load.size()) != l_size) ||
+              (has_test_bytes(0, l_load.data(), l_size) == false)) {
+              l_result = false;
+          }
+          close(l_pair[0]);
+          close(l_pair[1]);
+      }
+      // anything else is copied through a buffer
+      if(true) {
+          fio  l_src(l_src_name, O_RDONLY);
+          sio  l_sio;
+          if((sys::transfer(l_src, l_sio, l_size, l_direct_size) != l_size) ||
+              (l_direct_size != 0) ||
+              (l_sio.get_size() != l_size)) {
+              l_result = false;
+          }
+          fio  l_dst(l_dst_name, O_WRONLY | O_TRUNC);
+          if((sys::transfer(l_sio, l_dst, l_size) != l_size) ||
+              (l_dst.seek(0, SEEK_CUR) != l_size)) {
+              l_result = false;
+          }
+      }
+      if(true) {
+          sys::asio<fio> l_dst(l_dst_name, O_RDONLY);
+          if((l_dst.read(l_size, l_data.data()) != l_size) ||
+              (has_test_bytes(0, l_data.data(), l_size) == false)) {
+              l_result = false;
+          }
+      }
+      unlink(l_src_name);
+      unlink(l_dst_name);
+      return l_result;
+}
+
+bool  test_41() noexcept
+{
+      sio  l_sio;
+      cio  l_cio(l_sio);
+      if(l_cio.write(9, "123456789") != 9) {
+          return false;
+      }
+      if(l_cio.get_save_sum() != 0xe3069283u) {
+          return false;
+      }
+      if(crc32c::make("123456789", 9) != 0xe3069283u) {
+          return false;
+      }
+      return true;
+}
+
+bool  test_42() noexcept
+{
+      sio  l_sio;
+      cio  l_cio(l_sio);
+      char l_text[16];
+      l_sio.write(16, "0123456789ABCDEF");
+      if(l_cio.read(4, l_text) != 4) {
+          return false;
+      }
+      if(l_cio.read(8) != 8) {
+          return false;
+      }
+      if(l_cio.get_char() != 'C') {
+          return false;
+      }
+      if(l_cio.read(3, l_text) != 3) {
+          return false;
+      }
+      if(l_cio.get_read_sum() != crc32c::make("0123456789ABCDEF", 16)) {
+          return false;
+      }
+      return true;
+}
+
+/* get_crc32c_bits()
+   bitwise crc32c, as a reference for the table and hardware implementations
+*/
+static std::uint32_t get_crc32c_bits(const char* data, std::size_t size) noexcept
+{
+      std::uint32_t l_crc = 0xffffffffu;
+      for(std::size_t l_index = 0; l_index < size; l_index++) {
+          l_crc ^= static_cast<std::uint8_t>(data[l_index]);
+          for(int l_bit = 0; l_bit < 8; l_bit++) {
+              l_crc = (l_crc >> 1) ^ (crc32c::poly & (0u - (l_crc & 1u)));
+          }
+      }
+      return l_crc ^ 0xffffffffu;
+}
+
+bool  test_43() noexcept
+{
+      char l_data[16384];
+      for(std::size_t l_index = 0; l_index < sizeof(l_data); l_index++) {
+          l_data[l_index] = get_test_byte(l_index * 7 + 3);
+      }
+      // lengths around the boundaries of the interleaved blocks, at every alignment
+      for(std::size_t l_size: {0ul, 1ul, 7ul, 8ul, 9ul, 63ul, 255ul, 767ul, 768ul, 769ul, 1000ul, 3071ul, 3072ul, 8192ul + 5ul, 16376ul}) {
+          for(std::size_t l_offset = 0; l_offset < 8; l_offset++) {
+              std::uint32_t l_want = get_crc32c_bits(l_data + l_offset, l_size);
+              std::uint32_t l_sw;
+              crc32c::set(l_sw);
+              crc32c::add_sw(l_sw, l_data + l_offset, l_size);
+              if((crc32c::make(l_data + l_offset, l_size) != l_want) ||
+                  (crc32c::get(l_sw) != l_want)) {
+                  return false;
+              }
+          }
+      }
+      // the same buffer added in uneven chunks, through either implementation
+      std::uint32_t l_want = get_crc32c_bits(l_data, sizeof(l_data));
+      for(std::size_t l_chunk: {1ul, 13ul, 767ul, 1031ul, 4096ul}) {
+          std::uint32_t l_hw;
+          std::uint32_t l_sw;
+          crc32c::set(l_hw);
+          crc32c::set(l_sw);
+          for(std::size_t l_offset = 0; l_offset < sizeof(l_data); l_offset += l_chunk) {
+              std::size_t l_size = sizeof(l_data) - l_offset < l_chunk ? sizeof(l_data) - l_offset : l_chunk;
+              crc32c::add(l_hw, l_data + l_offset, l_size);
+              crc32c::add_sw(l_sw, l_data + l_offset, l_size);
+          }
+          if((crc32c::get(l_hw) != l_want) ||
+              (crc32c::get(l_sw) != l_want)) {
+              return false;
+          }
+      }
+      return true;
+}
+
+/* sys::uio tests
+*/
+bool  test_51() noexcept
+{
+      char        l_name[32];
+      std::size_t l_size = 1048576 + 123;
+      if(make_test_file(l_name, l_size) == false) {
+          return false;
+      }
+      bool l_result = true;
+      for(unsigned int l_depth: {uio::depth_default, 0u}) {
+          for(std::int32_t l_block_size: {uio::block_size_default, 4096}) {
+              uio  l_file(l_name, O_RDONLY, 0777, l_depth);
+              char l_data[8192];
+              if((l_file == false) ||
+                  (l_depth == 0 && l_file.has_ring())) {
+                  l_result = false;
+                  break;
+              }
+              l_file.set_readahead(3, l_block_size);
+              // sequential, in odd sizes
+              std::int64_t l_offset = 0;
+              std::size_t  l_step = 1;
+              while(l_offset < static_cast<std::int64_t>(l_size)) {
+                  std::int32_t l_read_size = l_file.read(l_step, l_data);
+                  if((l_read_size <= 0) ||
+                      (has_test_bytes(l_offset, l_data, l_read_size) == false)) {
+                      l_result = false;
+                      break;
+                  }
+                  l_offset += l_read_size;
+                  l_step = (l_step * 13 + 7) % sizeof(l_data) + 1;
+              }
+              if(l_file.read(sizeof(l_data), l_data) != 0) {
+                  l_result = false;
+              }
+              // back and forth
+              for(std::int64_t l_seek: {0l, 1048000l, 70000l, 69999l, 1048576l + 100l, 5l}) {
+                  if((l_file.seek(l_seek, SEEK_SET) != l_seek) ||
+                      (l_file.get_char() != get_test_byte(l_seek))) {
+                      l_result = false;
+                  }
+                  std::int32_t l_read_size = l_file.read(300, l_data);
+                  std::int32_t l_read_want = l_size - l_seek - 1 < 300 ? l_size - l_seek - 1 : 300;
+                  if((l_read_size != l_read_want) ||
+                      (has_test_bytes(l_seek + 1, l_data, l_read_size) == false)) {
+                      l_result = false;
+                  }
+              }
+          }
+      }
+      unlink(l_name);
+      return l_result;
+}
+
+bool  test_52() noexcept
+{
+      char l_name[32];
+      if(make_test_file(l_name, 0) == false) {
+          return false;
+      }
+      bool l_result = true;
+      for(unsigned int l_depth: {uio::depth_default, 0u}) {
+          uio          l_file(l_name, O_RDWR, 0777, l_depth);
+          static char  s_save_data[65536];
+          static char  s_load_data[65536];
+          struct iovec l_buffer = {s_save_data, sizeof(s_save_data)};
+          for(std::size_t l_index = 0; l_index < sizeof(s_save_data); l_index++) {
+              s_save_data[l_index] = get_test_byte(l_index);
+          }
+          if(l_file.has_ring()) {
+              l_file.register_buffers(std::addressof(l_buffer), 1);
+          }
+          // writes from the registered buffer, in one batch
+          for(std::size_t l_block = 0; l_block < 16; l_block++) {
+              l_result &= l_file.post_write(l_block * 4096, 4096, s_save_data + l_block * 4096, reinterpret_cast<void*>(l_block));
+          }
+          l_file.submit();
+          uio::completion l_list[16];
+          std::size_t     l_count = 0;
+          while(l_count < 16) {
+              std::size_t l_reap_count = l_file.reap(l_list + l_count, 16 - l_count, 1);
+              if(l_reap_count == 0) {
+                  break;
+              }
+              l_count += l_reap_count;
+          }
+          for(std::size_t l_index = 0; l_index < l_count; l_index++) {
+              if(l_list[l_index].result != 4096) {
+                  l_result = false;
+              }
+          }
+          // reads in linked chains of four, reaped into a queue
+          for(std::size_t l_block = 0; l_block < 16; l_block++) {
+              l_result &= l_file.post_read(l_block * 4096, 4096, s_load_data + l_block * 4096, reinterpret_cast<void*>(l_block), (l_block & 3) != 3);
+          }
+          parallel::queue<uio::completion, none> l_queue;
+          std::size_t l_reap_count = 0;
+          while(l_reap_count < 16) {
+              std::size_t l_next_count = l_file.reap(l_queue, 16 - l_reap_count);
+              if(l_next_count == 0) {
+                  break;
+              }
+              l_reap_count += l_next_count;
+          }
+          for(auto i_completion = l_queue.get_head(); i_completion != l_queue.get_tail(); i_completion++) {
+              std::size_t l_block = reinterpret_cast<std::size_t>(i_completion->user);
+              if((i_completion->result != 4096) ||
+                  (i_completion->offset != static_cast<std::int64_t>(l_block * 4096)) ||
+                  (has_test_bytes(l_block * 4096, i_completion->data, 4096) == false)) {
+                  l_result = false;
+              }
+          }
+          if((l_count != 16) ||
+              (l_reap_count != 16) ||
+              (l_file.get_pending_count() != 0) ||
+              (std::memcmp(s_save_data, s_load_data, sizeof(s_save_data)) != 0)) {
+              l_result = false;
+          }
+          // the stream interface sees the same file
+          if((l_file.seek(4096 * 3 + 5, SEEK_SET) != 4096 * 3 + 5) ||
+              (l_file.get_char() != get_test_byte(4096 * 3 + 5)) ||
+              (l_file.get_size() != 65536)) {
+              l_result = false;
+          }
+          // outstanding requests are bounded by the queue depth
+          std::size_t l_post_count = 0;
+          while(l_file.post_read(0, 1, s_load_data, nullptr)) {
+              l_post_count++;
+          }
+          if((l_post_count == 0) ||
+              (l_post_count > uio::depth_default) ||
+              (l_file.reap(l_list, 16, 16) != 16) ||
+              (l_file.post_read(0, 1, s_load_data, nullptr) == false)) {
+              l_result = false;
+          }
+      }
+      unlink(l_name);
+      return l_result;
+}
+
+bool  test_53() noexcept
+{
+      char        l_name[32];
+      const char* l_text = "the quick brown fox jumps over the lazy dog\n";
+      std::size_t l_size = 16777216;
+      if(make_test_file(l_name, l_size, l_text) == false) {
+          return false;
+      }
+      bool l_result = true;
+      // records through bio, with each source
+      auto l_get_records = [&](sys::ios& source, const char* name) {
+          bio          l_bio(std::addressof(source));
+          char         l_data[44];
+          std::size_t  l_count = 0;
+          auto         l_start = std::chrono::steady_clock::now();
+          while(l_bio.read(sizeof(l_data), l_data) == sizeof(l_data)) {
+              if(std::strncmp(l_data, l_text, sizeof(l_data)) != 0) {
+                  l_result = false;
+                  break;
+              }
+              l_count++;
+          }
+          double l_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - l_start).count();
+          printf("    %s: %zu records, %.1f MiB/s\n", name, l_count, l_size / l_time / 1048576.0);
+          if(l_count != l_size / 44) {
+              l_result = false;
+          }
+      };
+      // raw blocks, with each source
+      auto l_get_blocks = [&](sys::ios& source, const char* name) {
+          static char  s_data[16384];
+          std::size_t  l_total = 0;
+          std::int32_t l_read_size;
+          auto         l_start = std::chrono::steady_clock::now();
+          while((l_read_size = source.read(sizeof(s_data), s_data)) > 0) {
+              l_total += l_read_size;
+          }
+          double l_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - l_start).count();
+          printf("    %s: %.1f MiB/s\n", name, l_size / l_time / 1048576.0);
+          if(l_total != l_size) {
+              l_result = false;
+          }
+      };
+      if(true) {
+          fio l_file(l_name, O_RDONLY);
+          l_get_blocks(l_file, "fio 16KiB reads");
+      }
+      if(true) {
+          uio l_file(l_name, O_RDONLY);
+          l_get_blocks(l_file, l_file.has_ring() ? "uio 16KiB reads" : "uio 16KiB reads (fallback)");
+      }
+      if(true) {
+          fio l_file(l_name, O_RDONLY);
+          l_get_records(l_file, "bio over fio");
+      }
+      if(true) {
+          uio l_file(l_name, O_RDONLY);
+          l_get_records(l_file, "bio over uio");
+      }
+      if(true) {
+          sys::asio<uio> l_file(l_name, O_RDONLY);
+          char           l_data[44];
+          if((l_file.read(sizeof(l_data), l_data) != sizeof(l_data)) ||
+              (std::strncmp(l_data, l_text, sizeof(l_data)) != 0)) {
+              l_result = false;
+          }
+      }
+      unlink(l_name);
+      return l_result;
+}
+
+/* sys::mio tests
+*/
+bool  test_61() noexcept
+{
+      char        l_name[32];
+      std::size_t l_size = 1048576 + 123;
+      if(make_test_file(l_name, l_size) == false) {
+          return false;
+      }
+      bool l_result = true;
+      // a window of 16 pages, so that most requests cross one
+      mio  l_file(l_name, O_RDONLY, 65536);
+      char l_data[8192];
+      if((l_file == false) ||
+          (l_file.get_size() != static_cast<std::int64_t>(l_size)) ||
+          (l_file.is_writable())) {
+          l_result = false;
+      }
+      // spans, straight from the mapping
+      std::int64_t l_offset = 0;
+      std::size_t  l_step = 1;
+      while(l_offset < static_cast<std::int64_t>(l_size)) {
+          std::int32_t l_span_size;
+          char*        l_span = l_file.get_span(l_step, l_span_size);
+          if((l_span == nullptr) ||
+              (l_span_size <= 0) ||
+              (has_test_bytes(l_offset, l_span, l_span_size) == false)) {
+              l_result = false;
+              break;
+          }
+          l_offset += l_span_size;
+          l_step = (l_step * 13 + 7) % 100000 + 1;
+      }
+      std::int32_t l_span_size;
+      if((l_file.get_span(1, l_span_size) != nullptr) ||
+          (l_file.get_data() != nullptr) ||
+          (l_file.get_char() != EOF)) {
+          l_result = false;
+      }
+      // copies and seeks
+      for(std::int64_t l_seek: {0l, 1048000l, 65535l, 65536l, 1048576l + 100l, 5l}) {
+          if((l_file.seek(l_seek, SEEK_SET) != l_seek) ||
+              (l_file.get_char() != get_test_byte(l_seek)) ||
+              (l_file.get_data() == nullptr) ||
+              (*l_file.get_data() != get_test_byte(l_seek + 1))) {
+              l_result = false;
+          }
+          std::int32_t l_read_size = l_file.read(sizeof(l_data), l_data);
+          std::int32_t l_read_want = l_size - l_seek - 1 < sizeof(l_data) ? l_size - l_seek - 1 : sizeof(l_data);
+          if((l_read_size != l_read_want) ||
+              (has_test_bytes(l_seek + 1, l_data, l_read_size) == false)) {
+              l_result = false;
+          }
+      }
+      unlink(l_name);
+      return l_result;
+}
+
+bool  test_62() noexcept
+{
+      char l_name[32];
+      if(make_test_file(l_name, 0) == false) {
+          return false;
+      }
+      // lines of growing length, some of them longer than the window, an empty one and a last
+      // one without end of line
+      std::string l_text;
+      for(std::size_t l_line = 0; l_line < 64; l_line++) {
+          l_text.append(l_line * l_line * 7, 'a' + l_line % 26);
+          l_text.push_back('\n');
+      }
+      l_text.append("last");
+      if(true) {
+          fio l_file(l_name, O_WRONLY);
+          l_file.write(l_text.size(), l_text.data());
+      }
+      bool l_result = true;
+      mio  l_file(l_name, O_RDONLY, 4096);
+      std::size_t  l_count = 0;
+      std::int32_t l_length;
+      while(char* l_line = l_file.get_line(l_length)) {
+          std::size_t l_want = l_count < 64 ? l_count * l_count * 7 : 4;
+          if((static_cast<std::size_t>(l_length) != l_want) ||
+              ((l_count < 64) && l_length && ((l_line[0] != 'a' + static_cast<char>(l_count % 26)) || (l_line[l_length - 1] != l_line[0]))) ||
+              ((l_count == 64) && std::strncmp(l_line, "last", 4))) {
+              l_result = false;
+          }
+          l_count++;
+      }
+      if((l_count != 65) ||
+          (l_length != -1)) {
+          l_result = false;
+      }
+      // as a source for bio
+      sys::asio<mio> l_asio(l_name, O_RDONLY);
+      char l_data[64];
+      if((l_asio.read(8, l_data) != 8) ||
+          (std::strncmp(l_data, "\nbbbbbbb", 8) != 0) ||
+          (l_asio.seek(l_text.size() - 4, SEEK_SET) != static_cast<std::int64_t>(l_text.size() - 4)) ||
+          (l_asio.read(sizeof(l_data), l_data) != 4) ||
+          (std::strncmp(l_data, "last", 4) != 0)) {
+          l_result = false;
+      }
+      unlink(l_name);
+      return l_result;
+}
+
+bool  test_63() noexcept
+{
+      char        l_name[32];
+      const char* l_text = "the quick brown fox jumps over the lazy dog\n";
+      std::size_t l_size = 67108864;
+      if(make_test_file(l_name, l_size, l_text) == false) {
+          return false;
+      }
+      bool        l_result = true;
+      std::size_t l_line_count = (l_size + 43) / 44;
+      if(true) {
+          mio          l_file(l_name);
+          std::size_t  l_count = 0;
+          std::int32_t l_length;
+          auto         l_start = std::chrono::steady_clock::now();
+          while(l_file.get_line(l_length)) {
+              l_count++;
+          }
+          double l_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - l_start).count();
+          printf("    mio get_line(): %.1f MiB/s\n", l_size / l_time / 1048576.0);
+          l_result &= l_count == l_line_count;
+      }
+      if(true) {
+          fio          l_file(l_name, O_RDONLY);
+          static char  s_data[65536];
+          std::size_t  l_count = 0;
+          std::int32_t l_read_size;
+          char         l_last = '\n';
+          auto         l_start = std::chrono::steady_clock::now();
+          while((l_read_size = l_file.read(sizeof(s_data), s_data)) > 0) {
+              char* l_iter = s_data;
+              char* l_tail = s_data + l_read_size;
+              while(char* l_eol = static_cast<char*>(std::memchr(l_iter, '\n', l_tail - l_iter))) {
+                  l_count++;
+                  l_iter = l_eol + 1;
+              }
+              l_last = l_tail[-1];
+          }
+          if(l_last != '\n') {
+              l_count++;
+          }
+          double l_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - l_start).count();
+          printf("    fio 64KiB reads and memchr(): %.1f MiB/s\n", l_size / l_time / 1048576.0);
+          l_result &= l_count == l_line_count;
+      }
+      unlink(l_name);
+      return l_result;
+}
+
 bool  make_server_socket(int& desc, const char* location) noexcept
 {
       // open an UNIX socket
@@ -660,6 +1753,24 @@ int   main(int, char**)
 
       test::scenario<basic> t31(test_31, "[31]");
       test::scenario<basic> t32(test_32, "[32]");
+      test::scenario<basic> t33(test_33, "[33] sys::bio get_line() across buffer refills");
+      test::scenario<basic> t34(test_34, "[34] sys::bio get_lines() batches");
+      test::scenario<basic> t35(test_35, "[35] sys::bio get_line() throughput against getline(3)");
+      test::scenario<basic> t36(test_36, "[36] sys::ios offsets past 4GiB, on a sparse file");
+      test::scenario<basic> t37(test_37, "[37] sys::ios readv() and writev(), buffered and not");
+      test::scenario<basic> t38(test_38, "[38] sys::transfer() between files, pipes and buffered streams");
+
+      test::scenario<basic> t41(test_41, "[41] sys::cio crc32c of written data");
+      test::scenario<basic> t42(test_42, "[42] sys::cio crc32c of read and skipped data");
+      test::scenario<basic> t43(test_43, "[43] crc32c of long, unaligned and chunked buffers against a bitwise reference");
+
+      test::scenario<basic> t51(test_51, "[51] sys::uio sequential and random reads, with and without io_uring");
+      test::scenario<basic> t52(test_52, "[52] sys::uio batched requests, registered buffers and reaping into a queue");
+      test::scenario<basic> t53(test_53, "[53] sys::uio as a bio source against fio");
+
+      test::scenario<basic> t61(test_61, "[61] sys::mio spans, copies and seeks across windows");
+      test::scenario<basic> t62(test_62, "[62] sys::mio line iteration and use as a bio source");
+      test::scenario<basic> t63(test_63, "[63] sys::mio line iteration against fio reads");
 
       test::scenario<basic> t91(test_91, "[91]");
 
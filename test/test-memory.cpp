@@ -0,0 +1,665 @@
+#include "test-memory.h"
+#include <memory/bloom_filter.h>
+#include <memory/cuckoo_filter.h>
+#include <memory/spsc_ring.h>
+#include <memory/mpmc_ring.h>
+#include <memory/small_list.h>
+#include <memory/perfect_map.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <string>
+#include <cstdio>
+
+static constexpr std::size_t s_key_count = 1000000;
+static constexpr std::size_t s_probe_count = 1000000;
+static constexpr std::size_t s_ring_count = 4000000;
+
+/* get_key()
+   keys [0, s_key_count) are inserted, keys from s_key_count onwards are only ever probed
+*/
+static std::uint64_t get_key(std::uint64_t index) noexcept
+{
+      std::uint64_t l_key = index * 0x9e3779b97f4a7c15ull;
+      l_key = (l_key ^ (l_key >> 30)) * 0xbf58476d1ce4e5b9ull;
+      l_key = (l_key ^ (l_key >> 27)) * 0x94d049bb133111ebull;
+      return l_key ^ (l_key >> 31);
+}
+
+static double get_ns(std::chrono::steady_clock::time_point start, std::size_t count) noexcept
+{
+      std::chrono::duration<double, std::nano> l_time = std::chrono::steady_clock::now() - start;
+      return l_time.count() / count;
+}
+
+/* memory::bloom_filter tests
+*/
+bool  test_01() noexcept
+{
+      memory::bloom_filter l_filter(s_key_count);
+      if(l_filter) {
+          for(std::size_t l_index = 0; l_index < s_key_count; l_index++) {
+              l_filter.insert(get_key(l_index));
+          }
+          for(std::size_t l_index = 0; l_index < s_key_count; l_index++) {
+              if(l_filter.contains(get_key(l_index)) == false) {
+                  return false;
+              }
+          }
+          return true;
+      }
+      return false;
+}
+
+bool  test_02() noexcept
+{
+      memory::bloom_filter l_filter(s_key_count);
+      if(l_filter) {
+          l_filter.insert("alpha");
+          l_filter.insert("beta", 4);
+          if(l_filter.contains("alpha") &&
+              l_filter.contains("beta") &&
+              l_filter.contains("alpha", 5)) {
+              l_filter.clear();
+              return l_filter.contains("alpha") == false;
+          }
+      }
+      return false;
+}
+
+bool  test_03() noexcept
+{
+      for(std::size_t l_bits_per_key: {8u, 12u, 16u}) {
+          memory::bloom_filter l_filter(s_key_count, l_bits_per_key);
+          std::size_t          l_hit_count = 0;
+          for(std::size_t l_index = 0; l_index < s_key_count; l_index++) {
+              l_filter.insert(get_key(l_index));
+          }
+          for(std::size_t l_index = 0; l_index < s_probe_count; l_index++) {
+              if(l_filter.contains(get_key(s_key_count + l_index))) {
+                  l_hit_count++;
+              }
+          }
+          double l_rate = 100.0 * l_hit_count / s_probe_count;
+          printf("    bloom_filter: %2zu bits/key, %7zu bytes, false positive rate %.3f%%\n", l_bits_per_key, l_filter.get_size(), l_rate);
+          if((l_bits_per_key == 16u) && (l_rate > 1.0)) {
+              return false;
+          }
+      }
+      return true;
+}
+
+bool  test_04() noexcept
+{
+      memory::bloom_filter l_filter(s_key_count);
+      std::size_t          l_hit_count = 0;
+      auto l_insert_start = std::chrono::steady_clock::now();
+      for(std::size_t l_index = 0; l_index < s_key_count; l_index++) {
+          l_filter.insert(l_index * 0x9e3779b97f4a7c15ull);
+      }
+      double l_insert_ns = get_ns(l_insert_start, s_key_count);
+      auto l_probe_start = std::chrono::steady_clock::now();
+      for(std::size_t l_index = 0; l_index < s_probe_count; l_index++) {
+          if(l_filter.contains(l_index * 0xc6a4a7935bd1e995ull)) {
+              l_hit_count++;
+          }
+      }
+      double l_probe_ns = get_ns(l_probe_start, s_probe_count);
+      printf("    bloom_filter: insert %.2f ns/key, contains %.2f ns/key (%zu hits)\n", l_insert_ns, l_probe_ns, l_hit_count);
+      return true;
+}
+
+/* memory::cuckoo_filter tests
+*/
+bool  test_11() noexcept
+{
+      memory::cuckoo_filter l_filter(s_key_count);
+      if(l_filter) {
+          for(std::size_t l_index = 0; l_index < s_key_count; l_index++) {
+              if(l_filter.insert(get_key(l_index)) == false) {
+                  return false;
+              }
+          }
+          for(std::size_t l_index = 0; l_index < s_key_count; l_index++) {
+              if(l_filter.contains(get_key(l_index)) == false) {
+                  return false;
+              }
+          }
+          return l_filter.get_count() == s_key_count;
+      }
+      return false;
+}
+
+bool  test_12() noexcept
+{
+      memory::cuckoo_filter l_filter(s_key_count);
+      for(std::size_t l_index = 0; l_index < s_key_count; l_index++) {
+          l_filter.insert(get_key(l_index));
+      }
+      // remove every other key; the rest must still be found
+      for(std::size_t l_index = 0; l_index < s_key_count; l_index += 2) {
+          if(l_filter.remove(get_key(l_index)) == false) {
+              return false;
+          }
+      }
+      for(std::size_t l_index = 1; l_index < s_key_count; l_index += 2) {
+          if(l_filter.contains(get_key(l_index)) == false) {
+              return false;
+          }
+      }
+      std::size_t l_hit_count = 0;
+      for(std::size_t l_index = 0; l_index < s_key_count; l_index += 2) {
+          if(l_filter.contains(get_key(l_index))) {
+              l_hit_count++;
+          }
+      }
+      if(l_hit_count > s_key_count / 200u) {
+          return false;
+      }
+      return l_filter.get_count() == s_key_count / 2u;
+}
+
+bool  test_13() noexcept
+{
+      memory::cuckoo_filter l_filter(1024);
+      std::size_t           l_insert_count = 0;
+      // overfill the filter: insert() must eventually fail, without losing any of the keys
+      // stored so far
+      while(l_filter.insert(get_key(l_insert_count))) {
+          l_insert_count++;
+      }
+      if(l_insert_count < l_filter.get_capacity() * 9u / 10u) {
+          return false;
+      }
+      for(std::size_t l_index = 0; l_index < l_insert_count; l_index++) {
+          if(l_filter.contains(get_key(l_index)) == false) {
+              return false;
+          }
+      }
+      printf("    cuckoo_filter: %zu of %zu slots filled\n", l_insert_count, l_filter.get_capacity());
+      return true;
+}
+
+bool  test_14() noexcept
+{
+      memory::cuckoo_filter l_filter(s_key_count);
+      std::size_t           l_hit_count = 0;
+      for(std::size_t l_index = 0; l_index < s_key_count; l_index++) {
+          l_filter.insert(get_key(l_index));
+      }
+      for(std::size_t l_index = 0; l_index < s_probe_count; l_index++) {
+          if(l_filter.contains(get_key(s_key_count + l_index))) {
+              l_hit_count++;
+          }
+      }
+      double l_rate = 100.0 * l_hit_count / s_probe_count;
+      printf("    cuckoo_filter: %7zu bytes, false positive rate %.3f%%\n", l_filter.get_size(), l_rate);
+      return l_rate < 1.0;
+}
+
+bool  test_15() noexcept
+{
+      memory::cuckoo_filter l_filter(s_key_count);
+      std::size_t           l_hit_count = 0;
+      auto l_insert_start = std::chrono::steady_clock::now();
+      for(std::size_t l_index = 0; l_index < s_key_count; l_index++) {
+          l_filter.insert(l_index * 0x9e3779b97f4a7c15ull);
+      }
+      double l_insert_ns = get_ns(l_insert_start, s_key_count);
+      auto l_probe_start = std::chrono::steady_clock::now();
+      for(std::size_t l_index = 0; l_index < s_probe_count; l_index++) {
+          if(l_filter.contains(l_index * 0xc6a4a7935bd1e995ull)) {
+              l_hit_count++;
+          }
+      }
+      double l_probe_ns = get_ns(l_probe_start, s_probe_count);
+      auto l_remove_start = std::chrono::steady_clock::now();
+      for(std::size_t l_index = 0; l_index < s_key_count; l_index++) {
+          l_filter.remove(l_index * 0x9e3779b97f4a7c15ull);
+      }
+      double l_remove_ns = get_ns(l_remove_start, s_key_count);
+      printf("    cuckoo_filter: insert %.2f ns/key, contains %.2f ns/key, remove %.2f ns/key (%zu hits)\n", l_insert_ns, l_probe_ns, l_remove_ns, l_hit_count);
+      return l_filter.get_count() == 0;
+}
+
+/* memory::spsc_ring tests
+*/
+bool  test_21() noexcept
+{
+      memory::spsc_ring<int> l_ring(6);
+      int                    l_value;
+      if(l_ring.get_capacity() != 8) {
+          return false;
+      }
+      // wrap around the end of the storage a few times
+      for(int l_round = 0; l_round < 5; l_round++) {
+          for(int l_index = 0; l_index < 8; l_index++) {
+              if(l_ring.push(l_round * 8 + l_index) == false) {
+                  return false;
+              }
+          }
+          if(l_ring.push(-1)) {
+              return false;
+          }
+          for(int l_index = 0; l_index < 5; l_index++) {
+              if((l_ring.pop(l_value) == false) ||
+                  (l_value != l_round * 8 + l_index)) {
+                  return false;
+              }
+          }
+          int l_list[8];
+          if(l_ring.pop(std::span<int>(l_list)) != 3) {
+              return false;
+          }
+          if(l_list[2] != l_round * 8 + 7) {
+              return false;
+          }
+      }
+      int l_list[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+      if(l_ring.push(std::span<const int>(l_list)) != 8) {
+          return false;
+      }
+      // a ring whose storage could not be allocated takes nothing
+      memory::spsc_ring<int> l_none(nullptr, 8);
+      if(l_none.push(1) ||
+          l_none.pop(l_value) ||
+          (l_none.push(std::span<const int>(l_list)) != 0)) {
+          return false;
+      }
+      return l_ring.get_size() == 8;
+}
+
+bool  test_22() noexcept
+{
+      memory::spsc_ring<std::size_t> l_ring(1024);
+      bool                           l_order = true;
+      auto l_start = std::chrono::steady_clock::now();
+      std::thread l_consumer([&]() {
+          std::size_t l_expect = 0;
+          std::size_t l_value;
+          while(l_expect < s_ring_count) {
+              if(l_ring.pop(l_value)) {
+                  if(l_value != l_expect) {
+                      l_order = false;
+                  }
+                  l_expect++;
+              } else
+                  std::this_thread::yield();
+          }
+      });
+      for(std::size_t l_index = 0; l_index < s_ring_count; l_index++) {
+          while(l_ring.push(l_index) == false) {
+              std::this_thread::yield();
+          }
+      }
+      l_consumer.join();
+      printf("    spsc_ring: %.2f ns/element\n", get_ns(l_start, s_ring_count));
+      return l_order;
+}
+
+bool  test_23() noexcept
+{
+      constexpr std::size_t          l_batch_size = 64;
+      memory::spsc_ring<std::size_t> l_ring(1024);
+      bool                           l_order = true;
+      auto l_start = std::chrono::steady_clock::now();
+      std::thread l_consumer([&]() {
+          std::size_t l_expect = 0;
+          std::size_t l_list[l_batch_size];
+          while(l_expect < s_ring_count) {
+              std::size_t l_count = l_ring.pop(std::span<std::size_t>(l_list));
+              if(l_count) {
+                  for(std::size_t l_index = 0; l_index < l_count; l_index++) {
+                      if(l_list[l_index] != l_expect) {
+                          l_order = false;
+                      }
+                      l_expect++;
+                  }
+              } else
+                  std::this_thread::yield();
+          }
+      });
+      std::size_t l_list[l_batch_size];
+      for(std::size_t l_index = 0; l_index < s_ring_count; l_index += l_batch_size) {
+          for(std::size_t l_offset = 0; l_offset < l_batch_size; l_offset++) {
+              l_list[l_offset] = l_index + l_offset;
+          }
+          std::span<const std::size_t> l_span(l_list);
+          while(l_span.size()) {
+              std::size_t l_count = l_ring.push(l_span);
+              if(l_count == 0) {
+                  std::this_thread::yield();
+              }
+              l_span = l_span.subspan(l_count);
+          }
+      }
+      l_consumer.join();
+      printf("    spsc_ring: %.2f ns/element in batches of %zu\n", get_ns(l_start, s_ring_count), l_batch_size);
+      return l_order;
+}
+
+/* memory::mpmc_ring tests
+*/
+bool  test_31() noexcept
+{
+      memory::mpmc_ring<int> l_ring(8);
+      int                    l_value;
+      for(int l_round = 0; l_round < 5; l_round++) {
+          for(int l_index = 0; l_index < 8; l_index++) {
+              if(l_ring.push(l_round * 8 + l_index) == false) {
+                  return false;
+              }
+          }
+          if(l_ring.push(-1)) {
+              return false;
+          }
+          for(int l_index = 0; l_index < 5; l_index++) {
+              if((l_ring.pop(l_value) == false) ||
+                  (l_value != l_round * 8 + l_index)) {
+                  return false;
+              }
+          }
+          int l_list[8];
+          if(l_ring.pop(std::span<int>(l_list)) != 3) {
+              return false;
+          }
+          if(l_list[2] != l_round * 8 + 7) {
+              return false;
+          }
+      }
+      // a ring whose storage could not be allocated takes nothing
+      memory::mpmc_ring<int> l_none(nullptr, 8);
+      if(l_none.push(1) ||
+          l_none.pop(l_value)) {
+          return false;
+      }
+      return l_ring.pop(l_value) == false;
+}
+
+/* test_mpmc()
+   <thread_count> producers and as many consumers move s_ring_count elements; every element must
+   arrive exactly once
+*/
+static bool test_mpmc(std::size_t thread_count, std::size_t batch_size) noexcept
+{
+      memory::mpmc_ring<std::size_t> l_ring(1024);
+      std::atomic<std::size_t>       l_sum(0);
+      std::atomic<std::size_t>       l_received(0);
+      std::size_t                    l_count = s_ring_count / thread_count;
+      std::vector<std::thread>       l_threads;
+      auto l_start = std::chrono::steady_clock::now();
+      for(std::size_t l_thread = 0; l_thread < thread_count; l_thread++) {
+          l_threads.emplace_back([&, l_thread]() {
+              std::size_t l_list[64];
+              std::size_t l_base = l_thread * l_count;
+              for(std::size_t l_index = 0; l_index < l_count; l_index += batch_size) {
+                  for(std::size_t l_offset = 0; l_offset < batch_size; l_offset++) {
+                      l_list[l_offset] = l_base + l_index + l_offset;
+                  }
+                  std::span<const std::size_t> l_span(l_list, batch_size);
+                  while(l_span.size()) {
+                      std::size_t l_pushed = l_ring.push(l_span);
+                      if(l_pushed == 0) {
+                          std::this_thread::yield();
+                      }
+                      l_span = l_span.subspan(l_pushed);
+                  }
+              }
+          });
+          l_threads.emplace_back([&]() {
+              std::size_t l_list[64];
+              std::size_t l_local_sum = 0;
+              while(l_received.load(std::memory_order_relaxed) < l_count * thread_count) {
+                  std::size_t l_popped = l_ring.pop(std::span<std::size_t>(l_list, batch_size));
+                  if(l_popped) {
+                      for(std::size_t l_index = 0; l_index < l_popped; l_index++) {
+                          l_local_sum += l_list[l_index];
+                      }
+                      l_received.fetch_add(l_popped, std::memory_order_relaxed);
+                  } else
+                      std::this_thread::yield();
+              }
+              l_sum.fetch_add(l_local_sum);
+          });
+      }
+      for(auto& l_thread: l_threads) {
+          l_thread.join();
+      }
+      std::size_t l_total = l_count * thread_count;
+      printf("    mpmc_ring: %zu producers, %zu consumers, batches of %2zu: %.2f ns/element\n", thread_count, thread_count, batch_size, get_ns(l_start, l_total));
+      return l_sum.load() == l_total * (l_total - 1) / 2;
+}
+
+bool  test_32() noexcept
+{
+      return test_mpmc(1, 1);
+}
+
+bool  test_33() noexcept
+{
+      return test_mpmc(1, 64);
+}
+
+bool  test_34() noexcept
+{
+      return test_mpmc(2, 1) && test_mpmc(2, 64);
+}
+
+/* memory::small_list tests
+*/
+class count_resource: public std::pmr::memory_resource
+{
+  public:
+  std::size_t m_alloc_count = 0;
+  std::size_t m_free_count = 0;
+
+  protected:
+  virtual void* do_allocate(std::size_t size, std::size_t align) override {
+          m_alloc_count++;
+          return std::pmr::new_delete_resource()->allocate(size, align);
+  }
+
+  virtual void  do_deallocate(void* p, std::size_t size, std::size_t align) override {
+          m_free_count++;
+          std::pmr::new_delete_resource()->deallocate(p, size, align);
+  }
+
+  virtual bool  do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+          return this == std::addressof(other);
+  }
+};
+
+bool  test_41() noexcept
+{
+      count_resource l_resource;
+      {
+          memory::small_list<int, 4> l_list(std::addressof(l_resource));
+          for(int l_index = 0; l_index < 4; l_index++) {
+              l_list.push_back(l_index);
+          }
+          if((l_list.is_inline() == false) ||
+              (l_resource.m_alloc_count != 0)) {
+              return false;
+          }
+          l_list.push_back(4);
+          if(l_list.is_inline() ||
+              (l_resource.m_alloc_count != 1)) {
+              return false;
+          }
+          if((l_list.contains(3) == false) ||
+              l_list.contains(7) ||
+              (l_list.find(4) != l_list.end() - 1) ||
+              (l_list.find(7) != l_list.end())) {
+              return false;
+          }
+          l_list.erase(l_list.find(1));
+          l_list.erase(l_list.find(3));
+          if(l_list.shrink_to_fit() == false) {
+              return false;
+          }
+          if((l_list.is_inline() == false) ||
+              (l_list.size() != 3) ||
+              (l_list[0] != 0) ||
+              (l_list[1] != 2) ||
+              (l_list[2] != 4)) {
+              return false;
+          }
+      }
+      return l_resource.m_free_count == l_resource.m_alloc_count;
+}
+
+bool  test_42() noexcept
+{
+      count_resource l_resource;
+      {
+          memory::small_list<std::string, 2> l_list(std::addressof(l_resource));
+          l_list.push_back("alpha, and then some more text to avoid the small string buffer");
+          l_list.push_back("beta");
+          // moving an inline list moves the elements
+          memory::small_list<std::string, 2> l_inline(std::move(l_list));
+          if((l_inline.size() != 2) ||
+              (l_inline[1] != "beta") ||
+              (l_list.size() != 0)) {
+              return false;
+          }
+          l_inline.push_back("gamma");
+          std::string* l_data = l_inline.data();
+          // moving a spilled list transfers the buffer
+          memory::small_list<std::string, 2> l_spilled(std::move(l_inline));
+          if((l_spilled.data() != l_data) ||
+              (l_inline.size() != 0) ||
+              (l_inline.is_inline() == false)) {
+              return false;
+          }
+          memory::small_list<std::string, 2> l_copy(l_spilled);
+          l_copy.insert(l_copy.begin(), "delta");
+          l_copy.push_back(l_copy[0]);
+          if((l_copy.size() != 5) ||
+              (l_copy.front() != "delta") ||
+              (l_copy.back() != "delta") ||
+              (l_copy[1] != l_spilled[0])) {
+              return false;
+          }
+          l_spilled = std::move(l_copy);
+          if((l_spilled.size() != 5) ||
+              (l_copy.size() != 0)) {
+              return false;
+          }
+      }
+      return l_resource.m_free_count == l_resource.m_alloc_count;
+}
+
+/* memory::perfect_hash tests
+*/
+static constexpr const char* s_keyword_list[] = {
+      "", "if", "else", "for", "while", "do", "return", "break", "continue", "switch", "case",
+      "default", "goto", "struct", "union", "enum", "typedef", "static", "const", "volatile"
+};
+
+static constexpr memory::perfect_hash s_keyword_hash(s_keyword_list);
+
+bool  test_51() noexcept
+{
+      // hits, misses and the empty key, both at compile time and at run time
+      static_assert(s_keyword_hash.is_valid());
+      static_assert(s_keyword_hash.find("while") == 4);
+      static_assert(s_keyword_hash.find("") == 0);
+      static_assert(s_keyword_hash.find("whilst") == -1);
+      static_assert(s_keyword_hash.find("els") == -1);
+      static_assert(s_keyword_hash.contains("volatile"));
+      for(std::size_t l_index = 0; l_index < std::size(s_keyword_list); l_index++) {
+          std::string l_key(s_keyword_list[l_index]);
+          if(s_keyword_hash.find(l_key.c_str()) != static_cast<int>(l_index)) {
+              return false;
+          }
+          // prefixes and extensions of a key are not members, unless keys themselves
+          l_key.push_back('x');
+          if(s_keyword_hash.contains(l_key.c_str())) {
+              return false;
+          }
+          if(s_keyword_hash.find(s_keyword_list[l_index], l_key.size() - 1) != static_cast<int>(l_index)) {
+              return false;
+          }
+      }
+      if(s_keyword_hash.contains(nullptr) ||
+          s_keyword_hash.contains("typedef", 3) ||
+          s_keyword_hash.contains("int")) {
+          return false;
+      }
+      return true;
+}
+
+bool  test_52() noexcept
+{
+      // key sets no layout can be built for
+      static constexpr const char* l_duplicate_list[] = {"alpha", "beta", "alpha"};
+      static constexpr const char* l_null_list[] = {"alpha", nullptr, "gamma"};
+      static constexpr const char* l_empty_list[] = {"", ""};
+      static_assert(memory::perfect_hash(l_duplicate_list).is_valid() == false);
+      static_assert(memory::perfect_hash(l_null_list).is_valid() == false);
+      static_assert(memory::perfect_hash(l_empty_list).is_valid() == false);
+      static constexpr const char* l_single_list[] = {"alpha"};
+      static_assert(memory::perfect_hash(l_single_list).is_valid());
+      static_assert(memory::perfect_hash(l_single_list).find("alpha") == 0);
+      static_assert(memory::perfect_hash(l_single_list).find("beta") == -1);
+      return true;
+}
+
+bool  test_53() noexcept
+{
+      static constexpr const char* l_key_list[] = {"red", "green", "blue", "cyan", "magenta", "yellow"};
+      static constexpr std::uint32_t l_value_list[] = {0xff0000u, 0x00ff00u, 0x0000ffu, 0x00ffffu, 0xff00ffu, 0xffff00u};
+      static constexpr memory::perfect_map l_map(l_key_list, l_value_list);
+      static_assert(l_map.is_valid());
+      static_assert(*l_map.find("magenta") == 0xff00ffu);
+      static_assert(l_map.find("black") == nullptr);
+      for(std::size_t l_index = 0; l_index < std::size(l_key_list); l_index++) {
+          std::string                 l_key(l_key_list[l_index]);
+          const std::uint32_t*        l_value = l_map.find(l_key.c_str());
+          if((l_value == nullptr) ||
+              (*l_value != l_value_list[l_index]) ||
+              (l_map.find(l_key.c_str(), l_key.size()) != l_value)) {
+              return false;
+          }
+      }
+      if((l_map.find("") != nullptr) ||
+          (l_map.find(nullptr) != nullptr) ||
+          l_map.contains("blu") ||
+          (l_map.contains("bluest", 4) == false)) {
+          return false;
+      }
+      return true;
+}
+
+int   main(int, char**)
+{
+      test::scenario<basic> t01(test_01, "[01] memory::bloom_filter no false negatives");
+      test::scenario<basic> t02(test_02, "[02] memory::bloom_filter string keys and clear()");
+      test::scenario<basic> t03(test_03, "[03] memory::bloom_filter false positive rate");
+      test::scenario<basic> t04(test_04, "[04] memory::bloom_filter throughput");
+
+      test::scenario<basic> t11(test_11, "[11] memory::cuckoo_filter no false negatives");
+      test::scenario<basic> t12(test_12, "[12] memory::cuckoo_filter remove()");
+      test::scenario<basic> t13(test_13, "[13] memory::cuckoo_filter insert() into a full filter");
+      test::scenario<basic> t14(test_14, "[14] memory::cuckoo_filter false positive rate");
+      test::scenario<basic> t15(test_15, "[15] memory::cuckoo_filter throughput");
+
+
+      test::scenario<basic> t21(test_21, "[21] memory::spsc_ring push() and pop() with wrap-around");
+      test::scenario<basic> t22(test_22, "[22] memory::spsc_ring two thread throughput");
+      test::scenario<basic> t23(test_23, "[23] memory::spsc_ring two thread batch throughput");
+
+      test::scenario<basic> t31(test_31, "[31] memory::mpmc_ring push() and pop() with wrap-around");
+      test::scenario<basic> t32(test_32, "[32] memory::mpmc_ring two thread throughput");
+      test::scenario<basic> t33(test_33, "[33] memory::mpmc_ring two thread batch throughput");
+      test::scenario<basic> t34(test_34, "[34] memory::mpmc_ring four thread throughput");
+
+      test::scenario<basic> t41(test_41, "[41] memory::small_list inline storage and spill-over");
+      test::scenario<basic> t42(test_42, "[42] memory::small_list copy and move");
+
+      test::scenario<basic> t51(test_51, "[51] memory::perfect_hash find() hits, misses and the empty key");
+      test::scenario<basic> t52(test_52, "[52] memory::perfect_hash with duplicate and null keys");
+      test::scenario<basic> t53(test_53, "[53] memory::perfect_map value lookup");
+
+      return test::run_all();
+}
@@ -0,0 +1,4 @@
+#ifndef  test_memory_h
+#define  test_memory_h
+#include <test.h>
+#endif
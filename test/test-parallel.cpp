@@ -0,0 +1,1821 @@
+#include "test-parallel.h"
+#include <parallel.h>
+#include <parallel/executor.h>
+#include <parallel/queue.h>
+#include <parallel/multi-queue.h>
+#include <parallel/algorithm.h>
+#include <parallel/timer-wheel.h>
+#include <parallel/task.h>
+#include <parallel/priority-queue.h>
+#include <parallel/queue-metrics.h>
+#include <parallel/future.h>
+#include <parallel/sync.h>
+#include <parallel/reclaim.h>
+#include <parallel/pipeline.h>
+#include <parallel/topology.h>
+#include <memory/manager/heap.h>
+#include <memory.h>
+#include <memory/pool.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <pthread.h>
+#include <future>
+#include <sched.h>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <filesystem>
+
+static constexpr std::size_t s_task_count = 1000000;
+
+static double get_ns(std::chrono::steady_clock::time_point start, std::size_t count) noexcept
+{
+      std::chrono::duration<double, std::nano> l_time = std::chrono::steady_clock::now() - start;
+      return l_time.count() / count;
+}
+
+static std::uint64_t get_key(std::uint64_t index) noexcept
+{
+      std::uint64_t l_key = index + 0x9e3779b97f4a7c15ull;
+      l_key = (l_key ^ (l_key >> 30)) * 0xbf58476d1ce4e5b9ull;
+      l_key = (l_key ^ (l_key >> 27)) * 0x94d049bb133111ebull;
+      return l_key ^ (l_key >> 31);
+}
+
+template<typename Et>
+static void wait_idle(Et& executor) noexcept
+{
+      while(executor.is_idle() == false) {
+          sched_yield();
+      }
+}
+
+/* parallel::executor tests
+*/
+using task_executor = parallel::executor<std::function<void()>>;
+
+bool  test_01() noexcept
+{
+      std::atomic<std::size_t> l_sum(0);
+      task_executor            l_executor(4);
+      // tasks enqueued before resume() wait on the injection list
+      for(std::size_t l_index = 0; l_index < 1000; l_index++) {
+          l_executor.enqueue([&l_sum, l_index]() { l_sum.fetch_add(l_index); });
+      }
+      if(l_executor.resume() == false) {
+          return false;
+      }
+      for(std::size_t l_index = 1000; l_index < 100000; l_index++) {
+          l_executor.enqueue([&l_sum, l_index]() { l_sum.fetch_add(l_index); });
+      }
+      wait_idle(l_executor);
+      return l_sum.load() == 100000ull * 99999ull / 2u;
+}
+
+/* spawn()
+   binary task tree of the given depth, every node enqueued from within its parent
+*/
+static void spawn(task_executor& executor, std::atomic<std::size_t>& count, int depth) noexcept
+{
+      count.fetch_add(1, std::memory_order_relaxed);
+      if(depth > 0) {
+          executor.enqueue([&executor, &count, depth]() { spawn(executor, count, depth - 1); });
+          executor.enqueue([&executor, &count, depth]() { spawn(executor, count, depth - 1); });
+      }
+}
+
+bool  test_02() noexcept
+{
+      std::atomic<std::size_t> l_count(0);
+      task_executor            l_executor(4);
+      l_executor.resume();
+      l_executor.enqueue([&]() { spawn(l_executor, l_count, 16); });
+      wait_idle(l_executor);
+      return l_count.load() == (1u << 17) - 1u;
+}
+
+/* delegate_executor
+   executor with a delegate for all of the optional callbacks
+*/
+class delegate_executor: public parallel::executor<int, delegate_executor>
+{
+  public:
+  std::atomic<int>  m_sum{0};
+  std::atomic<int>  m_launch_count{0};
+  std::atomic<int>  m_finish_count{0};
+  std::atomic<int>  m_sleep_count{0};
+  std::atomic<int>  m_wake_count{0};
+
+  public:
+  delegate_executor() noexcept:
+      executor(2) {
+  }
+
+  void  queue_execute(int& value) noexcept {
+        m_sum.fetch_add(value);
+  }
+
+  void  thread_launch_event() noexcept {
+        m_launch_count++;
+  }
+
+  void  thread_finish_event() noexcept {
+        m_finish_count++;
+  }
+
+  void  thread_sleep_event() noexcept {
+        m_sleep_count++;
+  }
+
+  void  thread_wake_event() noexcept {
+        m_wake_count++;
+  }
+};
+
+bool  test_03() noexcept
+{
+      delegate_executor l_executor;
+      l_executor.resume();
+      for(int l_index = 1; l_index <= 100; l_index++) {
+          l_executor.enqueue(l_index);
+      }
+      wait_idle(l_executor);
+      // give the workers time to park
+      while(l_executor.m_sleep_count.load() < 2) {
+          sched_yield();
+      }
+      l_executor.enqueue(1000);
+      wait_idle(l_executor);
+      l_executor.suspend();
+      return (l_executor.m_sum.load() == 6050) &&
+          (l_executor.m_launch_count.load() == 2) &&
+          (l_executor.m_finish_count.load() == 2) &&
+          (l_executor.m_wake_count.load() >= 1);
+}
+
+bool  test_04() noexcept
+{
+      for(std::size_t l_worker_count: {1u, 2u, 4u, 8u}) {
+          std::atomic<std::size_t> l_count(0);
+          task_executor            l_executor(l_worker_count);
+          l_executor.resume();
+          auto l_inject_start = std::chrono::steady_clock::now();
+          for(std::size_t l_index = 0; l_index < s_task_count; l_index++) {
+              l_executor.enqueue([&l_count]() { l_count.fetch_add(1, std::memory_order_relaxed); });
+          }
+          wait_idle(l_executor);
+          double l_inject_ns = get_ns(l_inject_start, s_task_count);
+          auto l_spawn_start = std::chrono::steady_clock::now();
+          l_executor.enqueue([&]() { spawn(l_executor, l_count, 19); });
+          wait_idle(l_executor);
+          double l_spawn_ns = get_ns(l_spawn_start, (1u << 20) - 1u);
+          printf("    executor: %zu workers: external %.2f ns/task (%.2f Mtasks/s), spawned %.2f ns/task (%.2f Mtasks/s)\n",
+              l_worker_count, l_inject_ns, 1000.0 / l_inject_ns, l_spawn_ns, 1000.0 / l_spawn_ns
+          );
+          if(l_count.load() != s_task_count + (1u << 20) - 1u) {
+              return false;
+          }
+      }
+      return true;
+}
+
+/* parallel::queue<atomic_thread_base> tests
+*/
+using atomic_queue = parallel::queue<std::function<void()>, atomic_thread_base>;
+
+/* test_queue()
+   <producer_count> threads enqueue s_task_count tasks in total; all of them must be executed
+*/
+template<typename Qt>
+static bool test_queue(const char* name, std::size_t producer_count) noexcept
+{
+      std::atomic<std::size_t> l_count(0);
+      std::size_t              l_share = s_task_count / producer_count;
+      std::vector<std::thread> l_threads;
+      Qt                       l_queue;
+      if(l_queue.resume() == false) {
+          return false;
+      }
+      auto l_start = std::chrono::steady_clock::now();
+      for(std::size_t l_thread = 0; l_thread < producer_count; l_thread++) {
+          l_threads.emplace_back([&]() {
+              for(std::size_t l_index = 0; l_index < l_share; l_index++) {
+                  l_queue.enqueue([&l_count]() { l_count.fetch_add(1, std::memory_order_relaxed); });
+              }
+          });
+      }
+      for(auto& l_thread: l_threads) {
+          l_thread.join();
+      }
+      while(l_count.load() < l_share * producer_count) {
+          sched_yield();
+      }
+      printf("    %s: %zu producers: %.2f ns/task\n", name, producer_count, get_ns(l_start, l_share * producer_count));
+      l_queue.suspend();
+      return true;
+}
+
+bool  test_11() noexcept
+{
+      std::atomic<int> l_sum(0);
+      atomic_queue     l_queue;
+      for(int l_index = 1; l_index <= 100; l_index++) {
+          l_queue.enqueue([&l_sum, l_index]() { l_sum.fetch_add(l_index); });
+      }
+      l_queue.resume();
+      while(l_sum.load() < 5050) {
+          sched_yield();
+      }
+      // let the consumer park, then wake it up again
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      if(l_queue.is_idle() == false) {
+          return false;
+      }
+      l_queue.enqueue([&l_sum]() { l_sum.fetch_add(1000); });
+      while(l_sum.load() < 6050) {
+          sched_yield();
+      }
+      return l_queue.suspend();
+}
+
+bool  test_12() noexcept
+{
+      for(std::size_t l_producer_count: {1u, 2u, 4u}) {
+          if(test_queue<atomic_queue>("queue<atomic_thread_base>", l_producer_count) == false) {
+              return false;
+          }
+      }
+      return true;
+}
+
+/* parallel::queue<posix_thread_base> tests
+*/
+using posix_queue = parallel::queue<std::function<void()>, posix_thread_base>;
+
+bool  test_21() noexcept
+{
+      std::atomic<int> l_sum(0);
+      posix_queue      l_queue;
+      l_queue.set_batch_size(8);
+      for(int l_index = 1; l_index <= 100; l_index++) {
+          l_queue.enqueue([&l_sum, l_index]() { l_sum.fetch_add(l_index); });
+      }
+      // drop the last one before the consumer starts
+      if(l_queue.dequeue() == false) {
+          return false;
+      }
+      l_queue.resume();
+      while(l_sum.load() < 4950) {
+          sched_yield();
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      l_queue.enqueue([&l_sum]() { l_sum.fetch_add(1000); });
+      while(l_sum.load() < 5950) {
+          sched_yield();
+      }
+      l_queue.suspend();
+      return l_sum.load() == 5950;
+}
+
+bool  test_22() noexcept
+{
+      for(std::size_t l_producer_count: {1u, 2u, 4u}) {
+          if(test_queue<posix_queue>("queue<posix_thread_base>", l_producer_count) == false) {
+              return false;
+          }
+      }
+      return true;
+}
+
+/* parallel::multi_queue tests
+*/
+using task_multi_queue = parallel::multi_queue<std::function<void()>>;
+
+bool  test_31() noexcept
+{
+      std::atomic<int> l_sum(0);
+      task_multi_queue l_queue(4);
+      cpu_set_t        l_cpu_set;
+      CPU_ZERO(std::addressof(l_cpu_set));
+      CPU_SET(0, std::addressof(l_cpu_set));
+      l_queue.set_affinity(0, l_cpu_set);
+      l_queue.set_batch_size(16);
+      l_queue.resume();
+      for(int l_index = 1; l_index <= 1000; l_index++) {
+          l_queue.enqueue([&l_sum, l_index]() { l_sum.fetch_add(l_index); });
+      }
+      while(l_sum.load() < 500500) {
+          sched_yield();
+      }
+      l_queue.suspend();
+      std::uint64_t l_task_count = 0;
+      for(std::size_t l_index = 0; l_index < l_queue.get_worker_count(); l_index++) {
+          l_task_count += l_queue.get_stats(l_index).task_count;
+      }
+      cpu_set_t l_get_set;
+      if((l_queue.get_affinity(0, l_get_set) == false) ||
+          (CPU_EQUAL(std::addressof(l_get_set), std::addressof(l_cpu_set)) == false)) {
+          return false;
+      }
+      return (l_task_count == 1000) &&
+          (l_queue.get_pending_count() == 0);
+}
+
+bool  test_32() noexcept
+{
+      for(std::size_t l_worker_count: {1u, 2u, 4u}) {
+          std::atomic<std::size_t> l_count(0);
+          task_multi_queue         l_queue(l_worker_count);
+          l_queue.set_batch_size(256);
+          l_queue.resume();
+          auto l_start = std::chrono::steady_clock::now();
+          for(std::size_t l_index = 0; l_index < s_task_count; l_index++) {
+              l_queue.enqueue([&l_count]() { l_count.fetch_add(1, std::memory_order_relaxed); });
+          }
+          while(l_count.load() < s_task_count) {
+              sched_yield();
+          }
+          printf("    multi_queue: %zu workers: %.2f ns/task\n", l_worker_count, get_ns(l_start, s_task_count));
+          l_queue.suspend();
+          for(std::size_t l_index = 0; l_index < l_worker_count; l_index++) {
+              parallel::worker_stats l_stats = l_queue.get_stats(l_index);
+              printf("        worker %zu: %llu tasks in %llu batches, %llu wakes, %.2f ms busy\n",
+                  l_index,
+                  static_cast<unsigned long long>(l_stats.task_count),
+                  static_cast<unsigned long long>(l_stats.batch_count),
+                  static_cast<unsigned long long>(l_stats.wake_count),
+                  l_stats.busy_time / 1000000.0
+              );
+          }
+      }
+      return true;
+}
+
+/* parallel algorithm tests
+*/
+bool  test_41() noexcept
+{
+      parallel::range_executor     l_executor(4);
+      memory::pool<std::uint64_t>  l_pool;
+      std::vector<std::uint64_t>   l_vector(100003);
+      l_executor.resume();
+      for(std::uint64_t l_index = 0; l_index < 100003; l_index++) {
+          *l_pool.raw_get() = l_index;
+      }
+      // an empty pool yields null pointers, i.e. an empty range
+      memory::pool<std::uint64_t>  l_empty;
+      parallel::for_each(l_executor, l_empty.get_head(), l_empty.get_tail(), [](std::uint64_t&) {});
+      parallel::for_each(l_executor, l_pool.get_head(), l_pool.get_tail(), [](std::uint64_t& value) { value *= 2; }, 64);
+      parallel::transform(l_executor, l_pool.get_head(), l_pool.get_tail(), l_vector.begin(), [](std::uint64_t value) { return value + 1; });
+      for(std::uint64_t l_index = 0; l_index < 100003; l_index++) {
+          if(l_vector[l_index] != l_index * 2 + 1) {
+              return false;
+          }
+      }
+      std::atomic<std::size_t> l_count(0);
+      parallel::parallel_for(l_executor, 10, 100010, [&](std::size_t index) {
+          if(l_vector[index - 10] == (index - 10) * 2 + 1) {
+              l_count.fetch_add(1, std::memory_order_relaxed);
+          }
+      });
+      if(l_count.load() != 100000) {
+          return false;
+      }
+      // nested calls from a worker run sequentially instead of waiting on their own workers
+      std::atomic<std::size_t> l_nested_count(0);
+      parallel::parallel_for(l_executor, 0, 64, [&](std::size_t) {
+          parallel::parallel_for(l_executor, 0, 1000, [&](std::size_t) { l_nested_count.fetch_add(1, std::memory_order_relaxed); });
+      }, 1);
+      if(l_nested_count.load() != 64000) {
+          return false;
+      }
+      std::uint64_t l_sum = parallel::reduce(l_executor, l_vector.begin(), l_vector.end(), std::uint64_t(0), std::plus<>());
+      std::uint64_t l_max = parallel::reduce(l_executor, l_pool.get_head(), l_pool.get_tail(), std::uint64_t(0),
+          [](std::uint64_t lhs, std::uint64_t rhs) { return lhs > rhs ? lhs : rhs; }
+      );
+      return (l_sum == 100003ull * 100003ull) &&
+          (l_max == 200004);
+}
+
+bool  test_42() noexcept
+{
+      std::vector<double> l_vector(16 * 1048576);
+      for(std::size_t l_index = 0; l_index < l_vector.size(); l_index++) {
+          l_vector[l_index] = l_index & 1023;
+      }
+      auto   l_start = std::chrono::steady_clock::now();
+      double l_expected = 0.0;
+      for(double i_value: l_vector) {
+          l_expected += i_value;
+      }
+      printf("    reduce: sequential: %.3f ns/element\n", get_ns(l_start, l_vector.size()));
+      for(std::size_t l_worker_count: {1u, 2u, 4u}) {
+          parallel::range_executor l_executor(l_worker_count);
+          l_executor.resume();
+          l_start = std::chrono::steady_clock::now();
+          double l_sum = parallel::reduce(l_executor, l_vector.begin(), l_vector.end(), 0.0, std::plus<>());
+          printf("    reduce: %zu workers: %.3f ns/element\n", l_worker_count, get_ns(l_start, l_vector.size()));
+          if(l_sum != l_expected) {
+              return false;
+          }
+      }
+      return true;
+}
+
+/* parallel::timer_wheel tests
+*/
+struct timer_task
+{
+  std::uint64_t m_expiry;
+  std::atomic<std::size_t>* m_count;
+
+  inline  void  operator()() noexcept {
+          m_count->fetch_add(1, std::memory_order_relaxed);
+  }
+};
+
+using task_timer_wheel = parallel::timer_wheel<timer_task, parallel::queue<timer_task, posix_thread_base>>;
+
+bool  test_51() noexcept
+{
+      std::size_t                   l_count = 0;
+      std::size_t                   l_error_count = 0;
+      std::vector<parallel::timer_id> l_ids;
+      task_timer_wheel              l_wheel(nullptr);
+      std::uint64_t                 l_tick = l_wheel.get_tick();
+      std::uint64_t                 l_key = 0;
+      auto l_expire = [&](timer_task&& task) {
+          // the wheel has moved to the tick after the one being expired
+          if(task.m_expiry != l_wheel.get_tick() - 1) {
+              l_error_count++;
+          }
+          l_count++;
+      };
+      // delays spanning all levels, every fourth timer cancelled
+      for(std::size_t l_index = 0; l_index < 100000; l_index++) {
+          std::uint64_t l_delay = get_key(l_key++) % (std::uint64_t(1) << (l_index % 25));
+          l_ids.push_back(l_wheel.insert(l_delay, timer_task{l_tick + l_delay, nullptr}));
+      }
+      for(std::size_t l_index = 0; l_index < l_ids.size(); l_index += 4) {
+          if(l_wheel.cancel(l_ids[l_index]) == false) {
+              return false;
+          }
+      }
+      if(l_wheel.cancel(l_ids[0]) ||
+          (l_wheel.get_timer_count() != 75000)) {
+          return false;
+      }
+      // beyond the range of the wheel
+      l_wheel.insert((std::uint64_t(1) << 32) + 12345, timer_task{l_tick + (std::uint64_t(1) << 32) + 12345, nullptr});
+      while(l_wheel.get_timer_count()) {
+          l_tick += get_key(l_key++) % 100000;
+          l_wheel.advance(l_tick, l_expire);
+      }
+      if((l_count != 75001) ||
+          (l_error_count != 0)) {
+          return false;
+      }
+      // expired ids are stale; periodic timers keep firing until cancelled
+      if(l_wheel.cancel(l_ids[1])) {
+          return false;
+      }
+      l_count = 0;
+      parallel::timer_id l_periodic = l_wheel.insert_periodic(10, 300, timer_task{l_wheel.get_tick() + 10, nullptr});
+      l_wheel.advance(l_wheel.get_tick() + 10, l_expire);
+      for(int l_round = 0; l_round < 10; l_round++) {
+          l_wheel.advance(l_wheel.get_tick() + 299, [&](timer_task&&) { l_count++; });
+      }
+      if((l_count != 11) ||
+          (l_wheel.cancel(l_periodic) == false) ||
+          (l_wheel.advance(l_wheel.get_tick() + 1000, l_expire) != 0)) {
+          return false;
+      }
+      return l_error_count == 0;
+}
+
+bool  test_52() noexcept
+{
+      std::size_t l_timer_count = 1000000;
+      std::atomic<std::size_t> l_count(0);
+      parallel::queue<timer_task, posix_thread_base> l_queue;
+      task_timer_wheel            l_wheel(std::addressof(l_queue));
+      std::vector<parallel::timer_id> l_ids(l_timer_count);
+      std::uint64_t               l_key = 0;
+      std::uint64_t               l_tick = l_wheel.get_tick();
+      l_queue.resume();
+      auto l_start = std::chrono::steady_clock::now();
+      for(std::size_t l_index = 0; l_index < l_timer_count; l_index++) {
+          l_ids[l_index] = l_wheel.insert(get_key(l_key++) % 60000, timer_task{0, std::addressof(l_count)});
+      }
+      printf("    timer_wheel: insert %.2f ns/timer\n", get_ns(l_start, l_timer_count));
+      l_start = std::chrono::steady_clock::now();
+      for(std::size_t l_index = 0; l_index < l_timer_count; l_index += 2) {
+          l_wheel.cancel(l_ids[l_index]);
+      }
+      printf("    timer_wheel: cancel %.2f ns/timer\n", get_ns(l_start, l_timer_count / 2));
+      l_start = std::chrono::steady_clock::now();
+      std::size_t l_expire_count = 0;
+      while(l_wheel.get_timer_count()) {
+          l_tick += 100;
+          l_expire_count += l_wheel.advance(l_tick);
+      }
+      while(l_count.load() < l_expire_count) {
+          sched_yield();
+      }
+      printf("    timer_wheel: expire into queue %.2f ns/timer\n", get_ns(l_start, l_expire_count));
+      l_queue.suspend();
+      return (l_expire_count == l_timer_count / 2) &&
+          (l_count == l_timer_count / 2);
+}
+
+/* parallel::task tests
+*/
+class count_heap: public heap
+{
+  public:
+  std::atomic<std::size_t> m_alloc_count{0};
+  std::atomic<std::size_t> m_free_count{0};
+
+  protected:
+  virtual void* do_allocate(std::size_t size, std::size_t align) noexcept override {
+          m_alloc_count++;
+          return heap::do_allocate(size, align);
+  }
+
+  virtual void  do_deallocate(void* p, std::size_t size, std::size_t align) noexcept override {
+          m_free_count++;
+          heap::do_deallocate(p, size, align);
+  }
+};
+
+static parallel::task<int> get_square(std::allocator_arg_t, fragment*, int value) noexcept
+{
+      co_return value * value;
+}
+
+static parallel::task<int> get_sum_of_squares(std::allocator_arg_t, fragment* resource, int count) noexcept
+{
+      int l_sum = 0;
+      for(int l_index = 1; l_index <= count; l_index++) {
+          l_sum += co_await get_square(std::allocator_arg, resource, l_index);
+      }
+      co_return l_sum;
+}
+
+static parallel::task<void> set_value(int& value) noexcept
+{
+      value = co_await get_square(std::allocator_arg, fragment::get_default(), 7);
+}
+
+bool  test_61() noexcept
+{
+      count_heap l_resource;
+      {
+          parallel::task<int> l_task = get_sum_of_squares(std::allocator_arg, std::addressof(l_resource), 10);
+          if(l_task.is_ready() ||
+              (l_resource.m_alloc_count != 1)) {
+              return false;
+          }
+          l_task.start();
+          if((l_task.is_ready() == false) ||
+              (l_task.get_value() != 385)) {
+              return false;
+          }
+      }
+      if((l_resource.m_alloc_count != 11) ||
+          (l_resource.m_free_count != 11)) {
+          return false;
+      }
+      int l_value = 0;
+      parallel::task<void> l_task = set_value(l_value);
+      l_task.start();
+      l_task.wait();
+      return l_value == 49;
+}
+
+using handle_executor = parallel::executor<std::coroutine_handle<>>;
+using handle_queue = parallel::queue<std::coroutine_handle<>, posix_thread_base>;
+
+static parallel::task<std::size_t> get_hops(handle_executor& executor, handle_queue& queue, std::size_t count) noexcept
+{
+      std::size_t l_hops = 0;
+      for(std::size_t l_index = 0; l_index < count; l_index++) {
+          if(l_index & 1) {
+              co_await parallel::resume_on(executor);
+              if(executor.has_local_worker()) {
+                  l_hops++;
+              }
+          } else {
+              co_await parallel::resume_on(queue);
+              if(executor.has_local_worker() == false) {
+                  l_hops++;
+              }
+          }
+      }
+      co_return l_hops;
+}
+
+static parallel::task<std::uint64_t> get_wake_tick(parallel::timer_wheel<std::coroutine_handle<>, handle_queue>& wheel, std::atomic<std::uint64_t>& tick) noexcept
+{
+      co_await parallel::resume_after(wheel, 100);
+      co_return tick.load();
+}
+
+bool  test_62() noexcept
+{
+      handle_executor l_executor(2);
+      handle_queue    l_queue;
+      l_executor.resume();
+      l_queue.resume();
+      std::vector<parallel::task<std::size_t>> l_tasks;
+      for(int l_index = 0; l_index < 16; l_index++) {
+          l_tasks.push_back(get_hops(l_executor, l_queue, 1000));
+          l_tasks.back().start();
+      }
+      for(auto& i_task: l_tasks) {
+          i_task.wait();
+          if(i_task.get_value() != 1000) {
+              return false;
+          }
+      }
+      // the timer awaitable resumes on the wheel's target queue once the wheel has been advanced
+      std::atomic<std::uint64_t> l_tick(0);
+      parallel::timer_wheel<std::coroutine_handle<>, handle_queue> l_wheel(std::addressof(l_queue));
+      parallel::task<std::uint64_t> l_task = get_wake_tick(l_wheel, l_tick);
+      l_task.start();
+      for(std::uint64_t l_offset = 1; l_offset <= 200; l_offset++) {
+          l_tick.store(l_offset);
+          l_wheel.advance(l_wheel.get_tick());
+      }
+      l_task.wait();
+      l_queue.suspend();
+      l_executor.suspend();
+      return l_task.get_value() >= 100;
+}
+
+bool  test_63() noexcept
+{
+      std::size_t l_count = 1000000;
+      auto l_start = std::chrono::steady_clock::now();
+      for(std::size_t l_index = 0; l_index < l_count; l_index++) {
+          parallel::task<int> l_task = get_square(std::allocator_arg, fragment::get_default(), l_index & 1023);
+          l_task.start();
+      }
+      printf("    task: create, run and destroy %.2f ns/task\n", get_ns(l_start, l_count));
+      return true;
+}
+
+/* parallel::priority_queue tests
+*/
+using task_priority_queue = parallel::priority_queue<std::function<void()>, 4>;
+
+bool  test_71() noexcept
+{
+      std::vector<std::size_t> l_order;
+      task_priority_queue      l_queue;
+      l_queue.set_batch_size(0);
+      l_queue.set_starvation_limit(0);
+      for(std::size_t l_index = 0; l_index < 400; l_index++) {
+          std::size_t l_priority = (l_index * 7) % 5;
+          l_queue.enqueue(l_priority, [&l_order, l_priority]() { l_order.push_back(l_priority < 4 ? l_priority : 3); });
+      }
+      if((l_queue.get_pending_count() != 400) ||
+          (l_queue.get_pending_count(3) != 160)) {
+          return false;
+      }
+      l_queue.resume();
+      while(l_queue.get_pending_count()) {
+          sched_yield();
+      }
+      l_queue.suspend();
+      if(l_order.size() != 400) {
+          return false;
+      }
+      for(std::size_t l_index = 1; l_index < l_order.size(); l_index++) {
+          if(l_order[l_index] < l_order[l_index - 1]) {
+              return false;
+          }
+      }
+      parallel::lane_stats l_stats = l_queue.get_stats(3);
+      return (l_stats.task_count == 160) &&
+          (l_stats.promote_count == 0) &&
+          (l_stats.wait_max > 0);
+}
+
+bool  test_72() noexcept
+{
+      std::vector<std::size_t> l_order;
+      task_priority_queue      l_queue;
+      l_queue.set_starvation_limit(parallel::nspms);
+      l_queue.enqueue(3, [&l_order]() { l_order.push_back(3); });
+      std::this_thread::sleep_for(std::chrono::milliseconds(3));
+      for(std::size_t l_index = 0; l_index < 100; l_index++) {
+          l_queue.enqueue(0, [&l_order]() { l_order.push_back(0); });
+      }
+      l_queue.resume();
+      while(l_queue.get_pending_count()) {
+          sched_yield();
+      }
+      l_queue.suspend();
+      parallel::lane_stats l_stats = l_queue.get_stats(3);
+      return (l_order.size() == 101) &&
+          (l_order[0] == 3) &&
+          (l_stats.promote_count == 1) &&
+          (l_stats.wait_time >= 3 * static_cast<std::uint64_t>(parallel::nspms));
+}
+
+bool  test_73() noexcept
+{
+      std::atomic<std::size_t> l_count(0);
+      task_priority_queue      l_queue;
+      l_queue.resume();
+      // a bulk load on the least urgent lane, with urgent tasks trickling in
+      for(std::size_t l_index = 0; l_index < 200000; l_index++) {
+          l_queue.enqueue(3, [&l_count]() { l_count.fetch_add(1, std::memory_order_relaxed); });
+          if(l_index % 1000 == 0) {
+              l_queue.enqueue(0, [&l_count]() { l_count.fetch_add(1, std::memory_order_relaxed); });
+          }
+      }
+      while(l_count.load() < 200200) {
+          sched_yield();
+      }
+      l_queue.suspend();
+      for(std::size_t l_priority: {0u, 3u}) {
+          parallel::lane_stats l_stats = l_queue.get_stats(l_priority);
+          printf("    priority_queue: lane %zu: %llu tasks, %.2f us mean wait, %.2f us max wait, %llu promoted\n",
+              l_priority,
+              static_cast<unsigned long long>(l_stats.task_count),
+              l_stats.wait_time / 1000.0 / l_stats.task_count,
+              l_stats.wait_max / 1000.0,
+              static_cast<unsigned long long>(l_stats.promote_count)
+          );
+      }
+      return l_queue.get_stats(0).task_count == 200;
+}
+
+/* parallel::queue_metrics tests
+*/
+bool  test_81() noexcept
+{
+      parallel::latency_histogram l_histogram;
+      for(std::uint64_t l_value = 1; l_value <= 1000000; l_value++) {
+          l_histogram.record(l_value);
+      }
+      for(double l_percentile: {1.0, 50.0, 90.0, 99.0, 99.9}) {
+          double l_expected = l_percentile * 10000.0;
+          double l_value = l_histogram.get_percentile(l_percentile);
+          if((l_value < l_expected) ||
+              (l_value > l_expected * 1.032)) {
+              return false;
+          }
+      }
+      if((l_histogram.get_count() != 1000000) ||
+          (l_histogram.get_max() != 1000000) ||
+          (l_histogram.get_mean() != 500000)) {
+          return false;
+      }
+      l_histogram.record(std::uint64_t(1) << 50);
+      return l_histogram.get_percentile(100.0) >= (std::uint64_t(1) << 40) - 1;
+}
+
+template<typename Qt>
+static bool test_metrics(const char* name) noexcept
+{
+      std::atomic<std::size_t> l_count(0);
+      Qt                       l_queue;
+      for(std::size_t l_index = 0; l_index < 1000; l_index++) {
+          l_queue.enqueue([&l_count]() { l_count.fetch_add(1, std::memory_order_relaxed); });
+      }
+      l_queue.resume();
+      while(l_count.load() < 1000) {
+          sched_yield();
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      for(std::size_t l_index = 0; l_index < 1000; l_index++) {
+          l_queue.enqueue([&l_count]() { std::this_thread::sleep_for(std::chrono::microseconds(1)); l_count.fetch_add(1, std::memory_order_relaxed); });
+          if(l_index % 100 == 99) {
+              std::this_thread::sleep_for(std::chrono::milliseconds(1));
+          }
+      }
+      // readable while the consumer is running
+      auto& l_metrics = l_queue.get_metrics();
+      while(l_metrics.get_dequeue_count() < 2000) {
+          sched_yield();
+      }
+      while(l_metrics.get_service_histogram().get_count() < 2000) {
+          sched_yield();
+      }
+      l_queue.suspend();
+      printf("    %s: depth max %llu, %llu wakes, %llu sleeps, wait p50 %llu ns p99 %llu ns, service p50 %llu ns\n",
+          name,
+          static_cast<unsigned long long>(l_metrics.get_depth_max()),
+          static_cast<unsigned long long>(l_metrics.get_wake_count()),
+          static_cast<unsigned long long>(l_metrics.get_sleep_count()),
+          static_cast<unsigned long long>(l_metrics.get_wait_histogram().get_percentile(50.0)),
+          static_cast<unsigned long long>(l_metrics.get_wait_histogram().get_percentile(99.0)),
+          static_cast<unsigned long long>(l_metrics.get_service_histogram().get_percentile(50.0))
+      );
+      return (l_metrics.get_enqueue_count() == 2000) &&
+          (l_metrics.get_depth() == 0) &&
+          (l_metrics.get_depth_max() >= 1000) &&
+          (l_metrics.get_wake_count() >= 1) &&
+          (l_metrics.get_wake_count() >= l_metrics.get_sleep_count()) &&
+          (l_metrics.get_wait_histogram().get_count() == 2000);
+}
+
+bool  test_82() noexcept
+{
+      using tsc_posix_queue = parallel::queue<std::function<void()>, posix_thread_base, std::pmr::vector<std::function<void()>>, parallel::queue_metrics<parallel::tsc_clock>>;
+      using coarse_atomic_queue = parallel::queue<std::function<void()>, atomic_thread_base, std::pmr::vector<std::function<void()>>, parallel::queue_metrics<parallel::coarse_clock>>;
+      return test_metrics<tsc_posix_queue>("queue<posix_thread_base, tsc_clock>") &&
+          test_metrics<coarse_atomic_queue>("queue<atomic_thread_base, coarse_clock>");
+}
+
+bool  test_83() noexcept
+{
+      using tsc_queue = parallel::queue<std::function<void()>, posix_thread_base, std::pmr::vector<std::function<void()>>, parallel::queue_metrics<parallel::tsc_clock>>;
+      using coarse_queue = parallel::queue<std::function<void()>, posix_thread_base, std::pmr::vector<std::function<void()>>, parallel::queue_metrics<parallel::coarse_clock>>;
+      return test_queue<posix_queue>("queue<posix_thread_base>", 1) &&
+          test_queue<coarse_queue>("queue<posix_thread_base, coarse_clock>", 1) &&
+          test_queue<tsc_queue>("queue<posix_thread_base, tsc_clock>", 1);
+}
+
+/* parallel::future tests
+*/
+bool  test_91() noexcept
+{
+      // values across threads, broken promises and timed waits
+      parallel::promise<int>   l_promise;
+      parallel::future<int>    l_future = l_promise.get_future();
+      if(l_promise.get_future().is_valid() ||
+          l_future.is_ready()) {
+          return false;
+      }
+      std::thread l_thread([&l_promise]() {
+          std::this_thread::sleep_for(std::chrono::milliseconds(10));
+          l_promise.set_value(42);
+      });
+      int* l_value = l_future.get();
+      l_thread.join();
+      if((l_value == nullptr) ||
+          (*l_value != 42)) {
+          return false;
+      }
+      parallel::future<int> l_broken_future;
+      {
+          parallel::promise<int> l_broken;
+          l_broken_future = l_broken.get_future();
+      }
+      if((l_broken_future.is_ready() == false) ||
+          (l_broken_future.get() != nullptr)) {
+          return false;
+      }
+      parallel::promise<void> l_late;
+      parallel::future<void>  l_late_future = l_late.get_future();
+      if(l_late_future.wait(5)) {
+          return false;
+      }
+      l_late.set_value();
+      if(l_late_future.wait(5) == false) {
+          return false;
+      }
+      // states are returned to the bank and reused
+      for(int l_index = 0; l_index < 10000; l_index++) {
+          parallel::promise<std::vector<int>> l_vector;
+          parallel::future<std::vector<int>>  l_vector_future = l_vector.get_future();
+          l_vector.set_value(std::size_t(16), l_index);
+          if(l_vector_future.get()->back() != l_index) {
+              return false;
+          }
+          parallel::promise<int> l_dropped;
+      }
+      return true;
+}
+
+bool  test_92() noexcept
+{
+      // then() chains, completed on the producing thread or immediately, and combinators
+      parallel::promise<int> l_promise;
+      std::string            l_capture(64, 'x');
+      auto l_future = l_promise.get_future()
+          .then([](int& value) { return value * 2; })
+          .then([](int& value) { return std::to_string(value); })
+          .then([l_capture](std::string& value) { return value.size() + l_capture.size(); })
+          .then([](std::size_t&) {});
+      std::thread l_thread([&l_promise]() { l_promise.set_value(21); });
+      l_future.wait();
+      l_thread.join();
+      if(l_future.get() == nullptr) {
+          return false;
+      }
+      parallel::promise<void> l_void;
+      auto l_void_future = l_void.get_future().then([]() { return 7; });
+      l_void.set_value();
+      if((l_void_future.get() == nullptr) ||
+          (*l_void_future.get() != 7)) {
+          return false;
+      }
+      parallel::future<int> l_skipped;
+      {
+          parallel::promise<int> l_broken;
+          l_skipped = l_broken.get_future().then([](int& value) { return value + 1; });
+      }
+      if(l_skipped.get() != nullptr) {
+          return false;
+      }
+      std::vector<parallel::promise<int>> l_promises(8);
+      std::vector<parallel::future<int>>  l_all_futures;
+      std::vector<parallel::future<int>>  l_any_futures;
+      for(std::size_t l_index = 0; l_index < l_promises.size(); l_index++) {
+          if(l_index & 1) {
+              l_any_futures.push_back(l_promises[l_index].get_future());
+          } else
+              l_all_futures.push_back(l_promises[l_index].get_future());
+      }
+      auto l_all = parallel::when_all(l_all_futures);
+      auto l_any = parallel::when_any(l_any_futures);
+      // a state takes a single continuation
+      if(parallel::when_all(l_all_futures).get() != nullptr) {
+          return false;
+      }
+      std::vector<std::thread> l_threads;
+      for(std::size_t l_index = 0; l_index < l_promises.size(); l_index++) {
+          l_threads.emplace_back([&l_promises, l_index]() {
+              std::this_thread::sleep_for(std::chrono::milliseconds(l_index * 2));
+              l_promises[l_index].set_value(static_cast<int>(l_index));
+          });
+      }
+      l_all.wait();
+      std::size_t* l_first = l_any.get();
+      for(auto& i_thread: l_threads) {
+          i_thread.join();
+      }
+      if((l_first == nullptr) ||
+          (*l_first >= l_any_futures.size())) {
+          return false;
+      }
+      for(std::size_t l_index = 0; l_index < l_all_futures.size(); l_index++) {
+          if(*l_all_futures[l_index].get() != static_cast<int>(l_index * 2)) {
+              return false;
+          }
+      }
+      // then() on a future when_all() already chained fails, but still lets go of the state
+      auto l_token = std::make_shared<int>(0);
+      if(true) {
+          parallel::promise<std::shared_ptr<int>>             l_shared;
+          std::vector<parallel::future<std::shared_ptr<int>>> l_shared_futures;
+          l_shared_futures.push_back(l_shared.get_future());
+          auto l_shared_all = parallel::when_all(l_shared_futures);
+          auto l_shared_then = l_shared_futures[0].then([](std::shared_ptr<int>&) { return 1; });
+          if(l_shared_then.get() != nullptr) {
+              return false;
+          }
+          l_shared.set_value(l_token);
+          l_shared_all.wait();
+      }
+      if(l_token.use_count() != 1) {
+          return false;
+      }
+      std::vector<parallel::future<int>> l_empty;
+      return parallel::when_all(l_empty).is_ready() &&
+          (parallel::when_any(l_empty).get() == nullptr);
+}
+
+bool  test_93() noexcept
+{
+      std::size_t l_count = 1000000;
+      auto l_start = std::chrono::steady_clock::now();
+      for(std::size_t l_index = 0; l_index < l_count; l_index++) {
+          parallel::promise<int> l_promise;
+          parallel::future<int>  l_future = l_promise.get_future();
+          l_promise.set_value(static_cast<int>(l_index));
+          l_future.get();
+      }
+      printf("    parallel::future: %.2f ns/value\n", get_ns(l_start, l_count));
+      l_start = std::chrono::steady_clock::now();
+      for(std::size_t l_index = 0; l_index < l_count; l_index++) {
+          std::promise<int> l_promise;
+          std::future<int>  l_future = l_promise.get_future();
+          l_promise.set_value(static_cast<int>(l_index));
+          l_future.get();
+      }
+      printf("    std::future:      %.2f ns/value\n", get_ns(l_start, l_count));
+      // completed on another thread, including thread start-up
+      std::size_t l_hop_count = 20000;
+      l_start = std::chrono::steady_clock::now();
+      for(std::size_t l_index = 0; l_index < l_hop_count; l_index++) {
+          parallel::promise<int> l_promise;
+          parallel::future<int>  l_future = l_promise.get_future();
+          std::thread l_thread([&l_promise]() { l_promise.set_value(1); });
+          l_future.wait();
+          l_thread.join();
+      }
+      printf("    parallel::future: %.2f ns/value, set on a new thread\n", get_ns(l_start, l_hop_count));
+      return true;
+}
+
+/* parallel synchronisation primitives tests
+*/
+static constexpr std::size_t s_sync_thread_count = 4;
+
+bool  test_101() noexcept
+{
+      // latch releases all waiters at once, barrier phases don't overlap
+      parallel::latch          l_latch(s_sync_thread_count);
+      parallel::latch          l_done(s_sync_thread_count);
+      std::atomic<std::size_t> l_count(0);
+      std::vector<std::thread> l_threads;
+      for(std::size_t l_index = 0; l_index < s_sync_thread_count; l_index++) {
+          l_threads.emplace_back([&]() {
+              l_count.fetch_add(1);
+              l_latch.arrive_and_wait();
+              if(l_count.load() != s_sync_thread_count) {
+                  l_count.fetch_add(1000);
+              }
+              l_done.count_down();
+          });
+      }
+      l_done.wait();
+      for(auto& i_thread: l_threads) {
+          i_thread.join();
+      }
+      if((l_count.load() != s_sync_thread_count) ||
+          (l_latch.try_wait() == false)) {
+          return false;
+      }
+      std::size_t               l_phase_count = 1000;
+      parallel::barrier         l_barrier(s_sync_thread_count);
+      std::atomic<std::size_t>  l_serial_count(0);
+      std::atomic<std::size_t>  l_error_count(0);
+      std::vector<std::size_t>  l_slots(s_sync_thread_count, 0);
+      l_threads.clear();
+      for(std::size_t l_index = 0; l_index < s_sync_thread_count; l_index++) {
+          l_threads.emplace_back([&, l_index]() {
+              for(std::size_t l_phase = 0; l_phase < l_phase_count; l_phase++) {
+                  l_slots[l_index] = l_phase;
+                  if(l_barrier.arrive_and_wait()) {
+                      l_serial_count++;
+                  }
+                  for(std::size_t i_slot: l_slots) {
+                      if(i_slot != l_phase) {
+                          l_error_count++;
+                      }
+                  }
+                  l_barrier.arrive_and_wait();
+              }
+          });
+      }
+      for(auto& i_thread: l_threads) {
+          i_thread.join();
+      }
+      return (l_error_count.load() == 0) &&
+          (l_serial_count.load() == l_phase_count) &&
+          (l_barrier.get_phase() == l_phase_count * 2);
+}
+
+bool  test_102() noexcept
+{
+      // readers never observe a torn snapshot
+      struct snapshot_t
+      {
+        std::uint64_t m_a;
+        std::uint64_t m_b;
+        std::uint64_t m_c;
+      };
+      parallel::seqlock<snapshot_t> l_lock(snapshot_t{0, 0, 0});
+      std::atomic<bool>        l_stop(false);
+      std::atomic<std::size_t> l_error_count(0);
+      std::atomic<std::size_t> l_read_count(0);
+      std::vector<std::thread> l_threads;
+      for(std::size_t l_index = 0; l_index < 2; l_index++) {
+          l_threads.emplace_back([&]() {
+              std::size_t l_reads = 0;
+              while(l_stop.load(std::memory_order_relaxed) == false) {
+                  snapshot_t l_value = l_lock.load();
+                  if((l_value.m_b != l_value.m_a * 2) ||
+                      (l_value.m_c != l_value.m_a * 3)) {
+                      l_error_count++;
+                  }
+                  l_reads++;
+              }
+              l_read_count += l_reads;
+          });
+      }
+      for(std::uint64_t l_index = 1; l_index <= 100000; l_index++) {
+          if(l_index & 1) {
+              l_lock.store(snapshot_t{l_index, l_index * 2, l_index * 3});
+          } else
+              l_lock.update([](snapshot_t& value) noexcept {
+                  value.m_a += 1;
+                  value.m_b += 2;
+                  value.m_c += 3;
+              });
+      }
+      l_stop = true;
+      for(auto& i_thread: l_threads) {
+          i_thread.join();
+      }
+      snapshot_t l_last = l_lock.load();
+      return (l_error_count.load() == 0) &&
+          (l_last.m_a == 100000) &&
+          (l_lock.get_sequence() == 200000) &&
+          (alignof(parallel::cache_aligned<int>) == global::cache_line_size) &&
+          (sizeof(parallel::cache_aligned<std::atomic<std::uint64_t>>) == global::cache_line_size);
+}
+
+template<typename Xt>
+static double get_counter_ns(std::size_t count) noexcept
+{
+      std::vector<Xt>          l_counters(s_sync_thread_count);
+      std::vector<std::thread> l_threads;
+      auto l_start = std::chrono::steady_clock::now();
+      for(std::size_t l_index = 0; l_index < s_sync_thread_count; l_index++) {
+          l_threads.emplace_back([&l_counters, l_index, count]() {
+              for(std::size_t l_iteration = 0; l_iteration < count; l_iteration++) {
+                  (*l_counters[l_index]).fetch_add(1, std::memory_order_relaxed);
+              }
+          });
+      }
+      for(auto& i_thread: l_threads) {
+          i_thread.join();
+      }
+      return get_ns(l_start, count * s_sync_thread_count);
+}
+
+template<typename Xt>
+struct plain_counter
+{
+  Xt  m_value;
+
+  inline  plain_counter() noexcept: m_value(0) {}
+  inline  Xt& operator*() noexcept { return m_value; }
+};
+
+bool  test_103() noexcept
+{
+      std::size_t l_phase_count = 20000;
+      std::vector<std::thread> l_threads;
+      // barrier
+      parallel::barrier l_barrier(s_sync_thread_count);
+      auto l_start = std::chrono::steady_clock::now();
+      for(std::size_t l_index = 0; l_index < s_sync_thread_count; l_index++) {
+          l_threads.emplace_back([&]() {
+              for(std::size_t l_phase = 0; l_phase < l_phase_count; l_phase++) {
+                  l_barrier.arrive_and_wait();
+              }
+          });
+      }
+      for(auto& i_thread: l_threads) {
+          i_thread.join();
+      }
+      printf("    parallel::barrier:  %.2f ns/phase\n", get_ns(l_start, l_phase_count));
+      pthread_barrier_t l_pthread_barrier;
+      pthread_barrier_init(std::addressof(l_pthread_barrier), nullptr, s_sync_thread_count);
+      l_threads.clear();
+      l_start = std::chrono::steady_clock::now();
+      for(std::size_t l_index = 0; l_index < s_sync_thread_count; l_index++) {
+          l_threads.emplace_back([&]() {
+              for(std::size_t l_phase = 0; l_phase < l_phase_count; l_phase++) {
+                  pthread_barrier_wait(std::addressof(l_pthread_barrier));
+              }
+          });
+      }
+      for(auto& i_thread: l_threads) {
+          i_thread.join();
+      }
+      printf("    pthread_barrier_t:  %.2f ns/phase\n", get_ns(l_start, l_phase_count));
+      pthread_barrier_destroy(std::addressof(l_pthread_barrier));
+      // latch, uncontended
+      std::size_t l_count = 1000000;
+      l_start = std::chrono::steady_clock::now();
+      for(std::size_t l_index = 0; l_index < l_count; l_index++) {
+          parallel::latch l_latch(1);
+          l_latch.count_down();
+          l_latch.wait();
+      }
+      printf("    parallel::latch:    %.2f ns/countdown\n", get_ns(l_start, l_count));
+      l_start = std::chrono::steady_clock::now();
+      for(std::size_t l_index = 0; l_index < l_count; l_index++) {
+          pthread_mutex_t l_mutex = PTHREAD_MUTEX_INITIALIZER;
+          pthread_cond_t  l_cond = PTHREAD_COND_INITIALIZER;
+          int             l_latch = 1;
+          pthread_mutex_lock(std::addressof(l_mutex));
+          if(--l_latch == 0) {
+              pthread_cond_broadcast(std::addressof(l_cond));
+          }
+          while(l_latch) {
+              pthread_cond_wait(std::addressof(l_cond), std::addressof(l_mutex));
+          }
+          pthread_mutex_unlock(std::addressof(l_mutex));
+      }
+      printf("    pthread mutex/cond: %.2f ns/countdown\n", get_ns(l_start, l_count));
+      // seqlock against a read/write lock, read side
+      parallel::seqlock<std::uint64_t> l_seqlock(1);
+      std::uint64_t l_sum = 0;
+      l_start = std::chrono::steady_clock::now();
+      for(std::size_t l_index = 0; l_index < l_count; l_index++) {
+          l_sum += l_seqlock.load();
+      }
+      printf("    parallel::seqlock:  %.2f ns/read\n", get_ns(l_start, l_count));
+      pthread_rwlock_t l_rwlock = PTHREAD_RWLOCK_INITIALIZER;
+      volatile std::uint64_t l_value = 1;
+      l_start = std::chrono::steady_clock::now();
+      for(std::size_t l_index = 0; l_index < l_count; l_index++) {
+          pthread_rwlock_rdlock(std::addressof(l_rwlock));
+          l_sum += l_value;
+          pthread_rwlock_unlock(std::addressof(l_rwlock));
+      }
+      printf("    pthread_rwlock_t:   %.2f ns/read\n", get_ns(l_start, l_count));
+      // per-thread counters
+      printf("    cache_aligned counters: %.2f ns/increment\n", get_counter_ns<parallel::cache_aligned<std::atomic<std::uint64_t>>>(l_count));
+      printf("    packed counters:        %.2f ns/increment\n", get_counter_ns<plain_counter<std::atomic<std::uint64_t>>>(l_count));
+      return l_sum == l_count * 2;
+}
+
+/* parallel reclamation tests
+*/
+struct reclaim_node
+{
+  static inline std::atomic<std::size_t> s_live_count;
+
+  reclaim_node* m_next;
+  std::size_t   m_value;
+
+  inline  reclaim_node(std::size_t value) noexcept:
+          m_next(nullptr),
+          m_value(value) {
+          s_live_count++;
+  }
+
+  inline  ~reclaim_node() {
+          m_value = 0;
+          s_live_count--;
+  }
+};
+
+template<typename Dt>
+class reclaim_stack
+{
+  Dt&   m_domain;
+  std::atomic<reclaim_node*> m_head;
+
+  public:
+  inline  reclaim_stack(Dt& domain) noexcept:
+          m_domain(domain),
+          m_head(nullptr) {
+  }
+
+  inline  void  push(std::size_t value) noexcept {
+          void*         l_data = fragment::get_default()->allocate(sizeof(reclaim_node), alignof(reclaim_node));
+          reclaim_node* l_node = new(l_data) reclaim_node(value);
+          l_node->m_next = m_head.load(std::memory_order_relaxed);
+          while(m_head.compare_exchange_weak(l_node->m_next, l_node, std::memory_order_release, std::memory_order_relaxed) == false) {
+          }
+  }
+
+  inline  std::atomic<reclaim_node*>& get_head() noexcept {
+          return m_head;
+  }
+
+  inline  bool  pop(std::size_t& value) noexcept {
+          if constexpr (std::is_same<Dt, parallel::epoch_domain>::value) {
+              parallel::epoch_guard l_guard(m_domain);
+              reclaim_node* l_node = m_head.load(std::memory_order_acquire);
+              while(l_node) {
+                  if(m_head.compare_exchange_weak(l_node, l_node->m_next, std::memory_order_acquire)) {
+                      value = l_node->m_value;
+                      m_domain.retire(l_node);
+                      return true;
+                  }
+              }
+              return false;
+          } else {
+              while(true) {
+                  reclaim_node* l_node = m_domain.protect(0, m_head);
+                  if(l_node == nullptr) {
+                      return false;
+                  }
+                  if(m_head.compare_exchange_strong(l_node, l_node->m_next, std::memory_order_acquire)) {
+                      value = l_node->m_value;
+                      m_domain.clear(0);
+                      m_domain.retire(l_node);
+                      return true;
+                  }
+              }
+          }
+  }
+};
+
+template<typename Dt>
+static bool test_reclaim_stack(Dt& domain, std::size_t thread_count, std::size_t count) noexcept
+{
+      reclaim_stack<Dt>        l_stack(domain);
+      std::atomic<std::size_t> l_error_count(0);
+      std::vector<std::thread> l_threads;
+      for(std::size_t l_index = 0; l_index < thread_count; l_index++) {
+          l_threads.emplace_back([&, l_index]() {
+              std::size_t l_value;
+              for(std::size_t l_iteration = 0; l_iteration < count; l_iteration++) {
+                  l_stack.push(l_index * count + l_iteration + 1);
+                  if((l_stack.pop(l_value) == false) ||
+                      (l_value == 0)) {
+                      l_error_count++;
+                  }
+              }
+          });
+      }
+      for(auto& i_thread: l_threads) {
+          i_thread.join();
+      }
+      std::size_t l_value;
+      while(l_stack.pop(l_value)) {
+          l_error_count++;
+      }
+      return l_error_count.load() == 0;
+}
+
+bool  test_111() noexcept
+{
+      // stack pops under an epoch domain; exiting threads hand their retired nodes over
+      parallel::epoch_domain l_domain;
+      for(int l_round = 0; l_round < 2; l_round++) {
+          if(test_reclaim_stack(l_domain, s_sync_thread_count, 100000) == false) {
+              return false;
+          }
+      }
+      if(l_domain.get_thread_count() > s_sync_thread_count + 1) {
+          return false;
+      }
+      if((l_domain.synchronize() == false) ||
+          (reclaim_node::s_live_count.load() != 0)) {
+          return false;
+      }
+      // no reclamation while a critical section is open
+      reclaim_stack<parallel::epoch_domain> l_stack(l_domain);
+      std::size_t l_value;
+      l_stack.push(1);
+      l_domain.enter();
+      std::uint64_t l_epoch = l_domain.get_epoch();
+      std::thread([&]() {
+          l_stack.pop(l_value);
+          l_domain.try_advance();
+          l_domain.try_advance();
+          l_domain.collect();
+      }).join();
+      if((reclaim_node::s_live_count.load() != 1) ||
+          (l_domain.get_epoch() > l_epoch + 1) ||
+          (l_domain.synchronize() == true)) {
+          return false;
+      }
+      l_domain.leave();
+      l_domain.synchronize();
+      if(reclaim_node::s_live_count.load() != 0) {
+          return false;
+      }
+      // posix_thread_base workers detach from the default domain when they finish
+      parallel::epoch_domain&               l_default = parallel::epoch_domain::get_default();
+      reclaim_stack<parallel::epoch_domain> l_default_stack(l_default);
+      std::atomic<std::size_t>              l_pop_count(0);
+      posix_queue l_queue;
+      l_queue.resume();
+      for(std::size_t l_index = 0; l_index < 1000; l_index++) {
+          l_default_stack.push(l_index + 1);
+          l_queue.enqueue([&l_default_stack, &l_pop_count]() {
+              std::size_t l_value;
+              if(l_default_stack.pop(l_value)) {
+                  l_pop_count++;
+              }
+          });
+      }
+      while(l_pop_count.load() < 1000) {
+          sched_yield();
+      }
+      l_queue.suspend();
+      l_default.synchronize();
+      return reclaim_node::s_live_count.load() == 0;
+}
+
+bool  test_112() noexcept
+{
+      // stack pops under a hazard domain; protected nodes survive scans
+      parallel::hazard_domain l_domain;
+      for(int l_round = 0; l_round < 2; l_round++) {
+          if(test_reclaim_stack(l_domain, s_sync_thread_count, 100000) == false) {
+              return false;
+          }
+      }
+      l_domain.collect();
+      if(reclaim_node::s_live_count.load() != 0) {
+          return false;
+      }
+      // hold on to the top node while another thread pops and retires all of them
+      reclaim_stack<parallel::hazard_domain> l_stack(l_domain);
+      for(std::size_t l_index = 0; l_index < 1000; l_index++) {
+          l_stack.push(l_index + 1);
+      }
+      reclaim_node* l_node = l_domain.protect(1, l_stack.get_head());
+      std::thread([&]() {
+          std::size_t l_value;
+          while(l_stack.pop(l_value)) {
+          }
+          l_domain.collect();
+      }).join();
+      if((reclaim_node::s_live_count.load() != 1) ||
+          (l_node->m_value != 1000)) {
+          return false;
+      }
+      l_domain.clear(1);
+      l_domain.collect();
+      return reclaim_node::s_live_count.load() == 0;
+}
+
+bool  test_113() noexcept
+{
+      std::size_t l_count = 1000000;
+      parallel::epoch_domain  l_epoch_domain;
+      parallel::hazard_domain l_hazard_domain;
+      auto l_start = std::chrono::steady_clock::now();
+      for(std::size_t l_index = 0; l_index < l_count; l_index++) {
+          parallel::epoch_guard l_guard(l_epoch_domain);
+      }
+      printf("    epoch_domain: %.2f ns/critical section\n", get_ns(l_start, l_count));
+      std::atomic<reclaim_node*> l_source(nullptr);
+      l_start = std::chrono::steady_clock::now();
+      for(std::size_t l_index = 0; l_index < l_count; l_index++) {
+          l_hazard_domain.protect(0, l_source);
+      }
+      printf("    hazard_domain: %.2f ns/protect\n", get_ns(l_start, l_count));
+      // push and pop through a stack, retiring each node against freeing it right away
+      reclaim_stack<parallel::epoch_domain>  l_epoch_stack(l_epoch_domain);
+      reclaim_stack<parallel::hazard_domain> l_hazard_stack(l_hazard_domain);
+      std::size_t l_value;
+      l_start = std::chrono::steady_clock::now();
+      for(std::size_t l_index = 0; l_index < l_count; l_index++) {
+          l_epoch_stack.push(l_index);
+          l_epoch_stack.pop(l_value);
+      }
+      printf("    epoch_domain: %.2f ns/push, pop and retire\n", get_ns(l_start, l_count));
+      l_start = std::chrono::steady_clock::now();
+      for(std::size_t l_index = 0; l_index < l_count; l_index++) {
+          l_hazard_stack.push(l_index);
+          l_hazard_stack.pop(l_value);
+      }
+      printf("    hazard_domain: %.2f ns/push, pop and retire\n", get_ns(l_start, l_count));
+      l_start = std::chrono::steady_clock::now();
+      for(std::size_t l_index = 0; l_index < l_count; l_index++) {
+          l_epoch_stack.push(l_index);
+          reclaim_node* l_node = l_epoch_stack.get_head().exchange(nullptr);
+          l_node->~reclaim_node();
+          fragment::get_default()->deallocate(l_node, sizeof(reclaim_node), alignof(reclaim_node));
+      }
+      printf("    unprotected: %.2f ns/push, pop and free\n", get_ns(l_start, l_count));
+      l_epoch_domain.synchronize();
+      l_hazard_domain.collect();
+      return reclaim_node::s_live_count.load() == 0;
+}
+
+/* parallel::pipeline tests
+*/
+bool  test_121() noexcept
+{
+      // parse, filter and transform on several threads, then sum up on one
+      std::atomic<std::uint64_t> l_sum(0);
+      parallel::stage<std::uint64_t> l_sink("sink", [&l_sum](std::uint64_t& value) { l_sum.fetch_add(value, std::memory_order_relaxed); });
+      parallel::stage<std::uint64_t, std::uint64_t> l_transform("transform", [](std::uint64_t& value, std::uint64_t& result) {
+          result = value * 3;
+          return true;
+      }, 2, 256);
+      parallel::stage<std::string, std::uint64_t> l_parse("parse", [](std::string& value, std::uint64_t& result) {
+          result = std::stoull(value);
+          return (result % 10) != 0;
+      }, 2, 256);
+      l_parse.connect(l_transform);
+      l_transform.connect(l_sink);
+      parallel::pipeline l_pipeline;
+      l_pipeline.add(l_parse);
+      l_pipeline.add(l_transform);
+      l_pipeline.add(l_sink);
+      if(l_pipeline.resume() == false) {
+          return false;
+      }
+      std::uint64_t l_expected = 0;
+      for(std::uint64_t l_index = 1; l_index <= 100000; l_index++) {
+          if(l_parse.push(std::to_string(l_index)) == false) {
+              return false;
+          }
+          if(l_index % 10) {
+              l_expected += l_index * 3;
+          }
+      }
+      l_pipeline.drain();
+      l_pipeline.suspend();
+      parallel::stage_stats l_parse_stats = l_parse.get_stats();
+      parallel::stage_stats l_sink_stats = l_sink.get_stats();
+      for(std::size_t l_index = 0; l_index < l_pipeline.get_stage_count(); l_index++) {
+          parallel::stage_base* l_stage = l_pipeline.get_stage(l_index);
+          parallel::stage_stats l_stats = l_stage->get_stats();
+          printf("    %-9s: %8lu items in %6lu batches, %.0f items/s, %lu idle, %lu stalls\n",
+              l_stage->get_name(), l_stats.item_count, l_stats.batch_count, l_stats.get_throughput(), l_stats.idle_count, l_stats.stall_count
+          );
+      }
+      // the queue itself takes move-only items without a default constructor, in batches, and
+      // destroys whatever it still holds
+      struct handle_t
+      {
+        std::shared_ptr<int> m_ptr;
+
+        inline  handle_t(std::shared_ptr<int> ptr) noexcept: m_ptr(std::move(ptr)) {
+        }
+
+        handle_t(const handle_t&) = delete;
+        handle_t(handle_t&&) noexcept = default;
+        handle_t& operator=(const handle_t&) = delete;
+        handle_t& operator=(handle_t&&) noexcept = default;
+      };
+      auto l_token = std::make_shared<int>(0);
+      if(true) {
+          parallel::ring_queue<handle_t> l_queue(4);
+          std::vector<handle_t>          l_handles;
+          for(int l_index = 0; l_index < 6; l_index++) {
+              l_handles.emplace_back(l_token);
+          }
+          if((l_queue.push(l_handles.data(), l_handles.size()) != 4) ||
+              (l_queue.is_full() == false) ||
+              (l_queue.pop(l_handles.data(), 1) != 1) ||
+              (l_queue.get_size() != 3)) {
+              return false;
+          }
+          l_handles.clear();
+          if(l_token.use_count() != 4) {
+              return false;
+          }
+      }
+      if(l_token.use_count() != 1) {
+          return false;
+      }
+      return (l_sum.load() == l_expected) &&
+          (l_parse_stats.item_count == 100000) &&
+          (l_sink_stats.item_count == 90000) &&
+          (l_parse_stats.drop_count == 0) &&
+          (l_parse_stats.batch_count <= l_parse_stats.item_count);
+}
+
+static parallel::stage_stats get_overflow_stats(parallel::overflow_mode mode, std::size_t& count) noexcept
+{
+      std::atomic<std::size_t> l_count(0);
+      parallel::stage<int> l_sink("sink", [&l_count](int&) {
+          std::this_thread::sleep_for(std::chrono::microseconds(20));
+          l_count++;
+      }, 1, 16, mode, 4);
+      parallel::stage<int, int> l_source("source", [](int& value, int& result) {
+          result = value;
+          return true;
+      }, 1, 1024, parallel::overflow_block, 16);
+      l_source.connect(l_sink);
+      parallel::pipeline l_pipeline;
+      l_pipeline.add(l_source);
+      l_pipeline.add(l_sink);
+      l_pipeline.resume();
+      for(int l_index = 0; l_index < 2000; l_index++) {
+          l_source.push(std::move(l_index));
+      }
+      l_pipeline.drain();
+      l_pipeline.suspend();
+      count = l_count.load();
+      parallel::stage_stats l_stats = l_source.get_stats();
+      l_stats.drop_count = l_sink.get_stats().drop_count;
+      return l_stats;
+}
+
+bool  test_122() noexcept
+{
+      // a slow final stage either holds the previous one back, or sheds load
+      std::size_t           l_block_count;
+      std::size_t           l_drop_count;
+      parallel::stage_stats l_block_stats = get_overflow_stats(parallel::overflow_block, l_block_count);
+      parallel::stage_stats l_drop_stats = get_overflow_stats(parallel::overflow_drop, l_drop_count);
+      printf("    overflow_block: %zu processed, %lu dropped, %lu stalls, %.2f ms stalled\n",
+          l_block_count, l_block_stats.drop_count, l_block_stats.stall_count, l_block_stats.stall_time / 1000000.0
+      );
+      printf("    overflow_drop:  %zu processed, %lu dropped, %lu stalls\n",
+          l_drop_count, l_drop_stats.drop_count, l_drop_stats.stall_count
+      );
+      return (l_block_count == 2000) &&
+          (l_block_stats.drop_count == 0) &&
+          (l_block_stats.stall_count > 0) &&
+          (l_drop_count + l_drop_stats.drop_count == 2000) &&
+          (l_drop_stats.drop_count > 0) &&
+          (l_drop_stats.stall_count == 0);
+}
+
+bool  test_123() noexcept
+{
+      std::size_t l_count = 1000000;
+      for(std::size_t l_batch_size: {1u, 16u, 64u}) {
+          std::atomic<std::uint64_t> l_sum(0);
+          parallel::stage<std::uint64_t> l_sink("sink", [&l_sum](std::uint64_t& value) { l_sum.fetch_add(value, std::memory_order_relaxed); }, 1, 1024, parallel::overflow_block, l_batch_size);
+          parallel::stage<std::uint64_t, std::uint64_t> l_transform("transform", [](std::uint64_t& value, std::uint64_t& result) {
+              result = value + 1;
+              return true;
+          }, 1, 1024, parallel::overflow_block, l_batch_size);
+          l_transform.connect(l_sink);
+          parallel::pipeline l_pipeline;
+          l_pipeline.add(l_transform);
+          l_pipeline.add(l_sink);
+          l_pipeline.resume();
+          auto l_start = std::chrono::steady_clock::now();
+          std::uint64_t l_batch[64];
+          for(std::size_t l_index = 0; l_index < l_count; l_index += l_batch_size) {
+              for(std::size_t l_offset = 0; l_offset < l_batch_size; l_offset++) {
+                  l_batch[l_offset] = l_index + l_offset;
+              }
+              l_transform.push(l_batch, l_batch_size);
+          }
+          l_pipeline.drain();
+          printf("    pipeline, batch size %2zu: %.2f ns/item\n", l_batch_size, get_ns(l_start, l_count));
+          l_pipeline.suspend();
+          if(l_sum.load() != l_count * (l_count + 1) / 2) {
+              return false;
+          }
+      }
+      return true;
+}
+
+/* parallel::topology tests
+*/
+static void  make_sysfs_file(const std::filesystem::path& path, const char* text) noexcept
+{
+      std::error_code l_error;
+      std::filesystem::create_directories(path.parent_path(), l_error);
+      if(std::FILE* l_file = std::fopen(path.c_str(), "w"); l_file != nullptr) {
+          std::fputs(text, l_file);
+          std::fclose(l_file);
+      }
+}
+
+static bool  has_placement(const parallel::topology& topology, parallel::placement_policy policy, std::size_t count, std::initializer_list<int> expected, int producer = -1) noexcept
+{
+      int l_cpus[16];
+      if(topology.get_placement(policy, count, l_cpus, producer) != count) {
+          return false;
+      }
+      return std::equal(l_cpus, l_cpus + count, expected.begin(), expected.end());
+}
+
+bool  test_131() noexcept
+{
+      // two nodes with a shared last level cache each, four cores of two SMT threads: cpu <n> and
+      // <n + 4> are siblings
+      char l_path[] = "/tmp/test-topology-XXXXXX";
+      if(mkdtemp(l_path) == nullptr) {
+          return false;
+      }
+      std::filesystem::path l_root(l_path);
+      make_sysfs_file(l_root / "online", "0-7\n");
+      for(int l_cpu = 0; l_cpu < 8; l_cpu++) {
+          int         l_core = l_cpu % 4;
+          int         l_node = l_core / 2;
+          std::string l_siblings = std::to_string(l_core) + "," + std::to_string(l_core + 4) + "\n";
+          std::string l_shared = l_node ? "2-3,6-7\n" : "0-1,4-5\n";
+          std::filesystem::path l_cpu_path = l_root / ("cpu" + std::to_string(l_cpu));
+          make_sysfs_file(l_cpu_path / "topology" / "thread_siblings_list", l_siblings.c_str());
+          make_sysfs_file(l_cpu_path / "topology" / "physical_package_id", l_node ? "1\n" : "0\n");
+          make_sysfs_file(l_cpu_path / "cache" / "index0" / "level", "1\n");
+          make_sysfs_file(l_cpu_path / "cache" / "index0" / "type", "Data\n");
+          make_sysfs_file(l_cpu_path / "cache" / "index0" / "shared_cpu_list", l_siblings.c_str());
+          make_sysfs_file(l_cpu_path / "cache" / "index1" / "level", "1\n");
+          make_sysfs_file(l_cpu_path / "cache" / "index1" / "type", "Instruction\n");
+          make_sysfs_file(l_cpu_path / "cache" / "index1" / "shared_cpu_list", l_siblings.c_str());
+          make_sysfs_file(l_cpu_path / "cache" / "index2" / "level", "3\n");
+          make_sysfs_file(l_cpu_path / "cache" / "index2" / "type", "Unified\n");
+          make_sysfs_file(l_cpu_path / "cache" / "index2" / "shared_cpu_list", l_shared.c_str());
+          std::error_code l_error;
+          std::filesystem::create_directories(l_cpu_path / ("node" + std::to_string(l_node)), l_error);
+      }
+      parallel::topology l_topology;
+      bool l_result = l_topology.load(l_path);
+      std::error_code l_error;
+      std::filesystem::remove_all(l_root, l_error);
+      if(l_result == false) {
+          return false;
+      }
+      if((l_topology.get_cpu_count() != 8) ||
+          (l_topology.get_core_count() != 4) ||
+          (l_topology.get_llc_count() != 2) ||
+          (l_topology.get_package_count() != 2) ||
+          (l_topology.get_node_count() != 2)) {
+          return false;
+      }
+      const parallel::cpu_info* l_info = l_topology.get_cpu_info(6);
+      if((l_info == nullptr) ||
+          (l_info->thread != 1) ||
+          (l_info->node != 1) ||
+          (l_info->core_rank != 0) ||
+          (l_topology.get_cpu_info(8) != nullptr)) {
+          return false;
+      }
+      return has_placement(l_topology, parallel::place_compact, 4, {0, 4, 1, 5}) &&
+          has_placement(l_topology, parallel::place_scatter, 4, {0, 2, 1, 3}) &&
+          has_placement(l_topology, parallel::place_physical_core, 6, {0, 1, 2, 3, 4, 5}) &&
+          has_placement(l_topology, parallel::place_physical_core, 10, {0, 1, 2, 3, 4, 5, 6, 7, 0, 1}) &&
+          has_placement(l_topology, parallel::place_same_llc, 4, {2, 3, 6, 7}, 6) &&
+          (l_topology.get_placement(parallel::place_none, 4, nullptr) == 0);
+}
+
+bool  test_132() noexcept
+{
+      const parallel::topology& l_topology = parallel::topology::get_default();
+      printf("    %d cpus, %d cores, %d cache domains, %d packages, %d nodes\n",
+          l_topology.get_cpu_count(), l_topology.get_core_count(), l_topology.get_llc_count(), l_topology.get_package_count(), l_topology.get_node_count()
+      );
+      if((l_topology.get_cpu_count() == 0) ||
+          (l_topology.get_core_count() > l_topology.get_cpu_count())) {
+          return false;
+      }
+      std::size_t l_count = 1000000;
+      for(parallel::placement_policy l_policy: {parallel::place_none, parallel::place_compact, parallel::place_physical_core}) {
+          std::atomic<std::size_t> l_sum(0);
+          task_executor            l_executor(s_sync_thread_count);
+          if(l_executor.set_placement(l_policy) == false) {
+              return false;
+          }
+          l_executor.resume();
+          auto l_start = std::chrono::steady_clock::now();
+          for(std::size_t l_index = 0; l_index < l_count; l_index++) {
+              l_executor.enqueue([&l_sum]() { l_sum.fetch_add(1, std::memory_order_relaxed); });
+          }
+          wait_idle(l_executor);
+          printf("    executor, placement %d: %.2f ns/task\n", l_policy, get_ns(l_start, l_count));
+          l_executor.suspend();
+          if(l_sum.load() != l_count) {
+              return false;
+          }
+      }
+      task_multi_queue l_queue(2);
+      cpu_set_t        l_cpu_set;
+      int              l_cpu;
+      l_topology.get_placement(parallel::place_scatter, 1, std::addressof(l_cpu));
+      return l_queue.set_placement(parallel::place_scatter) &&
+          l_queue.get_affinity(0, l_cpu_set) &&
+          (CPU_COUNT(std::addressof(l_cpu_set)) == 1) &&
+          CPU_ISSET(l_cpu, std::addressof(l_cpu_set));
+}
+
+int   main(int, char**)
+{
+      test::scenario<basic> t01(test_01, "[01] parallel::executor external tasks");
+      test::scenario<basic> t02(test_02, "[02] parallel::executor nested tasks");
+      test::scenario<basic> t03(test_03, "[03] parallel::executor delegate callbacks");
+      test::scenario<basic> t04(test_04, "[04] parallel::executor task throughput scaling");
+
+      test::scenario<basic> t11(test_11, "[11] parallel::queue<atomic_thread_base> park and wake");
+      test::scenario<basic> t12(test_12, "[12] parallel::queue<atomic_thread_base> throughput");
+
+      test::scenario<basic> t21(test_21, "[21] parallel::queue<posix_thread_base> batches and dequeue()");
+      test::scenario<basic> t22(test_22, "[22] parallel::queue<posix_thread_base> throughput");
+
+      test::scenario<basic> t31(test_31, "[31] parallel::multi_queue workers, affinity and stats");
+      test::scenario<basic> t32(test_32, "[32] parallel::multi_queue throughput");
+
+      test::scenario<basic> t41(test_41, "[41] parallel algorithms over pool and vector ranges");
+      test::scenario<basic> t42(test_42, "[42] parallel::reduce scaling");
+
+      test::scenario<basic> t51(test_51, "[51] parallel::timer_wheel expiry ticks, cancel() and periodic timers");
+      test::scenario<basic> t52(test_52, "[52] parallel::timer_wheel throughput into a queue");
+
+      test::scenario<basic> t61(test_61, "[61] parallel::task nesting and frame allocation");
+      test::scenario<basic> t62(test_62, "[62] parallel::task resume_on() and resume_after()");
+      test::scenario<basic> t63(test_63, "[63] parallel::task overhead");
+
+      test::scenario<basic> t71(test_71, "[71] parallel::priority_queue lane order");
+      test::scenario<basic> t72(test_72, "[72] parallel::priority_queue starvation protection");
+      test::scenario<basic> t73(test_73, "[73] parallel::priority_queue urgent tasks under bulk load");
+
+      test::scenario<basic> t81(test_81, "[81] parallel::latency_histogram percentiles");
+      test::scenario<basic> t82(test_82, "[82] parallel::queue_metrics counters and histograms");
+      test::scenario<basic> t83(test_83, "[83] parallel::queue_metrics overhead");
+
+      test::scenario<basic> t91(test_91, "[91] parallel::future values, broken promises and timed waits");
+      test::scenario<basic> t92(test_92, "[92] parallel::future then(), when_all() and when_any()");
+      test::scenario<basic> t93(test_93, "[93] parallel::future overhead against std::future");
+
+      test::scenario<basic> t101(test_101, "[101] parallel::latch and parallel::barrier phases");
+      test::scenario<basic> t102(test_102, "[102] parallel::seqlock snapshots and parallel::cache_aligned layout");
+      test::scenario<basic> t103(test_103, "[103] parallel synchronisation primitives against pthread");
+
+      test::scenario<basic> t111(test_111, "[111] parallel::epoch_domain reclamation and thread detach");
+      test::scenario<basic> t112(test_112, "[112] parallel::hazard_domain reclamation and protected nodes");
+      test::scenario<basic> t113(test_113, "[113] parallel reclamation overhead");
+
+      test::scenario<basic> t121(test_121, "[121] parallel::pipeline stages, filtering and stats");
+      test::scenario<basic> t122(test_122, "[122] parallel::pipeline blocking and dropping backpressure");
+      test::scenario<basic> t123(test_123, "[123] parallel::pipeline batch handoff throughput");
+
+      test::scenario<basic> t131(test_131, "[131] parallel::topology discovery and placement policies");
+      test::scenario<basic> t132(test_132, "[132] parallel::topology of the running machine and placed workers");
+
+      return test::run_all();
+}
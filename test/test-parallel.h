@@ -0,0 +1,4 @@
+#ifndef  test_parallel_h
+#define  test_parallel_h
+#include <test.h>
+#endif